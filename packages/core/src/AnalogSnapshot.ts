@@ -0,0 +1,27 @@
+/**
+ * All analog values of a hub, read at once.
+ */
+export interface AnalogSnapshot {
+    /**
+     * Time when the values have been received, in ms of a monotonic clock.
+     */
+    timestampMs: number;
+    /**
+     * Voltages of the analog inputs in mV
+     */
+    analogInputs: number[];
+    digitalBusCurrent: number;
+    i2cCurrent: number;
+    servoCurrent: number;
+    batteryCurrent: number;
+    /**
+     * Currents of each motor in mA
+     */
+    motorCurrents: number[];
+    fiveVoltBusVoltage: number;
+    batteryVoltage: number;
+    /**
+     * Temperature in degrees Celsius
+     */
+    temperature: number;
+}
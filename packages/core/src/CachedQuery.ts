@@ -0,0 +1,9 @@
+//  These MUST be ordered so that their numeric values match the values specified in librhsp's include/rhsp/cache.h file
+export enum CachedQuery {
+    Version = 0,
+    ServoConfiguration,
+    DigitalDirection,
+    MotorChannelMode,
+    ClosedLoopCoefficients,
+    I2CConfiguration,
+}
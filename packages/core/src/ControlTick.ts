@@ -0,0 +1,84 @@
+import { BulkInputData } from "./BulkInputData.js";
+import { I2COperation } from "./I2COperation.js";
+import { I2CSample } from "./I2CSample.js";
+
+/**
+ * What each control tick does, besides sending the outputs that have changed
+ * since the previous tick.
+ */
+export interface ControlTickPlan {
+    /**
+     * Read the bulk input data. If outputs are sent, they are sent in the
+     * same transaction.
+     */
+    bulkInput?: boolean;
+    /**
+     * I2C operations to run every tick, e.g. sensor reads
+     */
+    i2cReads?: { i2cChannel: number; operations: I2COperation[] }[];
+}
+
+/**
+ * An output value that is sent by the next control tick
+ */
+export interface ControlTickOutput {
+    type: "motorConstantPower" | "motorTargetVelocity" | "servoPulseWidth";
+    channel: number;
+    value: number;
+}
+
+export interface ControlTickResult {
+    /**
+     * Index of the tick since the scheduler has been started
+     */
+    tick: number;
+    /**
+     * Time when the tick started, in ms of a monotonic clock
+     */
+    timestampMs: number;
+    /**
+     * How late the tick started, in microseconds
+     */
+    jitterUs: number;
+    /**
+     * Number of ticks skipped right before this one because the previous
+     * tick overran
+     */
+    missedTicks: number;
+    /**
+     * Set if sending the outputs or reading the bulk input data failed
+     */
+    error?: Error;
+    bulkInputData?: BulkInputData;
+    /**
+     * One sample per entry of {@link ControlTickPlan.i2cReads}
+     */
+    i2cReads: I2CSample[];
+}
+
+export interface ControlTickStats {
+    ticks: number;
+    missedTicks: number;
+    /**
+     * Number of ticks that took longer than the period
+     */
+    overruns: number;
+    /**
+     * Number of results that were dropped because the event loop did not
+     * take them in time
+     */
+    droppedResults: number;
+    /**
+     * Upper bounds of the histogram buckets in microseconds. The histograms
+     * have one more bucket for everything above the last bound.
+     */
+    histogramBucketsUs: number[];
+    /**
+     * How late ticks started
+     */
+    jitterHistogram: number[];
+    /**
+     * How long ticks took
+     */
+    durationHistogram: number[];
+}
@@ -0,0 +1,27 @@
+/**
+ * Encoder state of all motors, recorded each time bulk input data is received.
+ * Each array has one entry per motor channel.
+ */
+export interface EncoderSample {
+    /**
+     * Time when the bulk input data has been received, in µs of a monotonic
+     * clock. Wraps around after about 71 minutes.
+     */
+    timestampUs: number;
+    /**
+     * Encoder positions in counts
+     */
+    position: number[];
+    /**
+     * Velocities in counts per second, as reported by the hub
+     */
+    velocity: number[];
+    /**
+     * Velocities in counts per second, estimated from the position history
+     */
+    filteredVelocity: number[];
+    /**
+     * Accelerations in counts per second², estimated from the position history
+     */
+    filteredAcceleration: number[];
+}
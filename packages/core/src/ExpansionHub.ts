@@ -11,11 +11,26 @@ import { DigitalState } from "./DigitalState.js";
 import { I2CSpeedCode } from "./I2CSpeedCode.js";
 import { I2CWriteStatus } from "./I2CWriteStatus.js";
 import { I2CReadStatus } from "./I2CReadStatus.js";
+import { I2COperation } from "./I2COperation.js";
+import { AnalogSnapshot } from "./AnalogSnapshot.js";
+import { I2CSampleBatch } from "./I2CSample.js";
+import { EncoderSample } from "./EncoderSample.js";
+import { LinkStats } from "./LinkStats.js";
 import { PidCoefficients } from "./PidCoefficients.js";
 import { DigitalChannelDirection } from "./DigitalChannelDirection.js";
 import { MotorMode } from "./MotorMode.js";
 import { PidfCoefficients } from "./PidfCoefficients.js";
 import { ClosedLoopControlAlgorithm } from "./ClosedLoopControlAlgorithm.js";
+import { CachedQuery } from "./CachedQuery.js";
+import { MotionProfile, MotionProfileResult } from "./MotionProfile.js";
+import { RealtimeOptions, RealtimeStats } from "./RealtimeOptions.js";
+import { SynchronizedBulkInputData } from "./SynchronizedBulkInputData.js";
+import {
+    ControlTickOutput,
+    ControlTickPlan,
+    ControlTickResult,
+    ControlTickStats,
+} from "./ControlTick.js";
 
 export type ParentExpansionHub = ParentRevHub & ExpansionHub;
 
@@ -23,6 +38,105 @@ export interface ExpansionHub extends RevHub {
     readonly isOpen: boolean;
     responseTimeoutMs: number;
 
+    /**
+     * If true, the response timeout of each command is derived from the
+     * measured round trip time of that command, so lost responses are
+     * detected within a few milliseconds. {@link responseTimeoutMs} stays the
+     * upper limit and is used for commands that have not been measured yet.
+     */
+    adaptiveResponseTimeout: boolean;
+
+    /**
+     * How often a query is sent again after a timeout, corrupted or
+     * mismatched response before the error is reported. Queries that change
+     * the hub state and all setters are never repeated. Defaults to 2.
+     */
+    readRetryLimit: number;
+
+    /**
+     * Read the link health counters of this hub. Cheap enough to call every
+     * control loop iteration.
+     */
+    getLinkStats(): LinkStats;
+
+    /**
+     * Read the link health counters of the serial port of this hub. They
+     * include the traffic of all hubs on the port.
+     */
+    getSerialLinkStats(): LinkStats;
+
+    /**
+     * Publish the latest bulk input data, ADC values, module status and link
+     * stats of this hub into a POSIX shared memory segment as they are
+     * received, so other processes on this machine can read them without
+     * sending commands. Readers use rhsp_openTelemetry and
+     * rhsp_readTelemetry from librhsp. Fails if the segment exists already.
+     * Only supported on Linux and macOS.
+     * @param name shared memory object name, such as "/rhsp-hub-2"
+     */
+    publishTelemetry(name: string): Promise<void>;
+
+    /**
+     * Stop publishing telemetry and remove the shared memory segment. Also
+     * happens when the hub is closed.
+     */
+    stopPublishingTelemetry(): Promise<void>;
+
+    /**
+     * Set the scheduling options of the native threads of this hub. Running
+     * threads apply them at the start of their next period, threads started
+     * later apply them when they start.
+     * @param options
+     */
+    setRealtimeOptions(options: RealtimeOptions): void;
+
+    /**
+     * Read the timing of the native threads of this hub that are running.
+     */
+    getRealtimeStats(): RealtimeStats[];
+
+    /**
+     * Run a plan at a fixed period from a native thread, independent of the
+     * event loop. Each tick sends the outputs set with
+     * {@link setControlTickOutputs} since the previous tick, runs the plan and
+     * passes all results to onTick at once. If the event loop falls behind,
+     * results are dropped rather than queued. Starting a scheduler replaces
+     * the running one.
+     * @param periodMs time between the start of two ticks
+     * @param plan what each tick does
+     * @param onTick called with the results of each tick
+     */
+    startControlTick(
+        periodMs: number,
+        plan: ControlTickPlan,
+        onTick: (result: ControlTickResult) => void,
+    ): void;
+
+    /**
+     * Stop the control tick scheduler.
+     */
+    stopControlTick(): void;
+
+    /**
+     * Set outputs to be sent by the next control tick. Only the last value of
+     * each output is sent.
+     * @param outputs
+     */
+    setControlTickOutputs(outputs: ControlTickOutput[]): void;
+
+    /**
+     * Read the timing of the control tick scheduler, or undefined if it is
+     * not running.
+     */
+    getControlTickStats(): ControlTickStats | undefined;
+
+    /**
+     * If true, motor, servo and digital output setters called during the same
+     * event loop turn are coalesced into one output frame, which is committed
+     * once the turn is over.
+     */
+    coalesceOutputs: boolean;
+
     /**
      * Closes this hub and releases any resources bound to it.
      * If this hub is a parent hub, the serial port will be closed
@@ -30,6 +144,21 @@ export interface ExpansionHub extends RevHub {
      * it has been closed.
      */
     close(): void;
+
+    /**
+     * Answer repeated queries of the given kind from a cache for ttlMs milliseconds
+     * instead of sending them to the hub. Setting a value of that kind, a fail safe, or
+     * a hub reset drops the cached responses. A ttlMs of 0 (the default) disables caching.
+     *
+     * @param query the kind of query to cache
+     * @param ttlMs time to live of cached responses in milliseconds
+     */
+    setQueryCacheTtl(query: CachedQuery, ttlMs: number): Promise<void>;
+
+    /**
+     * Drop all cached query responses.
+     */
+    clearQueryCache(): Promise<void>;
     sendWriteCommand(packetTypeID: number, payload: number[]): Promise<number[]>;
     sendReadCommand(packetTypeID: number, payload: number[]): Promise<number[]>;
     getModuleStatus(clearStatusAfterResponse: boolean): Promise<ModuleStatus>;
@@ -60,6 +189,28 @@ export interface ExpansionHub extends RevHub {
      */
     getBulkInputData(): Promise<BulkInputData>;
 
+    /**
+     * Read the bulk input data of this hub and of its expansion hub children
+     * at once. The requests are sent back to back without waiting for each
+     * response, so the snapshots are only a few packet times apart. A hub that
+     * does not answer is reported in its own sample. Can only be called on a
+     * parent hub.
+     */
+    getBulkInputDataFromAllHubs(): Promise<SynchronizedBulkInputData>;
+
+    /**
+     * Start deferring motor, servo and digital output setters. Their values
+     * are sent by {@link commitOutputFrame}, and their promises settle once it
+     * has sent them.
+     */
+    beginOutputFrame(): void;
+
+    /**
+     * Send the values set since {@link beginOutputFrame}, in a single bulk output
+     * packet when possible, and read bulk input data.
+     */
+    commitOutputFrame(): Promise<BulkInputData>;
+
     /**
      * Read the value of an analog channel in mV.
      *
@@ -109,6 +260,12 @@ export interface ExpansionHub extends RevHub {
      */
     getTemperature(): Promise<number>;
 
+    /**
+     * Read all analog inputs, currents, voltages and the temperature at once.
+     * This is much faster than calling the individual getters.
+     */
+    getAnalogSnapshot(): Promise<AnalogSnapshot>;
+
     setPhoneChargeControl(chargeEnable: boolean): Promise<void>;
     getPhoneChargeControl(): Promise<boolean>;
 
@@ -244,6 +401,44 @@ export interface ExpansionHub extends RevHub {
         register: number,
     ): Promise<number[]>;
 
+    /**
+     * Run several I2C operations in order in a single call. This avoids a round trip
+     * to javascript for each register access, e.g. during sensor initialization.
+     * @param i2cChannel
+     * @param operations operations to run
+     * @return the bytes read by each operation. Writes return an empty array.
+     */
+    runI2COperations(i2cChannel: number, operations: I2COperation[]): Promise<number[][]>;
+
+    /**
+     * Run a list of I2C operations periodically on a native thread. Samples are
+     * buffered until they are drained with {@link drainI2CSamples}. Starting a
+     * sampler replaces any sampler running on the same channel.
+     * @param i2cChannel
+     * @param operations operations to run for each sample
+     * @param periodMs time between two samples, at least 1
+     * @param capacity number of samples that can be buffered, in range 1 -
+     * 4096. Defaults to 256.
+     */
+    startI2CSampler(
+        i2cChannel: number,
+        operations: I2COperation[],
+        periodMs: number,
+        capacity?: number,
+    ): void;
+
+    /**
+     * Stop the sampler of a channel. Samples that have not been drained are lost.
+     * @param i2cChannel
+     */
+    stopI2CSampler(i2cChannel: number): void;
+
+    /**
+     * Get all samples taken since the last call.
+     * @param i2cChannel
+     */
+    drainI2CSamples(i2cChannel: number): I2CSampleBatch;
+
     // Motor
     /**
      * Configure a specific motor
@@ -366,6 +561,50 @@ export interface ExpansionHub extends RevHub {
      */
     getMotorEncoderPosition(motorChannel: number): Promise<number>;
 
+    /**
+     * Get the encoder states recorded from the bulk input data received so far,
+     * newest first. Does not communicate with the hub.
+     * @param maxSamples maximum number of samples to return. Defaults to all
+     * recorded samples.
+     */
+    getEncoderHistory(maxSamples?: number): Promise<EncoderSample[]>;
+
+    /**
+     * Get the newest recorded encoder state, or undefined if no bulk input data
+     * has been received yet. Does not communicate with the hub.
+     */
+    getLatestEncoderSample(): Promise<EncoderSample | undefined>;
+
+    /**
+     * Set the gains of the alpha-beta-gamma filter that estimates velocity
+     * and acceleration from the encoder positions. Higher gains follow the
+     * measurements faster, lower gains smooth more.
+     * @param alpha position gain in range (0, 1]
+     * @param beta velocity gain in range (0, 2]
+     * @param gamma acceleration gain in range [0, 1]
+     */
+    setEncoderFilterGains(alpha: number, beta: number, gamma: number): Promise<void>;
+
+    /**
+     * Move a motor along a trapezoidal or S-curve profile. Velocity setpoints
+     * are sent from a native thread at a fixed rate, batched with the
+     * setpoints of profiles running on other channels. The motor must be
+     * enabled and in velocity mode. Starting a profile replaces any profile
+     * running on the same channel.
+     * @param motorChannel
+     * @param profile limits of the move
+     * @return resolves once the profile has ended and the motor has been
+     * stopped
+     */
+    runMotionProfile(motorChannel: number, profile: MotionProfile): Promise<MotionProfileResult>;
+
+    /**
+     * Stop the profile running on a channel. Its promise resolves with
+     * cancelled set.
+     * @param motorChannel
+     */
+    cancelMotionProfile(motorChannel: number): void;
+
     /**
      * Set the Closed Loop Control Coefficients for PID mode.
      *
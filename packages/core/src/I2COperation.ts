@@ -0,0 +1,20 @@
+/**
+ * Writes bytes to an I2C device. To write a register, put the register address first.
+ */
+export interface I2CWriteOperation {
+    type: "write";
+    address: number;
+    bytes: number[];
+}
+
+/**
+ * Reads bytes from an I2C device. If register is given, it is written before reading.
+ */
+export interface I2CReadOperation {
+    type: "read";
+    address: number;
+    numBytes: number;
+    register?: number;
+}
+
+export type I2COperation = I2CWriteOperation | I2CReadOperation;
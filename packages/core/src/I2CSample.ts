@@ -0,0 +1,22 @@
+export interface I2CSample {
+    /**
+     * Time when the sample was taken, in ms of a monotonic clock.
+     */
+    timestampMs: number;
+    /**
+     * Bytes returned by all read operations of the sampler, in order.
+     */
+    bytes: number[];
+    /**
+     * Set if running the operations failed. bytes is empty in that case.
+     */
+    error?: Error;
+}
+
+export interface I2CSampleBatch {
+    samples: I2CSample[];
+    /**
+     * Number of samples that were dropped because they were not drained in time.
+     */
+    droppedSamples: number;
+}
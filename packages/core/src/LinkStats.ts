@@ -0,0 +1,38 @@
+/**
+ * Link health counters. Counters only increase and wrap around at 2^32, so
+ * compare two readings by their difference.
+ */
+export interface LinkStats {
+    framesSent: number;
+    /**
+     * Frames received with a valid checksum
+     */
+    framesReceived: number;
+    bytesSent: number;
+    bytesReceived: number;
+    checksumErrors: number;
+    /**
+     * Number of times the receiver dropped a partial frame because of a bad
+     * sync byte, an invalid length or a checksum error
+     */
+    resyncs: number;
+    /**
+     * Bytes that were not part of a valid frame
+     */
+    discardedBytes: number;
+    timeouts: number;
+    nacks: number;
+    /**
+     * Number of received NACKs per NACK code. Codes that have not been
+     * received are omitted.
+     */
+    nacksByCode: Record<number, number>;
+    /**
+     * ACKs that had the attention required flag set
+     */
+    attentionRequired: number;
+    /**
+     * Queries that were sent again after a transient error
+     */
+    retries: number;
+}
@@ -0,0 +1,39 @@
+/**
+ * Limits of a move run by {@link ExpansionHub.runMotionProfile}. Units are
+ * encoder counts and seconds. The move starts and ends at rest.
+ */
+export interface MotionProfile {
+    /**
+     * Distance to move in counts, relative to the current position. Negative to move backwards.
+     */
+    distance: number;
+    /**
+     * Maximum velocity in counts per second
+     */
+    maxVelocity: number;
+    /**
+     * Maximum acceleration in counts per second^2
+     */
+    maxAcceleration: number;
+    /**
+     * Maximum jerk in counts per second^3 for an S-curve profile. Omit or set
+     * to 0 for a trapezoidal profile.
+     */
+    maxJerk?: number;
+    /**
+     * Velocity added per count that the motor lags behind the profile, in 1/s.
+     * Defaults to 0, which streams the profile velocity only.
+     */
+    positionGain?: number;
+}
+
+export interface MotionProfileResult {
+    /**
+     * Encoder position in counts when the profile ended
+     */
+    position: number;
+    /**
+     * True if the profile has been cancelled or replaced before it completed
+     */
+    cancelled: boolean;
+}
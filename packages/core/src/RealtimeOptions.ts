@@ -0,0 +1,46 @@
+/**
+ * Scheduling options of the native threads of a hub: keep alive, I2C
+ * samplers and motion profiles. Only supported on Linux. Raising the
+ * priority needs CAP_SYS_NICE or a suitable RLIMIT_RTPRIO, and locking memory
+ * needs a large enough RLIMIT_MEMLOCK.
+ */
+export interface RealtimeOptions {
+    /**
+     * SCHED_FIFO priority from 1 to 99. 0 or omitted for the default scheduler.
+     */
+    priority?: number;
+    /**
+     * CPU to run the threads on. Omit to run on any CPU.
+     */
+    cpu?: number;
+    /**
+     * Pre-fault and lock the stack of each thread and the buffers it uses
+     * every period, so that no page fault can delay a transaction.
+     */
+    lockMemory?: boolean;
+}
+
+/**
+ * Timing of one native thread of a hub
+ */
+export interface RealtimeStats {
+    /**
+     * "keepAlive", "i2cSampler<channel>" or "motionProfile"
+     */
+    thread: string;
+    periods: number;
+    /**
+     * Number of periods that could not be run on time. For keep alive, the
+     * number of times the hub has been idle for longer than the interval.
+     */
+    missedDeadlines: number;
+    /**
+     * Latest the thread has woken up after a deadline, in microseconds
+     */
+    maxLatenessUs: number;
+    /**
+     * False if the last options could not be applied to the thread, for
+     * example because of missing privileges
+     */
+    optionsApplied: boolean;
+}
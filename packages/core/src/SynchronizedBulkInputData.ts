@@ -0,0 +1,30 @@
+import { BulkInputData } from "./BulkInputData.js";
+import { RevHub } from "./RevHub.js";
+
+export interface HubBulkInputSample {
+    hub: RevHub;
+    /**
+     * Time when the response was received, in microseconds of a monotonic
+     * clock. Set if bulkInputData is set.
+     */
+    timestampUs?: number;
+    /**
+     * Set if the hub did not answer
+     */
+    error?: Error;
+    bulkInputData?: BulkInputData;
+}
+
+/**
+ * Bulk input data of a parent hub and its children, requested back to back
+ */
+export interface SynchronizedBulkInputData {
+    /**
+     * One sample per hub, the parent first
+     */
+    samples: HubBulkInputSample[];
+    /**
+     * Time between the first and last response, in microseconds
+     */
+    skewUs: number;
+}
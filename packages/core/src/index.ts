@@ -3,22 +3,32 @@ export * from "./ExpansionHub.js";
 export * from "./RevHub.js";
 export * from "./RevHubType.js";
 export * from "./led-pattern.js";
+export * from "./AnalogSnapshot.js";
 export * from "./BulkInputData.js";
+export * from "./CachedQuery.js";
 export * from "./DebugGroup.js";
 export * from "./DigitalChannelDirection.js";
 export * from "./DigitalState.js";
 export * from "./DiscoveredAddresses.js";
+export * from "./EncoderSample.js";
+export * from "./I2COperation.js";
+export * from "./I2CSample.js";
 export * from "./I2CReadStatus.js";
 export * from "./I2CSpeedCode.js";
 export * from "./I2CWriteStatus.js";
 export * from "./LedPattern.js";
+export * from "./LinkStats.js";
 export * from "./ModuleInterface.js";
 export * from "./ModuleStatus.js";
 export * from "./PidCoefficients.js";
 export * from "./PidfCoefficients.js";
+export * from "./RealtimeOptions.js";
 export * from "./ClosedLoopControlAlgorithm.js";
+export * from "./ControlTick.js";
 export * from "./Rgb.js";
+export * from "./SynchronizedBulkInputData.js";
 export * from "./MotorMode.js";
+export * from "./MotionProfile.js";
 export * from "./VerbosityLevel.js";
 export * from "./Version.js";
 export * from "./general-errors/HubNotRespondingError.js";
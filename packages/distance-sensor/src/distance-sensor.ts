@@ -10,9 +10,13 @@ export class DistanceSensor {
      * @param channel the I2C channel this sensor is plugged into.
      */
     constructor(hub: ExpansionHub, channel: number) {
+        this.hub = hub;
+        this.channel = channel;
         this.device = new VL53L0X(hub, channel);
     }
 
+    private readonly hub: ExpansionHub;
+    private readonly channel: number;
     private readonly device: DistanceSensorDriver;
     private timer?: NodeJS.Timer;
     private isInitialized = false;
@@ -38,7 +42,9 @@ export class DistanceSensor {
     }
 
     /**
-     * Begin recording distance continuously.
+     * Begin recording distance continuously. Measurements are taken natively at
+     * a fixed rate and delivered to the callback in batches, so a busy event loop
+     * delays the callback but not the measurements.
      * @param onDistanceRecorded callback for when a distance is measured in mm.
      * @param interval interval at which to start measurement.
      */
@@ -52,9 +58,18 @@ export class DistanceSensor {
             );
         }
         this.stop();
-        this.timer = setInterval(async () => {
-            let distance = await this.getDistanceMillimeters();
-            onDistanceRecorded(distance);
+        this.hub.startI2CSampler(
+            this.channel,
+            this.device.measurementOperations(),
+            interval,
+        );
+        this.timer = setInterval(() => {
+            let batch = this.hub.drainI2CSamples(this.channel);
+            for (let sample of batch.samples) {
+                onDistanceRecorded(
+                    sample.error ? -1 : this.device.decodeDistance(sample.bytes),
+                );
+            }
         }, interval);
     }
 
@@ -64,6 +79,8 @@ export class DistanceSensor {
     stop() {
         if (this.timer) {
             clearInterval(this.timer);
+            this.timer = undefined;
+            this.hub.stopI2CSampler(this.channel);
         }
     }
 }
@@ -1,4 +1,16 @@
+import { I2COperation } from "@rev-robotics/rev-hub-core";
+
 export interface DistanceSensorDriver {
     getDistanceMillimeters(): Promise<number>;
     setup(): Promise<void>;
+
+    /**
+     * I2C operations that take one measurement. Used to sample the sensor natively.
+     */
+    measurementOperations(): I2COperation[];
+
+    /**
+     * Convert the bytes read by {@link measurementOperations} to a distance in mm.
+     */
+    decodeDistance(bytes: number[]): number;
 }
@@ -1,4 +1,4 @@
-import { ExpansionHub } from "@rev-robotics/rev-hub-core";
+import { ExpansionHub, I2COperation } from "@rev-robotics/rev-hub-core";
 import * as register from "../registers.js";
 import { SYSTEM_SEQUENCE_CONFIG } from "../registers.js";
 import {
@@ -8,6 +8,7 @@ import {
     writeInt,
     writeRegister,
     writeRegisterMultipleBytes,
+    writeRegisters,
     writeShort,
 } from "../i2c-utils.js";
 import { DistanceSensorDriver } from "./DistanceSensorDriver.js";
@@ -79,114 +80,135 @@ export class VL53L0X implements DistanceSensorDriver {
         return -1;
     }
 
-    async initData() {
-        await this.writeRegister(0x88, 0x00);
-
-        await this.writeRegister(0x80, 0x01);
-        await this.writeRegister(0xff, 0x01);
-        await this.writeRegister(0x00, 0x00);
-
-        this.stopValue = await this.readRegister(0x91);
-
-        await this.writeRegister(0x00, 0x01);
-        await this.writeRegister(0xff, 0x00);
-        await this.writeRegister(0x80, 0x00);
+    measurementOperations(): I2COperation[] {
+        return [
+            {
+                type: "read",
+                address: this.address,
+                numBytes: 2,
+                register: register.RESULT_RANGE_STATUS + 10,
+            },
+            this.writeOperation(register.SYSTEM_INTERRUPT_CLEAR, 0x01),
+        ];
     }
 
-    async loadTuningSettings() {
-        await this.writeRegister(0xff, 0x01);
-        await this.writeRegister(0x00, 0x00);
-
-        await this.writeRegister(0xff, 0x00);
-        await this.writeRegister(0x09, 0x00);
-        await this.writeRegister(0x10, 0x00);
-        await this.writeRegister(0x11, 0x00);
-
-        await this.writeRegister(0x24, 0x01);
-        await this.writeRegister(0x25, 0xff);
-        await this.writeRegister(0x75, 0x00);
-
-        await this.writeRegister(0xff, 0x01);
-        await this.writeRegister(0x4e, 0x2c);
-        await this.writeRegister(0x48, 0x00);
-        await this.writeRegister(0x30, 0x20);
-
-        await this.writeRegister(0xff, 0x00);
-        await this.writeRegister(0x30, 0x09);
-        await this.writeRegister(0x54, 0x00);
-        await this.writeRegister(0x31, 0x04);
-        await this.writeRegister(0x32, 0x03);
-        await this.writeRegister(0x40, 0x83);
-        await this.writeRegister(0x46, 0x25);
-        await this.writeRegister(0x60, 0x00);
-        await this.writeRegister(0x27, 0x00);
-        await this.writeRegister(0x50, 0x06);
-        await this.writeRegister(0x51, 0x00);
-        await this.writeRegister(0x52, 0x96);
-        await this.writeRegister(0x56, 0x08);
-        await this.writeRegister(0x57, 0x30);
-        await this.writeRegister(0x61, 0x00);
-        await this.writeRegister(0x62, 0x00);
-        await this.writeRegister(0x64, 0x00);
-        await this.writeRegister(0x65, 0x00);
-        await this.writeRegister(0x66, 0xa0);
-
-        await this.writeRegister(0xff, 0x01);
-        await this.writeRegister(0x22, 0x32);
-        await this.writeRegister(0x47, 0x14);
-        await this.writeRegister(0x49, 0xff);
-        await this.writeRegister(0x4a, 0x00);
-
-        await this.writeRegister(0xff, 0x00);
-        await this.writeRegister(0x7a, 0x0a);
-        await this.writeRegister(0x7b, 0x00);
-        await this.writeRegister(0x78, 0x21);
-
-        await this.writeRegister(0xff, 0x01);
-        await this.writeRegister(0x23, 0x34);
-        await this.writeRegister(0x42, 0x00);
-        await this.writeRegister(0x44, 0xff);
-        await this.writeRegister(0x45, 0x26);
-        await this.writeRegister(0x46, 0x05);
-        await this.writeRegister(0x40, 0x40);
-        await this.writeRegister(0x0e, 0x06);
-        await this.writeRegister(0x20, 0x1a);
-        await this.writeRegister(0x43, 0x40);
-
-        await this.writeRegister(0xff, 0x00);
-        await this.writeRegister(0x34, 0x03);
-        await this.writeRegister(0x35, 0x44);
+    decodeDistance(bytes: number[]): number {
+        return (bytes[0] << 8) | bytes[1];
+    }
 
-        await this.writeRegister(0xff, 0x01);
-        await this.writeRegister(0x31, 0x04);
-        await this.writeRegister(0x4b, 0x09);
-        await this.writeRegister(0x4c, 0x05);
-        await this.writeRegister(0x4d, 0x04);
+    async initData() {
+        let results = await this.hub.runI2COperations(this.channel, [
+            this.writeOperation(0x88, 0x00),
 
-        await this.writeRegister(0xff, 0x00);
-        await this.writeRegister(0x44, 0x00);
-        await this.writeRegister(0x45, 0x20);
-        await this.writeRegister(0x47, 0x08);
-        await this.writeRegister(0x48, 0x28);
-        await this.writeRegister(0x67, 0x00);
-        await this.writeRegister(0x70, 0x04);
-        await this.writeRegister(0x71, 0x01);
-        await this.writeRegister(0x72, 0xfe);
-        await this.writeRegister(0x76, 0x00);
-        await this.writeRegister(0x77, 0x00);
+            this.writeOperation(0x80, 0x01),
+            this.writeOperation(0xff, 0x01),
+            this.writeOperation(0x00, 0x00),
 
-        await this.writeRegister(0xff, 0x01);
-        await this.writeRegister(0x0d, 0x01);
+            { type: "read", address: this.address, numBytes: 1, register: 0x91 },
 
-        await this.writeRegister(0xff, 0x00);
-        await this.writeRegister(0x80, 0x01);
-        await this.writeRegister(0x01, 0xf8);
+            this.writeOperation(0x00, 0x01),
+            this.writeOperation(0xff, 0x00),
+            this.writeOperation(0x80, 0x00),
+        ]);
+        this.stopValue = results[4][0];
+    }
 
-        await this.writeRegister(0xff, 0x01);
-        await this.writeRegister(0x8e, 0x01);
-        await this.writeRegister(0x00, 0x01);
-        await this.writeRegister(0xff, 0x00);
-        await this.writeRegister(0x80, 0x00);
+    async loadTuningSettings() {
+        await this.writeRegisters([
+            [0xff, 0x01],
+            [0x00, 0x00],
+
+            [0xff, 0x00],
+            [0x09, 0x00],
+            [0x10, 0x00],
+            [0x11, 0x00],
+
+            [0x24, 0x01],
+            [0x25, 0xff],
+            [0x75, 0x00],
+
+            [0xff, 0x01],
+            [0x4e, 0x2c],
+            [0x48, 0x00],
+            [0x30, 0x20],
+
+            [0xff, 0x00],
+            [0x30, 0x09],
+            [0x54, 0x00],
+            [0x31, 0x04],
+            [0x32, 0x03],
+            [0x40, 0x83],
+            [0x46, 0x25],
+            [0x60, 0x00],
+            [0x27, 0x00],
+            [0x50, 0x06],
+            [0x51, 0x00],
+            [0x52, 0x96],
+            [0x56, 0x08],
+            [0x57, 0x30],
+            [0x61, 0x00],
+            [0x62, 0x00],
+            [0x64, 0x00],
+            [0x65, 0x00],
+            [0x66, 0xa0],
+
+            [0xff, 0x01],
+            [0x22, 0x32],
+            [0x47, 0x14],
+            [0x49, 0xff],
+            [0x4a, 0x00],
+
+            [0xff, 0x00],
+            [0x7a, 0x0a],
+            [0x7b, 0x00],
+            [0x78, 0x21],
+
+            [0xff, 0x01],
+            [0x23, 0x34],
+            [0x42, 0x00],
+            [0x44, 0xff],
+            [0x45, 0x26],
+            [0x46, 0x05],
+            [0x40, 0x40],
+            [0x0e, 0x06],
+            [0x20, 0x1a],
+            [0x43, 0x40],
+
+            [0xff, 0x00],
+            [0x34, 0x03],
+            [0x35, 0x44],
+
+            [0xff, 0x01],
+            [0x31, 0x04],
+            [0x4b, 0x09],
+            [0x4c, 0x05],
+            [0x4d, 0x04],
+
+            [0xff, 0x00],
+            [0x44, 0x00],
+            [0x45, 0x20],
+            [0x47, 0x08],
+            [0x48, 0x28],
+            [0x67, 0x00],
+            [0x70, 0x04],
+            [0x71, 0x01],
+            [0x72, 0xfe],
+            [0x76, 0x00],
+            [0x77, 0x00],
+
+            [0xff, 0x01],
+            [0x0d, 0x01],
+
+            [0xff, 0x00],
+            [0x80, 0x01],
+            [0x01, 0xf8],
+
+            [0xff, 0x01],
+            [0x8e, 0x01],
+            [0x00, 0x01],
+            [0xff, 0x00],
+            [0x80, 0x00],
+        ]);
     }
 
     private async initialize() {
@@ -539,6 +561,14 @@ export class VL53L0X implements DistanceSensorDriver {
         await writeRegister(this.hub, this.channel, this.address, register, value);
     }
 
+    private async writeRegisters(values: [register: number, value: number][]) {
+        await writeRegisters(this.hub, this.channel, this.address, values);
+    }
+
+    private writeOperation(register: number, value: number): I2COperation {
+        return { type: "write", address: this.address, bytes: [register, value] };
+    }
+
     private async writeShort(register: number, value: number) {
         await writeShort(this.hub, this.channel, this.address, register, value);
     }
@@ -39,6 +39,25 @@ export async function writeRegister(
     await hub.writeI2CMultipleBytes(channel, address, [register, value]);
 }
 
+/**
+ * Writes several registers in a single call to the hub.
+ */
+export async function writeRegisters(
+    hub: ExpansionHub,
+    channel: number,
+    address: number,
+    values: [register: number, value: number][],
+): Promise<void> {
+    await hub.runI2COperations(
+        channel,
+        values.map(([register, value]) => ({
+            type: "write",
+            address: address,
+            bytes: [register, value],
+        })),
+    );
+}
+
 export async function writeShort(
     hub: ExpansionHub,
     channel: number,
@@ -11,6 +11,7 @@ export {
     BatteryTooLowToRunMotorError,
     BatteryTooLowToRunServoError,
     BulkInputData,
+    CachedQuery,
     ClosedLoopControlAlgorithm,
     CommandImplementationPendingError,
     CommandNotSupportedError,
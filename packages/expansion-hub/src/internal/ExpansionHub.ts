@@ -1,35 +1,59 @@
-import { NackCode, NativeRevHub, Serial as SerialPort } from "@rev-robotics/rhsplib";
 import {
+    NackCode,
+    NativeOutputFrameResult,
+    NativeOutputFrameSetter,
+    NativeRevHub,
+    Serial as SerialPort,
+} from "@rev-robotics/rhsplib";
+import {
+    AnalogSnapshot,
     BulkInputData,
+    CachedQuery,
     ClosedLoopControlAlgorithm,
+    ControlTickOutput,
+    ControlTickPlan,
+    ControlTickResult,
+    ControlTickStats,
     DebugGroup,
     DigitalChannelDirection,
     DigitalState,
+    EncoderSample,
     ExpansionHub,
+    I2COperation,
     I2CReadStatus,
+    I2CSampleBatch,
     I2CSpeedCode,
     I2CWriteStatus,
     LedPattern,
+    LinkStats,
     ModuleInterface,
     ModuleStatus,
+    MotionProfile,
+    MotionProfileResult,
     MotorMode,
     NoExpansionHubWithAddressError,
     ParameterOutOfRangeError,
-    I2cOperationInProgressError,
     ParentRevHub,
     PidCoefficients,
     PidfCoefficients,
+    RealtimeOptions,
+    RealtimeStats,
     RevHub,
     RevHubType,
     Rgb,
+    SynchronizedBulkInputData,
     TimeoutError,
     VerbosityLevel,
     Version,
 } from "@rev-robotics/rev-hub-core";
 import { closeSerialPort } from "../open-rev-hub.js";
 import { EventEmitter } from "events";
-import { startKeepAlive } from "../start-keep-alive.js";
-import { convertErrorPromise, convertErrorSync } from "./error-conversion.js";
+import { startKeepAlive, stopKeepAlive } from "../start-keep-alive.js";
+import {
+    convertError,
+    convertErrorPromise,
+    convertErrorSync,
+} from "./error-conversion.js";
 import { performance } from "perf_hooks";
 
 export class ExpansionHubInternal implements ExpansionHub {
@@ -53,7 +77,10 @@ export class ExpansionHubInternal implements ExpansionHub {
         return this.mutableChildren;
     }
 
-    keepAliveTimer?: NodeJS.Timer;
+    coalesceOutputs = false;
+    private isOutputFrameScheduled = false;
+    // setters deferred since beginOutputFrame, undefined if no frame is open
+    private outputFrame?: DeferredSetter[];
 
     type = RevHubType.ExpansionHub;
     private emitter = new EventEmitter();
@@ -67,8 +94,7 @@ export class ExpansionHubInternal implements ExpansionHub {
     }
 
     close(): void {
-        clearInterval(this.keepAliveTimer);
-        this.keepAliveTimer = undefined;
+        stopKeepAlive(this);
 
         //Closing a parent closes the serial port and all children
         if (this.isParent()) {
@@ -106,6 +132,114 @@ export class ExpansionHubInternal implements ExpansionHub {
         });
     }
 
+    get adaptiveResponseTimeout(): boolean {
+        return this.convertErrorSync(() => {
+            return this.nativeRevHub.isAdaptiveResponseTimeoutEnabled();
+        });
+    }
+
+    set adaptiveResponseTimeout(enabled: boolean) {
+        this.convertErrorSync(() => {
+            this.nativeRevHub.setAdaptiveResponseTimeout(enabled);
+        });
+    }
+
+    get readRetryLimit(): number {
+        return this.convertErrorSync(() => {
+            return this.nativeRevHub.getReadRetryLimit();
+        });
+    }
+
+    set readRetryLimit(retries: number) {
+        this.convertErrorSync(() => {
+            this.nativeRevHub.setReadRetryLimit(retries);
+        });
+    }
+
+    getLinkStats(): LinkStats {
+        return this.nativeRevHub.getLinkStats();
+    }
+
+    getSerialLinkStats(): LinkStats {
+        return this.serialPort.getLinkStats();
+    }
+
+    publishTelemetry(name: string): Promise<void> {
+        return this.convertErrorPromise(() => {
+            return this.nativeRevHub.publishTelemetry(name);
+        });
+    }
+
+    stopPublishingTelemetry(): Promise<void> {
+        return this.convertErrorPromise(() => {
+            return this.nativeRevHub.stopPublishingTelemetry();
+        });
+    }
+
+    setRealtimeOptions(options: RealtimeOptions): void {
+        this.convertErrorSync(() => {
+            this.nativeRevHub.setRealtimeOptions(options);
+        });
+    }
+
+    getRealtimeStats(): RealtimeStats[] {
+        return this.nativeRevHub.getRealtimeStats();
+    }
+
+    startControlTick(
+        periodMs: number,
+        plan: ControlTickPlan,
+        onTick: (result: ControlTickResult) => void,
+    ): void {
+        this.convertErrorSync(() => {
+            this.nativeRevHub.startControlTick(periodMs, plan, (result) => {
+                onTick({
+                    tick: result.tick,
+                    timestampMs: result.timestampMs,
+                    jitterUs: result.jitterUs,
+                    missedTicks: result.missedTicks,
+                    error: result.error
+                        ? convertError(this.serialNumber, result.error)
+                        : undefined,
+                    bulkInputData: result.bulkInputData,
+                    i2cReads: result.i2cReads.map((sample) => ({
+                        timestampMs: sample.timestampMs,
+                        bytes: sample.bytes,
+                        error: sample.error
+                            ? convertError(this.serialNumber, sample.error)
+                            : undefined,
+                    })),
+                });
+            });
+        });
+    }
+
+    stopControlTick(): void {
+        this.nativeRevHub.stopControlTick();
+    }
+
+    setControlTickOutputs(outputs: ControlTickOutput[]): void {
+        this.convertErrorSync(() => {
+            this.nativeRevHub.setControlTickOutputs(outputs);
+        });
+    }
+
+    getControlTickStats(): ControlTickStats | undefined {
+        return this.nativeRevHub.getControlTickStats();
+    }
+
+    setQueryCacheTtl(query: CachedQuery, ttlMs: number): Promise<void> {
+        return this.convertErrorPromise(() => {
+            return this.nativeRevHub.setQueryCacheTtlMs(query, ttlMs);
+        });
+    }
+
+    clearQueryCache(): Promise<void> {
+        return this.convertErrorPromise(() => {
+            return this.nativeRevHub.clearQueryCache();
+        });
+    }
+
     async getAnalogInput(channel: number): Promise<number> {
         return this.convertErrorPromise(() => {
             return this.nativeRevHub.getADC(channel, 0);
@@ -165,12 +299,130 @@ export class ExpansionHubInternal implements ExpansionHub {
         return deciCelsius / 10;
     }
 
+    async getAnalogSnapshot(): Promise<AnalogSnapshot> {
+        // channel numbers 0 - 14 in order, see the individual getters
+        let channels = [...Array(15).keys()];
+        let sweep = await this.convertErrorPromise(() => {
+            return this.nativeRevHub.getADCSweep(channels, 0);
+        });
+        let values = sweep.values;
+        return {
+            timestampMs: sweep.timestampMs,
+            analogInputs: values.slice(0, 4),
+            digitalBusCurrent: values[4],
+            i2cCurrent: values[5],
+            servoCurrent: values[6],
+            batteryCurrent: values[7],
+            motorCurrents: values.slice(8, 12),
+            fiveVoltBusVoltage: values[12],
+            batteryVoltage: values[13],
+            temperature: values[14] / 10,
+        };
+    }
+
     getBulkInputData(): Promise<BulkInputData> {
         return this.convertErrorPromise(() => {
             return this.nativeRevHub.getBulkInputData();
         });
     }
 
+    async getBulkInputDataFromAllHubs(): Promise<SynchronizedBulkInputData> {
+        if (!this.isParent()) {
+            throw new Error("Bulk input data of all hubs can only be read from a parent hub");
+        }
+        let hubs: ExpansionHubInternal[] = [this];
+        for (let child of this.children) {
+            if (child instanceof ExpansionHubInternal) {
+                hubs.push(child);
+            }
+        }
+        let result = await this.convertErrorPromise(() => {
+            return this.nativeRevHub.getBulkInputDataFromHubs(
+                hubs.slice(1).map((hub) => hub.nativeRevHub),
+            );
+        });
+        return {
+            samples: result.samples.map((sample, i) => ({
+                hub: hubs[i],
+                timestampUs: sample.timestampUs,
+                error: sample.error
+                    ? convertError(hubs[i].serialNumber, sample.error)
+                    : undefined,
+                bulkInputData: sample.bulkInputData,
+            })),
+            skewUs: result.skewUs,
+        };
+    }
+
+    beginOutputFrame(): void {
+        if (!this.outputFrame) {
+            this.outputFrame = [];
+        }
+    }
+
+    async commitOutputFrame(): Promise<BulkInputData> {
+        const setters = this.outputFrame ?? [];
+        this.outputFrame = undefined;
+
+        // the whole frame is sent by one native call, so no other command
+        // runs while it is open
+        let result: NativeOutputFrameResult;
+        try {
+            result = await this.convertErrorPromise(() => {
+                return this.nativeRevHub.commitOutputFrame(
+                    setters.map((deferred) => deferred.setter),
+                );
+            });
+        } catch (e: any) {
+            setters.forEach((deferred) => deferred.reject(e));
+            throw e;
+        }
+        setters.forEach((deferred, i) => {
+            const errorCode = result.setterResults[i];
+            if (errorCode < 0) {
+                deferred.reject(convertError(this.serialNumber, { errorCode }));
+            } else {
+                deferred.resolve();
+            }
+        });
+        return result.bulkInputData;
+    }
+
+    /**
+     * If output coalescing is enabled, open an output frame that is committed
+     * once the current event loop turn is over.
+     */
+    private scheduleOutputFrame(): void {
+        if (!this.coalesceOutputs || this.isOutputFrameScheduled) return;
+        this.isOutputFrameScheduled = true;
+        this.beginOutputFrame();
+        setImmediate(() => {
+            this.isOutputFrameScheduled = false;
+            // errors reject the promises of the setters in the frame
+            this.commitOutputFrame().catch(() => {});
+        });
+    }
+
+    /**
+     * Defer a setter if an output frame is open, otherwise send it.
+     *
+     * @param setter the setter as recorded by the frame
+     * @param send sends the setter on its own
+     */
+    private setOutput(
+        setter: NativeOutputFrameSetter,
+        send: () => Promise<void>,
+    ): Promise<void> {
+        this.scheduleOutputFrame();
+        const frame = this.outputFrame;
+        if (!frame) {
+            return this.convertErrorPromise(send);
+        }
+        return new Promise((resolve, reject) => {
+            frame.push({ setter, resolve, reject });
+        });
+    }
+
     getDestAddress(): number {
         return this.convertErrorSync(() => {
             return this.nativeRevHub.getDestAddress();
@@ -283,6 +535,54 @@ export class ExpansionHubInternal implements ExpansionHub {
         });
     }
 
+    getEncoderHistory(maxSamples?: number): Promise<EncoderSample[]> {
+        return this.convertErrorPromise(() => {
+            return this.nativeRevHub.getEncoderHistory(maxSamples);
+        });
+    }
+
+    getLatestEncoderSample(): Promise<EncoderSample | undefined> {
+        return this.convertErrorPromise(() => {
+            return this.nativeRevHub.getLatestEncoderSample();
+        });
+    }
+
+    setEncoderFilterGains(alpha: number, beta: number, gamma: number): Promise<void> {
+        return this.convertErrorPromise(() => {
+            return this.nativeRevHub.setEncoderFilterGains(alpha, beta, gamma);
+        });
+    }
+
+    runMotionProfile(
+        motorChannel: number,
+        profile: MotionProfile,
+    ): Promise<MotionProfileResult> {
+        return new Promise((resolve, reject) => {
+            try {
+                this.convertErrorSync(() => {
+                    this.nativeRevHub.runMotionProfile(motorChannel, profile, (result) => {
+                        if (result.error) {
+                            reject(convertError(this.serialNumber, result.error));
+                        } else {
+                            resolve({
+                                position: result.position,
+                                cancelled: result.cancelled,
+                            });
+                        }
+                    });
+                });
+            } catch (e) {
+                reject(e);
+            }
+        });
+    }
+
+    cancelMotionProfile(motorChannel: number): void {
+        this.convertErrorSync(() => {
+            this.nativeRevHub.cancelMotionProfile(motorChannel);
+        });
+    }
+
     async setMotorClosedLoopControlCoefficients(
         motorChannel: number,
         motorMode: MotorMode,
@@ -382,41 +682,19 @@ export class ExpansionHubInternal implements ExpansionHub {
         numBytesToRead: number,
     ): Promise<number[]> {
         return this.convertErrorPromise(async () => {
-            await this.nativeRevHub.readI2CMultipleBytes(
+            let status = await this.nativeRevHub.i2cRead(
                 i2cChannel,
                 targetAddress,
                 numBytesToRead,
             );
-            while (true) {
-                try {
-                    let status: I2CReadStatus = await this.nativeRevHub.getI2CReadStatus(
-                        i2cChannel,
-                    );
-                    return status.bytes;
-                } catch (e) {
-                    if (e! instanceof I2cOperationInProgressError) {
-                        throw e;
-                    }
-                }
-            }
+            return status.bytes;
         });
     }
 
     readI2CSingleByte(i2cChannel: number, targetAddress: number): Promise<number> {
         return this.convertErrorPromise(async () => {
-            await this.nativeRevHub.readI2CSingleByte(i2cChannel, targetAddress);
-            while (true) {
-                try {
-                    let status: I2CReadStatus = await this.nativeRevHub.getI2CReadStatus(
-                        i2cChannel,
-                    );
-                    return status.bytes[0];
-                } catch (e) {
-                    if (e! instanceof I2cOperationInProgressError) {
-                        throw e;
-                    }
-                }
-            }
+            let status = await this.nativeRevHub.i2cRead(i2cChannel, targetAddress, 1);
+            return status.bytes[0];
         });
     }
 
@@ -478,27 +756,39 @@ export class ExpansionHubInternal implements ExpansionHub {
     }
 
     setAllDigitalOutputs(bitPackedField: number): Promise<void> {
-        return this.convertErrorPromise(() => {
-            return this.nativeRevHub.setDigitalAllOutputs(bitPackedField);
-        });
+        return this.setOutput(
+            { method: "setDigitalAllOutputs", args: [bitPackedField] },
+            () => {
+                return this.nativeRevHub.setDigitalAllOutputs(bitPackedField);
+            },
+        );
     }
 
     setDigitalDirection(
         digitalChannel: number,
         direction: DigitalChannelDirection,
     ): Promise<void> {
-        return this.convertErrorPromise(() => {
-            return this.nativeRevHub.setDigitalDirection(digitalChannel, direction);
-        });
+        return this.setOutput(
+            { method: "setDigitalDirection", args: [digitalChannel, direction] },
+            () => {
+                return this.nativeRevHub.setDigitalDirection(digitalChannel, direction);
+            },
+        );
     }
 
     setDigitalOutput(digitalChannel: number, value: DigitalState): Promise<void> {
-        return this.convertErrorPromise(() => {
-            return this.nativeRevHub.setDigitalSingleOutput(
-                digitalChannel,
-                value.isHigh(),
-            );
-        });
+        return this.setOutput(
+            {
+                method: "setDigitalSingleOutput",
+                args: [digitalChannel, value.isHigh()],
+            },
+            () => {
+                return this.nativeRevHub.setDigitalSingleOutput(
+                    digitalChannel,
+                    value.isHigh(),
+                );
+            },
+        );
     }
 
     setFTDIResetControl(ftdiResetControl: boolean): Promise<void> {
@@ -541,9 +831,12 @@ export class ExpansionHubInternal implements ExpansionHub {
     }
 
     setMotorChannelEnable(motorChannel: number, enable: boolean): Promise<void> {
-        return this.convertErrorPromise(() => {
-            return this.nativeRevHub.setMotorChannelEnable(motorChannel, enable);
-        });
+        return this.setOutput(
+            { method: "setMotorChannelEnable", args: [motorChannel, enable] },
+            () => {
+                return this.nativeRevHub.setMotorChannelEnable(motorChannel, enable);
+            },
+        );
     }
 
     setMotorChannelMode(
@@ -551,19 +844,28 @@ export class ExpansionHubInternal implements ExpansionHub {
         motorMode: MotorMode,
         floatAtZero: boolean,
     ): Promise<void> {
-        return this.convertErrorPromise(() => {
-            return this.nativeRevHub.setMotorChannelMode(
-                motorChannel,
-                motorMode,
-                floatAtZero,
-            );
-        });
+        return this.setOutput(
+            {
+                method: "setMotorChannelMode",
+                args: [motorChannel, motorMode, floatAtZero],
+            },
+            () => {
+                return this.nativeRevHub.setMotorChannelMode(
+                    motorChannel,
+                    motorMode,
+                    floatAtZero,
+                );
+            },
+        );
     }
 
     setMotorConstantPower(motorChannel: number, powerLevel: number): Promise<void> {
-        return this.convertErrorPromise(() => {
-            return this.nativeRevHub.setMotorConstantPower(motorChannel, powerLevel);
-        });
+        return this.setOutput(
+            { method: "setMotorConstantPower", args: [motorChannel, powerLevel] },
+            () => {
+                return this.nativeRevHub.setMotorConstantPower(motorChannel, powerLevel);
+            },
+        );
     }
 
     setMotorPIDCoefficients(
@@ -599,19 +901,28 @@ export class ExpansionHubInternal implements ExpansionHub {
         targetPosition_counts: number,
         targetTolerance_counts: number,
     ): Promise<void> {
-        return this.convertErrorPromise(() => {
-            return this.nativeRevHub.setMotorTargetPosition(
-                motorChannel,
-                targetPosition_counts,
-                targetTolerance_counts,
-            );
-        });
+        return this.setOutput(
+            {
+                method: "setMotorTargetPosition",
+                args: [motorChannel, targetPosition_counts, targetTolerance_counts],
+            },
+            () => {
+                return this.nativeRevHub.setMotorTargetPosition(
+                    motorChannel,
+                    targetPosition_counts,
+                    targetTolerance_counts,
+                );
+            },
+        );
     }
 
     setMotorTargetVelocity(motorChannel: number, velocity_cps: number): Promise<void> {
-        return this.convertErrorPromise(() => {
-            return this.nativeRevHub.setMotorTargetVelocity(motorChannel, velocity_cps);
-        });
+        return this.setOutput(
+            { method: "setMotorTargetVelocity", args: [motorChannel, velocity_cps] },
+            () => {
+                return this.nativeRevHub.setMotorTargetVelocity(motorChannel, velocity_cps);
+            },
+        );
     }
 
     setNewModuleAddress(newModuleAddress: number): Promise<void> {
@@ -634,15 +945,21 @@ export class ExpansionHubInternal implements ExpansionHub {
     }
 
     setServoEnable(servoChannel: number, enable: boolean): Promise<void> {
-        return this.convertErrorPromise(() => {
-            return this.nativeRevHub.setServoEnable(servoChannel, enable);
-        });
+        return this.setOutput(
+            { method: "setServoEnable", args: [servoChannel, enable] },
+            () => {
+                return this.nativeRevHub.setServoEnable(servoChannel, enable);
+            },
+        );
     }
 
     setServoPulseWidth(servoChannel: number, pulseWidth_us: number): Promise<void> {
-        return this.convertErrorPromise(() => {
-            return this.nativeRevHub.setServoPulseWidth(servoChannel, pulseWidth_us);
-        });
+        return this.setOutput(
+            { method: "setServoPulseWidth", args: [servoChannel, pulseWidth_us] },
+            () => {
+                return this.nativeRevHub.setServoPulseWidth(servoChannel, pulseWidth_us);
+            },
+        );
     }
 
     writeI2CMultipleBytes(
@@ -666,27 +983,55 @@ export class ExpansionHubInternal implements ExpansionHub {
         register: number,
     ): Promise<number[]> {
         return this.convertErrorPromise(async () => {
-            await this.nativeRevHub.writeI2CReadMultipleBytes(
+            let status = await this.nativeRevHub.i2cRead(
                 i2cChannel,
                 targetAddress,
                 numBytesToRead,
                 register,
             );
-            while (true) {
-                try {
-                    let status: I2CReadStatus = await this.nativeRevHub.getI2CReadStatus(
-                        i2cChannel,
-                    );
-                    return status.bytes;
-                } catch (e) {
-                    if (e! instanceof I2cOperationInProgressError) {
-                        throw e;
-                    }
-                }
-            }
+            return status.bytes;
+        });
+    }
+
+    runI2COperations(i2cChannel: number, operations: I2COperation[]): Promise<number[][]> {
+        return this.convertErrorPromise(() => {
+            return this.nativeRevHub.runI2COperations(i2cChannel, operations);
+        });
+    }
+
+    startI2CSampler(
+        i2cChannel: number,
+        operations: I2COperation[],
+        periodMs: number,
+        capacity?: number,
+    ): void {
+        this.convertErrorSync(() => {
+            this.nativeRevHub.startI2CSampler(i2cChannel, operations, periodMs, capacity);
+        });
+    }
+
+    stopI2CSampler(i2cChannel: number): void {
+        this.convertErrorSync(() => {
+            this.nativeRevHub.stopI2CSampler(i2cChannel);
         });
     }
 
+    drainI2CSamples(i2cChannel: number): I2CSampleBatch {
+        let batch = this.convertErrorSync(() => {
+            return this.nativeRevHub.drainI2CSamples(i2cChannel);
+        });
+        return {
+            samples: batch.samples.map((sample) => ({
+                timestampMs: sample.timestampMs,
+                bytes: sample.bytes,
+                error: sample.error
+                    ? convertError(this.serialNumber, sample.error)
+                    : undefined,
+            })),
+            droppedSamples: batch.droppedSamples,
+        };
+    }
+
     writeI2CSingleByte(
         i2cChannel: number,
         targetAddress: number,
@@ -760,3 +1105,12 @@ export class ExpansionHubInternal implements ExpansionHub {
         this.emitter.emit("error", error);
     }
 }
+
+/**
+ * A setter deferred by an output frame, with the promise it has returned
+ */
+interface DeferredSetter {
+    setter: NativeOutputFrameSetter;
+    resolve: () => void;
+    reject: (e: any) => void;
+}
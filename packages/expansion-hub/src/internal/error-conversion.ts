@@ -28,6 +28,13 @@ export function convertErrorSync<T>(serialNumber: string | undefined, block: ()
     }
 }
 
+/**
+ * Converts an error reported by the native library outside of a call, e.g. by the keep alive thread.
+ */
+export function convertError(serialNumber: string | undefined, e: any): any {
+    return createError(e, serialNumber);
+}
+
 function createError(e: any, serialNumber: string | undefined): any {
     // noinspection JSUnresolvedReference
     const errorCode: number | undefined = e.errorCode;
@@ -45,6 +52,8 @@ function createError(e: any, serialNumber: string | undefined): any {
             return new CommandNotSupportedError();
         } else if (errorCode == RhspLibErrorCode.UNEXPECTED_RESPONSE) {
             return new RhspLibError("Unexpected packet received");
+        } else if (errorCode == RhspLibErrorCode.CANCELLED) {
+            return new RhspLibError("Command was cancelled by a fail safe");
         } else if (errorCode == RhspLibErrorCode.TIMEOUT) {
             return new TimeoutError();
         } else if (errorCode == RhspLibErrorCode.NO_HUBS_DISCOVERED) {
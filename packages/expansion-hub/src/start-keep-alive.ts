@@ -1,21 +1,29 @@
 import { ExpansionHubInternal } from "./internal/ExpansionHub.js";
-import { convertErrorPromise } from "./internal/error-conversion.js";
+import { convertError, convertErrorSync } from "./internal/error-conversion.js";
 
 /**
- * Starts a keep alive task for a given hub.
+ * Starts a keep alive task for a given hub. The task runs on a native thread, so it
+ * is not delayed by the event loop, and only sends keep alive if no other command
+ * has been sent to the hub during the interval. Any existing task for the hub is
+ * replaced.
  * @param hub hub to start the keep alive for
- * @param intervalMs interval in ms between each keep alive
+ * @param intervalMs maximum interval in ms between two commands sent to the hub,
+ * at least 20
  */
 export function startKeepAlive(hub: ExpansionHubInternal, intervalMs: number) {
-    if (hub.keepAliveTimer) {
-        //stop existing keep alive timer, so we can start a new one.
-        clearInterval(hub.keepAliveTimer);
-    }
-    hub.keepAliveTimer = setInterval(() => {
-        convertErrorPromise(hub.serialNumber, async (): Promise<void> => {
-            await hub.sendKeepAlive();
-        }).catch((e: any) => {
-            hub.emitError(e);
+    convertErrorSync(hub.serialNumber, () => {
+        hub.nativeRevHub.startKeepAlive(intervalMs, (e: any) => {
+            hub.emitError(convertError(hub.serialNumber, e));
         });
-    }, intervalMs);
+    });
+}
+
+/**
+ * Stops the keep alive task of a given hub, if there is one.
+ * @param hub hub to stop the keep alive for
+ */
+export function stopKeepAlive(hub: ExpansionHubInternal) {
+    convertErrorSync(hub.serialNumber, () => {
+        hub.nativeRevHub.stopKeepAlive();
+    });
 }
@@ -9,6 +9,7 @@ export enum RhspLibErrorCode {
     COMMAND_NOT_SUPPORTED = -7,
     UNEXPECTED_RESPONSE = -8,
     NO_HUBS_DISCOVERED = -9,
+    CANCELLED = -10,
 
     ARG_OUT_OF_RANGE_START = -50,
     ARG_OUT_OF_RANGE_END = -55,
@@ -4,19 +4,29 @@ import { dirname } from "path";
 import * as path from "path";
 import {
     BulkInputData,
+    CachedQuery,
     ClosedLoopControlAlgorithm,
+    ControlTickOutput,
+    ControlTickPlan,
+    ControlTickStats,
     DebugGroup,
     DigitalChannelDirection,
     DiscoveredAddresses,
+    EncoderSample,
+    I2COperation,
     I2CReadStatus,
     I2CSpeedCode,
     I2CWriteStatus,
     LedPattern,
+    LinkStats,
     ModuleInterface,
     ModuleStatus,
+    MotionProfile,
     MotorMode,
     PidCoefficients,
     PidfCoefficients,
+    RealtimeOptions,
+    RealtimeStats,
     Rgb,
     VerbosityLevel,
     Version,
@@ -39,19 +49,29 @@ export * from "./SerialParity.js";
 // Everything that this file needs to import from @rev-robotics/rev-hub-core must also be exported here.
 export {
     BulkInputData,
+    CachedQuery,
     ClosedLoopControlAlgorithm,
+    ControlTickOutput,
+    ControlTickPlan,
+    ControlTickStats,
     DebugGroup,
     DigitalChannelDirection,
     DiscoveredAddresses,
+    EncoderSample,
+    I2COperation,
     I2CReadStatus,
     I2CSpeedCode,
     I2CWriteStatus,
     LedPattern,
+    LinkStats,
     ModuleInterface,
     ModuleStatus,
+    MotionProfile,
     MotorMode,
     PidCoefficients,
     PidfCoefficients,
+    RealtimeOptions,
+    RealtimeStats,
     Rgb,
     VerbosityLevel,
     Version,
@@ -64,6 +84,62 @@ export {
 export let NativeSerial = addon.Serial;
 export let NativeRevHub = addon.RevHub;
 
+/**
+ * Commands of one priority class waiting for a serial port. Commands are served by class, highest first;
+ * promoted counts the commands served ahead of their class after waiting too long.
+ */
+export interface NativeCommandQueueStats {
+    waiting: number;
+    maxWaiting: number;
+    acquired: number;
+    promoted: number;
+    totalWaitUs: number;
+    maxWaitUs: number;
+}
+
+/**
+ * Allocation counters of the pooled native workers. Once every command has been called a few times, only
+ * reusedWorkers grows; a growing createdWorkers or heapCallables means calls are allocating.
+ */
+export interface NativeWorkerStats {
+    createdWorkers: number;
+    reusedWorkers: number;
+    heapCallables: number;
+    /**
+     * Motor and servo setpoints replaced by a newer setpoint of the same channel before they were sent
+     */
+    supersededCommands: number;
+}
+
+export let getWorkerStats: () => NativeWorkerStats = addon.getWorkerStats;
+
+/**
+ * A setter recorded by an output frame. args are the arguments of the
+ * RevHub method of the same name.
+ */
+export interface NativeOutputFrameSetter {
+    method:
+        | "setDigitalSingleOutput"
+        | "setDigitalAllOutputs"
+        | "setDigitalDirection"
+        | "setMotorChannelMode"
+        | "setMotorChannelEnable"
+        | "setMotorConstantPower"
+        | "setMotorTargetVelocity"
+        | "setMotorTargetPosition"
+        | "setServoPulseWidth"
+        | "setServoEnable";
+    args: (number | boolean)[];
+}
+
+export interface NativeOutputFrameResult {
+    bulkInputData: BulkInputData;
+    /**
+     * Result code of each setter, negative if the setter rejected its arguments
+     */
+    setterResults: number[];
+}
+
 export declare class Serial {
     constructor();
     open(
@@ -77,6 +153,43 @@ export declare class Serial {
     close(): void;
     read(numBytesToRead: number): Promise<number[]>;
     write(bytes: number[]): Promise<void>;
+    getLinkStats(): LinkStats;
+    /**
+     * Get the queue of each priority class of the commands sent through this port
+     */
+    getCommandQueueStats(): {
+        safety: NativeCommandQueueStats;
+        actuation: NativeCommandQueueStats;
+        telemetry: NativeCommandQueueStats;
+        diagnostics: NativeCommandQueueStats;
+    };
+}
+
+export interface NativeI2CSample {
+    timestampMs: number;
+    bytes: number[];
+    error?: { errorCode: number; nackCode?: number };
+}
+
+export interface NativeI2CSampleBatch {
+    samples: NativeI2CSample[];
+    droppedSamples: number;
+}
+
+export interface NativeControlTickResult {
+    tick: number;
+    timestampMs: number;
+    jitterUs: number;
+    missedTicks: number;
+    error?: { errorCode: number; nackCode?: number };
+    bulkInputData?: BulkInputData;
+    i2cReads: NativeI2CSample[];
+}
+
+export interface NativeHubBulkInputSample {
+    timestampUs?: number;
+    error?: { errorCode: number; nackCode?: number };
+    bulkInputData?: BulkInputData;
 }
 
 export declare class RevHub {
@@ -88,12 +201,34 @@ export declare class RevHub {
     getDestAddress(): number;
     setResponseTimeoutMs(responseTimeoutMs: number): void;
     getResponseTimeoutMs(): number;
+    setAdaptiveResponseTimeout(enabled: boolean): void;
+    isAdaptiveResponseTimeoutEnabled(): boolean;
+    setReadRetryLimit(retries: number): void;
+    getReadRetryLimit(): number;
+    getLinkStats(): LinkStats;
+    publishTelemetry(name: string): Promise<void>;
+    stopPublishingTelemetry(): Promise<void>;
+    setQueryCacheTtlMs(query: CachedQuery, ttlMs: number): Promise<void>;
+    getQueryCacheTtlMs(query: CachedQuery): Promise<number>;
+    clearQueryCache(): Promise<void>;
     sendWriteCommandInternal(packetTypeID: number, payload: number[]): Promise<void>;
     sendWriteCommand(packetTypeID: number, payload: number[]): Promise<number[]>;
     sendReadCommandInternal(packetTypeID: number, payload: number[]): Promise<void>;
     sendReadCommand(packetTypeID: number, payload: number[]): Promise<number[]>;
     getModuleStatus(clearStatusAfterResponse: boolean): Promise<ModuleStatus>;
     sendKeepAlive(): Promise<void>;
+    startKeepAlive(intervalMs: number, onError: (error: any) => void): void;
+    stopKeepAlive(): void;
+    setRealtimeOptions(options: RealtimeOptions): void;
+    getRealtimeStats(): RealtimeStats[];
+    startControlTick(
+        periodMs: number,
+        plan: ControlTickPlan,
+        onTick: (result: NativeControlTickResult) => void,
+    ): void;
+    stopControlTick(): void;
+    setControlTickOutputs(outputs: ControlTickOutput[]): void;
+    getControlTickStats(): ControlTickStats | undefined;
     sendFailSafe(): Promise<void>;
     setNewModuleAddress(newModuleAddress: number): Promise<void>;
     queryInterface(interfaceName: string): Promise<ModuleInterface>;
@@ -110,7 +245,15 @@ export declare class RevHub {
 
     // Device Control
     getBulkInputData(): Promise<BulkInputData>;
+    getBulkInputDataFromHubs(
+        otherHubs: RevHub[],
+    ): Promise<{ samples: NativeHubBulkInputSample[]; skewUs: number }>;
+    commitOutputFrame(setters: NativeOutputFrameSetter[]): Promise<NativeOutputFrameResult>;
     getADC(channel: number, rawMode: number): Promise<number>;
+    getADCSweep(
+        channels: number[],
+        rawMode: number,
+    ): Promise<{ timestampMs: number; values: number[] }>;
     setPhoneChargeControl(chargeEnable: boolean): Promise<void>;
     getPhoneChargeControl(): Promise<boolean>;
     injectDataLogHint(hintText: string): Promise<void>;
@@ -160,6 +303,21 @@ export declare class RevHub {
         startAddress: number,
     ): Promise<void>;
     getI2CReadStatus(i2cChannel: number): Promise<I2CReadStatus>;
+    i2cRead(
+        i2cChannel: number,
+        targetAddress: number,
+        numBytesToRead: number,
+        register?: number,
+    ): Promise<I2CReadStatus>;
+    runI2COperations(i2cChannel: number, operations: I2COperation[]): Promise<number[][]>;
+    startI2CSampler(
+        i2cChannel: number,
+        operations: I2COperation[],
+        periodMs: number,
+        capacity?: number,
+    ): void;
+    stopI2CSampler(i2cChannel: number): void;
+    drainI2CSamples(i2cChannel: number): NativeI2CSampleBatch;
 
     // Motor
     setMotorChannelMode(
@@ -192,6 +350,19 @@ export declare class RevHub {
     ): Promise<{ targetPosition: number; targetTolerance: number }>;
     getMotorAtTarget(motorChannel: number): Promise<boolean>;
     getMotorEncoderPosition(motorChannel: number): Promise<number>;
+    getEncoderHistory(maxSamples?: number): Promise<EncoderSample[]>;
+    getLatestEncoderSample(): Promise<EncoderSample | undefined>;
+    setEncoderFilterGains(alpha: number, beta: number, gamma: number): Promise<void>;
+    runMotionProfile(
+        motorChannel: number,
+        profile: MotionProfile,
+        onComplete: (result: {
+            position: number;
+            cancelled: boolean;
+            error?: { errorCode: number; nackCode?: number };
+        }) => void,
+    ): void;
+    cancelMotionProfile(motorChannel: number): void;
     setMotorClosedLoopControlCoefficients(
         motorChannel: number,
         motorMode: MotorMode,
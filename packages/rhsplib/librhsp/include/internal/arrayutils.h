@@ -5,24 +5,62 @@
 extern "C" {
 #endif
 
-// helper functions to set/get byte, word, dword values from payload
+#include <stdint.h>
+#include <string.h>
+
+// helper functions to set/get byte values from payload
 #define RHSP_ARRAY_BYTE(type, buffer, index)       ((type)(buffer)[index])
 #define RHSP_ARRAY_BYTE_PTR(type, buffer, index)   (&((type)(buffer))[index])
-#define RHSP_ARRAY_WORD(type, buffer, startIndex)  ((type)(buffer)[startIndex] | ((type)(buffer)[(startIndex) + 1] << 8))
-#define RHSP_ARRAY_DWORD(type, buffer, startIndex) ((type)(buffer)[startIndex] | \
-                                                       ((type)(buffer)[(startIndex) + 1] << 8)  | \
-                                                       ((type)(buffer)[(startIndex) + 2] << 16) | \
-                                                       ((type)(buffer)[(startIndex) + 3] << 24))
 
 #define RHSP_ARRAY_SET_BYTE(buffer, index, value)  do { (buffer)[index] = (uint8_t)(value); } while(0)
-#define RHSP_ARRAY_SET_WORD(buffer, index, value)  do { (buffer)[index]     = (uint8_t)(value); \
-                                                            (buffer)[index + 1] = (uint16_t)(value) >> 8; \
-                                                          } while(0)
-#define RHSP_ARRAY_SET_DWORD(buffer, index, value)  do { (buffer)[index]     = (uint8_t)(value); \
-                                                             (buffer)[index + 1] = (uint32_t)(value) >> 8; \
-                                                             (buffer)[index + 2] = (uint32_t)(value) >> 16; \
-                                                             (buffer)[index + 3] = (uint32_t)(value) >> 24; \
-                                                          } while(0)
+
+/*
+ * Little-endian word/dword access for payloads. The value is copied with memcpy, so the buffer does not have to be
+ * aligned, and swapped on big-endian hosts only. On x86 and ARM each helper compiles to a single load or store.
+ */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define RHSP_LE16(value) __builtin_bswap16(value)
+#define RHSP_LE32(value) __builtin_bswap32(value)
+#else
+#define RHSP_LE16(value) (value)
+#define RHSP_LE32(value) (value)
+#endif
+
+static inline uint16_t rhsp_loadU16(const uint8_t* buffer)
+{
+    uint16_t value;
+    memcpy(&value, buffer, sizeof(value));
+    return RHSP_LE16(value);
+}
+
+static inline uint32_t rhsp_loadU32(const uint8_t* buffer)
+{
+    uint32_t value;
+    memcpy(&value, buffer, sizeof(value));
+    return RHSP_LE32(value);
+}
+
+static inline int16_t rhsp_loadI16(const uint8_t* buffer)
+{
+    return (int16_t) rhsp_loadU16(buffer);
+}
+
+static inline int32_t rhsp_loadI32(const uint8_t* buffer)
+{
+    return (int32_t) rhsp_loadU32(buffer);
+}
+
+static inline void rhsp_storeU16(uint8_t* buffer, uint16_t value)
+{
+    value = RHSP_LE16(value);
+    memcpy(buffer, &value, sizeof(value));
+}
+
+static inline void rhsp_storeU32(uint8_t* buffer, uint32_t value)
+{
+    value = RHSP_LE32(value);
+    memcpy(buffer, &value, sizeof(value));
+}
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,71 @@
+#ifndef RHSP_INTERNAL_CACHE_H
+#define RHSP_INTERNAL_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rhsp/cache.h"
+
+#define RHSP_QUERY_CACHE_SIZE                   32  // number of cached responses per hub
+#define RHSP_QUERY_CACHE_MAX_REQUEST_SIZE       4   // max payload size of a cacheable request
+#define RHSP_QUERY_CACHE_MAX_RESPONSE_SIZE      80  // max size of a cacheable response packet including header and crc
+
+// Cached response to a single request
+typedef struct {
+    bool valid;
+    uint8_t query;          // RhspCachedQuery the entry belongs to
+    uint16_t packetID;
+    uint8_t requestSize;
+    uint8_t request[RHSP_QUERY_CACHE_MAX_REQUEST_SIZE];
+    uint32_t timestampMs;   // time when the response has been received
+    uint16_t responseSize;
+    uint8_t response[RHSP_QUERY_CACHE_MAX_RESPONSE_SIZE];
+} RhspQueryCacheEntry;
+
+typedef struct {
+    uint32_t ttlMs[RHSP_CACHED_QUERY_COUNT];
+    RhspQueryCacheEntry entries[RHSP_QUERY_CACHE_SIZE];
+} RhspQueryCache;
+
+/**
+ * @brief send read command, answering it from the query cache when possible
+ * @details If the query group has a non-zero TTL and a fresh response to the same request is cached,
+ *          the response is copied to the hub's receive buffer and nothing is sent.
+ *          Otherwise the command is sent and a successful response is cached.
+ *
+ * @param[in] hub           module instance
+ * @param[in] query         cached query group the command belongs to
+ * @param[in] packetTypeID  packet type id
+ * @param[in] payload       command payload
+ * @param[in] payloadSize   payload size in bytes
+ * @param[out] nackReasonCode it is set if the return value is RHSP_ERROR_NACK_RECEIVED
+ *
+ * @return RHSP_RESULT_OK in case success
+ *
+ * @note this function is for internal usage
+ * */
+int rhsp_sendCachedReadCommandInternal(RhspRevHub* hub,
+                                       RhspCachedQuery query,
+                                       uint16_t packetTypeID,
+                                       const uint8_t* payload,
+                                       uint16_t payloadSize,
+                                       uint8_t* nackReasonCode);
+
+/**
+ * @brief drop cached responses of a query group
+ *
+ * @param[in] hub   module instance
+ * @param[in] query cached query group
+ *
+ * @note this function is for internal usage
+ * */
+void rhsp_invalidateCachedQuery(RhspRevHub* hub, RhspCachedQuery query);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RHSP_INTERNAL_CACHE_H
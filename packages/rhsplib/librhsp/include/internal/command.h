@@ -10,7 +10,9 @@ extern "C" {
 
 /**
  * @brief send read command
- * @details sends a command that has an data/nack response
+ * @details sends a command that has an data/nack response. The command must be idempotent:
+ *          on a timeout, message number mismatch or unexpected response it is sent again,
+ *          up to rhsp_readRetryLimit() times.
  *
  * @param[in] hub           module instance
  * @param[in] packetTypeID  packet type id
@@ -28,6 +30,19 @@ int rhsp_sendReadCommandInternal(RhspRevHub* hub,
                                  uint16_t payloadSize,
                                  uint8_t* nackReasonCode);
 
+/**
+ * @brief send read command without retries
+ * @details same as rhsp_sendReadCommandInternal, but for commands that change the module state,
+ *          e.g. status queries that clear the status. Such commands are sent exactly once.
+ *
+ * @note this function is for internal usage
+ * */
+int rhsp_sendReadCommandOnceInternal(RhspRevHub* hub,
+                                     uint16_t packetTypeID,
+                                     const uint8_t* payload,
+                                     uint16_t payloadSize,
+                                     uint8_t* nackReasonCode);
+
 /**
  * @brief   send write command
  * @details sends a command that has an ack/nack response
@@ -64,6 +79,84 @@ int rhsp_sendWriteCommandInternal(RhspRevHub* hub,
  *
  *
  * */
+// maximum number of commands sent before the first response is awaited
+#define RHSP_PIPELINE_DEPTH 4
+
+typedef void (*RhspPipelinedResponseHandler)(void* context, size_t commandIndex, const uint8_t* responsePayload);
+
+/**
+ * @brief send several read commands of the same type without waiting for each response
+ * @details Up to RHSP_PIPELINE_DEPTH commands are in flight at a time. The module answers in order, so
+ *          responses are matched by message number. onResponse is called for every successful response in order.
+ *          On the first error, no further commands are sent and the responses to the commands in flight are
+ *          read out before returning. If receiving fails, they are marked stale instead, so that their late
+ *          responses are skipped by the following commands.
+ *
+ * @param[in]  hub               module instance
+ * @param[in]  packetTypeID      packet type id of all commands
+ * @param[in]  payloads          payloads of all commands, payloadSize bytes each
+ * @param[in]  payloadSize       payload size of a single command
+ * @param[in]  commandCount      number of commands
+ * @param[in]  onResponse        called with the response payload of each command
+ * @param[in]  context           passed to onResponse
+ * @param[out] nackReasonCode    nack reason code if the function returns RHSP_ERROR_NACK_RECEIVED
+ *
+ * @return RHSP_RESULT_OK in case success
+ *
+ * @note this function is for internal usage
+ * */
+int rhsp_sendPipelinedReadCommandsInternal(RhspRevHub* hub,
+                                           uint16_t packetTypeID,
+                                           const uint8_t* payloads,
+                                           uint16_t payloadSize,
+                                           size_t commandCount,
+                                           RhspPipelinedResponseHandler onResponse,
+                                           void* context,
+                                           uint8_t* nackReasonCode);
+
+// maximum number of commands in flight on a serial port, RHSP_PIPELINE_DEPTH at most to each module
+#define RHSP_PORT_MAX_IN_FLIGHT 12
+
+// a command to one of the modules on a serial port, see rhsp_runPortTransactionsInternal
+typedef struct {
+    RhspRevHub* hub;
+    uint16_t packetTypeID;
+    const uint8_t* payload;
+    uint16_t payloadSize;
+    bool isWrite;               // the module answers with an ACK instead of a read response
+    int result;                 // result of this command. The command is skipped if it is negative on entry.
+    uint8_t nackReasonCode;     // set if result is RHSP_ERROR_NACK_RECEIVED
+    bool sent;                  // used by rhsp_runPortTransactionsInternal
+} RhspPortTransaction;
+
+typedef void (*RhspPortTransactionHandler)(void* context, size_t transactionIndex);
+
+/**
+ * @brief send commands to the modules on a serial port without waiting for each response
+ * @details Message numbers are shared by all modules on the port, and responses are routed to their command by
+ *          source address and reference number, so commands to different modules are in flight at the same time
+ *          and may be answered in any order. Up to RHSP_PORT_MAX_IN_FLIGHT commands are in flight, and up to
+ *          RHSP_PIPELINE_DEPTH to the same module. Commands are sent in order, except that a command is passed
+ *          over while its module has a full pipeline. Responses are received through the module of the first
+ *          command. A module that does not answer only delays the others until the response timeout.
+ *
+ *          onResponse is called for every successful response, which is then in the receive buffer of the module.
+ *
+ * @param[in,out] transactions      commands to modules opened on the same serial port
+ * @param[in]     transactionCount  number of commands
+ * @param[in]     onResponse        called with the index of each command that has been answered. can be NULL.
+ * @param[in]     context           passed to onResponse
+ *
+ * @return RHSP_RESULT_OK if all commands have been sent, RHSP_ERROR if the modules do not share an opened serial
+ *         port, otherwise the serial port error. The result of each command is in its transaction.
+ *
+ * @note this function is for internal usage
+ * */
+int rhsp_runPortTransactionsInternal(RhspPortTransaction* transactions,
+                                     size_t transactionCount,
+                                     RhspPortTransactionHandler onResponse,
+                                     void* context);
+
 int rhsp_sendWriteCommand(RhspRevHub* hub,
                           uint16_t packetTypeID,
                           const uint8_t* payload,
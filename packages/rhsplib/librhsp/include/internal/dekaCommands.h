@@ -0,0 +1,195 @@
+#ifndef RHSP_INTERNAL_DEKA_COMMANDS_H
+#define RHSP_INTERNAL_DEKA_COMMANDS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rhsp/revhub.h"
+#include "rhsp/cache.h"
+
+#define RHSP_DEKA_VARIABLE_SIZE     0xFFFF  // request size depends on the arguments
+
+/*
+ * Commands of the DEKA interface.
+ *
+ * X(name, functionNumber, type, requestSize, responseSize)
+ *   type           WRITE     - command with an ack/nack response
+ *                  READ      - idempotent query, sent again after a transient link error
+ *                  READ_ONCE - query that changes the module state, e.g. clears a status. Never sent again
+ *   requestSize    payload size in bytes or RHSP_DEKA_VARIABLE_SIZE
+ *   responseSize   minimum response payload size of a query in bytes, 0 for write commands
+ */
+#define RHSP_DEKA_COMMANDS(X) \
+    X(GET_BULK_INPUT_DATA,                   0, READ,      0,                       35) \
+    X(SET_SINGLE_OUTPUT,                     1, WRITE,     2,                       0)  \
+    X(SET_ALL_OUTPUTS,                       2, WRITE,     1,                       0)  \
+    X(SET_DIRECTION,                         3, WRITE,     2,                       0)  \
+    X(GET_DIRECTION,                         4, READ,      1,                       1)  \
+    X(GET_SINGLE_INPUT,                      5, READ,      1,                       1)  \
+    X(GET_ALL_INPUTS,                        6, READ,      0,                       1)  \
+    X(GET_ADC,                               7, READ,      2,                       2)  \
+    X(SET_MOTOR_CHANNEL_MODE,                8, WRITE,     3,                       0)  \
+    X(GET_MOTOR_CHANNEL_MODE,                9, READ,      1,                       2)  \
+    X(SET_MOTOR_CHANNEL_ENABLE,             10, WRITE,     2,                       0)  \
+    X(GET_MOTOR_CHANNEL_ENABLE,             11, READ,      1,                       1)  \
+    X(SET_MOTOR_CURRENT_ALERT_LEVEL,        12, WRITE,     3,                       0)  \
+    X(GET_MOTOR_CURRENT_ALERT_LEVEL,        13, READ,      1,                       2)  \
+    X(RESET_ENCODER,                        14, WRITE,     1,                       0)  \
+    X(SET_MOTOR_CONSTANT_POWER,             15, WRITE,     3,                       0)  \
+    X(GET_MOTOR_CONSTANT_POWER,             16, READ,      1,                       2)  \
+    X(SET_MOTOR_TARGET_VELOCITY,            17, WRITE,     3,                       0)  \
+    X(GET_MOTOR_TARGET_VELOCITY,            18, READ,      1,                       2)  \
+    X(SET_MOTOR_TARGET_POSITION,            19, WRITE,     7,                       0)  \
+    X(GET_MOTOR_TARGET_POSITION,            20, READ,      1,                       6)  \
+    X(IS_MOTOR_AT_TARGET,                   21, READ,      1,                       1)  \
+    X(GET_ENCODER_POSITION,                 22, READ,      1,                       4)  \
+    X(SET_PID_COEFFICIENTS,                 23, WRITE,     19,                      0)  \
+    X(GET_PID_COEFFICIENTS,                 24, READ,      2,                       12) \
+    X(SET_SERVO_CONFIGURATION,              31, WRITE,     3,                       0)  \
+    X(GET_SERVO_CONFIGURATION,              32, READ,      1,                       2)  \
+    X(SET_SERVO_PULSE_WIDTH,                33, WRITE,     3,                       0)  \
+    X(GET_SERVO_PULSE_WIDTH,                34, READ,      1,                       2)  \
+    X(SET_SERVO_ENABLE,                     35, WRITE,     2,                       0)  \
+    X(GET_SERVO_ENABLE,                     36, READ,      1,                       1)  \
+    X(I2C_WRITE_SINGLE_BYTE,                37, WRITE,     3,                       0)  \
+    X(I2C_WRITE_MULTIPLE_BYTES,             38, WRITE,     RHSP_DEKA_VARIABLE_SIZE, 0)  \
+    X(I2C_READ_SINGLE_BYTE,                 39, WRITE,     2,                       0)  \
+    X(I2C_READ_MULTIPLE_BYTES,              40, WRITE,     3,                       0)  \
+    X(I2C_READ_STATUS_QUERY,                41, READ_ONCE, 1,                       2)  \
+    X(I2C_WRITE_STATUS_QUERY,               42, READ_ONCE, 1,                       2)  \
+    X(I2C_CONFIGURE_CHANNEL,                43, WRITE,     2,                       0)  \
+    X(PHONE_CHARGE_CONTROL,                 44, WRITE,     1,                       0)  \
+    X(PHONE_CHARGE_QUERY,                   45, READ,      0,                       1)  \
+    X(INJECT_DATA_LOG_HINT,                 46, WRITE,     101,                     0)  \
+    X(I2C_CONFIGURE_QUERY,                  47, READ,      1,                       1)  \
+    X(READ_VERSION_STRING,                  48, READ,      0,                       1)  \
+    X(FTDI_RESET_CONTROL,                   49, WRITE,     1,                       0)  \
+    X(FTDI_RESET_QUERY,                     50, READ,      0,                       1)  \
+    X(SET_PIDF_COEFFICIENTS,                51, WRITE,     19,                      0)  \
+    X(I2C_WRITE_READ_MULTIPLE_BYTES,        52, WRITE,     4,                       0)  \
+    X(GET_PIDF_COEFFICIENTS,                53, READ,      2,                       17) \
+    X(I2C_TRANSACTION,                      54, WRITE,     RHSP_DEKA_VARIABLE_SIZE, 0)  \
+    X(I2C_TRANSACTION_QUERY,                55, READ_ONCE, 2,                       2)  \
+    X(SET_BULK_OUTPUT_DATA,                 56, WRITE,     34,                      0)  \
+    X(READ_VERSION,                         57, READ,      0,                       9)
+
+typedef enum {
+    RHSP_DEKA_WRITE,
+    RHSP_DEKA_READ,
+    RHSP_DEKA_READ_ONCE
+} RhspDekaCommandType;
+
+typedef enum {
+#define RHSP_DEKA_COMMAND_ENUM(name, functionNumber, type, requestSize, responseSize) RHSP_DEKA_##name,
+    RHSP_DEKA_COMMANDS(RHSP_DEKA_COMMAND_ENUM)
+#undef RHSP_DEKA_COMMAND_ENUM
+    RHSP_DEKA_COMMAND_COUNT
+} RhspDekaCommand;
+
+typedef struct {
+    const char* name;
+    uint16_t functionNumber;
+    RhspDekaCommandType type;
+    uint16_t requestSize;
+    uint16_t responseSize;
+} RhspDekaCommandDescriptor;
+
+extern const RhspDekaCommandDescriptor rhsp_dekaCommands[RHSP_DEKA_COMMAND_COUNT];
+
+/**
+ * @brief get packet ID of a DEKA command
+ * @details The packet ID is resolved once per hub and kept until the hub is closed.
+ *
+ * @param[in]  hub              module instance
+ * @param[in]  command          command
+ * @param[out] packetID         packet ID
+ * @param[out] nackReasonCode   nack reason code if the function returns RHSP_ERROR_NACK_RECEIVED
+ *
+ * @return RHSP_RESULT_OK in case success, RHSP_ERROR_COMMAND_NOT_SUPPORTED if the module does not implement it
+ *
+ * @note this function is for internal usage
+ * */
+int rhsp_getDekaPacketID(RhspRevHub* hub, RhspDekaCommand command, uint16_t* packetID, uint8_t* nackReasonCode);
+
+/**
+ * @brief forget resolved packet IDs, e.g. when the interface list is dropped
+ *
+ * @note this function is for internal usage
+ * */
+void rhsp_clearDekaPacketIDs(RhspRevHub* hub);
+
+/**
+ * @brief send DEKA write command
+ * @details payloadSize must match the request size of the command unless it is variable.
+ *
+ * @return RHSP_RESULT_OK or RHSP_RESULT_ATTENTION_REQUIRED in case success
+ *
+ * @note this function is for internal usage
+ * */
+int rhsp_sendDekaWriteCommand(RhspRevHub* hub,
+                              RhspDekaCommand command,
+                              const uint8_t* payload,
+                              uint16_t payloadSize,
+                              uint8_t* nackReasonCode);
+
+/**
+ * @brief send DEKA query
+ * @details READ commands are retried on transient errors, READ_ONCE commands are sent once.
+ *          A response shorter than the response size of the command is rejected.
+ *
+ * @param[in]  hub              module instance
+ * @param[in]  command          command
+ * @param[in]  payload          command payload
+ * @param[in]  payloadSize      payload size in bytes
+ * @param[out] response         points to the response payload in the receive buffer of the hub. Valid until the
+ *                              next command is sent
+ * @param[out] nackReasonCode   nack reason code if the function returns RHSP_ERROR_NACK_RECEIVED
+ *
+ * @return RHSP_RESULT_OK in case success
+ *
+ * @note this function is for internal usage
+ * */
+int rhsp_sendDekaReadCommand(RhspRevHub* hub,
+                             RhspDekaCommand command,
+                             const uint8_t* payload,
+                             uint16_t payloadSize,
+                             const uint8_t** response,
+                             uint8_t* nackReasonCode);
+
+/**
+ * @brief same as rhsp_sendDekaReadCommand, but the response can be answered from the query cache
+ *
+ * @note this function is for internal usage
+ * */
+int rhsp_sendDekaCachedReadCommand(RhspRevHub* hub,
+                                   RhspCachedQuery query,
+                                   RhspDekaCommand command,
+                                   const uint8_t* payload,
+                                   uint16_t payloadSize,
+                                   const uint8_t** response,
+                                   uint8_t* nackReasonCode);
+
+/**
+ * @brief send several DEKA queries of the same command without waiting for each response
+ * @details see rhsp_sendPipelinedReadCommandsInternal. Each payload has the request size of the command.
+ *          onResponse has the RhspPipelinedResponseHandler signature.
+ *
+ * @note this function is for internal usage
+ * */
+int rhsp_sendDekaPipelinedReadCommands(RhspRevHub* hub,
+                                       RhspDekaCommand command,
+                                       const uint8_t* payloads,
+                                       size_t commandCount,
+                                       void (*onResponse)(void* context, size_t commandIndex,
+                                                          const uint8_t* responsePayload),
+                                       void* context,
+                                       uint8_t* nackReasonCode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RHSP_INTERNAL_DEKA_COMMANDS_H
@@ -0,0 +1,55 @@
+#ifndef RHSP_INTERNAL_ENCODER_H
+#define RHSP_INTERNAL_ENCODER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rhsp/encoder.h"
+#include "rhsp/deviceControl.h"
+
+typedef struct {
+    RhspEncoderSample samples[RHSP_ENCODER_HISTORY_SIZE];
+    size_t head;    // index of the next sample to write
+    size_t count;
+
+    // estimator state per motor
+    double position[RHSP_ENCODER_NUMBER_OF_MOTORS];
+    double velocity[RHSP_ENCODER_NUMBER_OF_MOTORS];
+    double acceleration[RHSP_ENCODER_NUMBER_OF_MOTORS];
+    uint32_t lastTimestampUs;
+    uint8_t filterValid;  // one bit per motor. Cleared bits restart the estimator from the next sample
+
+    double alpha;
+    double beta;
+    double gamma;
+} RhspEncoderHistory;
+
+/**
+ * @brief set the default estimator gains
+ *
+ * @note this function is for internal usage
+ * */
+void rhsp_initEncoderHistory(RhspRevHub* hub);
+
+/**
+ * @brief add the bulk input data that has just been received to the history
+ *
+ * @note this function is for internal usage
+ * */
+void rhsp_recordEncoderSample(RhspRevHub* hub, const RhspBulkInputData* data, uint32_t timestampUs);
+
+/**
+ * @brief restart the estimator of a motor, e.g. after its encoder has been reset
+ *
+ * @note this function is for internal usage
+ * */
+void rhsp_restartEncoderFilter(RhspRevHub* hub, uint8_t motorChannel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RHSP_INTERNAL_ENCODER_H
@@ -0,0 +1,86 @@
+#ifndef RHSP_INTERNAL_FRAME_H
+#define RHSP_INTERNAL_FRAME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rhsp/frame.h"
+
+#define RHSP_FRAME_NUMBER_OF_GPIO               8
+#define RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS     4
+#define RHSP_FRAME_NUMBER_OF_SERVO_CHANNELS     6
+
+// One bit per channel. known - the value is what the module has, dirty - the value is waiting in the open frame
+typedef struct {
+    uint8_t known;
+    uint8_t dirty;
+} RhspFrameMask;
+
+// Last output state written to the module
+typedef struct {
+    bool open;
+
+    uint8_t digitalOutputs;
+    RhspFrameMask digitalOutputsMask;
+    uint8_t digitalDirections;
+    RhspFrameMask digitalDirectionsMask;
+
+    uint8_t motorMode[RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS];
+    uint8_t motorFloatAtZero[RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS];
+    RhspFrameMask motorModeMask;
+    uint8_t motorEnable;
+    RhspFrameMask motorEnableMask;
+    double motorPower[RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS];
+    int16_t motorRawPower[RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS];
+    RhspFrameMask motorPowerMask;
+    int16_t motorVelocity[RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS];
+    RhspFrameMask motorVelocityMask;
+    int32_t motorPosition[RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS];
+    uint16_t motorTolerance[RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS];
+    RhspFrameMask motorPositionMask;
+    uint8_t motorToleranceChanged;  // motors whose deferred position carries a new tolerance
+
+    uint8_t servoEnable;
+    RhspFrameMask servoEnableMask;
+    uint16_t servoPulseWidth[RHSP_FRAME_NUMBER_OF_SERVO_CHANNELS];
+    RhspFrameMask servoPulseWidthMask;
+} RhspOutputFrame;
+
+/*
+ * The functions below are called by the setters. If deferred is true, the value is recorded in the open frame,
+ * otherwise the value has just been accepted by the module.
+ */
+void rhsp_frameSetSingleOutput(RhspRevHub* hub, uint8_t dioPin, uint8_t value, bool deferred);
+void rhsp_frameSetAllOutputs(RhspRevHub* hub, uint8_t bitPackedField, bool deferred);
+void rhsp_frameSetDirection(RhspRevHub* hub, uint8_t dioPin, uint8_t directionOutput, bool deferred);
+void rhsp_frameSetMotorChannelMode(RhspRevHub* hub, uint8_t motorChannel, uint8_t motorMode,
+                                   uint8_t floatAtZero, bool deferred);
+void rhsp_frameSetMotorChannelEnable(RhspRevHub* hub, uint8_t motorChannel, uint8_t enabled, bool deferred);
+void rhsp_frameSetMotorConstantPower(RhspRevHub* hub, uint8_t motorChannel, double powerLevel,
+                                     int16_t rawPowerLevel, bool deferred);
+void rhsp_frameSetMotorTargetVelocity(RhspRevHub* hub, uint8_t motorChannel, int16_t velocity, bool deferred);
+void rhsp_frameSetMotorTargetPosition(RhspRevHub* hub, uint8_t motorChannel, int32_t targetPosition,
+                                      uint16_t targetTolerance, bool deferred);
+void rhsp_frameSetServoPulseWidth(RhspRevHub* hub, uint8_t servoChannel, uint16_t pulseWidth, bool deferred);
+void rhsp_frameSetServoEnable(RhspRevHub* hub, uint8_t servoChannel, uint8_t enable, bool deferred);
+void rhsp_frameSetBulkOutputData(RhspRevHub* hub, const RhspBulkOutputData* data);
+
+/**
+ * @brief forget the known output state
+ * @details Called when the module state may have changed behind our back, e.g. after fail safe or reset.
+ *          Values waiting in an open frame are kept.
+ *
+ * @param[in] hub   module instance
+ *
+ * @note this function is for internal usage
+ * */
+void rhsp_forgetOutputState(RhspRevHub* hub);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RHSP_INTERNAL_FRAME_H
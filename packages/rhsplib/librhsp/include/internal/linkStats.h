@@ -0,0 +1,51 @@
+#ifndef RHSP_INTERNAL_LINK_STATS_H
+#define RHSP_INTERNAL_LINK_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "rhsp/linkStats.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// counters are written by the thread that owns the hub and may be read by any other thread
+static inline void rhsp_linkStatsAdd(uint32_t* counter, uint32_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    _InterlockedExchangeAdd((volatile long*) counter, (long) value);
+#else
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline uint32_t rhsp_linkStatsLoad(const uint32_t* counter)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return (uint32_t) _InterlockedOr((volatile long*) counter, 0);
+#else
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+#endif
+}
+
+/*
+ * Adds value to a counter of the hub and of its serial port.
+ * hub is a RhspRevHubInternal*, field a member of RhspLinkStats such as timeouts or nacksByCode[code].
+ */
+#define RHSP_LINK_STATS_ADD(hub, field, value)                                      \
+    do {                                                                            \
+        rhsp_linkStatsAdd(&(hub)->linkStats.field, (value));                        \
+        if ((hub)->serialPort)                                                      \
+        {                                                                           \
+            rhsp_linkStatsAdd(&(hub)->serialPort->linkStats.field, (value));        \
+        }                                                                           \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RHSP_INTERNAL_LINK_STATS_H
@@ -28,7 +28,7 @@ typedef struct {
     uint16_t size;
 } RhspPayloadData;
 
-void serialPurgeRxBuffer(RhspSerial* serialPort);
+void serialPurgeRxBuffer(RhspRevHubInternal* hub);
 
 /**
  * Receives packet with timeout
@@ -40,6 +40,29 @@ void serialPurgeRxBuffer(RhspSerial* serialPort);
  * */
 int receivePacket(RhspRevHubInternal* hub);
 
+/**
+ * Receives packet with the given timeout in ms instead of the response timeout of the hub.
+ * Zero value is infinite timeout.
+ * */
+int receivePacketWithTimeout(RhspRevHubInternal* hub, uint32_t timeoutMs);
+
+/**
+ * Takes the next message number of the serial port of the hub. Message numbers are shared by all modules on the port,
+ * so a response can be routed to its command by the reference number alone, whichever module it comes from.
+ * */
+uint8_t nextMessageNumber(RhspRevHubInternal* hub);
+
+/**
+ * Remembers that the response to a message may still arrive after its command has been given up, so it is not
+ * taken for the response to a later command.
+ * */
+void markMessageStale(RhspRevHubInternal* hub, uint8_t messageNumber);
+
+/**
+ * Returns true and forgets the message number if it belongs to a command that has been given up.
+ * */
+bool takeStaleMessage(RhspRevHubInternal* hub, uint8_t messageNumber);
+
 int sendPacket(RhspRevHubInternal* hub,
                uint8_t destAddr,
                uint8_t messageNumber,
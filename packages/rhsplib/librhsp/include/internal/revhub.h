@@ -5,19 +5,39 @@
 extern "C" {
 #endif
 
+#include "rhsp/i2c.h"
 #include "RhspRxStates.h"
+#include "cache.h"
+#include "dekaCommands.h"
+#include "encoder.h"
+#include "frame.h"
+#include "rtt.h"
+#include "telemetry.h"
 
 typedef struct {
     RhspSerial* serialPort;
     uint8_t address;
-    uint8_t messageNumber;
     uint8_t rxBuffer[RHSP_BUFFER_SIZE];
     size_t receivedBytes;
     size_t bytesToReceive;
     uint8_t txBuffer[RHSP_BUFFER_SIZE];
     RhspRxStates rxState;
     uint32_t responseTimeoutMs;
+    RhspRttEstimator rtt;
+    uint8_t readRetryLimit;
+    RhspLinkStats linkStats;
+    bool hasTransmitted;
+    uint32_t lastTransmitTimestampMs;  // time when the last command has been sent
     RhspModuleInterfaceList* interfaceList;
+    uint16_t dekaPacketIDs[RHSP_DEKA_COMMAND_COUNT];  // resolved from the interface list, zero if not yet
+    RhspQueryCache queryCache;
+    RhspOutputFrame outputFrame;
+    uint32_t i2cReadPollDelayUs[4];  // learned delay before polling read status, per i2c channel
+    uint8_t i2cChannelsInUse;        // bit per i2c channel with a blocking call in progress
+    RhspI2cWaitFunction i2cWaitFunction;
+    void* i2cWaitContext;
+    RhspEncoderHistory encoderHistory;
+    RhspTelemetryPublisher telemetry;
 } RhspRevHubInternal;
 
 #ifdef __cplusplus
@@ -0,0 +1,47 @@
+#ifndef RHSP_INTERNAL_RTT_H
+#define RHSP_INTERNAL_RTT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rhsp/revhub.h"
+
+#define RHSP_RTT_TABLE_SIZE     32  // number of packet types whose round trip time is tracked
+
+// Smoothed round trip time of one packet type, RFC 6298 style
+typedef struct {
+    uint16_t packetID;      // zero if the entry is unused
+    uint16_t samples;       // saturates at RHSP_RTT_MIN_SAMPLES
+    uint32_t smoothedRttUs;
+    uint32_t rttVariationUs;
+    uint8_t backoff;        // number of consecutive timeouts
+} RhspRttEntry;
+
+typedef struct {
+    bool enabled;
+    RhspRttEntry entries[RHSP_RTT_TABLE_SIZE];
+    uint8_t nextEviction;
+} RhspRttEstimator;
+
+/**
+ * @brief record the round trip time of a command that has been answered
+ *
+ * @note this function is for internal usage
+ * */
+void rhsp_rttAddSample(RhspRevHub* hub, uint16_t packetTypeID, uint32_t rttUs);
+
+/**
+ * @brief record that a command has not been answered in time
+ *
+ * @note this function is for internal usage
+ * */
+void rhsp_rttOnTimeout(RhspRevHub* hub, uint16_t packetTypeID);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RHSP_INTERNAL_RTT_H
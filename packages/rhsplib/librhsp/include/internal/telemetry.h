@@ -0,0 +1,28 @@
+#ifndef RHSP_INTERNAL_TELEMETRY_H
+#define RHSP_INTERNAL_TELEMETRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "rhsp/telemetry.h"
+
+typedef struct {
+    RhspTelemetrySegment* segment;  // NULL if the module is not published
+    char name[RHSP_TELEMETRY_MAX_NAME_LENGTH];
+} RhspTelemetryPublisher;
+
+/*
+ * Called with every value received from the module. They do nothing unless the module is published.
+ * hub is a RhspRevHub*.
+ */
+void rhsp_publishBulkInputData(RhspRevHub* hub, const RhspBulkInputData* data, uint32_t timestampUs);
+void rhsp_publishAdcValue(RhspRevHub* hub, uint8_t adcChannel, int16_t value, uint32_t timestampUs);
+void rhsp_publishModuleStatus(RhspRevHub* hub, const RhspModuleStatus* status, uint32_t timestampUs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RHSP_INTERNAL_TELEMETRY_H
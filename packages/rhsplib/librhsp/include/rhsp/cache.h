@@ -0,0 +1,66 @@
+/*
+ * cache.h
+ *
+ * Per-hub cache for queries whose results only change when the host writes them.
+ */
+
+#ifndef RHSP_CACHE_H_
+#define RHSP_CACHE_H_
+
+#include "revhub.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Groups of read commands that can be answered from the query cache.
+ * Each group has its own TTL. A TTL of zero (the default) disables caching for the group.
+ */
+typedef enum {
+    RHSP_CACHED_QUERY_VERSION = 0,                  // rhsp_readVersion, rhsp_readVersionString
+    RHSP_CACHED_QUERY_SERVO_CONFIGURATION = 1,      // rhsp_getServoConfiguration
+    RHSP_CACHED_QUERY_DIO_DIRECTION = 2,            // rhsp_getDirection
+    RHSP_CACHED_QUERY_MOTOR_CHANNEL_MODE = 3,       // rhsp_getMotorChannelMode
+    RHSP_CACHED_QUERY_CLOSED_LOOP_COEFFICIENTS = 4, // rhsp_getClosedLoopControlCoefficients
+    RHSP_CACHED_QUERY_I2C_CONFIGURATION = 5,        // rhsp_configureI2cQuery
+    RHSP_CACHED_QUERY_COUNT
+} RhspCachedQuery;
+
+/**
+ * @brief set time to live for a cached query group
+ * @details Responses of the group are reused for ttlMs after they have been received.
+ *          Setting a new TTL drops the cached responses of the group.
+ *
+ * @param[in] hub       module instance
+ * @param[in] query     cached query group
+ * @param[in] ttlMs     time to live in ms. Zero disables caching for the group
+ *
+ * @return RHSP_RESULT_OK in case success
+ * */
+int rhsp_setQueryCacheTtlMs(RhspRevHub* hub, RhspCachedQuery query, uint32_t ttlMs);
+
+/**
+ * @brief get time to live for a cached query group
+ *
+ * @param[in] hub       module instance
+ * @param[in] query     cached query group
+ *
+ * @return time to live in ms. If hub is NULL or query is invalid, zero is returned
+ * */
+uint32_t rhsp_queryCacheTtlMs(const RhspRevHub* hub, RhspCachedQuery query);
+
+/**
+ * @brief drop all cached responses
+ * @details The next read of any cached query goes to the module.
+ *
+ * @param[in] hub       module instance
+ * */
+void rhsp_clearQueryCache(RhspRevHub* hub);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RHSP_CACHE_H_ */
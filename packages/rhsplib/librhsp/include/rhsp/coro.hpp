@@ -0,0 +1,401 @@
+/*
+ * coro.hpp
+ *
+ * C++20 coroutine layer over rhsp.hpp. Every serial port gets one PortExecutor thread that runs the commands of all
+ * tasks on that port in the order they are awaited, so a task suspends while its command waits for the module instead
+ * of blocking a thread of its own. Requires C++20; nothing here is compiled into the library.
+ */
+
+#ifndef RHSP_CORO_HPP_
+#define RHSP_CORO_HPP_
+
+#if !defined(__cpp_impl_coroutine)
+#error "rhsp/coro.hpp requires C++20 coroutines"
+#endif
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "rhsp.hpp"
+
+namespace rhsp {
+
+/**
+ * I/O thread of a serial port. Jobs run one at a time in the order they were posted.
+ * Queued jobs still run when the executor is destroyed.
+ */
+class PortExecutor {
+public:
+    PortExecutor() : thread_([this] { run(); }) {}
+    ~PortExecutor() { stop(); }
+
+    PortExecutor(const PortExecutor&) = delete;
+    PortExecutor& operator=(const PortExecutor&) = delete;
+
+    void post(std::function<void()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(std::move(job));
+        }
+        condition_.notify_one();
+    }
+
+    bool isCurrentThread() const { return std::this_thread::get_id() == thread_.get_id(); }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        condition_.notify_one();
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            condition_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty())
+            {
+                return;
+            }
+            std::function<void()> job = std::move(jobs_.front());
+            jobs_.pop_front();
+            lock.unlock();
+            job();
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<std::function<void()>> jobs_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+template<typename T = void>
+class Task;
+
+namespace detail {
+
+template<typename T>
+class TaskPromiseBase {
+public:
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            std::coroutine_handle<> continuation = handle.promise().continuation_;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() { exception_ = std::current_exception(); }
+
+    void setContinuation(std::coroutine_handle<> continuation) { continuation_ = continuation; }
+
+protected:
+    void rethrowIfFailed() const
+    {
+        if (exception_)
+        {
+            std::rethrow_exception(exception_);
+        }
+    }
+
+private:
+    std::coroutine_handle<> continuation_;
+    std::exception_ptr exception_;
+};
+
+template<typename T>
+class TaskPromise : public TaskPromiseBase<T> {
+public:
+    Task<T> get_return_object();
+    void return_value(T value) { value_.emplace(std::move(value)); }
+
+    T result()
+    {
+        this->rethrowIfFailed();
+        return std::move(*value_);
+    }
+
+private:
+    std::optional<T> value_;
+};
+
+template<>
+class TaskPromise<void> : public TaskPromiseBase<void> {
+public:
+    Task<void> get_return_object();
+    void return_void() const noexcept {}
+    void result() const { rethrowIfFailed(); }
+};
+
+// runs a task to completion without anyone awaiting it
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+} // namespace detail
+
+/**
+ * Lazily started coroutine. It runs when it is awaited, or when it is handed to spawn() or syncWait().
+ */
+template<typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    ~Task()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+        }
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle_)
+            {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle_.promise().setContinuation(awaiting);
+        return handle_;
+    }
+
+    T await_resume() { return handle_.promise().result(); }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object()
+{
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object()
+{
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+inline DetachedTask runDetached(Task<void> task)
+{
+    co_await task;
+}
+
+} // namespace detail
+
+/**
+ * Awaitable that runs a function on the executor of a port and resumes the awaiting task there with its result
+ */
+template<typename T>
+class Command {
+public:
+    Command(PortExecutor& executor, std::function<Result<T>()> function)
+        : executor_(executor), function_(std::move(function)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> awaiting)
+    {
+        executor_.post([this, awaiting] {
+            result_.emplace(function_());
+            awaiting.resume();
+        });
+    }
+
+    Result<T> await_resume() { return std::move(*result_); }
+
+private:
+    PortExecutor& executor_;
+    std::function<Result<T>()> function_;
+    std::optional<Result<T>> result_;
+};
+
+/**
+ * Starts a task on the executor and lets it run in the background. An exception escaping the task terminates.
+ */
+inline void spawn(PortExecutor& executor, Task<void> task)
+{
+    auto taskPtr = std::make_shared<Task<void>>(std::move(task));
+    executor.post([taskPtr] { detail::runDetached(std::move(*taskPtr)); });
+}
+
+/**
+ * Blocks the calling thread until the task has completed and returns its result.
+ * Must not be called on the thread of the executor the task awaits commands on.
+ */
+template<typename T>
+T syncWait(Task<T> task)
+{
+    std::promise<T> promise;
+    std::future<T> future = promise.get_future();
+    auto wrapper = [](Task<T> inner, std::promise<T>& done) -> Task<void> {
+        try
+        {
+            if constexpr (std::is_void<T>::value)
+            {
+                co_await inner;
+                done.set_value();
+            } else
+            {
+                done.set_value(co_await inner);
+            }
+        } catch (...)
+        {
+            done.set_exception(std::current_exception());
+        }
+    };
+    detail::runDetached(wrapper(std::move(task), promise));
+    return future.get();
+}
+
+/**
+ * Hub whose commands are awaited. Commands are run by the executor of the serial port of the hub.
+ * Arguments are copied into the command, output pointers must stay valid until it completes.
+ */
+class AsyncHub {
+public:
+    AsyncHub(Hub& hub, PortExecutor& executor) : hub_(hub), executor_(executor) {}
+
+    Hub& hub() { return hub_; }
+    PortExecutor& executor() { return executor_; }
+
+    /**
+     * Runs function(hub) on the executor, e.g. co_await asyncHub.run<int32_t>([](Hub& hub) { ... })
+     */
+    template<typename T, typename Function>
+    Command<T> run(Function function)
+    {
+        Hub* hub = &hub_;
+        return Command<T>(executor_, [hub, function]() mutable { return function(*hub); });
+    }
+
+    /**
+     * Awaitable form of Hub::call, e.g. co_await asyncHub.call(rhsp_setMotorChannelEnable, motorChannel, 1)
+     */
+    template<typename... Params, typename... Args>
+    Command<void> call(int (* function)(RhspRevHub*, Params...), Args... args)
+    {
+        return run<void>([function, args...](Hub& hub) { return hub.call(function, args...); });
+    }
+
+    Command<void> sendKeepAlive() { return call(rhsp_sendKeepAlive); }
+
+    Command<RhspBulkInputData> getBulkInputData()
+    {
+        return run<RhspBulkInputData>([](Hub& hub) { return hub.getBulkInputData(); });
+    }
+
+    Command<int32_t> getEncoderPosition(uint8_t motorChannel)
+    {
+        return run<int32_t>([motorChannel](Hub& hub) { return hub.getEncoderPosition(motorChannel); });
+    }
+
+    Command<int16_t> getADC(uint8_t adcChannel, bool rawMode = false)
+    {
+        return run<int16_t>([adcChannel, rawMode](Hub& hub) { return hub.getADC(adcChannel, rawMode); });
+    }
+
+    Command<void> setMotorTargetVelocity(uint8_t motorChannel, int16_t velocity)
+    {
+        return call(rhsp_setMotorTargetVelocity, motorChannel, velocity);
+    }
+
+    Command<void> setMotorConstantPower(uint8_t motorChannel, double powerLevel)
+    {
+        return call(rhsp_setMotorConstantPower, motorChannel, powerLevel);
+    }
+
+    /**
+     * Reads bytes from an I2C device. Bytes read are written to payload, which must hold bytesToRead bytes.
+     */
+    Command<uint8_t> readI2cBytes(uint8_t i2cChannel, uint8_t slaveAddress, uint8_t bytesToRead, uint8_t* payload)
+    {
+        return run<uint8_t>([=](Hub& hub) -> Result<uint8_t> {
+            uint8_t bytesRead = 0;
+            Result<void> result = hub.call(rhsp_readMultipleBytesBlocking, i2cChannel, slaveAddress, bytesToRead,
+                                           (uint8_t*) nullptr, &bytesRead, payload);
+            if (!result)
+            {
+                return result.error();
+            }
+            return {bytesRead, result.status()};
+        });
+    }
+
+    /**
+     * Runs a list of I2C operations, see rhsp_runI2cOperations. The operations must stay valid until it completes.
+     */
+    Command<size_t> runI2cOperations(uint8_t i2cChannel, RhspI2cOperation* operations, size_t operationCount)
+    {
+        return run<size_t>([=](Hub& hub) -> Result<size_t> {
+            size_t completedOperations = 0;
+            Result<void> result = hub.call(rhsp_runI2cOperations, i2cChannel, operations, operationCount,
+                                           &completedOperations);
+            if (!result)
+            {
+                return result.error();
+            }
+            return {completedOperations, result.status()};
+        });
+    }
+
+private:
+    Hub& hub_;
+    PortExecutor& executor_;
+};
+
+} // namespace rhsp
+
+#endif /* RHSP_CORO_HPP_ */
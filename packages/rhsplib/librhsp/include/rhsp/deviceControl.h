@@ -16,6 +16,7 @@ extern "C" {
 #endif
 
 #define RHSP_INJECT_DATA_LOG_MAX_HINT_TEXT_LENGTH 100
+#define RHSP_NUMBER_OF_ADC_CHANNELS 15
 
 // bulk read data
 typedef struct {
@@ -80,6 +81,32 @@ int rhsp_getBulkInputData(RhspRevHub* hub,
                           RhspBulkInputData* response,
                           uint8_t* nackReasonCode);
 
+// bulk input data of one module, see rhsp_getBulkInputDataFromHubs
+typedef struct {
+    int resultCode;             // RHSP_RESULT_OK or the error of this module
+    uint8_t nackReasonCode;     // set if resultCode is RHSP_ERROR_NACK_RECEIVED
+    uint32_t timestampUs;       // steady clock when the response has been received, see rhsp_getSteadyClockUs
+    RhspBulkInputData data;     // valid if resultCode is RHSP_RESULT_OK
+} RhspHubBulkInputData;
+
+/**
+ * @brief get bulk input data of several modules on the same serial port at once
+ * @details The commands are sent back to back without waiting for each response, so the snapshots of all modules
+ *          are taken within a few packet times of each other. Each module records an encoder sample as with
+ *          rhsp_getBulkInputData.
+ *
+ * @param[in]  hubs      module instances, all opened on the same serial port
+ * @param[in]  hubCount  number of modules
+ * @param[out] data      result of each module, hubCount entries
+ *
+ * @return RHSP_RESULT_OK if all modules have answered, RHSP_ERROR if the modules do not share a serial port,
+ *         otherwise the first error
+ *
+ * */
+int rhsp_getBulkInputDataFromHubs(RhspRevHub* const* hubs,
+                                  size_t hubCount,
+                                  RhspHubBulkInputData* data);
+
 /**
  * @brief set bulk output data
  *
@@ -113,6 +140,30 @@ int rhsp_getADC(RhspRevHub* hub,
                 int16_t* adcValue,
                 uint8_t* nackReasonCode);
 
+/**
+ * @brief get several ADC values at once
+ * @details The requests are sent back to back without waiting for each response, so reading all channels
+ *          takes about as long as a few single reads.
+ *
+ * @param[in]  hub               module instance
+ * @param[in]  adcChannels       ADC channels to read
+ * @param[in]  channelCount      number of channels in range 1 - RHSP_NUMBER_OF_ADC_CHANNELS
+ * @param[in]  rawMode           Raw mode (engineering units = 0, raw counts = 1)
+ * @param[out] adcValues         adc values in the order of adcChannels
+ * @param[out] timestampMs       steady clock time when the last value has been received. Can be NULL.
+ * @param[out] nackReasonCode    nack reason code if the function returns RHSP_ERROR_NACK_RECEIVED
+ *
+ * @return RHSP_RESULT_OK in case success
+ *
+ * */
+int rhsp_getADCSweep(RhspRevHub* hub,
+                     const uint8_t* adcChannels,
+                     uint8_t channelCount,
+                     uint8_t rawMode,
+                     int16_t* adcValues,
+                     uint32_t* timestampMs,
+                     uint8_t* nackReasonCode);
+
 /**
  * @brief controls presence of charging voltage on USB port of Hardware Interface Board
  *
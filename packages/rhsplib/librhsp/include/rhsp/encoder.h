@@ -0,0 +1,78 @@
+/*
+ * encoder.h
+ *
+ * Per-hub history of the encoder state received with bulk input data.
+ */
+
+#ifndef RHSP_ENCODER_H_
+#define RHSP_ENCODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "revhub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RHSP_ENCODER_NUMBER_OF_MOTORS   4
+#define RHSP_ENCODER_HISTORY_SIZE       64
+
+// Encoder state of all motors at the time a bulk input data response has been received
+typedef struct {
+    uint32_t timestampUs;                                   // rhsp_getSteadyClockUs() when the response was received
+    int32_t position[RHSP_ENCODER_NUMBER_OF_MOTORS];        // encoder counts
+    int16_t velocity[RHSP_ENCODER_NUMBER_OF_MOTORS];        // counts per second, as reported by the module
+    double filteredVelocity[RHSP_ENCODER_NUMBER_OF_MOTORS];     // counts per second
+    double filteredAcceleration[RHSP_ENCODER_NUMBER_OF_MOTORS]; // counts per second^2
+} RhspEncoderSample;
+
+/**
+ * @brief get the encoder history
+ * @details Every successful rhsp_getBulkInputData, rhsp_setBulkOutputData or rhsp_commitOutputFrame
+ *          adds a sample. The last RHSP_ENCODER_HISTORY_SIZE samples are kept.
+ *
+ * @param[in]  hub          module instance
+ * @param[out] samples      samples, newest first
+ * @param[in]  maxSamples   capacity of samples
+ *
+ * @return number of samples written
+ * */
+size_t rhsp_getEncoderHistory(const RhspRevHub* hub, RhspEncoderSample* samples, size_t maxSamples);
+
+/**
+ * @brief get the newest encoder sample
+ *
+ * @param[in]  hub      module instance
+ * @param[out] sample   newest sample
+ *
+ * @return RHSP_RESULT_OK in case success, RHSP_ERROR if there is no sample yet
+ * */
+int rhsp_getLatestEncoderSample(const RhspRevHub* hub, RhspEncoderSample* sample);
+
+/**
+ * @brief set gains of the velocity and acceleration estimator
+ * @details The estimator is an alpha-beta-gamma filter on the encoder position. Higher gains follow
+ *          the measurements faster, lower gains smooth more. The default gains are 0.5, 0.2 and 0.02.
+ *
+ * @param[in] hub   module instance
+ * @param[in] alpha position gain in range (0, 1]
+ * @param[in] beta  velocity gain in range (0, 2]
+ * @param[in] gamma acceleration gain in range [0, 1]
+ *
+ * @return RHSP_RESULT_OK in case success
+ * */
+int rhsp_setEncoderFilterGains(RhspRevHub* hub, double alpha, double beta, double gamma);
+
+/**
+ * @brief clear the encoder history and restart the estimator
+ *
+ * @param[in] hub   module instance
+ * */
+void rhsp_clearEncoderHistory(RhspRevHub* hub);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RHSP_ENCODER_H_ */
@@ -16,6 +16,7 @@
 #define RHSP_ERROR_COMMAND_NOT_SUPPORTED    -7 // command is not supported by module
 #define RHSP_ERROR_UNEXPECTED_RESPONSE      -8 // error when we've received unexpected packet
 #define RHSP_ERROR_NO_HUBS_DISCOVERED       -9 // discovery failed to find any modules
+#define RHSP_ERROR_CANCELLED                -10 // command was cancelled before it was sent
 
 // out of range errors
 #define RHSP_ERROR_ARG_0_OUT_OF_RANGE       -50 // zero arg is out of range
@@ -0,0 +1,64 @@
+/*
+ * frame.h
+ *
+ * Output frames coalesce actuator setters issued during one control tick into a single transaction.
+ */
+
+#ifndef RHSP_FRAME_H_
+#define RHSP_FRAME_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "revhub.h"
+#include "deviceControl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief begin output frame
+ * @details While a frame is open, the following setters only record their value and return RHSP_RESULT_OK
+ *          without sending anything: rhsp_setSingleOutput, rhsp_setAllOutputs, rhsp_setDirection,
+ *          rhsp_setMotorChannelMode, rhsp_setMotorChannelEnable, rhsp_setMotorConstantPower,
+ *          rhsp_setMotorTargetVelocity, rhsp_setMotorTargetPosition, rhsp_setServoPulseWidth
+ *          and rhsp_setServoEnable. Only the last value written to each output is kept.
+ *          Read commands are not affected and return the state of the module.
+ *
+ * @param[in] hub   module instance
+ *
+ * @return RHSP_RESULT_OK in case success
+ * */
+int rhsp_beginOutputFrame(RhspRevHub* hub);
+
+/**
+ * @brief commit output frame
+ * @details Closes the frame and sends the recorded values. When the full output state of the module is known
+ *          and every recorded value can be expressed by the bulk output command, a single bulk output packet is sent.
+ *          Otherwise the recorded values are sent by individual commands. If sending stops on an error,
+ *          the values that have not been sent are dropped.
+ *
+ * @param[in]  hub              module instance
+ * @param[out] bulkInputData    bulk input data read after the outputs have been applied. Can be NULL.
+ * @param[out] nackReasonCode   nack reason code if the function returns RHSP_ERROR_NACK_RECEIVED
+ *
+ * @return RHSP_RESULT_OK in case success
+ * */
+int rhsp_commitOutputFrame(RhspRevHub* hub,
+                           RhspBulkInputData* bulkInputData,
+                           uint8_t* nackReasonCode);
+
+/**
+ * @brief check whether an output frame is open
+ *
+ * @param[in] hub   module instance
+ *
+ * @return true if an output frame is open, otherwise false
+ * */
+bool rhsp_isOutputFrameOpen(const RhspRevHub* hub);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RHSP_FRAME_H_ */
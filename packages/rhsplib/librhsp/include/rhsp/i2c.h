@@ -9,6 +9,7 @@
 #define RHSP_I2C_H_
 
 #include "revhub.h"
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -25,6 +26,23 @@ typedef struct {
     uint8_t buffer[RHSP_I2C_TRANSACTION_ARRAY_MAX_BUFFER_SIZE];
 } RhspI2cTransactionArray;
 
+#define RHSP_I2C_OPERATION_MAX_BUFFER_SIZE 100
+
+typedef enum {
+    RHSP_I2C_OPERATION_WRITE = 0,          // write length bytes from buffer
+    RHSP_I2C_OPERATION_READ = 1,           // read length bytes into buffer
+    RHSP_I2C_OPERATION_READ_REGISTER = 2,  // write startAddress, then read length bytes into buffer
+} RhspI2cOperationType;
+
+// single operation of an i2c script
+typedef struct {
+    uint8_t type;  // RhspI2cOperationType
+    uint8_t slaveAddress;
+    uint8_t startAddress;
+    uint8_t length;  // bytes to write or read. Set to the number of bytes read once a read completes
+    uint8_t buffer[RHSP_I2C_OPERATION_MAX_BUFFER_SIZE];
+} RhspI2cOperation;
+
 /**
  * @brief configure i2c channel
  *
@@ -186,6 +204,108 @@ int rhsp_readStatusQuery(RhspRevHub* hub,
                          uint8_t* payload,
                          uint8_t* nackReasonCode);
 
+/**
+ * @brief called instead of sleeping while a blocking i2c call waits for the controller
+ * @details Lets a caller that serializes access to the library release its lock while the hub is busy, so
+ *          commands to other modules on the port can be sent in between. The function must return after
+ *          delayUs and must not call the library for the same i2c channel. delayUs can be zero, between two
+ *          steps of an operation.
+ *
+ * @param[in] context   context given to rhsp_setI2cWaitFunction
+ * @param[in] delayUs   time to wait
+ * */
+typedef void (*RhspI2cWaitFunction)(void* context, uint32_t delayUs);
+
+/**
+ * @brief set the function blocking i2c calls of a module wait with
+ * @details Without a wait function, blocking calls sleep. While a blocking call waits, other blocking calls on
+ *          the same channel wait for it to finish.
+ *
+ * @param[in] hub           module instance
+ * @param[in] waitFunction  wait function, NULL to sleep
+ * @param[in] context       passed to waitFunction
+ * */
+void rhsp_setI2cWaitFunction(RhspRevHub* hub, RhspI2cWaitFunction waitFunction, void* context);
+
+/**
+ * @brief read multiple bytes from i2c channel and wait for the result
+ * @details Starts the read and polls the read status until the data is available.
+ *          Polling backs off while the operation is in progress, and the delay that was needed
+ *          is remembered per channel so the next read starts polling closer to completion.
+ *
+ * @param[in]  hub                      module instance
+ * @param[in]  i2cChannel               i2c channel in range 0 - 3
+ * @param[in]  slaveAddress             slave address in range 0 - 127
+ * @param[in]  bytesToRead              number of bytes to read in range 1 - 100
+ * @param[out] i2cTransactionStatusByte i2c transaction status byte. Can be NULL.
+ * @param[out] bytesRead                number of bytes read in range 0 - 100
+ * @param[out] payload                  payload bytes. Should hold at least bytesToRead bytes.
+ * @param[out] nackReasonCode           nack reason code if the function returns RHSP_ERROR_NACK_RECEIVED
+ *
+ * @return RHSP_RESULT_OK in case success, RHSP_ERROR_RESPONSE_TIMEOUT if the operation does not complete
+ *
+ * */
+int rhsp_readMultipleBytesBlocking(RhspRevHub* hub,
+                                   uint8_t i2cChannel,
+                                   uint8_t slaveAddress,
+                                   uint8_t bytesToRead,
+                                   uint8_t* i2cTransactionStatusByte,
+                                   uint8_t* bytesRead,
+                                   uint8_t* payload,
+                                   uint8_t* nackReasonCode);
+
+/**
+ * @brief write a starting address, read multiple bytes and wait for the result
+ * @details Same as rhsp_readMultipleBytesBlocking, but the read is started by rhsp_writeReadMultipleBytes.
+ *
+ * @param[in]  hub                      module instance
+ * @param[in]  i2cChannel               i2c channel in range 0 - 3
+ * @param[in]  slaveAddress             slave address in range 0 - 127
+ * @param[in]  bytesToRead              number of bytes to read in range 1 - 100
+ * @param[in]  startAddress             start address in range 0 - 255
+ * @param[out] i2cTransactionStatusByte i2c transaction status byte. Can be NULL.
+ * @param[out] bytesRead                number of bytes read in range 0 - 100
+ * @param[out] payload                  payload bytes. Should hold at least bytesToRead bytes.
+ * @param[out] nackReasonCode           nack reason code if the function returns RHSP_ERROR_NACK_RECEIVED
+ *
+ * @return RHSP_RESULT_OK in case success, RHSP_ERROR_RESPONSE_TIMEOUT if the operation does not complete
+ *
+ * */
+int rhsp_writeReadMultipleBytesBlocking(RhspRevHub* hub,
+                                        uint8_t i2cChannel,
+                                        uint8_t slaveAddress,
+                                        uint8_t bytesToRead,
+                                        uint8_t startAddress,
+                                        uint8_t* i2cTransactionStatusByte,
+                                        uint8_t* bytesRead,
+                                        uint8_t* payload,
+                                        uint8_t* nackReasonCode);
+
+/**
+ * @brief run a list of i2c operations on one channel
+ * @details The operations are run in order without returning to the caller in between. Writes are not waited
+ *          for; the following operation is retried until the controller has finished the write. Reads wait for
+ *          their data the same way as rhsp_readMultipleBytesBlocking. The call returns once the last operation
+ *          has completed on the bus, or on the first error. The wait function of the module is also called
+ *          between operations, so a caller can let other commands run there.
+ *
+ * @param[in]     hub                   module instance
+ * @param[in]     i2cChannel            i2c channel in range 0 - 3
+ * @param[in,out] operations            operations to run. Read operations receive their data in buffer.
+ * @param[in]     operationCount        number of operations
+ * @param[out]    completedOperations   number of operations that have completed. Can be NULL.
+ * @param[out]    nackReasonCode        nack reason code if the function returns RHSP_ERROR_NACK_RECEIVED
+ *
+ * @return RHSP_RESULT_OK in case success
+ *
+ * */
+int rhsp_runI2cOperations(RhspRevHub* hub,
+                          uint8_t i2cChannel,
+                          RhspI2cOperation* operations,
+                          size_t operationCount,
+                          size_t* completedOperations,
+                          uint8_t* nackReasonCode);
+
 /**
  * @brief write single combined I2C message, including one or multiple reads or writes
  *
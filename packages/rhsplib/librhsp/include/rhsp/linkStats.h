@@ -0,0 +1,41 @@
+/*
+ * linkStats.h
+ *
+ * Link health counters of serial ports and modules.
+ */
+
+#ifndef RHSP_LINK_STATS_H_
+#define RHSP_LINK_STATS_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RHSP_LINK_STATS_NUMBER_OF_NACK_CODES    256
+
+/*
+ * Counters only increase and wrap around at 2^32. Use the difference between two readings.
+ * All fields are uint32_t, so the structure can be read counter by counter.
+ */
+typedef struct {
+    uint32_t framesSent;
+    uint32_t framesReceived;        // frames with a valid checksum
+    uint32_t bytesSent;
+    uint32_t bytesReceived;
+    uint32_t checksumErrors;
+    uint32_t resyncs;               // the receiver dropped a partial frame: bad sync byte, invalid length or checksum
+    uint32_t discardedBytes;        // bytes that were not part of a valid frame, including stale bytes purged before a command
+    uint32_t timeouts;
+    uint32_t nacks;
+    uint32_t attentionRequired;     // ACKs with the attention required flag
+    uint32_t retries;               // queries sent again after a transient error
+    uint32_t nacksByCode[RHSP_LINK_STATS_NUMBER_OF_NACK_CODES];
+} RhspLinkStats;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RHSP_LINK_STATS_H_ */
@@ -0,0 +1,69 @@
+/*
+ * motionProfile.h
+ *
+ * Trapezoidal and S-curve (jerk limited) motion profiles for a move from rest to rest.
+ */
+
+#ifndef RHSP_MOTION_PROFILE_H_
+#define RHSP_MOTION_PROFILE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// limits of a move. Units are encoder counts and seconds
+typedef struct {
+    double distance;            // counts, negative to move backwards
+    double maxVelocity;         // counts per second, > 0
+    double maxAcceleration;     // counts per second^2, > 0
+    double maxJerk;             // counts per second^3, 0 for a trapezoidal profile
+} RhspMotionConstraints;
+
+// planned profile. Acceleration and deceleration are symmetric
+typedef struct {
+    double direction;                   // 1 or -1
+    double distance;                    // counts, >= 0
+    double peakVelocity;                // counts per second, may be below maxVelocity on short moves
+    double peakAcceleration;            // counts per second^2
+    double jerk;                        // counts per second^3, 0 for a trapezoidal profile
+    double jerkTime;                    // s, duration of each jerk segment
+    double constantAccelerationTime;    // s
+    double accelerationTime;            // s, 2 * jerkTime + constantAccelerationTime
+    double accelerationDistance;        // counts covered while accelerating
+    double cruiseTime;                  // s
+    double duration;                    // s
+} RhspMotionProfile;
+
+// state of a profile at a point in time, relative to the start position
+typedef struct {
+    double position;        // counts
+    double velocity;        // counts per second
+    double acceleration;    // counts per second^2
+} RhspMotionState;
+
+/**
+ * @brief plan a motion profile
+ * @details If the distance is too short to reach maxVelocity, the peak velocity is lowered so that the move
+ *          still respects maxAcceleration and maxJerk.
+ *
+ * @param[in]  constraints  limits of the move
+ * @param[out] profile      planned profile
+ *
+ * @return RHSP_RESULT_OK in case success, RHSP_ERROR if a limit is not positive or the distance is not finite
+ * */
+int rhsp_planMotionProfile(const RhspMotionConstraints* constraints, RhspMotionProfile* profile);
+
+/**
+ * @brief get the state of a profile at a point in time
+ *
+ * @param[in]  profile  planned profile
+ * @param[in]  time     s since the start of the move. Clamped to [0, duration]
+ * @param[out] state    state at that time
+ * */
+void rhsp_sampleMotionProfile(const RhspMotionProfile* profile, double time, RhspMotionState* state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RHSP_MOTION_PROFILE_H_ */
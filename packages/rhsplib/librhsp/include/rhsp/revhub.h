@@ -10,6 +10,8 @@ extern "C" {
 
 #define RHSP_BUFFER_SIZE 1024
 #define RHSP_RESPONSE_TIMEOUT_MS            1000 // response timeout, ms. Zero means infinite timeout. Since FW has interval timeout 500 ms, it is reasonable to set longer timeout
+#define RHSP_ADAPTIVE_RESPONSE_TIMEOUT_MIN_MS 5  // lower bound of adaptive response timeouts, ms
+#define RHSP_READ_RETRY_LIMIT               2    // default number of retries of a query after a transient error
 #define RHSP_DISCOVERY_RESPONSE_TIMEOUT_MS  1000 // response timeout for discovery, ms. It may differ from commonly used RHSP_RESPONSE_TIMEOUT_MS
 // @TODO adjust timeout for discovery
 
@@ -33,6 +35,15 @@ RhspRevHub* rhsp_allocRevHub(RhspSerial* serialPort, uint8_t destAddress);
  */
 void freeRevHub(RhspRevHub* hub);
 
+/**
+ * @brief size of a hub allocated by rhsp_allocRevHub
+ * @details The hub holds the transmit and receive buffers, so callers that need deterministic latency can lock
+ *          the range [hub, hub + size) in memory.
+ *
+ * @return size in bytes
+ * */
+size_t rhsp_revHubSize(void);
+
 /**
  * @brief check whether the module is opened
  *
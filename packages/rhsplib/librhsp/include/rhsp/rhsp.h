@@ -15,16 +15,22 @@ extern "C" {
 
 #include <stdbool.h>
 
+#include "cache.h"
 #include "compiler.h"
 #include "deviceControl.h"
 #include "dio.h"
+#include "encoder.h"
 #include "errors.h"
+#include "frame.h"
 #include "i2c.h"
+#include "linkStats.h"
 #include "module.h"
+#include "motionProfile.h"
 #include "motor.h"
 #include "revhub.h"
 #include "serial.h"
 #include "servo.h"
+#include "telemetry.h"
 #include "time.h"
 
 #ifdef __cplusplus
@@ -97,6 +103,125 @@ int rhsp_setResponseTimeoutMs(RhspRevHub* hub, uint32_t responseTimeoutMs);
  * */
 uint32_t rhsp_responseTimeoutMs(const RhspRevHub* hub);
 
+/**
+ * @brief set how often a query is repeated after a transient error
+ * @details Queries without side effects are sent again if the response times out, does not match the
+ *          message number of the command or is not the expected response. Responses dropped for a bad
+ *          checksum end in a timeout. Queries that change the module state, e.g. status queries that
+ *          clear the status or I2C status queries, are never repeated.
+ *          Write commands are never repeated.
+ *
+ * @param[in] hub       module instance
+ * @param[in] retries   maximum number of retries per query. Zero disables retries. Default is RHSP_READ_RETRY_LIMIT
+ *
+ * @return RHSP_RESULT_OK in case success
+ * */
+int rhsp_setReadRetryLimit(RhspRevHub* hub, uint8_t retries);
+
+/**
+ * @brief get how often a query is repeated after a transient error
+ *
+ * @param[in] hub   module instance
+ *
+ * @return maximum number of retries per query. If hub is NULL, zero is returned
+ * */
+uint8_t rhsp_readRetryLimit(const RhspRevHub* hub);
+
+/**
+ * @brief read the link health counters of a module
+ * @details Counts the traffic of this module only. Safe to call from any thread while commands are sent.
+ *
+ * @param[in]  hub      module instance
+ * @param[out] stats    counters
+ *
+ * @return RHSP_RESULT_OK in case success
+ * */
+int rhsp_getLinkStats(const RhspRevHub* hub, RhspLinkStats* stats);
+
+/**
+ * @brief read the link health counters of a serial port
+ * @details Counts the traffic of all modules on the port, including discovery.
+ *          Safe to call from any thread while commands are sent.
+ *
+ * @param[in]  serial   serial port
+ * @param[out] stats    counters
+ *
+ * @return RHSP_RESULT_OK in case success
+ * */
+int rhsp_getSerialLinkStats(const RhspSerial* serial, RhspLinkStats* stats);
+
+/**
+ * @brief enable or disable adaptive response timeouts
+ * @details When enabled, the round trip time of every packet type is measured and the response timeout
+ *          of a command is its smoothed round trip time plus four times its variation, but at least
+ *          RHSP_ADAPTIVE_RESPONSE_TIMEOUT_MIN_MS. Each timeout doubles the timeout of that packet type until
+ *          the next response. The timeout set by rhsp_setResponseTimeoutMs is the upper bound and is used
+ *          for packet types that have not been measured often enough, so slow commands keep their limit.
+ *          Adaptive timeouts are not used while the response timeout is infinite. Disabled by default.
+ *
+ * @param[in] hub       module instance
+ * @param[in] enabled   true to enable adaptive timeouts
+ *
+ * @return RHSP_RESULT_OK in case success
+ * */
+int rhsp_setAdaptiveResponseTimeout(RhspRevHub* hub, bool enabled);
+
+/**
+ * @brief check whether adaptive response timeouts are enabled
+ *
+ * @param[in] hub   module instance
+ *
+ * @return true if adaptive response timeouts are enabled
+ * */
+bool rhsp_isAdaptiveResponseTimeoutEnabled(const RhspRevHub* hub);
+
+/**
+ * @brief get the response timeout the next command of a packet type would use
+ *
+ * @param[in] hub           module instance
+ * @param[in] packetTypeID  packet type id
+ *
+ * @return response timeout in ms. Zero value is infinite timeout
+ * */
+uint32_t rhsp_commandResponseTimeoutMs(const RhspRevHub* hub, uint16_t packetTypeID);
+
+/**
+ * @brief send write command without copying the response
+ * @details The response payload is returned as a pointer into the receive buffer of the hub. The pointer stays
+ *          valid until the next command is sent to the hub.
+ *
+ * @param[in]  hub                  module instance
+ * @param[in]  packetTypeID         packet type id
+ * @param[in]  payload              command payload
+ * @param[in]  payloadSize          payload size in bytes
+ * @param[out] responsePayload      response payload. Can be NULL
+ * @param[out] responsePayloadSize  response payload size in bytes. Can be NULL
+ * @param[out] nackReasonCode       it is set if the return value is RHSP_ERROR_NACK_RECEIVED
+ *
+ * @return RHSP_RESULT_OK or RHSP_RESULT_ATTENTION_REQUIRED in case success
+ * */
+int rhsp_sendWriteCommandView(RhspRevHub* hub,
+                              uint16_t packetTypeID,
+                              const uint8_t* payload,
+                              uint16_t payloadSize,
+                              const uint8_t** responsePayload,
+                              uint16_t* responsePayloadSize,
+                              uint8_t* nackReasonCode);
+
+/**
+ * @brief send read command without copying the response
+ * @details same as rhsp_sendWriteCommandView, for read commands. The command is not repeated after an error.
+ *
+ * @return RHSP_RESULT_OK in case success
+ * */
+int rhsp_sendReadCommandView(RhspRevHub* hub,
+                             uint16_t packetTypeID,
+                             const uint8_t* payload,
+                             uint16_t payloadSize,
+                             const uint8_t** responsePayload,
+                             uint16_t* responsePayloadSize,
+                             uint8_t* nackReasonCode);
+
 /**
  * @brief request module status
  *
@@ -122,6 +247,30 @@ int rhsp_getModuleStatus(RhspRevHub* hub,
  * */
 int rhsp_sendKeepAlive(RhspRevHub* hub, uint8_t* nackReasonCode);
 
+/**
+ * @brief send keep alive if the module has not been spoken to recently
+ * @details Every command resets the keep alive timer of the module, so keep alive is only sent
+ *          if no command has been sent to the module during the last idleTimeMs.
+ *
+ * @param[in]  hub            module instance
+ * @param[in]  idleTimeMs     time without commands after which keep alive is sent
+ * @param[out] nackReasonCode nack reason code if the function returns RHSP_ERROR_NACK_RECEIVED
+ *
+ * @return RHSP_RESULT_OK or RHSP_RESULT_ATTENTION_REQUIRED in case success
+ *
+ * */
+int rhsp_sendKeepAliveIfIdle(RhspRevHub* hub, uint32_t idleTimeMs, uint8_t* nackReasonCode);
+
+/**
+ * @brief time since the last command has been sent to the module
+ *
+ * @param[in] hub module instance
+ *
+ * @return idle time in ms. If nothing has been sent yet or hub is NULL, UINT32_MAX is returned
+ *
+ * */
+uint32_t rhsp_idleTimeMs(const RhspRevHub* hub);
+
 /**
  * @brief send fail safe
  *
@@ -0,0 +1,305 @@
+/*
+ * rhsp.hpp
+ *
+ * Header-only C++ API over librhsp. Serial ports and hubs are owned by RAII types, calls return Result instead of
+ * writing to output pointers, and raw command responses are views into the receive buffer of the hub.
+ * Requires C++14. The C API stays the ABI; nothing here is compiled into the library.
+ */
+
+#ifndef RHSP_HPP_
+#define RHSP_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "rhsp.h"
+
+namespace rhsp {
+
+/**
+ * Error of a failed call. code is one of RHSP_ERROR_* or RHSP_SERIAL_ERROR_*,
+ * nackReasonCode is valid if code is RHSP_ERROR_NACK_RECEIVED.
+ */
+struct Error {
+    int code;
+    uint8_t nackReasonCode;
+};
+
+/**
+ * Value of a successful call or the error of a failed one. T must be default constructible.
+ * status() is the non-negative return value of the C function, e.g. RHSP_RESULT_ATTENTION_REQUIRED.
+ */
+template<typename T>
+class Result {
+public:
+    Result(T value, int status = RHSP_RESULT_OK) : value_(std::move(value)), error_{status, 0} {}
+    Result(Error error) : value_(), error_(error) {}
+
+    bool ok() const { return error_.code >= 0; }
+    explicit operator bool() const { return ok(); }
+    int status() const { return error_.code; }
+
+    const Error& error() const { return error_; }
+    T& value() & { return value_; }
+    const T& value() const & { return value_; }
+    T&& value() && { return std::move(value_); }
+    T valueOr(T fallback) const { return ok() ? value_ : fallback; }
+
+    T& operator*() & { return value_; }
+    const T& operator*() const & { return value_; }
+    T* operator->() { return &value_; }
+    const T* operator->() const { return &value_; }
+
+private:
+    T value_;
+    Error error_;
+};
+
+template<>
+class Result<void> {
+public:
+    Result(int status = RHSP_RESULT_OK) : error_{status, 0} {}
+    Result(Error error) : error_(error) {}
+
+    bool ok() const { return error_.code >= 0; }
+    explicit operator bool() const { return ok(); }
+    int status() const { return error_.code; }
+    const Error& error() const { return error_; }
+
+private:
+    Error error_;
+};
+
+/**
+ * Non-owning view of contiguous elements, a subset of std::span
+ */
+template<typename T>
+class Span {
+public:
+    Span() : data_(nullptr), size_(0) {}
+    Span(T* data, size_t size) : data_(data), size_(size) {}
+    template<size_t N>
+    Span(T (&array)[N]) : data_(array), size_(N) {}
+    template<typename Container,
+             typename = decltype(static_cast<T*>(std::declval<Container&>().data())),
+             typename = decltype(std::declval<Container&>().size())>
+    Span(Container& container) : data_(container.data()), size_(container.size()) {}
+
+    T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+    T& operator[](size_t index) const { return data_[index]; }
+
+private:
+    T* data_;
+    size_t size_;
+};
+
+using ByteView = Span<const uint8_t>;
+
+/**
+ * Serial port. Hubs keep a pointer to it, so it can not be moved and must outlive them.
+ */
+class Serial {
+public:
+    Serial() { rhsp_serialInit(&serial_); }
+    ~Serial() { close(); }
+
+    Serial(const Serial&) = delete;
+    Serial& operator=(const Serial&) = delete;
+
+    Result<void> open(const char* serialPort,
+                      uint32_t baudrate = 460800,
+                      uint32_t databits = 8,
+                      RhspSerialParity parity = RHSP_SERIAL_PARITY_NONE,
+                      uint32_t stopbits = 1,
+                      RhspSerialFlowControl flowControl = RHSP_SERIAL_FLOW_CONTROL_NONE)
+    {
+        close();
+        int result = rhsp_serialOpen(&serial_, serialPort, baudrate, databits, parity, stopbits, flowControl);
+        if (result < 0)
+        {
+            return Error{result, 0};
+        }
+        open_ = true;
+        return result;
+    }
+
+    void close()
+    {
+        if (open_)
+        {
+            rhsp_serialClose(&serial_);
+            open_ = false;
+        }
+    }
+
+    bool isOpen() const { return open_; }
+
+    Result<RhspDiscoveredAddresses> discoverRevHubs()
+    {
+        RhspDiscoveredAddresses addresses{};
+        int result = rhsp_discoverRevHubs(&serial_, &addresses);
+        if (result < 0)
+        {
+            return Error{result, 0};
+        }
+        return {addresses, result};
+    }
+
+    RhspLinkStats linkStats() const
+    {
+        RhspLinkStats stats{};
+        rhsp_getSerialLinkStats(&serial_, &stats);
+        return stats;
+    }
+
+    RhspSerial* get() { return &serial_; }
+
+private:
+    RhspSerial serial_;
+    bool open_ = false;
+};
+
+/**
+ * Module on a serial port. Closed and freed when destroyed.
+ */
+class Hub {
+public:
+    Hub(Serial& serial, uint8_t address) : Hub(serial.get(), address) {}
+    Hub(RhspSerial* serial, uint8_t address) : hub_(rhsp_allocRevHub(serial, address)) {}
+    ~Hub() { reset(); }
+
+    Hub(const Hub&) = delete;
+    Hub& operator=(const Hub&) = delete;
+    Hub(Hub&& other) noexcept : hub_(other.hub_) { other.hub_ = nullptr; }
+    Hub& operator=(Hub&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            hub_ = other.hub_;
+            other.hub_ = nullptr;
+        }
+        return *this;
+    }
+
+    /**
+     * false if the hub could not be allocated or has been moved from
+     */
+    explicit operator bool() const { return hub_ != nullptr; }
+    RhspRevHub* get() const { return hub_; }
+
+    uint8_t address() const { return rhsp_getDestinationAddress(hub_); }
+    void setAddress(uint8_t address) { rhsp_setDestinationAddress(hub_, address); }
+
+    /**
+     * Calls a C function that takes the hub first and the nack reason code last, e.g.
+     * hub.call(rhsp_getEncoderPosition, motorChannel, &position)
+     */
+    template<typename... Params, typename... Args>
+    Result<void> call(int (* function)(RhspRevHub*, Params...), Args&& ... args)
+    {
+        uint8_t nackReasonCode = 0;
+        int result = function(hub_, std::forward<Args>(args)..., &nackReasonCode);
+        if (result < 0)
+        {
+            return Error{result, nackReasonCode};
+        }
+        return result;
+    }
+
+    Result<void> sendKeepAlive() { return call(rhsp_sendKeepAlive); }
+    Result<void> sendFailSafe() { return call(rhsp_sendFailSafe); }
+
+    Result<RhspModuleStatus> getModuleStatus(bool clearStatusAfterResponse)
+    {
+        return query<RhspModuleStatus>(rhsp_getModuleStatus, (uint8_t) clearStatusAfterResponse);
+    }
+
+    Result<RhspVersion> readVersion() { return query<RhspVersion>(rhsp_readVersion); }
+    Result<RhspBulkInputData> getBulkInputData() { return query<RhspBulkInputData>(rhsp_getBulkInputData); }
+
+    Result<int16_t> getADC(uint8_t adcChannel, bool rawMode = false)
+    {
+        return query<int16_t>(rhsp_getADC, adcChannel, (uint8_t) rawMode);
+    }
+
+    Result<int32_t> getEncoderPosition(uint8_t motorChannel)
+    {
+        return query<int32_t>(rhsp_getEncoderPosition, motorChannel);
+    }
+
+    Result<uint8_t> getAllInputs() { return query<uint8_t>(rhsp_getAllInputs); }
+
+    /**
+     * The returned view points into the receive buffer of the hub and is valid until the next command
+     */
+    Result<ByteView> sendReadCommand(uint16_t packetTypeID, ByteView payload = {})
+    {
+        return sendRaw(rhsp_sendReadCommandView, packetTypeID, payload);
+    }
+
+    /**
+     * The returned view points into the receive buffer of the hub and is valid until the next command
+     */
+    Result<ByteView> sendWriteCommand(uint16_t packetTypeID, ByteView payload = {})
+    {
+        return sendRaw(rhsp_sendWriteCommandView, packetTypeID, payload);
+    }
+
+    RhspLinkStats linkStats() const
+    {
+        RhspLinkStats stats{};
+        rhsp_getLinkStats(hub_, &stats);
+        return stats;
+    }
+
+private:
+    template<typename T, typename... Params, typename... Args>
+    Result<T> query(int (* function)(RhspRevHub*, Params...), Args&& ... args)
+    {
+        T value{};
+        Result<void> result = call(function, std::forward<Args>(args)..., &value);
+        if (!result)
+        {
+            return result.error();
+        }
+        return {value, result.status()};
+    }
+
+    using RawCommand = int (*)(RhspRevHub*, uint16_t, const uint8_t*, uint16_t, const uint8_t**, uint16_t*, uint8_t*);
+
+    Result<ByteView> sendRaw(RawCommand command, uint16_t packetTypeID, ByteView payload)
+    {
+        const uint8_t* response = nullptr;
+        uint16_t responseSize = 0;
+        uint8_t nackReasonCode = 0;
+        int result = command(hub_, packetTypeID, payload.data(), (uint16_t) payload.size(),
+                             &response, &responseSize, &nackReasonCode);
+        if (result < 0)
+        {
+            return Error{result, nackReasonCode};
+        }
+        return {ByteView(response, responseSize), result};
+    }
+
+    void reset()
+    {
+        if (hub_)
+        {
+            rhsp_close(hub_);
+            freeRevHub(hub_);
+            hub_ = nullptr;
+        }
+    }
+
+    RhspRevHub* hub_;
+};
+
+} // namespace rhsp
+
+#endif /* RHSP_HPP_ */
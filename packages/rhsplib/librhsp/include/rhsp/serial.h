@@ -21,8 +21,10 @@
 #endif
 
 #include "errors.h"
+#include "linkStats.h"
 
 #define RHSP_SERIAL_INFINITE_TIMEOUT    -1
+#define RHSP_SERIAL_STALE_MESSAGE_SLOTS 16  // at least the number of commands that can be in flight on a port
 
 typedef enum {
     RHSP_SERIAL_PARITY_NONE = 0,
@@ -49,6 +51,10 @@ typedef struct {
     bool useTermiosTimeout;
     int rxTimeoutMs;
 #endif
+    RhspLinkStats linkStats;  // counters of all modules on this port, see rhsp_getSerialLinkStats
+    uint8_t messageNumber;    // last message number sent to any module on this port, zero if none
+    // message numbers of commands given up while their response could still arrive, by number modulo the size
+    uint8_t staleMessageNumbers[RHSP_SERIAL_STALE_MESSAGE_SLOTS];
 } RhspSerial;
 
 /**
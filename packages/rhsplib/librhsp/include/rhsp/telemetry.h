@@ -0,0 +1,134 @@
+/*
+ * telemetry.h
+ *
+ * Latest state of a hub published into shared memory for other local processes.
+ */
+
+#ifndef RHSP_TELEMETRY_H_
+#define RHSP_TELEMETRY_H_
+
+#include <stdint.h>
+#include "deviceControl.h"
+#include "linkStats.h"
+#include "module.h"
+#include "revhub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RHSP_TELEMETRY_MAGIC            0x54505352u  // "RSPT" in little endian
+#define RHSP_TELEMETRY_VERSION          1
+#define RHSP_TELEMETRY_READ_ATTEMPTS    1000         // reads that overlap an update before rhsp_readTelemetry gives up
+#define RHSP_TELEMETRY_MAX_NAME_LENGTH  64           // including the terminating zero
+
+/*
+ * The summary counters of RhspLinkStats. The NACKs by code are left out, they would make every update copy
+ * RHSP_LINK_STATS_NUMBER_OF_NACK_CODES more counters; rhsp_getLinkStats returns them.
+ */
+typedef struct {
+    uint32_t framesSent;
+    uint32_t framesReceived;
+    uint32_t bytesSent;
+    uint32_t bytesReceived;
+    uint32_t checksumErrors;
+    uint32_t resyncs;
+    uint32_t discardedBytes;
+    uint32_t timeouts;
+    uint32_t nacks;
+    uint32_t attentionRequired;
+    uint32_t retries;
+} RhspTelemetryLinkStats;
+
+/*
+ * Timestamps are rhsp_getSteadyClockUs() of the publishing process, zero if the value has not been received yet.
+ * The steady clock is system wide, so they can be compared with the clock of the reading process.
+ */
+typedef struct {
+    uint32_t updateTimestampUs;                             // last update of any field
+    uint32_t bulkInputTimestampUs;
+    RhspBulkInputData bulkInputData;
+    uint32_t adcTimestampUs[RHSP_NUMBER_OF_ADC_CHANNELS];
+    int16_t adcValues[RHSP_NUMBER_OF_ADC_CHANNELS];        // engineering units, raw mode reads are not published
+    uint32_t moduleStatusTimestampUs;
+    RhspModuleStatus moduleStatus;
+    RhspTelemetryLinkStats linkStats;                       // of the module, as of the last update
+} RhspTelemetryData;
+
+/*
+ * Layout of the shared memory segment.
+ *
+ * The publisher is the only writer. It makes sequence odd, updates data, then makes sequence even again, with a
+ * release fence after the first store and a release store for the second. A reader loads sequence with acquire
+ * semantics, retries while it is odd, copies data, issues an acquire fence and loads sequence again: the copy is
+ * consistent if both loads are equal. rhsp_readTelemetry does exactly this, so reading takes no system call and
+ * never blocks the publisher.
+ *
+ * Readers must check magic, version and size before trusting data. magic is written last when a segment is set up.
+ */
+typedef struct {
+    uint32_t magic;         // RHSP_TELEMETRY_MAGIC
+    uint32_t version;       // RHSP_TELEMETRY_VERSION
+    uint32_t size;          // sizeof(RhspTelemetrySegment) of the publisher
+    uint32_t sequence;      // seqlock, odd while data is being updated
+    uint8_t address;        // address of the module
+    uint8_t reserved[7];
+    RhspTelemetryData data;
+} RhspTelemetrySegment;
+
+/**
+ * @brief publish the state of a module into a POSIX shared memory segment
+ * @details The segment is created, and must not exist yet, so two publishers never write the same segment. A
+ *          segment left behind by a process that has crashed must be removed with shm_unlink first. From then on,
+ *          bulk input data, ADC values, module status and link stats are written to it whenever they are
+ *          received. The segment is unlinked by rhsp_stopPublishingTelemetry and rhsp_close; readers that have it
+ *          mapped keep the last state. Only supported on Linux and macOS.
+ *
+ * @param[in] hub   module instance
+ * @param[in] name  shared memory object name, such as "/rhsp-hub-2"
+ *
+ * @return RHSP_RESULT_OK in case success, RHSP_ERROR_ARG_1_OUT_OF_RANGE if the name is longer than
+ *         RHSP_TELEMETRY_MAX_NAME_LENGTH, RHSP_ERROR if the segment exists already or cannot be created
+ * */
+int rhsp_publishTelemetry(RhspRevHub* hub, const char* name);
+
+/**
+ * @brief stop publishing the state of a module and unlink its segment
+ *
+ * @param[in] hub   module instance
+ * */
+void rhsp_stopPublishingTelemetry(RhspRevHub* hub);
+
+/**
+ * @brief map a telemetry segment read-only, from any process
+ *
+ * @param[in]  name     shared memory object name given to rhsp_publishTelemetry
+ * @param[out] segment  mapped segment
+ *
+ * @return RHSP_RESULT_OK in case success, RHSP_ERROR if the segment does not exist or has another layout
+ * */
+int rhsp_openTelemetry(const char* name, const RhspTelemetrySegment** segment);
+
+/**
+ * @brief unmap a segment mapped by rhsp_openTelemetry
+ *
+ * @param[in] segment   mapped segment
+ * */
+void rhsp_closeTelemetry(const RhspTelemetrySegment* segment);
+
+/**
+ * @brief take a consistent copy of the data of a segment
+ *
+ * @param[in]  segment  mapped segment
+ * @param[out] data     copy of the data
+ *
+ * @return RHSP_RESULT_OK in case success, RHSP_ERROR if the layout does not match or
+ *         RHSP_TELEMETRY_READ_ATTEMPTS reads overlapped an update
+ * */
+int rhsp_readTelemetry(const RhspTelemetrySegment* segment, RhspTelemetryData* data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RHSP_TELEMETRY_H_ */
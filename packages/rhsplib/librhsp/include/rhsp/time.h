@@ -23,6 +23,25 @@ extern "C" {
  * */
 uint32_t rhsp_getSteadyClockMs(void);
 
+/**
+ * @brief  steady clock in microseconds
+ * @details return steady(monotonic) clock in microseconds. The value wraps around after about 71 minutes,
+ *          so only differences between two values are meaningful.
+ *
+ * @return steady time in microseconds
+ *
+ * */
+uint32_t rhsp_getSteadyClockUs(void);
+
+/**
+ * @brief  suspend the calling thread
+ * @details the thread sleeps at least the given time. Resolution depends on the platform.
+ *
+ * @param[in] us  time to sleep in microseconds
+ *
+ * */
+void rhsp_sleepUs(uint32_t us);
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,6 +4,7 @@
  *  Created on: Dec 3, 2020
  *      Author: user
  */
+#include <errno.h>
 #include <time.h>
 
 #include "rhsp/time.h"
@@ -18,3 +19,25 @@ uint32_t rhsp_getSteadyClockMs(void)
         return 0;
     return time_spec.tv_sec * 1000UL + time_spec.tv_nsec / 1000000UL;
 }
+
+uint32_t rhsp_getSteadyClockUs(void)
+{
+    struct timespec time_spec;
+
+    int retval = clock_gettime(CLOCK_MONOTONIC, &time_spec);
+    if (retval < 0)
+        return 0;
+    return (uint32_t) (time_spec.tv_sec * 1000000ULL + time_spec.tv_nsec / 1000ULL);
+}
+
+void rhsp_sleepUs(uint32_t us)
+{
+    struct timespec time_spec;
+    time_spec.tv_sec = us / 1000000UL;
+    time_spec.tv_nsec = (us % 1000000UL) * 1000UL;
+
+    // continue sleeping if interrupted by a signal
+    while (nanosleep(&time_spec, &time_spec) < 0 && errno == EINTR)
+    {
+    }
+}
@@ -13,3 +13,19 @@ uint32_t rhsp_getSteadyClockMs(void)
 {
     return GetTickCount();
 }
+
+uint32_t rhsp_getSteadyClockUs(void)
+{
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint32_t) (counter.QuadPart / frequency.QuadPart * 1000000ULL +
+                       counter.QuadPart % frequency.QuadPart * 1000000ULL / frequency.QuadPart);
+}
+
+void rhsp_sleepUs(uint32_t us)
+{
+    // Sleep() has millisecond resolution, so round up
+    Sleep((us + 999) / 1000);
+}
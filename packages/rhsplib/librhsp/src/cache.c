@@ -0,0 +1,182 @@
+/*
+ * cache.c
+ *
+ * Query cache for read commands whose results only change when the host writes them.
+ */
+#include <string.h>
+
+#include "rhsp/cache.h"
+#include "rhsp/errors.h"
+#include "rhsp/time.h"
+#include "internal/cache.h"
+#include "internal/command.h"
+#include "internal/packet.h"
+#include "internal/revhub.h"
+
+static bool isEntryFresh(const RhspQueryCache* cache, const RhspQueryCacheEntry* entry, uint32_t nowMs)
+{
+    uint32_t ttlMs = cache->ttlMs[entry->query];
+    return entry->valid && ttlMs != 0 && (nowMs - entry->timestampMs) < ttlMs;
+}
+
+static RhspQueryCacheEntry* findEntry(RhspQueryCache* cache,
+                                      RhspCachedQuery query,
+                                      uint16_t packetTypeID,
+                                      const uint8_t* payload,
+                                      uint16_t payloadSize)
+{
+    for (int i = 0; i < RHSP_QUERY_CACHE_SIZE; i++)
+    {
+        RhspQueryCacheEntry* entry = &cache->entries[i];
+        if (entry->valid &&
+            entry->query == query &&
+            entry->packetID == packetTypeID &&
+            entry->requestSize == payloadSize &&
+            (payloadSize == 0 || memcmp(entry->request, payload, payloadSize) == 0))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// returns an empty or expired entry. If there are none, the oldest entry is returned.
+static RhspQueryCacheEntry* allocEntry(RhspQueryCache* cache, uint32_t nowMs)
+{
+    RhspQueryCacheEntry* oldest = &cache->entries[0];
+    for (int i = 0; i < RHSP_QUERY_CACHE_SIZE; i++)
+    {
+        RhspQueryCacheEntry* entry = &cache->entries[i];
+        if (!isEntryFresh(cache, entry, nowMs))
+        {
+            return entry;
+        }
+        if (nowMs - entry->timestampMs > nowMs - oldest->timestampMs)
+        {
+            oldest = entry;
+        }
+    }
+    return oldest;
+}
+
+int rhsp_sendCachedReadCommandInternal(RhspRevHub* hub,
+                                       RhspCachedQuery query,
+                                       uint16_t packetTypeID,
+                                       const uint8_t* payload,
+                                       uint16_t payloadSize,
+                                       uint8_t* nackReasonCode)
+{
+    if (!hub || query >= RHSP_CACHED_QUERY_COUNT)
+    {
+        return RHSP_ERROR;
+    }
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    RhspQueryCache* cache = &internalHub->queryCache;
+
+    if (cache->ttlMs[query] == 0 || payloadSize > RHSP_QUERY_CACHE_MAX_REQUEST_SIZE)
+    {
+        return rhsp_sendReadCommandInternal(hub, packetTypeID, payload, payloadSize, nackReasonCode);
+    }
+    if (!rhsp_isOpened(hub))
+    {
+        return RHSP_ERROR_NOT_OPENED;
+    }
+
+    uint32_t nowMs = rhsp_getSteadyClockMs();
+    RhspQueryCacheEntry* entry = findEntry(cache, query, packetTypeID, payload, payloadSize);
+    if (entry && isEntryFresh(cache, entry, nowMs))
+    {
+        memcpy(internalHub->rxBuffer, entry->response, entry->responseSize);
+        return RHSP_RESULT_OK;
+    }
+
+    int retval = rhsp_sendReadCommandInternal(hub, packetTypeID, payload, payloadSize, nackReasonCode);
+    if (retval < 0)
+    {
+        if (entry)
+        {
+            entry->valid = false;
+        }
+        return retval;
+    }
+
+    uint16_t responseSize = RHSP_PACKET_SIZE(internalHub->rxBuffer);
+    if (responseSize > RHSP_QUERY_CACHE_MAX_RESPONSE_SIZE)
+    {
+        return retval;
+    }
+    if (!entry)
+    {
+        entry = allocEntry(cache, nowMs);
+    }
+    entry->valid = true;
+    entry->query = (uint8_t) query;
+    entry->packetID = packetTypeID;
+    entry->requestSize = (uint8_t) payloadSize;
+    if (payloadSize > 0)
+    {
+        memcpy(entry->request, payload, payloadSize);
+    }
+    entry->timestampMs = rhsp_getSteadyClockMs();
+    entry->responseSize = responseSize;
+    memcpy(entry->response, internalHub->rxBuffer, responseSize);
+
+    return retval;
+}
+
+void rhsp_invalidateCachedQuery(RhspRevHub* hub, RhspCachedQuery query)
+{
+    if (!hub)
+    {
+        return;
+    }
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    for (int i = 0; i < RHSP_QUERY_CACHE_SIZE; i++)
+    {
+        RhspQueryCacheEntry* entry = &internalHub->queryCache.entries[i];
+        if (entry->query == query)
+        {
+            entry->valid = false;
+        }
+    }
+}
+
+int rhsp_setQueryCacheTtlMs(RhspRevHub* hub, RhspCachedQuery query, uint32_t ttlMs)
+{
+    if (!hub)
+    {
+        return RHSP_ERROR;
+    }
+    if (query >= RHSP_CACHED_QUERY_COUNT)
+    {
+        return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
+    }
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    internalHub->queryCache.ttlMs[query] = ttlMs;
+    rhsp_invalidateCachedQuery(hub, query);
+
+    return RHSP_RESULT_OK;
+}
+
+uint32_t rhsp_queryCacheTtlMs(const RhspRevHub* hub, RhspCachedQuery query)
+{
+    if (!hub || query >= RHSP_CACHED_QUERY_COUNT)
+    {
+        return 0;
+    }
+    const RhspRevHubInternal* internalHub = (const RhspRevHubInternal*) hub;
+    return internalHub->queryCache.ttlMs[query];
+}
+
+void rhsp_clearQueryCache(RhspRevHub* hub)
+{
+    if (!hub)
+    {
+        return;
+    }
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    for (int i = 0; i < RHSP_QUERY_CACHE_SIZE; i++)
+    {
+        internalHub->queryCache.entries[i].valid = false;
+    }
+}
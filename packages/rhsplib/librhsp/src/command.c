@@ -1,9 +1,17 @@
 
+#include <string.h>
+
 #include "internal/command.h"
 #include "rhsp/revhub.h"
+#include "rhsp/rhsp.h"
 #include "rhsp/compiler.h"
+#include "rhsp/time.h"
+#include "rhsp/cache.h"
 #include "internal/packet.h"
 #include "internal/revhub.h"
+#include "internal/frame.h"
+#include "internal/linkStats.h"
+#include "internal/rtt.h"
 
 static bool isAckReceived(RhspRevHubInternal* hub, bool* isAttentionRequired)
 {
@@ -13,9 +21,14 @@ static bool isAckReceived(RhspRevHubInternal* hub, bool* isAttentionRequired)
     }
     if (RHSP_PACKET_IS_ACK(hub->rxBuffer))
     {
+        bool attentionRequired = (bool) RHSP_PACKET_PAYLOAD_PTR(hub->rxBuffer)[0];
+        if (attentionRequired)
+        {
+            RHSP_LINK_STATS_ADD(hub, attentionRequired, 1);
+        }
         if (isAttentionRequired)
         {
-            *isAttentionRequired = (bool) RHSP_PACKET_PAYLOAD_PTR(hub->rxBuffer)[0];
+            *isAttentionRequired = attentionRequired;
         }
         return true;
     }
@@ -31,9 +44,12 @@ static bool isNackReceived(RhspRevHubInternal* hub, uint8_t* nackReasonCode)
 
     if (RHSP_PACKET_IS_NACK(hub->rxBuffer))
     {
+        uint8_t code = RHSP_PACKET_PAYLOAD_PTR(hub->rxBuffer)[0];
+        RHSP_LINK_STATS_ADD(hub, nacks, 1);
+        RHSP_LINK_STATS_ADD(hub, nacksByCode[code], 1);
         if (nackReasonCode)
         {
-            *nackReasonCode = RHSP_PACKET_PAYLOAD_PTR(hub->rxBuffer)[0];
+            *nackReasonCode = code;
         }
         return true;
     }
@@ -50,6 +66,12 @@ static int validateWriteCommand(RhspRevHub* hub, uint8_t* nackReasonCode)
     RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
     if (isAckReceived(internalHub, &isAttentionRequired))
     {
+        if (isAttentionRequired)
+        {
+            // the module may have been reset or gone to fail safe, so cached responses and outputs are stale
+            rhsp_clearQueryCache(hub);
+            rhsp_forgetOutputState(hub);
+        }
         return (isAttentionRequired == true) ? RHSP_RESULT_ATTENTION_REQUIRED : RHSP_RESULT_OK;
     } else if (isNackReceived(internalHub, nackReasonCode))
     {
@@ -74,6 +96,13 @@ static int validateReadCommand(RhspRevHubInternal* hub, uint8_t* nackReasonCode)
     return RHSP_ERROR_UNEXPECTED_RESPONSE;
 }
 
+// should be called upon successful data transfer
+static void onPacketSent(RhspRevHubInternal* hub)
+{
+    hub->hasTransmitted = true;
+    hub->lastTransmitTimestampMs = rhsp_getSteadyClockMs();
+}
+
 int sendCommand(RhspRevHubInternal* hub,
                 uint8_t destAddr,
                 uint16_t packetTypeID,
@@ -85,41 +114,59 @@ int sendCommand(RhspRevHubInternal* hub,
         return RHSP_ERROR;
     }
     // Purge receive buffers to avoid unexpected responses from previous commands
-    serialPurgeRxBuffer(hub->serialPort);
+    serialPurgeRxBuffer(hub);
+
+    uint32_t timeoutMs = rhsp_commandResponseTimeoutMs((RhspRevHub*) hub, packetTypeID);
+    uint32_t sentTimestampUs = rhsp_getSteadyClockUs();
 
     // send command and wait for response
-    int result = sendPacket(hub, destAddr, hub->messageNumber, 0, packetTypeID, payload, payloadSize);
+    int result = sendPacket(hub, destAddr, nextMessageNumber(hub), 0, packetTypeID, payload, payloadSize);
     if (result < 0)
     {
         return result;
     }
-    // we should increment message number upon successful data transfer
-    // otherwise we may get unexpected response when we send a new message with the same messageNumber
-    hub->messageNumber++;
-    if (hub->messageNumber == 0)
+    onPacketSent(hub);
+
+    result = receivePacketWithTimeout(hub, timeoutMs);
+    // responses to commands that have been given up may still arrive ahead of ours
+    while (result >= 0 && hub->rxBuffer[7] != hub->txBuffer[6] && takeStaleMessage(hub, hub->rxBuffer[7]))
+    {
+        result = receivePacketWithTimeout(hub, timeoutMs);
+    }
+    if (result == RHSP_ERROR_RESPONSE_TIMEOUT)
     {
-        hub->messageNumber = 1;
+        rhsp_rttOnTimeout((RhspRevHub*) hub, packetTypeID);
+        markMessageStale(hub, hub->txBuffer[6]);
     }
-    result = receivePacket(hub);
     if (result < 0)
     {
         return result;
     }
     // transaction was successful.
     // check whether the response match sent command
-    if (hub->rxBuffer[7] != hub->txBuffer[6])
+    if (hub->rxBuffer[7] != hub->txBuffer[6] || RHSP_PACKET_SRC_ADDRESS(hub->rxBuffer) != destAddr)
     {
         return RHSP_ERROR_MSG_NUMBER_MISMATCH;
     }
+    rhsp_rttAddSample((RhspRevHub*) hub, packetTypeID, rhsp_getSteadyClockUs() - sentTimestampUs);
 
     return RHSP_RESULT_OK;
 }
 
-int rhsp_sendReadCommandInternal(RhspRevHub* hub,
-                                 uint16_t packetTypeID,
-                                 const uint8_t* payload,
-                                 uint16_t payloadSize,
-                                 uint8_t* nackReasonCode)
+// errors caused by a lost or corrupted packet. Responses dropped for a bad checksum end in a timeout.
+static bool isTransientError(int result)
+{
+    return result == RHSP_ERROR_RESPONSE_TIMEOUT ||
+           result == RHSP_ERROR_MSG_NUMBER_MISMATCH ||
+           result == RHSP_ERROR_UNEXPECTED_RESPONSE;
+}
+
+static int sendReadCommand(RhspRevHub* hub,
+                           uint16_t packetTypeID,
+                           const uint8_t* payload,
+                           uint16_t payloadSize,
+                           uint8_t retries,
+                           uint8_t* nackReasonCode)
 {
     rhsp_assert(payloadSize <= RHSP_MAX_PAYLOAD_SIZE);
     if (payloadSize)
@@ -142,12 +189,38 @@ int rhsp_sendReadCommandInternal(RhspRevHub* hub,
     }
 
     RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-    int retval = sendCommand(internalHub, internalHub->address, packetTypeID, payload, payloadSize);
-    if (retval < 0)
+    int retval;
+    for (uint8_t attempt = 0;; attempt++)
     {
-        return retval;
+        retval = sendCommand(internalHub, internalHub->address, packetTypeID, payload, payloadSize);
+        if (retval >= 0)
+        {
+            retval = validateReadCommand(internalHub, nackReasonCode);
+        }
+        if (attempt >= retries || !isTransientError(retval))
+        {
+            return retval;
+        }
+        RHSP_LINK_STATS_ADD(internalHub, retries, 1);
     }
-    return validateReadCommand(internalHub, nackReasonCode);
+}
+
+int rhsp_sendReadCommandInternal(RhspRevHub* hub,
+                                 uint16_t packetTypeID,
+                                 const uint8_t* payload,
+                                 uint16_t payloadSize,
+                                 uint8_t* nackReasonCode)
+{
+    return sendReadCommand(hub, packetTypeID, payload, payloadSize, rhsp_readRetryLimit(hub), nackReasonCode);
+}
+
+int rhsp_sendReadCommandOnceInternal(RhspRevHub* hub,
+                                     uint16_t packetTypeID,
+                                     const uint8_t* payload,
+                                     uint16_t payloadSize,
+                                     uint8_t* nackReasonCode)
+{
+    return sendReadCommand(hub, packetTypeID, payload, payloadSize, 0, nackReasonCode);
 }
 
 int rhsp_sendWriteCommandInternal(RhspRevHub* hub,
@@ -185,6 +258,341 @@ int rhsp_sendWriteCommandInternal(RhspRevHub* hub,
     return validateWriteCommand(hub, nackReasonCode);
 }
 
+int rhsp_sendPipelinedReadCommandsInternal(RhspRevHub* hub,
+                                           uint16_t packetTypeID,
+                                           const uint8_t* payloads,
+                                           uint16_t payloadSize,
+                                           size_t commandCount,
+                                           RhspPipelinedResponseHandler onResponse,
+                                           void* context,
+                                           uint8_t* nackReasonCode)
+{
+    if (!hub || (payloadSize > 0 && !payloads) || !onResponse)
+    {
+        return RHSP_ERROR;
+    }
+    if (payloadSize > RHSP_MAX_PAYLOAD_SIZE)
+    {
+        return RHSP_ERROR_ARG_3_OUT_OF_RANGE;
+    }
+    if (!rhsp_isOpened(hub))
+    {
+        return RHSP_ERROR_NOT_OPENED;
+    }
+
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    // message numbers of the commands in flight, oldest first
+    uint8_t inFlight[RHSP_PIPELINE_DEPTH];
+    size_t inFlightCount = 0;
+    size_t sent = 0;
+    size_t received = 0;
+    int retval = RHSP_RESULT_OK;
+
+    // Purge receive buffers to avoid unexpected responses from previous commands
+    serialPurgeRxBuffer(internalHub);
+
+    while (received < commandCount)
+    {
+        // keep the pipeline full unless a command has failed
+        while (retval >= 0 && sent < commandCount && inFlightCount < RHSP_PIPELINE_DEPTH)
+        {
+            uint8_t messageNumber = nextMessageNumber(internalHub);
+            int result = sendPacket(internalHub, internalHub->address, messageNumber, 0, packetTypeID,
+                                    &payloads[sent * payloadSize], payloadSize);
+            if (result < 0)
+            {
+                retval = result;
+                break;
+            }
+            onPacketSent(internalHub);
+            inFlight[inFlightCount++] = messageNumber;
+            sent++;
+        }
+        if (inFlightCount == 0)
+        {
+            break;
+        }
+
+        int result = receivePacket(internalHub);
+        if (result < 0)
+        {
+            // the remaining responses cannot be matched any more, but may still arrive
+            for (size_t i = 0; i < inFlightCount; i++)
+            {
+                markMessageStale(internalHub, inFlight[i]);
+            }
+            return (retval < 0) ? retval : result;
+        }
+        if (internalHub->rxBuffer[7] != inFlight[0] && takeStaleMessage(internalHub, internalHub->rxBuffer[7]))
+        {
+            // a late response to an earlier command
+            continue;
+        }
+        if (internalHub->rxBuffer[7] != inFlight[0])
+        {
+            if (retval >= 0)
+            {
+                retval = RHSP_ERROR_MSG_NUMBER_MISMATCH;
+            }
+        } else if (retval >= 0)
+        {
+            if (RHSP_PACKET_ID(internalHub->rxBuffer) == (packetTypeID | 0x8000))
+            {
+                onResponse(context, received, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer));
+            } else if (isNackReceived(internalHub, nackReasonCode))
+            {
+                retval = RHSP_ERROR_NACK_RECEIVED;
+            } else
+            {
+                retval = RHSP_ERROR_UNEXPECTED_RESPONSE;
+            }
+        }
+        // responses arrive in order, so drop the oldest command
+        for (size_t i = 1; i < inFlightCount; i++)
+        {
+            inFlight[i - 1] = inFlight[i];
+        }
+        inFlightCount--;
+        received++;
+    }
+    return retval;
+}
+
+static size_t countInFlight(const RhspPortTransaction* transactions,
+                            const size_t* inFlight,
+                            size_t inFlightCount,
+                            uint8_t address)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < inFlightCount; i++)
+    {
+        if (((RhspRevHubInternal*) transactions[inFlight[i]].hub)->address == address)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+static void markPortTransactionsStale(const RhspPortTransaction* transactions,
+                                      const size_t* inFlight,
+                                      const uint8_t* inFlightMessageNumbers,
+                                      size_t inFlightCount)
+{
+    for (size_t i = 0; i < inFlightCount; i++)
+    {
+        markMessageStale((RhspRevHubInternal*) transactions[inFlight[i]].hub, inFlightMessageNumbers[i]);
+    }
+}
+
+int rhsp_runPortTransactionsInternal(RhspPortTransaction* transactions,
+                                     size_t transactionCount,
+                                     RhspPortTransactionHandler onResponse,
+                                     void* context)
+{
+    if (!transactions || transactionCount == 0)
+    {
+        return RHSP_ERROR;
+    }
+
+    // responses are received through the first module
+    RhspRevHubInternal* receiver = (RhspRevHubInternal*) transactions[0].hub;
+    for (size_t i = 0; i < transactionCount; i++)
+    {
+        RhspPortTransaction* transaction = &transactions[i];
+        RhspRevHubInternal* hub = (RhspRevHubInternal*) transaction->hub;
+        if (!hub || !rhsp_isOpened(transaction->hub) || !receiver || hub->serialPort != receiver->serialPort ||
+            (transaction->payloadSize > 0 && !transaction->payload))
+        {
+            return RHSP_ERROR;
+        }
+        if (transaction->payloadSize > RHSP_MAX_PAYLOAD_SIZE)
+        {
+            return RHSP_ERROR_ARG_3_OUT_OF_RANGE;
+        }
+        transaction->sent = false;
+    }
+
+    // indices of the transactions in flight, their message numbers, when they have been sent and how long
+    // their responses are waited for (0 to wait forever)
+    size_t inFlight[RHSP_PORT_MAX_IN_FLIGHT];
+    uint8_t inFlightMessageNumbers[RHSP_PORT_MAX_IN_FLIGHT];
+    uint32_t inFlightSentUs[RHSP_PORT_MAX_IN_FLIGHT];
+    uint32_t inFlightTimeoutUs[RHSP_PORT_MAX_IN_FLIGHT];
+    size_t inFlightCount = 0;
+    // transactions before this one have all been sent or skipped
+    size_t firstUnsent = 0;
+
+    serialPurgeRxBuffer(receiver);
+
+    for (;;)
+    {
+        // send in order, passing over transactions whose module already has a full pipeline
+        for (size_t i = firstUnsent; i < transactionCount && inFlightCount < RHSP_PORT_MAX_IN_FLIGHT; i++)
+        {
+            RhspPortTransaction* transaction = &transactions[i];
+            RhspRevHubInternal* hub = (RhspRevHubInternal*) transaction->hub;
+            if (transaction->sent)
+            {
+                continue;
+            }
+            if (transaction->result < 0)
+            {
+                transaction->sent = true;
+                continue;
+            }
+            if (countInFlight(transactions, inFlight, inFlightCount, hub->address) >= RHSP_PIPELINE_DEPTH)
+            {
+                continue;
+            }
+            uint8_t messageNumber = nextMessageNumber(hub);
+            int result = sendPacket(hub, hub->address, messageNumber, 0, transaction->packetTypeID,
+                                    transaction->payload, transaction->payloadSize);
+            if (result < 0)
+            {
+                // the responses to the commands in flight must not be taken for the next ones
+                markMessageStale(hub, messageNumber);
+                markPortTransactionsStale(transactions, inFlight, inFlightMessageNumbers, inFlightCount);
+                return result;
+            }
+            onPacketSent(hub);
+            transaction->sent = true;
+            // until a response arrives
+            transaction->result = RHSP_ERROR_RESPONSE_TIMEOUT;
+            inFlight[inFlightCount] = i;
+            inFlightMessageNumbers[inFlightCount] = messageNumber;
+            inFlightSentUs[inFlightCount] = rhsp_getSteadyClockUs();
+            uint32_t timeoutMs = rhsp_commandResponseTimeoutMs(transaction->hub, transaction->packetTypeID);
+            inFlightTimeoutUs[inFlightCount] = timeoutMs > UINT32_MAX / 1000 ? UINT32_MAX : timeoutMs * 1000;
+            inFlightCount++;
+        }
+        while (firstUnsent < transactionCount && transactions[firstUnsent].sent)
+        {
+            firstUnsent++;
+        }
+        if (inFlightCount == 0)
+        {
+            break;
+        }
+
+        // wait until the first transaction in flight is due
+        uint32_t nowUs = rhsp_getSteadyClockUs();
+        uint32_t waitMs = 0;
+        for (size_t i = 0; i < inFlightCount; i++)
+        {
+            if (inFlightTimeoutUs[i] == 0)
+            {
+                continue;
+            }
+            uint32_t elapsedUs = nowUs - inFlightSentUs[i];
+            uint32_t remainingUs = elapsedUs < inFlightTimeoutUs[i] ? inFlightTimeoutUs[i] - elapsedUs : 0;
+            // rounded up, since a timeout of 0 waits forever
+            uint32_t remainingMs = remainingUs / 1000 + 1;
+            if (waitMs == 0 || remainingMs < waitMs)
+            {
+                waitMs = remainingMs;
+            }
+        }
+
+        int result = receivePacketWithTimeout(receiver, waitMs);
+        if (result == RHSP_ERROR_RESPONSE_TIMEOUT)
+        {
+            // only the transactions past their own timeout are given up, they keep RHSP_ERROR_RESPONSE_TIMEOUT
+            nowUs = rhsp_getSteadyClockUs();
+            size_t remaining = 0;
+            for (size_t i = 0; i < inFlightCount; i++)
+            {
+                RhspPortTransaction* transaction = &transactions[inFlight[i]];
+                if (inFlightTimeoutUs[i] != 0 && nowUs - inFlightSentUs[i] >= inFlightTimeoutUs[i])
+                {
+                    rhsp_rttOnTimeout(transaction->hub, transaction->packetTypeID);
+                    markMessageStale((RhspRevHubInternal*) transaction->hub, inFlightMessageNumbers[i]);
+                    continue;
+                }
+                inFlight[remaining] = inFlight[i];
+                inFlightMessageNumbers[remaining] = inFlightMessageNumbers[i];
+                inFlightSentUs[remaining] = inFlightSentUs[i];
+                inFlightTimeoutUs[remaining] = inFlightTimeoutUs[i];
+                remaining++;
+            }
+            inFlightCount = remaining;
+            continue;
+        }
+        if (result < 0)
+        {
+            markPortTransactionsStale(transactions, inFlight, inFlightMessageNumbers, inFlightCount);
+            return result;
+        }
+
+        size_t match = inFlightCount;
+        for (size_t i = 0; i < inFlightCount; i++)
+        {
+            RhspRevHubInternal* hub = (RhspRevHubInternal*) transactions[inFlight[i]].hub;
+            if (RHSP_PACKET_SRC_ADDRESS(receiver->rxBuffer) == hub->address &&
+                receiver->rxBuffer[7] == inFlightMessageNumbers[i])
+            {
+                match = i;
+                break;
+            }
+        }
+        if (match == inFlightCount)
+        {
+            // a late response to an earlier command
+            continue;
+        }
+
+        size_t transactionIndex = inFlight[match];
+        RhspPortTransaction* transaction = &transactions[transactionIndex];
+        RhspRevHubInternal* hub = (RhspRevHubInternal*) transaction->hub;
+        rhsp_rttAddSample(transaction->hub, transaction->packetTypeID,
+                          rhsp_getSteadyClockUs() - inFlightSentUs[match]);
+        if (hub != receiver)
+        {
+            memcpy(hub->rxBuffer, receiver->rxBuffer, RHSP_PACKET_SIZE(receiver->rxBuffer));
+        }
+        if (transaction->isWrite)
+        {
+            transaction->result = validateWriteCommand(transaction->hub, &transaction->nackReasonCode);
+        } else if (RHSP_PACKET_ID(hub->rxBuffer) == (transaction->packetTypeID | 0x8000))
+        {
+            transaction->result = RHSP_RESULT_OK;
+        } else if (isNackReceived(hub, &transaction->nackReasonCode))
+        {
+            transaction->result = RHSP_ERROR_NACK_RECEIVED;
+        } else
+        {
+            transaction->result = RHSP_ERROR_UNEXPECTED_RESPONSE;
+        }
+        if (transaction->result >= 0 && onResponse)
+        {
+            onResponse(context, transactionIndex);
+        }
+
+        for (size_t i = match + 1; i < inFlightCount; i++)
+        {
+            inFlight[i - 1] = inFlight[i];
+            inFlightMessageNumbers[i - 1] = inFlightMessageNumbers[i];
+            inFlightSentUs[i - 1] = inFlightSentUs[i];
+            inFlightTimeoutUs[i - 1] = inFlightTimeoutUs[i];
+        }
+        inFlightCount--;
+    }
+    return RHSP_RESULT_OK;
+}
+
+static void getPayloadView(const RhspRevHubInternal* hub, const uint8_t** payload, uint16_t* payloadSize)
+{
+    rhsp_assert(RHSP_PACKET_SIZE(hub->rxBuffer) >= (RHSP_PACKET_HEADER_SIZE + RHSP_PACKET_CRC_SIZE));
+    if (payload)
+    {
+        *payload = RHSP_PACKET_PAYLOAD_PTR(hub->rxBuffer);
+    }
+    if (payloadSize)
+    {
+        *payloadSize = RHSP_PACKET_SIZE(hub->rxBuffer) - RHSP_PACKET_HEADER_SIZE - RHSP_PACKET_CRC_SIZE;
+    }
+}
+
 int rhsp_sendWriteCommand(RhspRevHub* hub,
                           uint16_t packetTypeID,
                           const uint8_t* payload,
@@ -196,6 +604,9 @@ int rhsp_sendWriteCommand(RhspRevHub* hub,
     {
         return RHSP_ERROR;
     }
+    // an arbitrary command may change any of the cached values and outputs
+    rhsp_clearQueryCache(hub);
+    rhsp_forgetOutputState(hub);
     int retval = rhsp_sendWriteCommandInternal(hub, packetTypeID, payload, payloadSize, nackReasonCode);
     if (retval < 0)
     {
@@ -218,7 +629,7 @@ int rhsp_sendReadCommand(RhspRevHub* hub,
     {
         return RHSP_ERROR;
     }
-    int retval = rhsp_sendReadCommandInternal(hub, packetTypeID, payload, payloadSize, nackReasonCode);
+    int retval = rhsp_sendReadCommandOnceInternal(hub, packetTypeID, payload, payloadSize, nackReasonCode);
     if (retval < 0)
     {
         return retval;
@@ -229,3 +640,51 @@ int rhsp_sendReadCommand(RhspRevHub* hub,
     return retval;
 }
 
+int rhsp_sendWriteCommandView(RhspRevHub* hub,
+                              uint16_t packetTypeID,
+                              const uint8_t* payload,
+                              uint16_t payloadSize,
+                              const uint8_t** responsePayload,
+                              uint16_t* responsePayloadSize,
+                              uint8_t* nackReasonCode)
+{
+    if (!hub)
+    {
+        return RHSP_ERROR;
+    }
+    // an arbitrary command may change any of the cached values and outputs
+    rhsp_clearQueryCache(hub);
+    rhsp_forgetOutputState(hub);
+    int retval = rhsp_sendWriteCommandInternal(hub, packetTypeID, payload, payloadSize, nackReasonCode);
+    if (retval < 0)
+    {
+        return retval;
+    }
+
+    getPayloadView((const RhspRevHubInternal*) hub, responsePayload, responsePayloadSize);
+
+    return retval;
+}
+
+int rhsp_sendReadCommandView(RhspRevHub* hub,
+                             uint16_t packetTypeID,
+                             const uint8_t* payload,
+                             uint16_t payloadSize,
+                             const uint8_t** responsePayload,
+                             uint16_t* responsePayloadSize,
+                             uint8_t* nackReasonCode)
+{
+    if (!hub)
+    {
+        return RHSP_ERROR;
+    }
+    int retval = rhsp_sendReadCommandOnceInternal(hub, packetTypeID, payload, payloadSize, nackReasonCode);
+    if (retval < 0)
+    {
+        return retval;
+    }
+
+    getPayloadView((const RhspRevHubInternal*) hub, responsePayload, responsePayloadSize);
+
+    return retval;
+}
@@ -0,0 +1,212 @@
+/*
+ * dekaCommands.c
+ *
+ * Packet ID lookup and request/response checks driven by the DEKA command table.
+ */
+#include <stdbool.h>
+#include "internal/dekaCommands.h"
+#include "internal/cache.h"
+#include "internal/command.h"
+#include "internal/packet.h"
+#include "internal/revhub.h"
+#include "rhsp/compiler.h"
+#include "rhsp/module.h"
+
+const RhspDekaCommandDescriptor rhsp_dekaCommands[RHSP_DEKA_COMMAND_COUNT] = {
+#define RHSP_DEKA_COMMAND_DESCRIPTOR(name, functionNumber, type, requestSize, responseSize) \
+    {#name, functionNumber, RHSP_DEKA_##type, requestSize, responseSize},
+    RHSP_DEKA_COMMANDS(RHSP_DEKA_COMMAND_DESCRIPTOR)
+#undef RHSP_DEKA_COMMAND_DESCRIPTOR
+};
+
+int rhsp_getDekaPacketID(RhspRevHub* hub, RhspDekaCommand command, uint16_t* packetID, uint8_t* nackReasonCode)
+{
+    if (!hub || command >= RHSP_DEKA_COMMAND_COUNT)
+    {
+        return RHSP_ERROR;
+    }
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    uint16_t resolvedID = internalHub->dekaPacketIDs[command];
+    if (resolvedID == RHSP_INTERFACE_INVALID_PACKET_ID)
+    {
+        int retval = rhsp_getInterfacePacketID(hub, "DEKA", rhsp_dekaCommands[command].functionNumber,
+                                               &resolvedID, nackReasonCode);
+        if (retval < 0)
+        {
+            return retval;
+        }
+        internalHub->dekaPacketIDs[command] = resolvedID;
+    }
+    if (packetID)
+    {
+        *packetID = resolvedID;
+    }
+    return RHSP_RESULT_OK;
+}
+
+void rhsp_clearDekaPacketIDs(RhspRevHub* hub)
+{
+    if (!hub)
+    {
+        return;
+    }
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    for (size_t i = 0; i < RHSP_DEKA_COMMAND_COUNT; i++)
+    {
+        internalHub->dekaPacketIDs[i] = RHSP_INTERFACE_INVALID_PACKET_ID;
+    }
+}
+
+static bool isRequestSizeValid(RhspDekaCommand command, uint16_t payloadSize)
+{
+    uint16_t requestSize = rhsp_dekaCommands[command].requestSize;
+    return requestSize == RHSP_DEKA_VARIABLE_SIZE || requestSize == payloadSize;
+}
+
+static int getResponse(RhspRevHub* hub, RhspDekaCommand command, const uint8_t** response)
+{
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    uint16_t packetSize = RHSP_PACKET_SIZE(internalHub->rxBuffer);
+    uint16_t minPacketSize = RHSP_PACKET_HEADER_SIZE + rhsp_dekaCommands[command].responseSize + RHSP_PACKET_CRC_SIZE;
+    if (packetSize < minPacketSize)
+    {
+        return RHSP_ERROR_UNEXPECTED_RESPONSE;
+    }
+    if (response)
+    {
+        *response = RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer);
+    }
+    return RHSP_RESULT_OK;
+}
+
+int rhsp_sendDekaWriteCommand(RhspRevHub* hub,
+                              RhspDekaCommand command,
+                              const uint8_t* payload,
+                              uint16_t payloadSize,
+                              uint8_t* nackReasonCode)
+{
+    uint16_t packetID;
+
+    if (!hub || command >= RHSP_DEKA_COMMAND_COUNT)
+    {
+        return RHSP_ERROR;
+    }
+    rhsp_assert(rhsp_dekaCommands[command].type == RHSP_DEKA_WRITE);
+    rhsp_assert(isRequestSizeValid(command, payloadSize));
+    if (!isRequestSizeValid(command, payloadSize))
+    {
+        return RHSP_ERROR;
+    }
+
+    int retval = rhsp_getDekaPacketID(hub, command, &packetID, nackReasonCode);
+    if (retval < 0)
+    {
+        return retval;
+    }
+    return rhsp_sendWriteCommandInternal(hub, packetID, payload, payloadSize, nackReasonCode);
+}
+
+int rhsp_sendDekaReadCommand(RhspRevHub* hub,
+                             RhspDekaCommand command,
+                             const uint8_t* payload,
+                             uint16_t payloadSize,
+                             const uint8_t** response,
+                             uint8_t* nackReasonCode)
+{
+    uint16_t packetID;
+
+    if (!hub || command >= RHSP_DEKA_COMMAND_COUNT)
+    {
+        return RHSP_ERROR;
+    }
+    rhsp_assert(rhsp_dekaCommands[command].type != RHSP_DEKA_WRITE);
+    rhsp_assert(isRequestSizeValid(command, payloadSize));
+    if (!isRequestSizeValid(command, payloadSize))
+    {
+        return RHSP_ERROR;
+    }
+
+    int retval = rhsp_getDekaPacketID(hub, command, &packetID, nackReasonCode);
+    if (retval < 0)
+    {
+        return retval;
+    }
+    if (rhsp_dekaCommands[command].type == RHSP_DEKA_READ_ONCE)
+    {
+        retval = rhsp_sendReadCommandOnceInternal(hub, packetID, payload, payloadSize, nackReasonCode);
+    } else
+    {
+        retval = rhsp_sendReadCommandInternal(hub, packetID, payload, payloadSize, nackReasonCode);
+    }
+    if (retval < 0)
+    {
+        return retval;
+    }
+    return getResponse(hub, command, response);
+}
+
+int rhsp_sendDekaCachedReadCommand(RhspRevHub* hub,
+                                   RhspCachedQuery query,
+                                   RhspDekaCommand command,
+                                   const uint8_t* payload,
+                                   uint16_t payloadSize,
+                                   const uint8_t** response,
+                                   uint8_t* nackReasonCode)
+{
+    uint16_t packetID;
+
+    if (!hub || command >= RHSP_DEKA_COMMAND_COUNT)
+    {
+        return RHSP_ERROR;
+    }
+    // only idempotent queries may be answered from the cache
+    rhsp_assert(rhsp_dekaCommands[command].type == RHSP_DEKA_READ);
+    rhsp_assert(isRequestSizeValid(command, payloadSize));
+    if (!isRequestSizeValid(command, payloadSize))
+    {
+        return RHSP_ERROR;
+    }
+
+    int retval = rhsp_getDekaPacketID(hub, command, &packetID, nackReasonCode);
+    if (retval < 0)
+    {
+        return retval;
+    }
+    retval = rhsp_sendCachedReadCommandInternal(hub, query, packetID, payload, payloadSize, nackReasonCode);
+    if (retval < 0)
+    {
+        return retval;
+    }
+    return getResponse(hub, command, response);
+}
+
+int rhsp_sendDekaPipelinedReadCommands(RhspRevHub* hub,
+                                       RhspDekaCommand command,
+                                       const uint8_t* payloads,
+                                       size_t commandCount,
+                                       RhspPipelinedResponseHandler onResponse,
+                                       void* context,
+                                       uint8_t* nackReasonCode)
+{
+    uint16_t packetID;
+
+    if (!hub || command >= RHSP_DEKA_COMMAND_COUNT)
+    {
+        return RHSP_ERROR;
+    }
+    const RhspDekaCommandDescriptor* descriptor = &rhsp_dekaCommands[command];
+    rhsp_assert(descriptor->type == RHSP_DEKA_READ);
+    rhsp_assert(descriptor->requestSize != RHSP_DEKA_VARIABLE_SIZE);
+    if (descriptor->type != RHSP_DEKA_READ || descriptor->requestSize == RHSP_DEKA_VARIABLE_SIZE)
+    {
+        return RHSP_ERROR;
+    }
+
+    int retval = rhsp_getDekaPacketID(hub, command, &packetID, nackReasonCode);
+    if (retval < 0)
+    {
+        return retval;
+    }
+    return rhsp_sendPipelinedReadCommandsInternal(hub, packetID, payloads, descriptor->requestSize, commandCount,
+                                                  onResponse, context, nackReasonCode);
+}
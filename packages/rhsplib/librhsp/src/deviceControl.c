@@ -5,6 +5,7 @@
  *  Authors: Andrey Mihadyuk, Eugene Shushkevich
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "rhsp/deviceControl.h"
@@ -12,62 +13,78 @@
 #include "internal/packet.h"
 #include "rhsp/compiler.h"
 #include "rhsp/module.h"
+#include "rhsp/time.h"
 #include "internal/command.h"
+#include "internal/dekaCommands.h"
+#include "internal/cache.h"
+#include "internal/encoder.h"
+#include "internal/frame.h"
 #include "internal/revhub.h"
 
-#define RHSP_NUMBER_OF_ADC_CHANNELS 15
-#define BULK_READ_FUNCTION_ID    0
+// wire layout of the bulk input response. Only byte arrays, so there is no padding and multi-byte fields are decoded
+// with the little-endian load helpers
+typedef struct {
+    uint8_t digitalInputs;
+    uint8_t motorPosition[4][4];
+    uint8_t motorStatus;
+    uint8_t motorVelocity[4][2];
+    uint8_t analog[4][2];
+    uint8_t attentionRequired;
+} RhspBulkInputPayload;
 
-static void fillBulkInputData(const RhspRevHub* hub, RhspBulkInputData* data);
+_Static_assert(sizeof(RhspBulkInputPayload) == 35, "bulk input payload layout");
 
-static void fillBulkInputData(const RhspRevHub* hub, RhspBulkInputData* data)
+static void fillBulkInputData(RhspRevHub* hub, RhspBulkInputData* response);
+
+static void fillBulkInputData(RhspRevHub* hub, RhspBulkInputData* response)
 {
-    if (!data)
-    {
-        return;
-    }
+    // the response is always decoded to keep the encoder history
+    RhspBulkInputData bulkInputData;
+    RhspBulkInputData* data = &bulkInputData;
+    RhspBulkInputPayload payload;
+    uint32_t timestampUs = rhsp_getSteadyClockUs();
 
     RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-    const uint8_t* payload = RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer);
-    data->digitalInputs = RHSP_ARRAY_BYTE(uint8_t, payload, 0);
+    memcpy(&payload, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), sizeof(payload));
+    data->digitalInputs = payload.digitalInputs;
+
+    data->motor0position_enc = rhsp_loadI32(payload.motorPosition[0]);
+    data->motor1position_enc = rhsp_loadI32(payload.motorPosition[1]);
+    data->motor2position_enc = rhsp_loadI32(payload.motorPosition[2]);
+    data->motor3position_enc = rhsp_loadI32(payload.motorPosition[3]);
 
-    data->motor0position_enc = RHSP_ARRAY_DWORD(int32_t, payload, 1);
-    data->motor1position_enc = RHSP_ARRAY_DWORD(int32_t, payload, 5);
-    data->motor2position_enc = RHSP_ARRAY_DWORD(int32_t, payload, 9);
-    data->motor3position_enc = RHSP_ARRAY_DWORD(int32_t, payload, 13);
+    data->motorStatus = payload.motorStatus;
 
-    data->motorStatus = RHSP_ARRAY_BYTE(uint8_t, payload, 17);
+    data->motor0velocity_cps = rhsp_loadI16(payload.motorVelocity[0]);
+    data->motor1velocity_cps = rhsp_loadI16(payload.motorVelocity[1]);
+    data->motor2velocity_cps = rhsp_loadI16(payload.motorVelocity[2]);
+    data->motor3velocity_cps = rhsp_loadI16(payload.motorVelocity[3]);
 
-    data->motor0velocity_cps = RHSP_ARRAY_WORD(int16_t, payload, 18);
-    data->motor0velocity_cps = RHSP_ARRAY_WORD(int16_t, payload, 20);
-    data->motor0velocity_cps = RHSP_ARRAY_WORD(int16_t, payload, 22);
-    data->motor0velocity_cps = RHSP_ARRAY_WORD(int16_t, payload, 24);
+    data->analog0_mV = rhsp_loadI16(payload.analog[0]);
+    data->analog1_mV = rhsp_loadI16(payload.analog[1]);
+    data->analog2_mV = rhsp_loadI16(payload.analog[2]);
+    data->analog3_mV = rhsp_loadI16(payload.analog[3]);
 
-    data->analog0_mV = RHSP_ARRAY_WORD(int16_t, payload, 26);
-    data->analog1_mV = RHSP_ARRAY_WORD(int16_t, payload, 28);
-    data->analog2_mV = RHSP_ARRAY_WORD(int16_t, payload, 30);
-    data->analog3_mV = RHSP_ARRAY_WORD(int16_t, payload, 32);
+    data->attentionRequired = payload.attentionRequired;
 
-    data->attentionRequired = RHSP_ARRAY_BYTE(uint8_t, payload, 34);
+    rhsp_recordEncoderSample(hub, data, timestampUs);
+    rhsp_publishBulkInputData(hub, data, timestampUs);
+    if (response)
+    {
+        *response = *data;
+    }
 }
 
 int rhsp_getBulkInputData(RhspRevHub* hub,
                           RhspBulkInputData* response,
                           uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
     }
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", BULK_READ_FUNCTION_ID, &packetID, nackReasonCode);
-    if (result < 0)
-    {
-        return result;
-    }
 
-    result = rhsp_sendReadCommandInternal(hub, packetID, NULL, 0, nackReasonCode);
+    int result = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_GET_BULK_INPUT_DATA, NULL, 0, NULL, nackReasonCode);
     if (result < 0)
     {
         return result;
@@ -78,12 +95,65 @@ int rhsp_getBulkInputData(RhspRevHub* hub,
     return RHSP_RESULT_OK;
 }
 
+typedef struct {
+    const RhspPortTransaction* transactions;
+    RhspHubBulkInputData* data;
+} MultiHubBulkInputContext;
+
+static void onHubBulkInputData(void* context, size_t transactionIndex)
+{
+    MultiHubBulkInputContext* multiHubContext = (MultiHubBulkInputContext*) context;
+    RhspHubBulkInputData* data = &multiHubContext->data[transactionIndex];
+    data->timestampUs = rhsp_getSteadyClockUs();
+    fillBulkInputData(multiHubContext->transactions[transactionIndex].hub, &data->data);
+}
+
+int rhsp_getBulkInputDataFromHubs(RhspRevHub* const* hubs,
+                                  size_t hubCount,
+                                  RhspHubBulkInputData* data)
+{
+    if (!hubs || hubCount == 0 || !data)
+    {
+        return RHSP_ERROR;
+    }
+    RhspPortTransaction* transactions = calloc(hubCount, sizeof(RhspPortTransaction));
+    if (!transactions)
+    {
+        return RHSP_ERROR;
+    }
+
+    // a module whose packet ID cannot be resolved fails on its own
+    for (size_t i = 0; i < hubCount; i++)
+    {
+        memset(&data[i], 0, sizeof(data[i]));
+        transactions[i].hub = hubs[i];
+        transactions[i].result = hubs[i] ? rhsp_getDekaPacketID(hubs[i], RHSP_DEKA_GET_BULK_INPUT_DATA,
+                                                                &transactions[i].packetTypeID,
+                                                                &transactions[i].nackReasonCode)
+                                         : RHSP_ERROR;
+    }
+
+    MultiHubBulkInputContext context = {transactions, data};
+    int retval = rhsp_runPortTransactionsInternal(transactions, hubCount, onHubBulkInputData, &context);
+    for (size_t i = 0; i < hubCount; i++)
+    {
+        data[i].resultCode = (retval < 0) ? retval : transactions[i].result;
+        data[i].nackReasonCode = transactions[i].nackReasonCode;
+        if (retval >= 0 && data[i].resultCode < 0)
+        {
+            retval = data[i].resultCode;
+        }
+    }
+
+    free(transactions);
+    return retval;
+}
+
 int rhsp_setBulkOutputData(RhspRevHub* hub,
                            const RhspBulkOutputData* bulkOutputData,
                            RhspBulkInputData* bulkInputDataResponse,
                            uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
     uint16_t packetIDBulkRead;
 
     if (!hub || !bulkOutputData)
@@ -91,14 +161,8 @@ int rhsp_setBulkOutputData(RhspRevHub* hub,
         return RHSP_ERROR;
     }
 
-    // check whether we support bulk read/write and get packetID of course
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 56, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
-    retval = rhsp_getInterfacePacketID(hub, "DEKA", BULK_READ_FUNCTION_ID, &packetIDBulkRead, nackReasonCode);
+    // the module answers bulk write with bulk read data, so the bulk read packet ID is needed to check the response
+    int retval = rhsp_getDekaPacketID(hub, RHSP_DEKA_GET_BULK_INPUT_DATA, &packetIDBulkRead, nackReasonCode);
     if (retval < 0)
     {
         return retval;
@@ -111,21 +175,24 @@ int rhsp_setBulkOutputData(RhspRevHub* hub,
     RHSP_ARRAY_SET_BYTE(buffer, 3, bulkOutputData->motorMode0_1);
     RHSP_ARRAY_SET_BYTE(buffer, 4, bulkOutputData->motorMode2_3);
 
-    RHSP_ARRAY_SET_DWORD(buffer, 5, bulkOutputData->motor0Target);
-    RHSP_ARRAY_SET_DWORD(buffer, 9, bulkOutputData->motor1Target);
-    RHSP_ARRAY_SET_DWORD(buffer, 13, bulkOutputData->motor2Target);
-    RHSP_ARRAY_SET_DWORD(buffer, 17, bulkOutputData->motor3Target);
+    rhsp_storeU32(buffer + 5, bulkOutputData->motor0Target);
+    rhsp_storeU32(buffer + 9, bulkOutputData->motor1Target);
+    rhsp_storeU32(buffer + 13, bulkOutputData->motor2Target);
+    rhsp_storeU32(buffer + 17, bulkOutputData->motor3Target);
 
     RHSP_ARRAY_SET_BYTE(buffer, 21, bulkOutputData->servoEnable);
 
-    RHSP_ARRAY_SET_WORD(buffer, 22, bulkOutputData->servo0Command);
-    RHSP_ARRAY_SET_WORD(buffer, 24, bulkOutputData->servo1Command);
-    RHSP_ARRAY_SET_WORD(buffer, 26, bulkOutputData->servo2Command);
-    RHSP_ARRAY_SET_WORD(buffer, 28, bulkOutputData->servo3Command);
-    RHSP_ARRAY_SET_WORD(buffer, 30, bulkOutputData->servo4Command);
-    RHSP_ARRAY_SET_WORD(buffer, 32, bulkOutputData->servo5Command);
-
-    retval = rhsp_sendWriteCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    rhsp_storeU16(buffer + 22, bulkOutputData->servo0Command);
+    rhsp_storeU16(buffer + 24, bulkOutputData->servo1Command);
+    rhsp_storeU16(buffer + 26, bulkOutputData->servo2Command);
+    rhsp_storeU16(buffer + 28, bulkOutputData->servo3Command);
+    rhsp_storeU16(buffer + 30, bulkOutputData->servo4Command);
+    rhsp_storeU16(buffer + 32, bulkOutputData->servo5Command);
+
+    // the packet also sets the digital directions and the motor modes
+    rhsp_invalidateCachedQuery(hub, RHSP_CACHED_QUERY_DIO_DIRECTION);
+    rhsp_invalidateCachedQuery(hub, RHSP_CACHED_QUERY_MOTOR_CHANNEL_MODE);
+    retval = rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_SET_BULK_OUTPUT_DATA, buffer, sizeof(buffer), nackReasonCode);
     // RHSP_ERROR_UNEXPECTED_RESPONSE means that we received nor ack or nack. Then we should check for bulk read packet
     if (retval < 0 && retval != RHSP_ERROR_UNEXPECTED_RESPONSE)
     {
@@ -138,6 +205,8 @@ int rhsp_setBulkOutputData(RhspRevHub* hub,
         return RHSP_ERROR_UNEXPECTED_RESPONSE;
     }
 
+    rhsp_frameSetBulkOutputData(hub, bulkOutputData);
+
     // fill out bulk read data
     fillBulkInputData(hub, bulkInputDataResponse);
 
@@ -150,7 +219,7 @@ int rhsp_getADC(RhspRevHub* hub,
                 int16_t* adcValue,
                 uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -163,32 +232,87 @@ int rhsp_getADC(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
     }
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 7, &packetID, nackReasonCode);
-    if (result < 0)
-    {
-        return result;
-    }
 
     uint8_t buffer[2] = {adcChannelToRead, rawMode};
-    int retval = rhsp_sendReadCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    int retval = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_GET_ADC, buffer, sizeof(buffer), &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
     }
+    int16_t value = rhsp_loadI16(response);
+    if (rawMode == 0)
+    {
+        rhsp_publishAdcValue(hub, adcChannelToRead, value, rhsp_getSteadyClockUs());
+    }
     if (adcValue)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *adcValue = RHSP_ARRAY_WORD(int16_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *adcValue = value;
     }
     return RHSP_RESULT_OK;
 
 }
 
+static void onAdcResponse(void* context, size_t commandIndex, const uint8_t* responsePayload)
+{
+    int16_t* adcValues = (int16_t*) context;
+    adcValues[commandIndex] = rhsp_loadI16(responsePayload);
+}
+
+int rhsp_getADCSweep(RhspRevHub* hub,
+                     const uint8_t* adcChannels,
+                     uint8_t channelCount,
+                     uint8_t rawMode,
+                     int16_t* adcValues,
+                     uint32_t* timestampMs,
+                     uint8_t* nackReasonCode)
+{
+    if (!hub || !adcChannels || !adcValues)
+    {
+        return RHSP_ERROR;
+    }
+    if (channelCount == 0 || channelCount > RHSP_NUMBER_OF_ADC_CHANNELS)
+    {
+        return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
+    } else if (rawMode > 1)
+    {
+        return RHSP_ERROR_ARG_3_OUT_OF_RANGE;
+    }
+    uint8_t payloads[RHSP_NUMBER_OF_ADC_CHANNELS][2];
+    for (uint8_t i = 0; i < channelCount; i++)
+    {
+        if (adcChannels[i] >= RHSP_NUMBER_OF_ADC_CHANNELS)
+        {
+            return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
+        }
+        payloads[i][0] = adcChannels[i];
+        payloads[i][1] = rawMode;
+    }
+
+    int retval = rhsp_sendDekaPipelinedReadCommands(hub, RHSP_DEKA_GET_ADC, &payloads[0][0], channelCount,
+                                                    onAdcResponse, adcValues, nackReasonCode);
+    if (retval < 0)
+    {
+        return retval;
+    }
+    if (rawMode == 0)
+    {
+        uint32_t timestampUs = rhsp_getSteadyClockUs();
+        for (uint8_t i = 0; i < channelCount; i++)
+        {
+            rhsp_publishAdcValue(hub, adcChannels[i], adcValues[i], timestampUs);
+        }
+    }
+    if (timestampMs)
+    {
+        *timestampMs = rhsp_getSteadyClockMs();
+    }
+    return RHSP_RESULT_OK;
+}
+
 int rhsp_phoneChargeControl(RhspRevHub* hub,
                             uint8_t chargeEnable,
                             uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
     if (!hub)
     {
         return RHSP_ERROR;
@@ -197,32 +321,22 @@ int rhsp_phoneChargeControl(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 44, &packetID, nackReasonCode);
-    if (result < 0)
-    {
-        return result;
-    }
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, &chargeEnable, sizeof(chargeEnable), nackReasonCode);
+    return rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_PHONE_CHARGE_CONTROL,
+                                     &chargeEnable, sizeof(chargeEnable), nackReasonCode);
 }
 
 int rhsp_phoneChargeQuery(RhspRevHub* hub,
                           uint8_t* chargeEnabled,
                           uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
     if (!hub)
     {
         return RHSP_ERROR;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 45, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
-    retval = rhsp_sendReadCommandInternal(hub, packetID, NULL, 0, nackReasonCode);
+    int retval = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_PHONE_CHARGE_QUERY, NULL, 0, &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
@@ -230,8 +344,7 @@ int rhsp_phoneChargeQuery(RhspRevHub* hub,
 
     if (chargeEnabled)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *chargeEnabled = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *chargeEnabled = RHSP_ARRAY_BYTE(uint8_t, response, 0);
     }
     return RHSP_RESULT_OK;
 }
@@ -240,8 +353,6 @@ int rhsp_injectDataLogHint(RhspRevHub* hub,
                            const char* hintText,
                            uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub || !hintText)
     {
         return RHSP_ERROR;
@@ -253,39 +364,28 @@ int rhsp_injectDataLogHint(RhspRevHub* hub,
         length = RHSP_INJECT_DATA_LOG_MAX_HINT_TEXT_LENGTH;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 46, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
     uint8_t buffer[1 + RHSP_INJECT_DATA_LOG_MAX_HINT_TEXT_LENGTH];
 
     buffer[0] = length;
     memcpy(&buffer[1], hintText, length);
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    return rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_INJECT_DATA_LOG_HINT, buffer, sizeof(buffer), nackReasonCode);
 }
 
 int rhsp_readVersion(RhspRevHub* hub, RhspVersion* version, uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
     if (!hub)
     {
         return RHSP_ERROR;
     }
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 57, &packetID, nackReasonCode);
+    int retval = rhsp_getDekaPacketID(hub, RHSP_DEKA_READ_VERSION, NULL, nackReasonCode);
     if (retval < 0)
     {
         // ReadVersion not supported, use ReadVersionString logic
 #define VERSION_FORMATTED_LENGTH    40 //buffer size for formatted version string including null terminated symbol
-        retval = rhsp_getInterfacePacketID(hub, "DEKA", 48, &packetID, nackReasonCode);
-        if (retval < 0)
-        {
-            return retval;
-        }
-
-        retval = rhsp_sendReadCommandInternal(hub, packetID, NULL, 0, nackReasonCode);
+        retval = rhsp_sendDekaCachedReadCommand(hub, RHSP_CACHED_QUERY_VERSION, RHSP_DEKA_READ_VERSION_STRING,
+                                                NULL, 0, &response, nackReasonCode);
         if (retval < 0)
         {
             return retval;
@@ -295,14 +395,12 @@ int rhsp_readVersion(RhspRevHub* hub, RhspVersion* version, uint8_t* nackReasonC
         char fw_version_formatted[VERSION_FORMATTED_LENGTH];
         uint8_t length;
 
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        length = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        length = RHSP_ARRAY_BYTE(uint8_t, response, 0);
         if (length > VERSION_FORMATTED_LENGTH - 1)
         {
             length = VERSION_FORMATTED_LENGTH - 1;
         }
-        memcpy(fw_version_formatted, RHSP_ARRAY_BYTE_PTR(uint8_t*, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 1),
-               length);
+        memcpy(fw_version_formatted, RHSP_ARRAY_BYTE_PTR(uint8_t*, response, 1), length);
         fw_version_formatted[length] = '\0';
 
         // extract major, minor and eng numbers from string "HW: 20, Maj: 1, Min: 8, Eng: 2"
@@ -368,7 +466,8 @@ int rhsp_readVersion(RhspRevHub* hub, RhspVersion* version, uint8_t* nackReasonC
         return RHSP_RESULT_OK;
     }
 
-    retval = rhsp_sendReadCommandInternal(hub, packetID, NULL, 0, nackReasonCode);
+    retval = rhsp_sendDekaCachedReadCommand(hub, RHSP_CACHED_QUERY_VERSION, RHSP_DEKA_READ_VERSION,
+                                            NULL, 0, &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
@@ -376,13 +475,12 @@ int rhsp_readVersion(RhspRevHub* hub, RhspVersion* version, uint8_t* nackReasonC
 
     if (version)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        version->engineeringRevision = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
-        version->minorVersion = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 1);
-        version->majorVersion = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 2);
-        version->minorHwRevision = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 3);
-        version->majorHwRevision = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 4);
-        version->hwType = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 5);
+        version->engineeringRevision = RHSP_ARRAY_BYTE(uint8_t, response, 0);
+        version->minorVersion = RHSP_ARRAY_BYTE(uint8_t, response, 1);
+        version->majorVersion = RHSP_ARRAY_BYTE(uint8_t, response, 2);
+        version->minorHwRevision = RHSP_ARRAY_BYTE(uint8_t, response, 3);
+        version->majorHwRevision = RHSP_ARRAY_BYTE(uint8_t, response, 4);
+        version->hwType = rhsp_loadU32(response + 5);
     }
     return RHSP_RESULT_OK;
 }
@@ -421,7 +519,6 @@ int rhsp_ftdiResetControl(RhspRevHub* hub,
                           uint8_t ftdiResetControl,
                           uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
     if (!hub)
     {
         return RHSP_ERROR;
@@ -430,31 +527,22 @@ int rhsp_ftdiResetControl(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 49, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, &ftdiResetControl, sizeof(ftdiResetControl), nackReasonCode);
+    return rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_FTDI_RESET_CONTROL,
+                                     &ftdiResetControl, sizeof(ftdiResetControl), nackReasonCode);
 }
 
 int rhsp_ftdiResetQuery(RhspRevHub* hub,
                         uint8_t* ftdiResetControl,
                         uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
     if (!hub)
     {
         return RHSP_ERROR;
     }
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 50, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
 
-    retval = rhsp_sendReadCommandInternal(hub, packetID, NULL, 0, nackReasonCode);
+    int retval = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_FTDI_RESET_QUERY, NULL, 0, &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
@@ -462,8 +550,7 @@ int rhsp_ftdiResetQuery(RhspRevHub* hub,
 
     if (ftdiResetControl)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *ftdiResetControl = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *ftdiResetControl = RHSP_ARRAY_BYTE(uint8_t, response, 0);
     }
 
     return RHSP_RESULT_OK;
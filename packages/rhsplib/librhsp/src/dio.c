@@ -8,6 +8,9 @@
 #include "internal/arrayutils.h"
 #include "rhsp/module.h"
 #include "internal/command.h"
+#include "internal/dekaCommands.h"
+#include "internal/cache.h"
+#include "internal/frame.h"
 #include "internal/packet.h"
 #include "internal/revhub.h"
 
@@ -18,7 +21,6 @@ int rhsp_setSingleOutput(RhspRevHub* hub,
                          uint8_t value,
                          uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
     if (!hub)
     {
         return RHSP_ERROR;
@@ -31,33 +33,42 @@ int rhsp_setSingleOutput(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
     }
-
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 1, &packetID, nackReasonCode);
-    if (retval < 0)
+    if (rhsp_isOutputFrameOpen(hub))
     {
-        return retval;
+        rhsp_frameSetSingleOutput(hub, dioPin, value, true);
+        return RHSP_RESULT_OK;
     }
 
     uint8_t buffer[2] = {dioPin, value};
-    return rhsp_sendWriteCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    int retval = rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_SET_SINGLE_OUTPUT, buffer, sizeof(buffer), nackReasonCode);
+    if (retval >= 0)
+    {
+        rhsp_frameSetSingleOutput(hub, dioPin, value, false);
+    }
+    return retval;
 }
 
 int rhsp_setAllOutputs(RhspRevHub* hub,
                        uint8_t bitPacketField,
                        uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
     if (!hub)
     {
         return RHSP_ERROR;
     }
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 2, &packetID, nackReasonCode);
-    if (retval < 0)
+    if (rhsp_isOutputFrameOpen(hub))
     {
-        return retval;
+        rhsp_frameSetAllOutputs(hub, bitPacketField, true);
+        return RHSP_RESULT_OK;
     }
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, &bitPacketField, sizeof(bitPacketField), nackReasonCode);
+    int retval = rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_SET_ALL_OUTPUTS,
+                                           &bitPacketField, sizeof(bitPacketField), nackReasonCode);
+    if (retval >= 0)
+    {
+        rhsp_frameSetAllOutputs(hub, bitPacketField, false);
+    }
+    return retval;
 }
 
 int rhsp_setDirection(RhspRevHub* hub,
@@ -65,7 +76,6 @@ int rhsp_setDirection(RhspRevHub* hub,
                       uint8_t directionOutput,
                       uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
     if (!hub)
     {
         return RHSP_ERROR;
@@ -78,14 +88,20 @@ int rhsp_setDirection(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
     }
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 3, &packetID, nackReasonCode);
-    if (retval < 0)
+    if (rhsp_isOutputFrameOpen(hub))
     {
-        return retval;
+        rhsp_frameSetDirection(hub, dioPin, directionOutput, true);
+        return RHSP_RESULT_OK;
     }
 
     uint8_t buffer[2] = {dioPin, directionOutput};
-    return rhsp_sendWriteCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    rhsp_invalidateCachedQuery(hub, RHSP_CACHED_QUERY_DIO_DIRECTION);
+    int retval = rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_SET_DIRECTION, buffer, sizeof(buffer), nackReasonCode);
+    if (retval >= 0)
+    {
+        rhsp_frameSetDirection(hub, dioPin, directionOutput, false);
+    }
+    return retval;
 }
 
 int rhsp_getDirection(RhspRevHub* hub,
@@ -93,7 +109,7 @@ int rhsp_getDirection(RhspRevHub* hub,
                       uint8_t* directionOutput,
                       uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -105,21 +121,15 @@ int rhsp_getDirection(RhspRevHub* hub,
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 4, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
-    retval = rhsp_sendReadCommandInternal(hub, packetID, &dioPin, sizeof(dioPin), nackReasonCode);
+    int retval = rhsp_sendDekaCachedReadCommand(hub, RHSP_CACHED_QUERY_DIO_DIRECTION, RHSP_DEKA_GET_DIRECTION,
+                                                &dioPin, sizeof(dioPin), &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
     }
     if (directionOutput)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *directionOutput = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *directionOutput = RHSP_ARRAY_BYTE(uint8_t, response, 0);
     }
     return RHSP_RESULT_OK;
 }
@@ -129,7 +139,7 @@ int rhsp_getSingleInput(RhspRevHub* hub,
                         uint8_t* inputValue,
                         uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -139,21 +149,16 @@ int rhsp_getSingleInput(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 5, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
 
-    retval = rhsp_sendReadCommandInternal(hub, packetID, &dioPin, sizeof(dioPin), nackReasonCode);
+    int retval = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_GET_SINGLE_INPUT,
+                                          &dioPin, sizeof(dioPin), &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
     }
     if (inputValue)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *inputValue = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *inputValue = RHSP_ARRAY_BYTE(uint8_t, response, 0);
     }
     return RHSP_RESULT_OK;
 }
@@ -162,27 +167,21 @@ int rhsp_getAllInputs(RhspRevHub* hub,
                       uint8_t* bitPacketField,
                       uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
         return RHSP_ERROR;
     }
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 6, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
 
-    retval = rhsp_sendReadCommandInternal(hub, packetID, NULL, 0, nackReasonCode);
+    int retval = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_GET_ALL_INPUTS, NULL, 0, &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
     }
     if (bitPacketField)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *bitPacketField = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *bitPacketField = RHSP_ARRAY_BYTE(uint8_t, response, 0);
     }
     return RHSP_RESULT_OK;
 }
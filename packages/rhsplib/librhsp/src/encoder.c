@@ -0,0 +1,170 @@
+/*
+ * encoder.c
+ *
+ * Encoder history and alpha-beta-gamma estimation of velocity and acceleration.
+ */
+#include <string.h>
+
+#include "rhsp/encoder.h"
+#include "rhsp/errors.h"
+#include "internal/encoder.h"
+#include "internal/revhub.h"
+
+#define ENCODER_DEFAULT_ALPHA       0.5
+#define ENCODER_DEFAULT_BETA        0.2
+#define ENCODER_DEFAULT_GAMMA       0.02
+// samples further apart than this are not filtered together
+#define ENCODER_MAX_FILTER_GAP_US   500000UL
+
+static const RhspEncoderSample* newestSample(const RhspEncoderHistory* history)
+{
+    if (history->count == 0)
+    {
+        return NULL;
+    }
+    return &history->samples[(history->head + RHSP_ENCODER_HISTORY_SIZE - 1) % RHSP_ENCODER_HISTORY_SIZE];
+}
+
+void rhsp_initEncoderHistory(RhspRevHub* hub)
+{
+    if (!hub)
+    {
+        return;
+    }
+    RhspEncoderHistory* history = &((RhspRevHubInternal*) hub)->encoderHistory;
+    memset(history, 0, sizeof(*history));
+    history->alpha = ENCODER_DEFAULT_ALPHA;
+    history->beta = ENCODER_DEFAULT_BETA;
+    history->gamma = ENCODER_DEFAULT_GAMMA;
+}
+
+void rhsp_recordEncoderSample(RhspRevHub* hub, const RhspBulkInputData* data, uint32_t timestampUs)
+{
+    if (!hub || !data)
+    {
+        return;
+    }
+    RhspEncoderHistory* history = &((RhspRevHubInternal*) hub)->encoderHistory;
+
+    RhspEncoderSample sample;
+    sample.timestampUs = timestampUs;
+    sample.position[0] = data->motor0position_enc;
+    sample.position[1] = data->motor1position_enc;
+    sample.position[2] = data->motor2position_enc;
+    sample.position[3] = data->motor3position_enc;
+    sample.velocity[0] = data->motor0velocity_cps;
+    sample.velocity[1] = data->motor1velocity_cps;
+    sample.velocity[2] = data->motor2velocity_cps;
+    sample.velocity[3] = data->motor3velocity_cps;
+
+    uint32_t dtUs = timestampUs - history->lastTimestampUs;
+    bool canFilter = history->count > 0 && dtUs > 0 && dtUs <= ENCODER_MAX_FILTER_GAP_US;
+    double dt = dtUs / 1e6;
+    history->lastTimestampUs = timestampUs;
+
+    for (int i = 0; i < RHSP_ENCODER_NUMBER_OF_MOTORS; i++)
+    {
+        if (!canFilter || !(history->filterValid & (1 << i)))
+        {
+            // start from the module's own velocity estimate
+            history->position[i] = sample.position[i];
+            history->velocity[i] = sample.velocity[i];
+            history->acceleration[i] = 0;
+            history->filterValid |= (uint8_t) (1 << i);
+        } else
+        {
+            double predictedPosition = history->position[i] + history->velocity[i] * dt +
+                                       history->acceleration[i] * dt * dt / 2;
+            double predictedVelocity = history->velocity[i] + history->acceleration[i] * dt;
+            double residual = sample.position[i] - predictedPosition;
+
+            history->position[i] = predictedPosition + history->alpha * residual;
+            history->velocity[i] = predictedVelocity + history->beta * residual / dt;
+            history->acceleration[i] += 2 * history->gamma * residual / (dt * dt);
+        }
+        sample.filteredVelocity[i] = history->velocity[i];
+        sample.filteredAcceleration[i] = history->acceleration[i];
+    }
+
+    history->samples[history->head] = sample;
+    history->head = (history->head + 1) % RHSP_ENCODER_HISTORY_SIZE;
+    if (history->count < RHSP_ENCODER_HISTORY_SIZE)
+    {
+        history->count++;
+    }
+}
+
+void rhsp_restartEncoderFilter(RhspRevHub* hub, uint8_t motorChannel)
+{
+    if (!hub || motorChannel >= RHSP_ENCODER_NUMBER_OF_MOTORS)
+    {
+        return;
+    }
+    RhspEncoderHistory* history = &((RhspRevHubInternal*) hub)->encoderHistory;
+    history->filterValid &= (uint8_t) ~(1 << motorChannel);
+}
+
+size_t rhsp_getEncoderHistory(const RhspRevHub* hub, RhspEncoderSample* samples, size_t maxSamples)
+{
+    if (!hub || !samples)
+    {
+        return 0;
+    }
+    const RhspEncoderHistory* history = &((const RhspRevHubInternal*) hub)->encoderHistory;
+    size_t count = (history->count < maxSamples) ? history->count : maxSamples;
+    for (size_t i = 0; i < count; i++)
+    {
+        samples[i] = history->samples[(history->head + RHSP_ENCODER_HISTORY_SIZE - 1 - i) % RHSP_ENCODER_HISTORY_SIZE];
+    }
+    return count;
+}
+
+int rhsp_getLatestEncoderSample(const RhspRevHub* hub, RhspEncoderSample* sample)
+{
+    if (!hub || !sample)
+    {
+        return RHSP_ERROR;
+    }
+    const RhspEncoderSample* newest = newestSample(&((const RhspRevHubInternal*) hub)->encoderHistory);
+    if (!newest)
+    {
+        return RHSP_ERROR;
+    }
+    *sample = *newest;
+    return RHSP_RESULT_OK;
+}
+
+int rhsp_setEncoderFilterGains(RhspRevHub* hub, double alpha, double beta, double gamma)
+{
+    if (!hub)
+    {
+        return RHSP_ERROR;
+    }
+    if (!(alpha > 0 && alpha <= 1))
+    {
+        return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
+    } else if (!(beta > 0 && beta <= 2))
+    {
+        return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
+    } else if (!(gamma >= 0 && gamma <= 1))
+    {
+        return RHSP_ERROR_ARG_3_OUT_OF_RANGE;
+    }
+    RhspEncoderHistory* history = &((RhspRevHubInternal*) hub)->encoderHistory;
+    history->alpha = alpha;
+    history->beta = beta;
+    history->gamma = gamma;
+    return RHSP_RESULT_OK;
+}
+
+void rhsp_clearEncoderHistory(RhspRevHub* hub)
+{
+    if (!hub)
+    {
+        return;
+    }
+    RhspEncoderHistory* history = &((RhspRevHubInternal*) hub)->encoderHistory;
+    history->head = 0;
+    history->count = 0;
+    history->filterValid = 0;
+}
@@ -0,0 +1,439 @@
+/*
+ * frame.c
+ *
+ * Coalescing of actuator setters into one bulk output transaction per control tick.
+ */
+#include "rhsp/frame.h"
+#include "rhsp/dio.h"
+#include "rhsp/errors.h"
+#include "rhsp/module.h"
+#include "rhsp/motor.h"
+#include "rhsp/servo.h"
+#include "internal/frame.h"
+#include "internal/revhub.h"
+
+#define ALL_GPIO_MASK       ((uint8_t) ((1u << RHSP_FRAME_NUMBER_OF_GPIO) - 1))
+#define ALL_MOTORS_MASK     ((uint8_t) ((1u << RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS) - 1))
+#define ALL_SERVOS_MASK     ((uint8_t) ((1u << RHSP_FRAME_NUMBER_OF_SERVO_CHANNELS) - 1))
+
+static RhspOutputFrame* getFrame(RhspRevHub* hub)
+{
+    return &((RhspRevHubInternal*) hub)->outputFrame;
+}
+
+static void updateMask(RhspFrameMask* mask, uint8_t bits, bool deferred)
+{
+    if (deferred)
+    {
+        mask->dirty |= bits;
+    } else
+    {
+        mask->known |= bits;
+        mask->dirty &= (uint8_t) ~bits;
+    }
+}
+
+static void setBit(uint8_t* field, uint8_t bit, uint8_t value)
+{
+    if (value)
+    {
+        *field |= bit;
+    } else
+    {
+        *field &= (uint8_t) ~bit;
+    }
+}
+
+void rhsp_frameSetSingleOutput(RhspRevHub* hub, uint8_t dioPin, uint8_t value, bool deferred)
+{
+    RhspOutputFrame* frame = getFrame(hub);
+    setBit(&frame->digitalOutputs, (uint8_t) (1 << dioPin), value);
+    updateMask(&frame->digitalOutputsMask, (uint8_t) (1 << dioPin), deferred);
+}
+
+void rhsp_frameSetAllOutputs(RhspRevHub* hub, uint8_t bitPackedField, bool deferred)
+{
+    RhspOutputFrame* frame = getFrame(hub);
+    frame->digitalOutputs = bitPackedField;
+    updateMask(&frame->digitalOutputsMask, ALL_GPIO_MASK, deferred);
+}
+
+void rhsp_frameSetDirection(RhspRevHub* hub, uint8_t dioPin, uint8_t directionOutput, bool deferred)
+{
+    RhspOutputFrame* frame = getFrame(hub);
+    setBit(&frame->digitalDirections, (uint8_t) (1 << dioPin), directionOutput);
+    updateMask(&frame->digitalDirectionsMask, (uint8_t) (1 << dioPin), deferred);
+}
+
+void rhsp_frameSetMotorChannelMode(RhspRevHub* hub, uint8_t motorChannel, uint8_t motorMode,
+                                   uint8_t floatAtZero, bool deferred)
+{
+    RhspOutputFrame* frame = getFrame(hub);
+    frame->motorMode[motorChannel] = motorMode;
+    frame->motorFloatAtZero[motorChannel] = floatAtZero;
+    updateMask(&frame->motorModeMask, (uint8_t) (1 << motorChannel), deferred);
+}
+
+void rhsp_frameSetMotorChannelEnable(RhspRevHub* hub, uint8_t motorChannel, uint8_t enabled, bool deferred)
+{
+    RhspOutputFrame* frame = getFrame(hub);
+    setBit(&frame->motorEnable, (uint8_t) (1 << motorChannel), enabled);
+    updateMask(&frame->motorEnableMask, (uint8_t) (1 << motorChannel), deferred);
+}
+
+void rhsp_frameSetMotorConstantPower(RhspRevHub* hub, uint8_t motorChannel, double powerLevel,
+                                     int16_t rawPowerLevel, bool deferred)
+{
+    RhspOutputFrame* frame = getFrame(hub);
+    frame->motorPower[motorChannel] = powerLevel;
+    frame->motorRawPower[motorChannel] = rawPowerLevel;
+    updateMask(&frame->motorPowerMask, (uint8_t) (1 << motorChannel), deferred);
+}
+
+void rhsp_frameSetMotorTargetVelocity(RhspRevHub* hub, uint8_t motorChannel, int16_t velocity, bool deferred)
+{
+    RhspOutputFrame* frame = getFrame(hub);
+    frame->motorVelocity[motorChannel] = velocity;
+    updateMask(&frame->motorVelocityMask, (uint8_t) (1 << motorChannel), deferred);
+}
+
+void rhsp_frameSetMotorTargetPosition(RhspRevHub* hub, uint8_t motorChannel, int32_t targetPosition,
+                                      uint16_t targetTolerance, bool deferred)
+{
+    RhspOutputFrame* frame = getFrame(hub);
+    uint8_t bit = (uint8_t) (1 << motorChannel);
+
+    // the bulk output command has no tolerance field, so a new tolerance has to go by the individual command
+    bool toleranceChanged = !(frame->motorPositionMask.known & bit) ||
+                            frame->motorTolerance[motorChannel] != targetTolerance;
+    setBit(&frame->motorToleranceChanged, bit, deferred && toleranceChanged);
+
+    frame->motorPosition[motorChannel] = targetPosition;
+    frame->motorTolerance[motorChannel] = targetTolerance;
+    updateMask(&frame->motorPositionMask, bit, deferred);
+}
+
+void rhsp_frameSetServoPulseWidth(RhspRevHub* hub, uint8_t servoChannel, uint16_t pulseWidth, bool deferred)
+{
+    RhspOutputFrame* frame = getFrame(hub);
+    frame->servoPulseWidth[servoChannel] = pulseWidth;
+    updateMask(&frame->servoPulseWidthMask, (uint8_t) (1 << servoChannel), deferred);
+}
+
+void rhsp_frameSetServoEnable(RhspRevHub* hub, uint8_t servoChannel, uint8_t enable, bool deferred)
+{
+    RhspOutputFrame* frame = getFrame(hub);
+    setBit(&frame->servoEnable, (uint8_t) (1 << servoChannel), enable);
+    updateMask(&frame->servoEnableMask, (uint8_t) (1 << servoChannel), deferred);
+}
+
+void rhsp_forgetOutputState(RhspRevHub* hub)
+{
+    if (!hub)
+    {
+        return;
+    }
+    RhspOutputFrame* frame = getFrame(hub);
+    frame->digitalOutputsMask.known = 0;
+    frame->digitalDirectionsMask.known = 0;
+    frame->motorModeMask.known = 0;
+    frame->motorEnableMask.known = 0;
+    frame->motorPowerMask.known = 0;
+    frame->motorVelocityMask.known = 0;
+    frame->motorPositionMask.known = 0;
+    frame->servoEnableMask.known = 0;
+    frame->servoPulseWidthMask.known = 0;
+}
+
+static bool isComplete(const RhspFrameMask* mask, uint8_t allChannels)
+{
+    return ((mask->known | mask->dirty) & allChannels) == allChannels;
+}
+
+static uint8_t motorTargetMask(const RhspOutputFrame* frame, uint8_t motorChannel)
+{
+    switch (frame->motorMode[motorChannel])
+    {
+        case MOTOR_MODE_REGULATED_VELOCITY:
+            return frame->motorVelocityMask.known | frame->motorVelocityMask.dirty;
+        case MOTOR_MODE_REGULATED_POSITION:
+            return frame->motorPositionMask.known | frame->motorPositionMask.dirty;
+        default:
+            return frame->motorPowerMask.known | frame->motorPowerMask.dirty;
+    }
+}
+
+static int32_t motorTarget(const RhspOutputFrame* frame, uint8_t motorChannel)
+{
+    switch (frame->motorMode[motorChannel])
+    {
+        case MOTOR_MODE_REGULATED_VELOCITY:
+            return frame->motorVelocity[motorChannel];
+        case MOTOR_MODE_REGULATED_POSITION:
+            return frame->motorPosition[motorChannel];
+        default:
+            return frame->motorRawPower[motorChannel];
+    }
+}
+
+/*
+ * Bulk output carries one target per motor, interpreted according to the motor mode, and overwrites every output.
+ * So it can only be used when the whole output state is known and every deferred value fits into it.
+ */
+static bool canUseBulkOutput(const RhspOutputFrame* frame)
+{
+    if (!isComplete(&frame->digitalOutputsMask, ALL_GPIO_MASK) ||
+        !isComplete(&frame->digitalDirectionsMask, ALL_GPIO_MASK) ||
+        !isComplete(&frame->motorEnableMask, ALL_MOTORS_MASK) ||
+        !isComplete(&frame->servoEnableMask, ALL_SERVOS_MASK) ||
+        !isComplete(&frame->servoPulseWidthMask, ALL_SERVOS_MASK))
+    {
+        return false;
+    }
+    // mode changes are subject to firmware checks of the individual command
+    if ((frame->motorModeMask.known & ALL_MOTORS_MASK) != ALL_MOTORS_MASK || frame->motorModeMask.dirty)
+    {
+        return false;
+    }
+    if (frame->motorToleranceChanged)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS; i++)
+    {
+        uint8_t bit = (uint8_t) (1 << i);
+        if (!(motorTargetMask(frame, i) & bit))
+        {
+            return false;
+        }
+        // targets of other modes are not carried by bulk output
+        uint8_t mode = frame->motorMode[i];
+        if (((frame->motorPowerMask.dirty & bit) && mode != MOTOR_MODE_OPEN_LOOP) ||
+            ((frame->motorVelocityMask.dirty & bit) && mode != MOTOR_MODE_REGULATED_VELOCITY) ||
+            ((frame->motorPositionMask.dirty & bit) && mode != MOTOR_MODE_REGULATED_POSITION))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void fillBulkOutputData(const RhspOutputFrame* frame, RhspBulkOutputData* data)
+{
+    data->digitalOutputs = frame->digitalOutputs;
+    data->digitalDirections = frame->digitalDirections;
+    data->motorEnable = frame->motorEnable;
+    // two bits of mode and the float at zero flag in each nibble, lower numbered motor in the low nibble
+    data->motorMode0_1 = (uint8_t) ((frame->motorMode[0] | frame->motorFloatAtZero[0] << 2) |
+                                    (frame->motorMode[1] | frame->motorFloatAtZero[1] << 2) << 4);
+    data->motorMode2_3 = (uint8_t) ((frame->motorMode[2] | frame->motorFloatAtZero[2] << 2) |
+                                    (frame->motorMode[3] | frame->motorFloatAtZero[3] << 2) << 4);
+    data->motor0Target = motorTarget(frame, 0);
+    data->motor1Target = motorTarget(frame, 1);
+    data->motor2Target = motorTarget(frame, 2);
+    data->motor3Target = motorTarget(frame, 3);
+    data->servoEnable = frame->servoEnable;
+    data->servo0Command = frame->servoPulseWidth[0];
+    data->servo1Command = frame->servoPulseWidth[1];
+    data->servo2Command = frame->servoPulseWidth[2];
+    data->servo3Command = frame->servoPulseWidth[3];
+    data->servo4Command = frame->servoPulseWidth[4];
+    data->servo5Command = frame->servoPulseWidth[5];
+}
+
+// Values that could not be sent are unknown to us now: the module may or may not have applied them.
+static void dropDirtyValues(RhspOutputFrame* frame)
+{
+    RhspFrameMask* masks[] = {
+            &frame->digitalOutputsMask, &frame->digitalDirectionsMask, &frame->motorModeMask,
+            &frame->motorEnableMask, &frame->motorPowerMask, &frame->motorVelocityMask,
+            &frame->motorPositionMask, &frame->servoEnableMask, &frame->servoPulseWidthMask
+    };
+    for (size_t i = 0; i < sizeof(masks) / sizeof(masks[0]); i++)
+    {
+        masks[i]->known &= (uint8_t) ~masks[i]->dirty;
+        masks[i]->dirty = 0;
+    }
+    frame->motorToleranceChanged = 0;
+}
+
+// Sends deferred values one by one. Modes go before targets and targets before enables.
+static int sendIndividualOutputs(RhspRevHub* hub, RhspOutputFrame* frame, uint8_t* nackReasonCode)
+{
+    int retval;
+    for (uint8_t i = 0; i < RHSP_FRAME_NUMBER_OF_GPIO; i++)
+    {
+        if (frame->digitalDirectionsMask.dirty & (1 << i))
+        {
+            retval = rhsp_setDirection(hub, i, (frame->digitalDirections >> i) & 1, nackReasonCode);
+            if (retval < 0) return retval;
+        }
+    }
+    uint8_t dirtyOutputs = frame->digitalOutputsMask.dirty;
+    bool allOutputsKnown = ((frame->digitalOutputsMask.known | dirtyOutputs) & ALL_GPIO_MASK) == ALL_GPIO_MASK;
+    if (dirtyOutputs && (dirtyOutputs & (dirtyOutputs - 1)) && allOutputsKnown)
+    {
+        retval = rhsp_setAllOutputs(hub, frame->digitalOutputs, nackReasonCode);
+        if (retval < 0) return retval;
+    } else
+    {
+        for (uint8_t i = 0; i < RHSP_FRAME_NUMBER_OF_GPIO; i++)
+        {
+            if (dirtyOutputs & (1 << i))
+            {
+                retval = rhsp_setSingleOutput(hub, i, (frame->digitalOutputs >> i) & 1, nackReasonCode);
+                if (retval < 0) return retval;
+            }
+        }
+    }
+    for (uint8_t i = 0; i < RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS; i++)
+    {
+        if (frame->motorModeMask.dirty & (1 << i))
+        {
+            retval = rhsp_setMotorChannelMode(hub, i, (MotorMode) frame->motorMode[i],
+                                              frame->motorFloatAtZero[i], nackReasonCode);
+            if (retval < 0) return retval;
+        }
+    }
+    for (uint8_t i = 0; i < RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS; i++)
+    {
+        if (frame->motorPowerMask.dirty & (1 << i))
+        {
+            retval = rhsp_setMotorConstantPower(hub, i, frame->motorPower[i], nackReasonCode);
+            if (retval < 0) return retval;
+        }
+        if (frame->motorVelocityMask.dirty & (1 << i))
+        {
+            retval = rhsp_setMotorTargetVelocity(hub, i, frame->motorVelocity[i], nackReasonCode);
+            if (retval < 0) return retval;
+        }
+        if (frame->motorPositionMask.dirty & (1 << i))
+        {
+            retval = rhsp_setMotorTargetPosition(hub, i, frame->motorPosition[i], frame->motorTolerance[i],
+                                                 nackReasonCode);
+            if (retval < 0) return retval;
+        }
+    }
+    for (uint8_t i = 0; i < RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS; i++)
+    {
+        if (frame->motorEnableMask.dirty & (1 << i))
+        {
+            retval = rhsp_setMotorChannelEnable(hub, i, (frame->motorEnable >> i) & 1, nackReasonCode);
+            if (retval < 0) return retval;
+        }
+    }
+    for (uint8_t i = 0; i < RHSP_FRAME_NUMBER_OF_SERVO_CHANNELS; i++)
+    {
+        if (frame->servoPulseWidthMask.dirty & (1 << i))
+        {
+            retval = rhsp_setServoPulseWidth(hub, i, frame->servoPulseWidth[i], nackReasonCode);
+            if (retval < 0) return retval;
+        }
+    }
+    for (uint8_t i = 0; i < RHSP_FRAME_NUMBER_OF_SERVO_CHANNELS; i++)
+    {
+        if (frame->servoEnableMask.dirty & (1 << i))
+        {
+            retval = rhsp_setServoEnable(hub, i, (frame->servoEnable >> i) & 1, nackReasonCode);
+            if (retval < 0) return retval;
+        }
+    }
+    return RHSP_RESULT_OK;
+}
+
+void rhsp_frameSetBulkOutputData(RhspRevHub* hub, const RhspBulkOutputData* data)
+{
+    RhspOutputFrame* frame = getFrame(hub);
+    frame->digitalOutputs = data->digitalOutputs;
+    updateMask(&frame->digitalOutputsMask, ALL_GPIO_MASK, false);
+    frame->digitalDirections = data->digitalDirections;
+    updateMask(&frame->digitalDirectionsMask, ALL_GPIO_MASK, false);
+    frame->motorEnable = data->motorEnable;
+    updateMask(&frame->motorEnableMask, ALL_MOTORS_MASK, false);
+
+    uint8_t modes[RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS] = {
+            data->motorMode0_1 & 0x0F, data->motorMode0_1 >> 4, data->motorMode2_3 & 0x0F, data->motorMode2_3 >> 4
+    };
+    int32_t targets[RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS] = {
+            data->motor0Target, data->motor1Target, data->motor2Target, data->motor3Target
+    };
+    for (uint8_t i = 0; i < RHSP_FRAME_NUMBER_OF_MOTOR_CHANNELS; i++)
+    {
+        rhsp_frameSetMotorChannelMode(hub, i, modes[i] & 0x03, (modes[i] >> 2) & 1, false);
+        switch (frame->motorMode[i])
+        {
+            case MOTOR_MODE_REGULATED_VELOCITY:
+                rhsp_frameSetMotorTargetVelocity(hub, i, (int16_t) targets[i], false);
+                break;
+            case MOTOR_MODE_REGULATED_POSITION:
+                rhsp_frameSetMotorTargetPosition(hub, i, targets[i], frame->motorTolerance[i], false);
+                break;
+            default:
+                rhsp_frameSetMotorConstantPower(hub, i, (int16_t) targets[i] * 1.0 / INT16_MAX,
+                                                (int16_t) targets[i], false);
+                break;
+        }
+    }
+
+    frame->servoEnable = data->servoEnable;
+    updateMask(&frame->servoEnableMask, ALL_SERVOS_MASK, false);
+    uint16_t commands[RHSP_FRAME_NUMBER_OF_SERVO_CHANNELS] = {
+            data->servo0Command, data->servo1Command, data->servo2Command,
+            data->servo3Command, data->servo4Command, data->servo5Command
+    };
+    for (uint8_t i = 0; i < RHSP_FRAME_NUMBER_OF_SERVO_CHANNELS; i++)
+    {
+        rhsp_frameSetServoPulseWidth(hub, i, commands[i], false);
+    }
+}
+
+int rhsp_beginOutputFrame(RhspRevHub* hub)
+{
+    if (!hub)
+    {
+        return RHSP_ERROR;
+    }
+    getFrame(hub)->open = true;
+    return RHSP_RESULT_OK;
+}
+
+bool rhsp_isOutputFrameOpen(const RhspRevHub* hub)
+{
+    if (!hub)
+    {
+        return false;
+    }
+    return ((const RhspRevHubInternal*) hub)->outputFrame.open;
+}
+
+int rhsp_commitOutputFrame(RhspRevHub* hub,
+                           RhspBulkInputData* bulkInputData,
+                           uint8_t* nackReasonCode)
+{
+    if (!hub)
+    {
+        return RHSP_ERROR;
+    }
+    RhspOutputFrame* frame = getFrame(hub);
+    // close the frame first, so the setters below go to the wire
+    frame->open = false;
+
+    int retval = RHSP_ERROR_COMMAND_NOT_SUPPORTED;
+    if (canUseBulkOutput(frame))
+    {
+        RhspBulkOutputData bulkOutputData;
+        fillBulkOutputData(frame, &bulkOutputData);
+        retval = rhsp_setBulkOutputData(hub, &bulkOutputData, bulkInputData, nackReasonCode);
+    }
+    if (retval == RHSP_ERROR_COMMAND_NOT_SUPPORTED)
+    {
+        retval = sendIndividualOutputs(hub, frame, nackReasonCode);
+        if (retval >= 0 && bulkInputData)
+        {
+            retval = rhsp_getBulkInputData(hub, bulkInputData, nackReasonCode);
+        }
+    }
+    dropDirtyValues(frame);
+
+    return retval;
+}
@@ -10,7 +10,10 @@
 #include "internal/packet.h"
 #include "internal/arrayutils.h"
 #include "rhsp/compiler.h"
+#include "rhsp/time.h"
 #include "internal/command.h"
+#include "internal/dekaCommands.h"
+#include "internal/cache.h"
 #include "internal/revhub.h"
 
 #define RHSP_NUMBER_OF_I2C_CHANNELS 4
@@ -20,6 +23,12 @@
 #define I2C_TRANSACTION_ARRAY_MAX_SIZE    108 //max i2c transaction array size
 #define I2C_MAX_TRANSACTION_ARRAY_COUNT      10  //max transaction arrays
 
+#define I2C_NACK_CONTROLLER_BUSY          40
+#define I2C_NACK_OPERATION_IN_PROGRESS    41
+#define I2C_READ_POLL_MIN_DELAY_US        250
+#define I2C_READ_POLL_MAX_DELAY_US        8000
+#define I2C_READ_TIMEOUT_MS               1000
+
 static int writeReadMultipleBytesFallback(RhspRevHub* hub,
                                           uint8_t i2cChannel,
                                           uint8_t slaveAddress,
@@ -32,8 +41,6 @@ int rhsp_configureI2cChannel(RhspRevHub* hub,
                              uint8_t speedCode,
                              uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
@@ -46,15 +53,10 @@ int rhsp_configureI2cChannel(RhspRevHub* hub,
         return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 43, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
     uint8_t buffer[2] = {i2cChannel, speedCode};
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    rhsp_invalidateCachedQuery(hub, RHSP_CACHED_QUERY_I2C_CONFIGURATION);
+    return rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_I2C_CONFIGURE_CHANNEL, buffer, sizeof(buffer), nackReasonCode);
 }
 
 int rhsp_configureI2cQuery(RhspRevHub* hub,
@@ -62,7 +64,7 @@ int rhsp_configureI2cQuery(RhspRevHub* hub,
                            uint8_t* speedCode,
                            uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -72,21 +74,16 @@ int rhsp_configureI2cQuery(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 47, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
 
-    retval = rhsp_sendReadCommandInternal(hub, packetID, &i2cChannel, sizeof(i2cChannel), nackReasonCode);
+    int retval = rhsp_sendDekaCachedReadCommand(hub, RHSP_CACHED_QUERY_I2C_CONFIGURATION, RHSP_DEKA_I2C_CONFIGURE_QUERY,
+                                                &i2cChannel, sizeof(i2cChannel), &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
     }
     if (speedCode)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *speedCode = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *speedCode = RHSP_ARRAY_BYTE(uint8_t, response, 0);
     }
     return RHSP_RESULT_OK;
 }
@@ -97,8 +94,6 @@ int rhsp_writeSingleByte(RhspRevHub* hub,
                          uint8_t byteToWrite,
                          uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
@@ -111,15 +106,9 @@ int rhsp_writeSingleByte(RhspRevHub* hub,
         return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 37, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
     uint8_t buffer[3] = {i2cChannel, slaveAddress, byteToWrite};
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    return rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_I2C_WRITE_SINGLE_BYTE, buffer, sizeof(buffer), nackReasonCode);
 }
 
 int rhsp_writeMultipleBytes(RhspRevHub* hub,
@@ -129,7 +118,6 @@ int rhsp_writeMultipleBytes(RhspRevHub* hub,
                             const uint8_t* payload,
                             uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
     rhsp_assert(bytesToWrite > 0 && bytesToWrite <= I2C_MAX_PAYLOAD_SIZE);
 
     if (!hub || !payload)
@@ -147,16 +135,10 @@ int rhsp_writeMultipleBytes(RhspRevHub* hub,
         return RHSP_ERROR_ARG_3_OUT_OF_RANGE;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 38, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
     uint8_t buffer[3 + I2C_MAX_PAYLOAD_SIZE] = {i2cChannel, slaveAddress, bytesToWrite};
     memcpy(&buffer[3], payload, (size_t) bytesToWrite);
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, buffer, 3 + bytesToWrite, nackReasonCode);
+    return rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_I2C_WRITE_MULTIPLE_BYTES, buffer, 3 + bytesToWrite, nackReasonCode);
 }
 
 int rhsp_writeStatusQuery(RhspRevHub* hub,
@@ -165,7 +147,7 @@ int rhsp_writeStatusQuery(RhspRevHub* hub,
                           uint8_t* writtenBytes,
                           uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -175,25 +157,20 @@ int rhsp_writeStatusQuery(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 42, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
 
-    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-    retval = rhsp_sendReadCommandInternal(hub, packetID, &i2cChannel, sizeof(i2cChannel), nackReasonCode);
+    int retval = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_I2C_WRITE_STATUS_QUERY,
+                                          &i2cChannel, sizeof(i2cChannel), &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
     }
     if (i2cTransactionStatus)
     {
-        *i2cTransactionStatus = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *i2cTransactionStatus = RHSP_ARRAY_BYTE(uint8_t, response, 0);
     }
     if (writtenBytes)
     {
-        *writtenBytes = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 1);
+        *writtenBytes = RHSP_ARRAY_BYTE(uint8_t, response, 1);
     }
     return RHSP_RESULT_OK;
 }
@@ -203,8 +180,6 @@ int rhsp_readSingleByte(RhspRevHub* hub,
                         uint8_t slaveAddress,
                         uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
@@ -217,15 +192,9 @@ int rhsp_readSingleByte(RhspRevHub* hub,
         return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 39, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
     uint8_t buffer[2] = {i2cChannel, slaveAddress};
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    return rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_I2C_READ_SINGLE_BYTE, buffer, sizeof(buffer), nackReasonCode);
 }
 
 int rhsp_readMultipleBytes(RhspRevHub* hub,
@@ -234,7 +203,6 @@ int rhsp_readMultipleBytes(RhspRevHub* hub,
                            uint8_t bytesToRead,
                            uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
     if (!hub)
     {
         return RHSP_ERROR;
@@ -251,15 +219,9 @@ int rhsp_readMultipleBytes(RhspRevHub* hub,
         return RHSP_ERROR_ARG_3_OUT_OF_RANGE;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 40, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
     uint8_t buffer[3] = {i2cChannel, slaveAddress, bytesToRead};
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    return rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_I2C_READ_MULTIPLE_BYTES, buffer, sizeof(buffer), nackReasonCode);
 }
 
 static int writeReadMultipleBytesFallback(RhspRevHub* hub,
@@ -292,7 +254,6 @@ int rhsp_writeReadMultipleBytes(RhspRevHub* hub,
                                 uint8_t startAddress,
                                 uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
     if (!hub)
     {
         return RHSP_ERROR;
@@ -310,7 +271,7 @@ int rhsp_writeReadMultipleBytes(RhspRevHub* hub,
 
     // if writeReadMultipleBytes is not supported,
     // use fallback is based on writeSingleByte, readSingleByte and readMultipleBytes
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 52, &packetID, nackReasonCode);
+    int retval = rhsp_getDekaPacketID(hub, RHSP_DEKA_I2C_WRITE_READ_MULTIPLE_BYTES, NULL, nackReasonCode);
     if (retval == RHSP_ERROR_COMMAND_NOT_SUPPORTED)
     {
         return writeReadMultipleBytesFallback(hub, i2cChannel, slaveAddress, bytesToRead, startAddress, nackReasonCode);
@@ -321,7 +282,8 @@ int rhsp_writeReadMultipleBytes(RhspRevHub* hub,
 
     uint8_t buffer[4] = {i2cChannel, slaveAddress, bytesToRead, startAddress};
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    return rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_I2C_WRITE_READ_MULTIPLE_BYTES, buffer, sizeof(buffer),
+                                     nackReasonCode);
 }
 
 int rhsp_readStatusQuery(RhspRevHub* hub,
@@ -331,7 +293,7 @@ int rhsp_readStatusQuery(RhspRevHub* hub,
                          uint8_t* payload,
                          uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
     if (!hub)
     {
         return RHSP_ERROR;
@@ -340,43 +302,321 @@ int rhsp_readStatusQuery(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 41, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
 
-    retval = rhsp_sendReadCommandInternal(hub, packetID, &i2cChannel, sizeof(i2cChannel), nackReasonCode);
+    int retval = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_I2C_READ_STATUS_QUERY,
+                                          &i2cChannel, sizeof(i2cChannel), &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
     }
 
-    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
     if (i2cTransactionStatusByte)
     {
-        *i2cTransactionStatusByte = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *i2cTransactionStatusByte = RHSP_ARRAY_BYTE(uint8_t, response, 0);
     }
 
-    uint8_t bytes_read = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 1);
+    uint8_t bytes_read = RHSP_ARRAY_BYTE(uint8_t, response, 1);
     if (bytesRead)
     {
         *bytesRead = bytes_read;
     }
     if (payload)
     {
-        memcpy(payload, RHSP_ARRAY_BYTE_PTR(uint8_t*, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 2), bytes_read);
+        memcpy(payload, RHSP_ARRAY_BYTE_PTR(uint8_t*, response, 2), bytes_read);
     }
     return RHSP_RESULT_OK;
 }
 
+void rhsp_setI2cWaitFunction(RhspRevHub* hub, RhspI2cWaitFunction waitFunction, void* context)
+{
+    if (!hub)
+    {
+        return;
+    }
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    internalHub->i2cWaitFunction = waitFunction;
+    internalHub->i2cWaitContext = context;
+}
+
+static void waitForController(RhspRevHub* hub, uint32_t delayUs)
+{
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    if (internalHub->i2cWaitFunction)
+    {
+        internalHub->i2cWaitFunction(internalHub->i2cWaitContext, delayUs);
+    } else if (delayUs > 0)
+    {
+        rhsp_sleepUs(delayUs);
+    }
+}
+
+// Another blocking call can only be in progress on the channel while it waits through the wait function.
+static void claimI2cChannel(RhspRevHub* hub, uint8_t i2cChannel)
+{
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    while (internalHub->i2cChannelsInUse & (1 << i2cChannel))
+    {
+        waitForController(hub, I2C_READ_POLL_MIN_DELAY_US);
+    }
+    internalHub->i2cChannelsInUse |= (uint8_t) (1 << i2cChannel);
+}
+
+static void releaseI2cChannel(RhspRevHub* hub, uint8_t i2cChannel)
+{
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    internalHub->i2cChannelsInUse &= (uint8_t) ~(1 << i2cChannel);
+}
+
+static uint32_t nextPollDelayUs(uint32_t delayUs)
+{
+    delayUs = (delayUs < I2C_READ_POLL_MIN_DELAY_US) ? I2C_READ_POLL_MIN_DELAY_US : delayUs * 2;
+    return (delayUs > I2C_READ_POLL_MAX_DELAY_US) ? I2C_READ_POLL_MAX_DELAY_US : delayUs;
+}
+
+static int waitForReadResult(RhspRevHub* hub,
+                             uint8_t i2cChannel,
+                             uint8_t* i2cTransactionStatusByte,
+                             uint8_t* bytesRead,
+                             uint8_t* payload,
+                             uint8_t* nackReasonCode)
+{
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    uint32_t* learnedDelayUs = &internalHub->i2cReadPollDelayUs[i2cChannel];
+    uint32_t delayUs = *learnedDelayUs;
+    uint32_t startMs = rhsp_getSteadyClockMs();
+
+    while (true)
+    {
+        waitForController(hub, delayUs);
+        uint8_t nackCode = 0;
+        int retval = rhsp_readStatusQuery(hub, i2cChannel, i2cTransactionStatusByte, bytesRead, payload, &nackCode);
+        if (retval >= 0)
+        {
+            // Start the next read a bit earlier than this one completed, so the delay can shrink again.
+            *learnedDelayUs = delayUs / 2;
+            return retval;
+        }
+        if (retval != RHSP_ERROR_NACK_RECEIVED || nackCode != I2C_NACK_OPERATION_IN_PROGRESS)
+        {
+            if (nackReasonCode)
+            {
+                *nackReasonCode = nackCode;
+            }
+            return retval;
+        }
+        if (rhsp_getSteadyClockMs() - startMs >= I2C_READ_TIMEOUT_MS)
+        {
+            *learnedDelayUs = 0;
+            return RHSP_ERROR_RESPONSE_TIMEOUT;
+        }
+        delayUs = nextPollDelayUs(delayUs);
+    }
+}
+
+// Starts a single operation. Retries while the controller is still busy with the previous write.
+static int startI2cOperation(RhspRevHub* hub, uint8_t i2cChannel, const RhspI2cOperation* operation,
+                             uint8_t* nackReasonCode)
+{
+    uint32_t delayUs = 0;
+    uint32_t startMs = rhsp_getSteadyClockMs();
+
+    while (true)
+    {
+        uint8_t nackCode = 0;
+        int retval;
+        switch (operation->type)
+        {
+            case RHSP_I2C_OPERATION_WRITE:
+                retval = rhsp_writeMultipleBytes(hub, i2cChannel, operation->slaveAddress, operation->length,
+                                                 operation->buffer, &nackCode);
+                break;
+            case RHSP_I2C_OPERATION_READ:
+                retval = rhsp_readMultipleBytes(hub, i2cChannel, operation->slaveAddress, operation->length,
+                                                &nackCode);
+                break;
+            case RHSP_I2C_OPERATION_READ_REGISTER:
+                retval = rhsp_writeReadMultipleBytes(hub, i2cChannel, operation->slaveAddress, operation->length,
+                                                     operation->startAddress, &nackCode);
+                break;
+            default:
+                return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
+        }
+        if (retval != RHSP_ERROR_NACK_RECEIVED || nackCode != I2C_NACK_CONTROLLER_BUSY)
+        {
+            if (retval < 0 && nackReasonCode)
+            {
+                *nackReasonCode = nackCode;
+            }
+            return retval;
+        }
+        if (rhsp_getSteadyClockMs() - startMs >= I2C_READ_TIMEOUT_MS)
+        {
+            return RHSP_ERROR_RESPONSE_TIMEOUT;
+        }
+        delayUs = nextPollDelayUs(delayUs);
+        waitForController(hub, delayUs);
+    }
+}
+
+static int waitForWriteResult(RhspRevHub* hub, uint8_t i2cChannel, uint8_t* nackReasonCode)
+{
+    uint32_t delayUs = 0;
+    uint32_t startMs = rhsp_getSteadyClockMs();
+
+    while (true)
+    {
+        uint8_t nackCode = 0;
+        int retval = rhsp_writeStatusQuery(hub, i2cChannel, NULL, NULL, &nackCode);
+        if (retval != RHSP_ERROR_NACK_RECEIVED || nackCode != I2C_NACK_OPERATION_IN_PROGRESS)
+        {
+            if (retval < 0 && nackReasonCode)
+            {
+                *nackReasonCode = nackCode;
+            }
+            return retval;
+        }
+        if (rhsp_getSteadyClockMs() - startMs >= I2C_READ_TIMEOUT_MS)
+        {
+            return RHSP_ERROR_RESPONSE_TIMEOUT;
+        }
+        delayUs = nextPollDelayUs(delayUs);
+        waitForController(hub, delayUs);
+    }
+}
+
+int rhsp_runI2cOperations(RhspRevHub* hub,
+                          uint8_t i2cChannel,
+                          RhspI2cOperation* operations,
+                          size_t operationCount,
+                          size_t* completedOperations,
+                          uint8_t* nackReasonCode)
+{
+    if (!hub || (!operations && operationCount > 0))
+    {
+        return RHSP_ERROR;
+    }
+    if (i2cChannel >= RHSP_NUMBER_OF_I2C_CHANNELS)
+    {
+        return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
+    }
+    for (size_t i = 0; i < operationCount; i++)
+    {
+        if (operations[i].type > RHSP_I2C_OPERATION_READ_REGISTER ||
+            operations[i].length == 0 || operations[i].length > I2C_MAX_PAYLOAD_SIZE)
+        {
+            return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
+        }
+    }
+    if (completedOperations)
+    {
+        *completedOperations = 0;
+    }
+
+    claimI2cChannel(hub, i2cChannel);
+    int retval = RHSP_RESULT_OK;
+    for (size_t i = 0; i < operationCount; i++)
+    {
+        if (i > 0)
+        {
+            // let other commands run between operations
+            waitForController(hub, 0);
+        }
+        RhspI2cOperation* operation = &operations[i];
+        retval = startI2cOperation(hub, i2cChannel, operation, nackReasonCode);
+        if (retval < 0)
+        {
+            break;
+        }
+
+        if (operation->type == RHSP_I2C_OPERATION_WRITE)
+        {
+            // writes are not waited for, the next operation is retried until the controller is free
+            if (i == operationCount - 1)
+            {
+                retval = waitForWriteResult(hub, i2cChannel, nackReasonCode);
+            }
+        }
+        else
+        {
+            uint8_t bytesRead = 0;
+            retval = waitForReadResult(hub, i2cChannel, NULL, &bytesRead, operation->buffer, nackReasonCode);
+            operation->length = bytesRead;
+        }
+        if (retval < 0)
+        {
+            break;
+        }
+        if (completedOperations)
+        {
+            *completedOperations = i + 1;
+        }
+    }
+    releaseI2cChannel(hub, i2cChannel);
+    return retval;
+}
+
+int rhsp_readMultipleBytesBlocking(RhspRevHub* hub,
+                                   uint8_t i2cChannel,
+                                   uint8_t slaveAddress,
+                                   uint8_t bytesToRead,
+                                   uint8_t* i2cTransactionStatusByte,
+                                   uint8_t* bytesRead,
+                                   uint8_t* payload,
+                                   uint8_t* nackReasonCode)
+{
+    if (!hub)
+    {
+        return RHSP_ERROR;
+    }
+    if (i2cChannel >= RHSP_NUMBER_OF_I2C_CHANNELS)
+    {
+        return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
+    }
+    claimI2cChannel(hub, i2cChannel);
+    int retval = rhsp_readMultipleBytes(hub, i2cChannel, slaveAddress, bytesToRead, nackReasonCode);
+    if (retval >= 0)
+    {
+        retval = waitForReadResult(hub, i2cChannel, i2cTransactionStatusByte, bytesRead, payload, nackReasonCode);
+    }
+    releaseI2cChannel(hub, i2cChannel);
+    return retval;
+}
+
+int rhsp_writeReadMultipleBytesBlocking(RhspRevHub* hub,
+                                        uint8_t i2cChannel,
+                                        uint8_t slaveAddress,
+                                        uint8_t bytesToRead,
+                                        uint8_t startAddress,
+                                        uint8_t* i2cTransactionStatusByte,
+                                        uint8_t* bytesRead,
+                                        uint8_t* payload,
+                                        uint8_t* nackReasonCode)
+{
+    if (!hub)
+    {
+        return RHSP_ERROR;
+    }
+    if (i2cChannel >= RHSP_NUMBER_OF_I2C_CHANNELS)
+    {
+        return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
+    }
+    claimI2cChannel(hub, i2cChannel);
+    int retval = rhsp_writeReadMultipleBytes(hub, i2cChannel, slaveAddress, bytesToRead, startAddress,
+                                             nackReasonCode);
+    if (retval >= 0)
+    {
+        retval = waitForReadResult(hub, i2cChannel, i2cTransactionStatusByte, bytesRead, payload, nackReasonCode);
+    }
+    releaseI2cChannel(hub, i2cChannel);
+    return retval;
+}
+
 int rhsp_i2cTransaction(RhspRevHub* hub,
                         uint8_t i2cChannel,
                         uint8_t transactionArrayCount,
                         const RhspI2cTransactionArray* transactionArray,
                         uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
     if (!hub || !transactionArray)
     {
         return RHSP_ERROR;
@@ -389,12 +629,6 @@ int rhsp_i2cTransaction(RhspRevHub* hub,
         return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 54, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
     size_t totalArraySize = 0;
     for (size_t i = 0; i < transactionArrayCount; i++)
     {
@@ -417,7 +651,7 @@ int rhsp_i2cTransaction(RhspRevHub* hub,
         offset += transactionArray[i].length;
     }
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    return rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_I2C_TRANSACTION, buffer, offset, nackReasonCode);
 }
 
 int rhsp_i2cTransactionQuery(RhspRevHub* hub,
@@ -428,8 +662,7 @@ int rhsp_i2cTransactionQuery(RhspRevHub* hub,
                              RhspI2cTransactionArray* transactionArray,
                              uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -443,14 +676,9 @@ int rhsp_i2cTransactionQuery(RhspRevHub* hub,
         return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 55, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
     uint8_t buffer[2] = {i2cChannel, doShortResponse};
-    retval = rhsp_sendReadCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    int retval = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_I2C_TRANSACTION_QUERY,
+                                          buffer, sizeof(buffer), &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
@@ -458,10 +686,10 @@ int rhsp_i2cTransactionQuery(RhspRevHub* hub,
 
     if (i2cTransactionStatusByte)
     {
-        *i2cTransactionStatusByte = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *i2cTransactionStatusByte = RHSP_ARRAY_BYTE(uint8_t, response, 0);
     }
 
-    uint8_t number_of_transactions = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 1);
+    uint8_t number_of_transactions = RHSP_ARRAY_BYTE(uint8_t, response, 1);
     if (numberOfTransactions)
     {
         *numberOfTransactions = number_of_transactions;
@@ -472,12 +700,9 @@ int rhsp_i2cTransactionQuery(RhspRevHub* hub,
         size_t offset = 2; // we set pointer to "I2C Transaction Array" at offset 2 according to spec
         for (size_t i = 0; i < number_of_transactions; i++)
         {
-            transactionArray[i].address = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer),
-                                                          offset++);
-            transactionArray[i].flags = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer),
-                                                        offset++);
-            transactionArray[i].length = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer),
-                                                         offset++);
+            transactionArray[i].address = RHSP_ARRAY_BYTE(uint8_t, response, offset++);
+            transactionArray[i].flags = RHSP_ARRAY_BYTE(uint8_t, response, offset++);
+            transactionArray[i].length = RHSP_ARRAY_BYTE(uint8_t, response, offset++);
             // normally device must not exceed the buffer size but if the module contains some bugs it could happen
             // @TODO consider to add a new ERROR for such cases
             if (transactionArray[i].length > RHSP_I2C_TRANSACTION_ARRAY_MAX_BUFFER_SIZE)
@@ -485,7 +710,7 @@ int rhsp_i2cTransactionQuery(RhspRevHub* hub,
                 return RHSP_ERROR;
             }
             memcpy(transactionArray[i].buffer,
-                   RHSP_ARRAY_BYTE_PTR(uint8_t*, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), offset),
+                   RHSP_ARRAY_BYTE_PTR(uint8_t*, response, offset),
                    transactionArray[i].length);
             offset += transactionArray[i].length;
         }
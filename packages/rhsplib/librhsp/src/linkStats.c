@@ -0,0 +1,40 @@
+/*
+ * linkStats.c
+ *
+ * Link health counters of serial ports and modules.
+ */
+#include <string.h>
+
+#include "rhsp/rhsp.h"
+#include "internal/linkStats.h"
+#include "internal/revhub.h"
+
+static void copyLinkStats(const RhspLinkStats* source, RhspLinkStats* destination)
+{
+    const uint32_t* sourceCounters = (const uint32_t*) source;
+    uint32_t* destinationCounters = (uint32_t*) destination;
+    for (size_t i = 0; i < sizeof(RhspLinkStats) / sizeof(uint32_t); i++)
+    {
+        destinationCounters[i] = rhsp_linkStatsLoad(&sourceCounters[i]);
+    }
+}
+
+int rhsp_getLinkStats(const RhspRevHub* hub, RhspLinkStats* stats)
+{
+    if (!hub || !stats)
+    {
+        return RHSP_ERROR;
+    }
+    copyLinkStats(&((const RhspRevHubInternal*) hub)->linkStats, stats);
+    return RHSP_RESULT_OK;
+}
+
+int rhsp_getSerialLinkStats(const RhspSerial* serial, RhspLinkStats* stats)
+{
+    if (!serial || !stats)
+    {
+        return RHSP_ERROR;
+    }
+    copyLinkStats(&serial->linkStats, stats);
+    return RHSP_RESULT_OK;
+}
@@ -141,8 +141,8 @@ int rhsp_queryInterface(RhspRevHub* hub,
     RhspModuleInterface intf_;
     intf_.name = malloc(interfaceNameLength);
     memcpy(intf_.name, interfaceName, interfaceNameLength);
-    intf_.firstPacketID = RHSP_ARRAY_WORD(uint16_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
-    intf_.numberIDValues = RHSP_ARRAY_WORD(uint16_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 2);
+    intf_.firstPacketID = rhsp_loadU16(RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer));
+    intf_.numberIDValues = rhsp_loadU16(RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer) + 2);
     addInterface(internalHub, &intf_);
     if (intf)
     {
@@ -0,0 +1,166 @@
+/*
+ * motionProfile.c
+ *
+ * Planning and sampling of trapezoidal and S-curve motion profiles.
+ */
+#include <math.h>
+#include <stddef.h>
+
+#include "rhsp/errors.h"
+#include "rhsp/motionProfile.h"
+
+// bisection steps when the peak velocity has to be lowered. Enough for double precision
+#define MOTION_PROFILE_SEARCH_STEPS     64
+
+// shape of the acceleration phase for a given peak velocity
+typedef struct {
+    double jerkTime;
+    double constantAccelerationTime;
+    double peakAcceleration;
+} AccelerationShape;
+
+static AccelerationShape accelerationShape(double peakVelocity, double maxAcceleration, double maxJerk)
+{
+    AccelerationShape shape;
+    if (maxJerk > 0)
+    {
+        // the acceleration limit is only reached if ramping to it and back takes less velocity than the peak
+        shape.jerkTime = fmin(maxAcceleration / maxJerk, sqrt(peakVelocity / maxJerk));
+        shape.peakAcceleration = maxJerk * shape.jerkTime;
+    } else
+    {
+        shape.jerkTime = 0;
+        shape.peakAcceleration = maxAcceleration;
+    }
+    shape.constantAccelerationTime = shape.peakAcceleration > 0
+                                     ? fmax(peakVelocity / shape.peakAcceleration - shape.jerkTime, 0)
+                                     : 0;
+    return shape;
+}
+
+static double accelerationDistance(double peakVelocity, const AccelerationShape* shape)
+{
+    // the velocity curve is symmetric around its midpoint, so the mean velocity is half the peak
+    return peakVelocity * (2 * shape->jerkTime + shape->constantAccelerationTime) / 2;
+}
+
+int rhsp_planMotionProfile(const RhspMotionConstraints* constraints, RhspMotionProfile* profile)
+{
+    if (!constraints || !profile)
+    {
+        return RHSP_ERROR;
+    }
+    if (!isfinite(constraints->distance) || !(constraints->maxVelocity > 0) ||
+        !(constraints->maxAcceleration > 0) || !(constraints->maxJerk >= 0))
+    {
+        return RHSP_ERROR;
+    }
+
+    double distance = fabs(constraints->distance);
+    double peakVelocity = constraints->maxVelocity;
+    AccelerationShape shape = accelerationShape(peakVelocity, constraints->maxAcceleration, constraints->maxJerk);
+
+    if (2 * accelerationDistance(peakVelocity, &shape) > distance)
+    {
+        // no cruise phase. The distance grows with the peak velocity, so search for the peak that covers it
+        double low = 0;
+        double high = peakVelocity;
+        for (int i = 0; i < MOTION_PROFILE_SEARCH_STEPS; i++)
+        {
+            double middle = (low + high) / 2;
+            AccelerationShape candidate = accelerationShape(middle, constraints->maxAcceleration,
+                                                            constraints->maxJerk);
+            if (2 * accelerationDistance(middle, &candidate) > distance)
+            {
+                high = middle;
+            } else
+            {
+                low = middle;
+            }
+        }
+        peakVelocity = low;
+        shape = accelerationShape(peakVelocity, constraints->maxAcceleration, constraints->maxJerk);
+    }
+
+    profile->direction = constraints->distance < 0 ? -1 : 1;
+    profile->distance = distance;
+    profile->peakVelocity = peakVelocity;
+    profile->peakAcceleration = shape.peakAcceleration;
+    profile->jerk = constraints->maxJerk;
+    profile->jerkTime = shape.jerkTime;
+    profile->constantAccelerationTime = shape.constantAccelerationTime;
+    profile->accelerationTime = 2 * shape.jerkTime + shape.constantAccelerationTime;
+    profile->accelerationDistance = accelerationDistance(peakVelocity, &shape);
+    profile->cruiseTime = peakVelocity > 0
+                          ? fmax(distance - 2 * profile->accelerationDistance, 0) / peakVelocity
+                          : 0;
+    profile->duration = 2 * profile->accelerationTime + profile->cruiseTime;
+    return RHSP_RESULT_OK;
+}
+
+// state during the acceleration phase, time in [0, accelerationTime]
+static void sampleAcceleration(const RhspMotionProfile* profile, double time, RhspMotionState* state)
+{
+    double jerk = profile->jerk;
+    double jerkTime = profile->jerkTime;
+    double peakAcceleration = profile->peakAcceleration;
+
+    if (time < jerkTime)
+    {
+        state->acceleration = jerk * time;
+        state->velocity = jerk * time * time / 2;
+        state->position = jerk * time * time * time / 6;
+        return;
+    }
+
+    double velocity1 = jerk * jerkTime * jerkTime / 2;
+    double position1 = jerk * jerkTime * jerkTime * jerkTime / 6;
+    double dt = time - jerkTime;
+    if (dt < profile->constantAccelerationTime)
+    {
+        state->acceleration = peakAcceleration;
+        state->velocity = velocity1 + peakAcceleration * dt;
+        state->position = position1 + velocity1 * dt + peakAcceleration * dt * dt / 2;
+        return;
+    }
+
+    double constantTime = profile->constantAccelerationTime;
+    double velocity2 = velocity1 + peakAcceleration * constantTime;
+    double position2 = position1 + velocity1 * constantTime + peakAcceleration * constantTime * constantTime / 2;
+    dt -= constantTime;
+    state->acceleration = peakAcceleration - jerk * dt;
+    state->velocity = velocity2 + peakAcceleration * dt - jerk * dt * dt / 2;
+    state->position = position2 + velocity2 * dt + peakAcceleration * dt * dt / 2 - jerk * dt * dt * dt / 6;
+}
+
+void rhsp_sampleMotionProfile(const RhspMotionProfile* profile, double time, RhspMotionState* state)
+{
+    if (!profile || !state)
+    {
+        return;
+    }
+    time = fmin(fmax(time, 0), profile->duration);
+
+    if (time < profile->accelerationTime)
+    {
+        sampleAcceleration(profile, time, state);
+    } else if (time < profile->accelerationTime + profile->cruiseTime)
+    {
+        state->acceleration = 0;
+        state->velocity = profile->peakVelocity;
+        state->position = profile->accelerationDistance +
+                          profile->peakVelocity * (time - profile->accelerationTime);
+    } else
+    {
+        // deceleration mirrors acceleration around the end of the move
+        RhspMotionState mirrored;
+        sampleAcceleration(profile, profile->duration - time, &mirrored);
+        state->acceleration = -mirrored.acceleration;
+        state->velocity = mirrored.velocity;
+        state->position = profile->distance - mirrored.position;
+    }
+
+    state->position *= profile->direction;
+    state->velocity *= profile->direction;
+    state->acceleration *= profile->direction;
+}
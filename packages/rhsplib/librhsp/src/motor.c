@@ -9,6 +9,10 @@
 #include <math.h>
 #include "internal/arrayutils.h"
 #include "internal/command.h"
+#include "internal/dekaCommands.h"
+#include "internal/cache.h"
+#include "internal/encoder.h"
+#include "internal/frame.h"
 #include "internal/packet.h"
 #include "internal/revhub.h"
 
@@ -23,8 +27,6 @@ int rhsp_setMotorChannelMode(RhspRevHub* hub,
                              uint8_t floatAtZero,
                              uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
@@ -36,16 +38,22 @@ int rhsp_setMotorChannelMode(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_3_OUT_OF_RANGE;
     }
-
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 8, &packetID, nackReasonCode);
-    if (retval < 0)
+    if (rhsp_isOutputFrameOpen(hub))
     {
-        return retval;
+        rhsp_frameSetMotorChannelMode(hub, motorChannel, motorMode, floatAtZero, true);
+        return RHSP_RESULT_OK;
     }
 
     uint8_t cmdPayload[3] = {motorChannel, motorMode, floatAtZero};
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, cmdPayload, sizeof(cmdPayload), nackReasonCode);
+    rhsp_invalidateCachedQuery(hub, RHSP_CACHED_QUERY_MOTOR_CHANNEL_MODE);
+    int retval = rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_SET_MOTOR_CHANNEL_MODE,
+                                           cmdPayload, sizeof(cmdPayload), nackReasonCode);
+    if (retval >= 0)
+    {
+        rhsp_frameSetMotorChannelMode(hub, motorChannel, motorMode, floatAtZero, false);
+    }
+    return retval;
 }
 
 int rhsp_getMotorChannelMode(RhspRevHub* hub,
@@ -54,7 +62,7 @@ int rhsp_getMotorChannelMode(RhspRevHub* hub,
                              uint8_t* floatAtZero,
                              uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -64,26 +72,22 @@ int rhsp_getMotorChannelMode(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 9, &packetID, nackReasonCode);
-    if (result < 0)
-    {
-        return result;
-    }
 
-    result = rhsp_sendReadCommandInternal(hub, packetID, &motorChannel, sizeof(motorChannel), nackReasonCode);
+    int result = rhsp_sendDekaCachedReadCommand(hub, RHSP_CACHED_QUERY_MOTOR_CHANNEL_MODE,
+                                                RHSP_DEKA_GET_MOTOR_CHANNEL_MODE, &motorChannel, sizeof(motorChannel),
+                                                &response, nackReasonCode);
     if (result < 0)
     {
         return result;
     }
 
-    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
     if (motorMode)
     {
-        *motorMode = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *motorMode = RHSP_ARRAY_BYTE(uint8_t, response, 0);
     }
     if (floatAtZero)
     {
-        *floatAtZero = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 1);
+        *floatAtZero = RHSP_ARRAY_BYTE(uint8_t, response, 1);
     }
 
     return RHSP_RESULT_OK;
@@ -94,8 +98,6 @@ int rhsp_setMotorChannelEnable(RhspRevHub* hub,
                                uint8_t enabled,
                                uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
@@ -107,16 +109,21 @@ int rhsp_setMotorChannelEnable(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
     }
-
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 10, &packetID, nackReasonCode);
-    if (retval < 0)
+    if (rhsp_isOutputFrameOpen(hub))
     {
-        return retval;
+        rhsp_frameSetMotorChannelEnable(hub, motorChannel, enabled, true);
+        return RHSP_RESULT_OK;
     }
 
     uint8_t cmdPayload[2] = {motorChannel, enabled};
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, cmdPayload, sizeof(cmdPayload), nackReasonCode);
+    int retval = rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_SET_MOTOR_CHANNEL_ENABLE,
+                                           cmdPayload, sizeof(cmdPayload), nackReasonCode);
+    if (retval >= 0)
+    {
+        rhsp_frameSetMotorChannelEnable(hub, motorChannel, enabled, false);
+    }
+    return retval;
 }
 
 int rhsp_getMotorChannelEnable(RhspRevHub* hub,
@@ -124,7 +131,7 @@ int rhsp_getMotorChannelEnable(RhspRevHub* hub,
                                uint8_t* enabled,
                                uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -135,13 +142,8 @@ int rhsp_getMotorChannelEnable(RhspRevHub* hub,
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
 
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 11, &packetID, nackReasonCode);
-    if (result < 0)
-    {
-        return result;
-    }
-
-    result = rhsp_sendReadCommandInternal(hub, packetID, &motorChannel, sizeof(motorChannel), nackReasonCode);
+    int result = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_GET_MOTOR_CHANNEL_ENABLE,
+                                          &motorChannel, sizeof(motorChannel), &response, nackReasonCode);
     if (result < 0)
     {
         return result;
@@ -149,8 +151,7 @@ int rhsp_getMotorChannelEnable(RhspRevHub* hub,
 
     if (enabled)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *enabled = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *enabled = RHSP_ARRAY_BYTE(uint8_t, response, 0);
     }
 
     return RHSP_RESULT_OK;
@@ -161,8 +162,6 @@ int rhsp_setMotorChannelCurrentAlertLevel(RhspRevHub* hub,
                                           uint16_t currentLimit,
                                           uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
@@ -171,18 +170,14 @@ int rhsp_setMotorChannelCurrentAlertLevel(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 12, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
 
     uint8_t cmdPayload[3];
 
     RHSP_ARRAY_SET_BYTE(cmdPayload, 0, motorChannel);
-    RHSP_ARRAY_SET_WORD(cmdPayload, 1, currentLimit);
+    rhsp_storeU16(cmdPayload + 1, currentLimit);
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, cmdPayload, sizeof(cmdPayload), nackReasonCode);
+    return rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_SET_MOTOR_CURRENT_ALERT_LEVEL,
+                                     cmdPayload, sizeof(cmdPayload), nackReasonCode);
 }
 
 int rhsp_getMotorChannelCurrentAlertLevel(RhspRevHub* hub,
@@ -190,7 +185,7 @@ int rhsp_getMotorChannelCurrentAlertLevel(RhspRevHub* hub,
                                           uint16_t* currentLimit,
                                           uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -201,13 +196,8 @@ int rhsp_getMotorChannelCurrentAlertLevel(RhspRevHub* hub,
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
 
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 13, &packetID, nackReasonCode);
-    if (result < 0)
-    {
-        return result;
-    }
-
-    result = rhsp_sendReadCommandInternal(hub, packetID, &motorChannel, sizeof(motorChannel), nackReasonCode);
+    int result = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_GET_MOTOR_CURRENT_ALERT_LEVEL,
+                                          &motorChannel, sizeof(motorChannel), &response, nackReasonCode);
     if (result < 0)
     {
         return result;
@@ -215,8 +205,7 @@ int rhsp_getMotorChannelCurrentAlertLevel(RhspRevHub* hub,
 
     if (currentLimit)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *currentLimit = RHSP_ARRAY_WORD(uint16_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *currentLimit = rhsp_loadU16(response);
     }
 
     return RHSP_RESULT_OK;
@@ -226,8 +215,6 @@ int rhsp_resetEncoder(RhspRevHub* hub,
                       uint8_t motorChannel,
                       uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
@@ -237,13 +224,13 @@ int rhsp_resetEncoder(RhspRevHub* hub,
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
 
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 14, &packetID, nackReasonCode);
-    if (result < 0)
+    int result = rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_RESET_ENCODER,
+                                           &motorChannel, sizeof(motorChannel), nackReasonCode);
+    if (result >= 0)
     {
-        return result;
+        rhsp_restartEncoderFilter(hub, motorChannel);
     }
-
-    return rhsp_sendWriteCommandInternal(hub, packetID, &motorChannel, sizeof(motorChannel), nackReasonCode);
+    return result;
 }
 
 int rhsp_setMotorConstantPower(RhspRevHub* hub,
@@ -251,8 +238,6 @@ int rhsp_setMotorConstantPower(RhspRevHub* hub,
                                double powerLevel,
                                uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
@@ -262,20 +247,25 @@ int rhsp_setMotorConstantPower(RhspRevHub* hub,
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
 
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 15, &packetID, nackReasonCode);
-    if (result < 0)
+    int16_t adjustedPowerLevel = (int16_t) (powerLevel * POWER_CONVERSION);
+    if (rhsp_isOutputFrameOpen(hub))
     {
-        return result;
+        rhsp_frameSetMotorConstantPower(hub, motorChannel, powerLevel, adjustedPowerLevel, true);
+        return RHSP_RESULT_OK;
     }
 
     uint8_t cmdPayload[3];
 
-    int16_t adjustedPowerLevel = (int16_t) (powerLevel * POWER_CONVERSION);
-
     RHSP_ARRAY_SET_BYTE(cmdPayload, 0, motorChannel);
-    RHSP_ARRAY_SET_WORD(cmdPayload, 1, adjustedPowerLevel);
+    rhsp_storeU16(cmdPayload + 1, adjustedPowerLevel);
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, cmdPayload, sizeof(cmdPayload), nackReasonCode);
+    int result = rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_SET_MOTOR_CONSTANT_POWER,
+                                           cmdPayload, sizeof(cmdPayload), nackReasonCode);
+    if (result >= 0)
+    {
+        rhsp_frameSetMotorConstantPower(hub, motorChannel, powerLevel, adjustedPowerLevel, false);
+    }
+    return result;
 }
 
 int rhsp_getMotorConstantPower(RhspRevHub* hub,
@@ -283,7 +273,7 @@ int rhsp_getMotorConstantPower(RhspRevHub* hub,
                                double* powerLevel,
                                uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -294,13 +284,8 @@ int rhsp_getMotorConstantPower(RhspRevHub* hub,
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
 
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 16, &packetID, nackReasonCode);
-    if (result < 0)
-    {
-        return result;
-    }
-
-    result = rhsp_sendReadCommandInternal(hub, packetID, &motorChannel, sizeof(motorChannel), nackReasonCode);
+    int result = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_GET_MOTOR_CONSTANT_POWER,
+                                          &motorChannel, sizeof(motorChannel), &response, nackReasonCode);
     if (result < 0)
     {
         return result;
@@ -308,8 +293,7 @@ int rhsp_getMotorConstantPower(RhspRevHub* hub,
 
     if (powerLevel)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        int16_t rawPowerLevel = RHSP_ARRAY_WORD(int16_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        int16_t rawPowerLevel = rhsp_loadI16(response);
         *powerLevel = (rawPowerLevel * 1.0 / POWER_CONVERSION);
     }
 
@@ -321,8 +305,6 @@ int rhsp_setMotorTargetVelocity(RhspRevHub* hub,
                                 int16_t velocity,
                                 uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
@@ -331,19 +313,24 @@ int rhsp_setMotorTargetVelocity(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
-
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 17, &packetID, nackReasonCode);
-    if (result < 0)
+    if (rhsp_isOutputFrameOpen(hub))
     {
-        return result;
+        rhsp_frameSetMotorTargetVelocity(hub, motorChannel, velocity, true);
+        return RHSP_RESULT_OK;
     }
 
     uint8_t cmdPayload[3];
 
     RHSP_ARRAY_SET_BYTE(cmdPayload, 0, motorChannel);
-    RHSP_ARRAY_SET_WORD(cmdPayload, 1, velocity);
+    rhsp_storeU16(cmdPayload + 1, velocity);
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, cmdPayload, sizeof(cmdPayload), nackReasonCode);
+    int result = rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_SET_MOTOR_TARGET_VELOCITY,
+                                           cmdPayload, sizeof(cmdPayload), nackReasonCode);
+    if (result >= 0)
+    {
+        rhsp_frameSetMotorTargetVelocity(hub, motorChannel, velocity, false);
+    }
+    return result;
 }
 
 int rhsp_getMotorTargetVelocity(RhspRevHub* hub,
@@ -351,7 +338,7 @@ int rhsp_getMotorTargetVelocity(RhspRevHub* hub,
                                 int16_t* velocity,
                                 uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -362,13 +349,8 @@ int rhsp_getMotorTargetVelocity(RhspRevHub* hub,
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
 
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 18, &packetID, nackReasonCode);
-    if (result < 0)
-    {
-        return result;
-    }
-
-    result = rhsp_sendReadCommandInternal(hub, packetID, &motorChannel, sizeof(motorChannel), nackReasonCode);
+    int result = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_GET_MOTOR_TARGET_VELOCITY,
+                                          &motorChannel, sizeof(motorChannel), &response, nackReasonCode);
     if (result < 0)
     {
         return result;
@@ -376,8 +358,7 @@ int rhsp_getMotorTargetVelocity(RhspRevHub* hub,
 
     if (velocity)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *velocity = RHSP_ARRAY_WORD(int16_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *velocity = rhsp_loadI16(response);
     }
 
     return RHSP_RESULT_OK;
@@ -389,8 +370,6 @@ int rhsp_setMotorTargetPosition(RhspRevHub* hub,
                                 uint16_t targetTolerance,
                                 uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
@@ -399,20 +378,25 @@ int rhsp_setMotorTargetPosition(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
-
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 19, &packetID, nackReasonCode);
-    if (result < 0)
+    if (rhsp_isOutputFrameOpen(hub))
     {
-        return result;
+        rhsp_frameSetMotorTargetPosition(hub, motorChannel, targetPosition, targetTolerance, true);
+        return RHSP_RESULT_OK;
     }
 
     uint8_t cmdPayload[7];
 
     RHSP_ARRAY_SET_BYTE(cmdPayload, 0, motorChannel);
-    RHSP_ARRAY_SET_DWORD(cmdPayload, 1, targetPosition);
-    RHSP_ARRAY_SET_WORD(cmdPayload, 5, targetTolerance);
+    rhsp_storeU32(cmdPayload + 1, targetPosition);
+    rhsp_storeU16(cmdPayload + 5, targetTolerance);
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, cmdPayload, sizeof(cmdPayload), nackReasonCode);
+    int result = rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_SET_MOTOR_TARGET_POSITION,
+                                           cmdPayload, sizeof(cmdPayload), nackReasonCode);
+    if (result >= 0)
+    {
+        rhsp_frameSetMotorTargetPosition(hub, motorChannel, targetPosition, targetTolerance, false);
+    }
+    return result;
 }
 
 int rhsp_getMotorTargetPosition(RhspRevHub* hub,
@@ -421,7 +405,7 @@ int rhsp_getMotorTargetPosition(RhspRevHub* hub,
                                 uint16_t* targetTolerance,
                                 uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -432,28 +416,21 @@ int rhsp_getMotorTargetPosition(RhspRevHub* hub,
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
 
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 20, &packetID, nackReasonCode);
-    if (result < 0)
-    {
-        return result;
-    }
-
-    result = rhsp_sendReadCommandInternal(hub, packetID, &motorChannel, sizeof(motorChannel), nackReasonCode);
+    int result = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_GET_MOTOR_TARGET_POSITION,
+                                          &motorChannel, sizeof(motorChannel), &response, nackReasonCode);
     if (result < 0)
     {
         return result;
     }
 
-    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-    const uint8_t* rspPayload = RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer);
 
     if (targetPosition)
     {
-        *targetPosition = RHSP_ARRAY_DWORD(int32_t, rspPayload, 0);
+        *targetPosition = rhsp_loadI32(response);
     }
     if (targetTolerance)
     {
-        *targetTolerance = RHSP_ARRAY_WORD(uint16_t, rspPayload, 4);
+        *targetTolerance = rhsp_loadU16(response + 4);
     }
 
     return RHSP_RESULT_OK;
@@ -464,7 +441,7 @@ int rhsp_isMotorAtTarget(RhspRevHub* hub,
                          uint8_t* atTarget,
                          uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -474,24 +451,18 @@ int rhsp_isMotorAtTarget(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 21, &packetID, nackReasonCode);
-    if (result < 0)
-    {
-        return result;
-    }
 
-    result = rhsp_sendReadCommandInternal(hub, packetID, &motorChannel, sizeof(motorChannel), nackReasonCode);
+    int result = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_IS_MOTOR_AT_TARGET,
+                                          &motorChannel, sizeof(motorChannel), &response, nackReasonCode);
     if (result < 0)
     {
         return result;
     }
 
-    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-    const uint8_t* const rspPayload = RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer);
 
     if (atTarget)
     {
-        *atTarget = RHSP_ARRAY_BYTE(uint8_t, rspPayload, 0);
+        *atTarget = RHSP_ARRAY_BYTE(uint8_t, response, 0);
     }
 
     return RHSP_RESULT_OK;
@@ -502,7 +473,7 @@ int rhsp_getEncoderPosition(RhspRevHub* hub,
                             int32_t* currentPosition,
                             uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -513,13 +484,8 @@ int rhsp_getEncoderPosition(RhspRevHub* hub,
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
 
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 22, &packetID, nackReasonCode);
-    if (result < 0)
-    {
-        return result;
-    }
-
-    result = rhsp_sendReadCommandInternal(hub, packetID, &motorChannel, sizeof(motorChannel), nackReasonCode);
+    int result = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_GET_ENCODER_POSITION,
+                                          &motorChannel, sizeof(motorChannel), &response, nackReasonCode);
     if (result < 0)
     {
         return result;
@@ -527,8 +493,7 @@ int rhsp_getEncoderPosition(RhspRevHub* hub,
 
     if (currentPosition)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *currentPosition = RHSP_ARRAY_DWORD(int32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *currentPosition = rhsp_loadI32(response);
     }
 
     return RHSP_RESULT_OK;
@@ -540,8 +505,6 @@ int rhsp_setClosedLoopControlCoefficients(RhspRevHub* hub,
                                           ClosedLoopControlParameters* parameters,
                                           uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
@@ -554,14 +517,9 @@ int rhsp_setClosedLoopControlCoefficients(RhspRevHub* hub,
         return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
     }
 
-    int functionNumber = (parameters->type == LEGACY_PID_TAG) ? 23 : 51;
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", functionNumber, &packetID, nackReasonCode);
-    if (result < 0)
-    {
-        return result;
-    }
-
-    uint8_t cmdPayload[19];
+    RhspDekaCommand command = (parameters->type == LEGACY_PID_TAG) ? RHSP_DEKA_SET_PID_COEFFICIENTS
+                                                                   : RHSP_DEKA_SET_PIDF_COEFFICIENTS;
+    uint8_t cmdPayload[19] = {0};
 
     RHSP_ARRAY_SET_BYTE(cmdPayload, 0, motorChannel);
     RHSP_ARRAY_SET_BYTE(cmdPayload, 1, mode);
@@ -572,9 +530,9 @@ int rhsp_setClosedLoopControlCoefficients(RhspRevHub* hub,
         int32_t i = (int) round(parameters->pid.i * CLOSED_LOOP_COEFF_CONVERSION);
         int32_t d = (int) round(parameters->pid.d * CLOSED_LOOP_COEFF_CONVERSION);
 
-        RHSP_ARRAY_SET_DWORD(cmdPayload, 2, p);
-        RHSP_ARRAY_SET_DWORD(cmdPayload, 6, i);
-        RHSP_ARRAY_SET_DWORD(cmdPayload, 10, d);
+        rhsp_storeU32(cmdPayload + 2, p);
+        rhsp_storeU32(cmdPayload + 6, i);
+        rhsp_storeU32(cmdPayload + 10, d);
     } else if (parameters->type == PIDF_TAG)
     {
         int32_t p = (int) round(parameters->pidf.p * CLOSED_LOOP_COEFF_CONVERSION);
@@ -582,14 +540,15 @@ int rhsp_setClosedLoopControlCoefficients(RhspRevHub* hub,
         int32_t d = (int) round(parameters->pidf.d * CLOSED_LOOP_COEFF_CONVERSION);
         int32_t f = (int) round(parameters->pidf.f * CLOSED_LOOP_COEFF_CONVERSION);
 
-        RHSP_ARRAY_SET_DWORD(cmdPayload, 2, p);
-        RHSP_ARRAY_SET_DWORD(cmdPayload, 6, i);
-        RHSP_ARRAY_SET_DWORD(cmdPayload, 10, d);
-        RHSP_ARRAY_SET_DWORD(cmdPayload, 14, f);
+        rhsp_storeU32(cmdPayload + 2, p);
+        rhsp_storeU32(cmdPayload + 6, i);
+        rhsp_storeU32(cmdPayload + 10, d);
+        rhsp_storeU32(cmdPayload + 14, f);
         RHSP_ARRAY_SET_BYTE(cmdPayload, 18, PIDF_TAG); //1 is PIDF
     }
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, cmdPayload, sizeof(cmdPayload), nackReasonCode);
+    rhsp_invalidateCachedQuery(hub, RHSP_CACHED_QUERY_CLOSED_LOOP_COEFFICIENTS);
+    return rhsp_sendDekaWriteCommand(hub, command, cmdPayload, sizeof(cmdPayload), nackReasonCode);
 }
 
 int rhsp_getClosedLoopControlCoefficients(RhspRevHub* hub,
@@ -598,7 +557,7 @@ int rhsp_getClosedLoopControlCoefficients(RhspRevHub* hub,
                                           ClosedLoopControlParameters* parameters,
                                           uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -616,13 +575,15 @@ int rhsp_getClosedLoopControlCoefficients(RhspRevHub* hub,
     // First try PIDF, then try PID if PIDF is
     // not supported.
     int supportsPidf = 1;
-    int result = rhsp_getInterfacePacketID(hub, "DEKA", 53, &packetID, nackReasonCode);
+    RhspDekaCommand command = RHSP_DEKA_GET_PIDF_COEFFICIENTS;
+    int result = rhsp_getDekaPacketID(hub, command, NULL, nackReasonCode);
 
     if (result < 0)
     {
         // PIDF is not supported. Try PID.
         supportsPidf = 0;
-        result = rhsp_getInterfacePacketID(hub, "DEKA", 24, &packetID, nackReasonCode);
+        command = RHSP_DEKA_GET_PID_COEFFICIENTS;
+        result = rhsp_getDekaPacketID(hub, command, NULL, nackReasonCode);
         if (result < 0)
         {
             // Neither PID mode is supported. Error.
@@ -632,26 +593,24 @@ int rhsp_getClosedLoopControlCoefficients(RhspRevHub* hub,
 
     uint8_t cmdPayload[2] = {motorChannel, mode};
 
-    result = rhsp_sendReadCommandInternal(hub, packetID, cmdPayload, sizeof(cmdPayload), nackReasonCode);
+    result = rhsp_sendDekaCachedReadCommand(hub, RHSP_CACHED_QUERY_CLOSED_LOOP_COEFFICIENTS, command,
+                                            cmdPayload, sizeof(cmdPayload), &response, nackReasonCode);
     if (result < 0)
     {
         return result;
     }
 
-    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-    const uint8_t* rspPayload = RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer);
-
     if (parameters)
     {
-        int32_t p = RHSP_ARRAY_DWORD(int32_t, rspPayload, 0);
-        int32_t i = RHSP_ARRAY_DWORD(int32_t, rspPayload, 4);
-        int32_t d = RHSP_ARRAY_DWORD(int32_t, rspPayload, 8);
+        int32_t p = rhsp_loadI32(response);
+        int32_t i = rhsp_loadI32(response + 4);
+        int32_t d = rhsp_loadI32(response + 8);
 
         int usingPidf = supportsPidf;
 
         if (supportsPidf)
         {
-            uint8_t pidMode = RHSP_ARRAY_BYTE(uint8_t, rspPayload, 16);
+            uint8_t pidMode = RHSP_ARRAY_BYTE(uint8_t, response, 16);
 
             // we support PIDF, but we're currently using the legacy PID.
             if (pidMode == LEGACY_PID_TAG)
@@ -662,7 +621,7 @@ int rhsp_getClosedLoopControlCoefficients(RhspRevHub* hub,
 
         if (usingPidf)
         {
-            int32_t f = RHSP_ARRAY_DWORD(int32_t, rspPayload, 12);
+            int32_t f = rhsp_loadI32(response + 12);
             parameters->type = PIDF_TAG;
             parameters->pidf.p = p * 1.0 / CLOSED_LOOP_COEFF_CONVERSION;
             parameters->pidf.i = i * 1.0 / CLOSED_LOOP_COEFF_CONVERSION;
@@ -1,6 +1,8 @@
 
 #include <memory.h>
 #include "internal/packet.h"
+#include "internal/linkStats.h"
+#include "internal/revhub.h"
 #include "rhsp/revhub.h"
 #include "rhsp/compiler.h"
 #include "rhsp/time.h"
@@ -29,18 +31,32 @@ static int serialWrite(RhspSerial* serialPort, const uint8_t* buffer, size_t byt
     return (int) bytes_written;
 }
 
-static int serialRead(RhspSerial* serialPort, uint8_t* buffer, size_t bytesToRead)
+static int serialRead(RhspRevHubInternal* hub, uint8_t* buffer, size_t bytesToRead)
 {
-    int retval = rhsp_serialRead(serialPort, buffer, bytesToRead);
+    int retval = rhsp_serialRead(hub->serialPort, buffer, bytesToRead);
+    if (retval > 0)
+    {
+        RHSP_LINK_STATS_ADD(hub, bytesReceived, (uint32_t) retval);
+    }
     return (retval < 0) ? RHSP_ERROR_SERIALPORT : retval;
 }
 
-void serialPurgeRxBuffer(RhspSerial* serialPort)
+// the receiver drops a partial frame and waits for the next sync bytes
+static void resync(RhspRevHubInternal* hub, size_t discardedBytes)
+{
+    RHSP_LINK_STATS_ADD(hub, resyncs, 1);
+    RHSP_LINK_STATS_ADD(hub, discardedBytes, (uint32_t) discardedBytes);
+    hub->rxState = RHSP_RX_STATES_FIRST_BYTE;
+}
+
+void serialPurgeRxBuffer(RhspRevHubInternal* hub)
 {
     uint8_t buffer[64];
+    int bytesRead;
     // read out rx buffer until becomes empty
-    while (serialRead(serialPort, buffer, sizeof(buffer)) > 0)
+    while ((bytesRead = serialRead(hub, buffer, sizeof(buffer))) > 0)
     {
+        RHSP_LINK_STATS_ADD(hub, discardedBytes, (uint32_t) bytesRead);
     }
 }
 
@@ -67,30 +83,39 @@ static int parse(RhspRevHubInternal* hub)
     switch (hub->rxState)
     {
         case RHSP_RX_STATES_FIRST_BYTE:
-            bytesTransferred = serialRead(hub->serialPort, &hub->rxBuffer[0], 1);
+            bytesTransferred = serialRead(hub, &hub->rxBuffer[0], 1);
             if (bytesTransferred < 0)
             {
                 return bytesTransferred;
             }
             // @TODO First and second bytes should be replaced by macro like RHSP_PACKET_FIRST_BYTE
-            if (bytesTransferred != 1 || hub->rxBuffer[0] != 0x44)
+            if (bytesTransferred != 1)
             {
                 break;
             }
+            if (hub->rxBuffer[0] != 0x44)
+            {
+                RHSP_LINK_STATS_ADD(hub, discardedBytes, 1);
+                break;
+            }
             hub->rxState = RHSP_RX_STATES_SECOND_BYTE;
             // fall through
             // break;
 
         case RHSP_RX_STATES_SECOND_BYTE:
-            bytesTransferred = serialRead(hub->serialPort, &hub->rxBuffer[1], 1);
+            bytesTransferred = serialRead(hub, &hub->rxBuffer[1], 1);
             if (bytesTransferred < 0)
             {
                 return bytesTransferred;
             }
 
-            if (bytesTransferred != 1 || hub->rxBuffer[1] != 0x4B)
+            if (bytesTransferred != 1)
             {
-                hub->rxState = RHSP_RX_STATES_FIRST_BYTE;
+                break;
+            }
+            if (hub->rxBuffer[1] != 0x4B)
+            {
+                resync(hub, 2);
                 break;
             }
             hub->receivedBytes = 2;
@@ -102,7 +127,7 @@ static int parse(RhspRevHubInternal* hub)
             //break;
 
         case RHSP_RX_STATES_HEADER:
-            bytesTransferred = serialRead(hub->serialPort, &hub->rxBuffer[hub->receivedBytes], hub->bytesToReceive);
+            bytesTransferred = serialRead(hub, &hub->rxBuffer[hub->receivedBytes], hub->bytesToReceive);
             if (bytesTransferred < 0)
             {
                 return bytesTransferred;
@@ -120,7 +145,7 @@ static int parse(RhspRevHubInternal* hub)
             if (packetLength < RHSP_PACKET_HEADER_SIZE + RHSP_PACKET_CRC_SIZE ||
                 packetLength > RHSP_BUFFER_SIZE)
             {
-                hub->rxState = RHSP_RX_STATES_FIRST_BYTE;
+                resync(hub, hub->receivedBytes);
                 break;
             }
 
@@ -137,7 +162,7 @@ static int parse(RhspRevHubInternal* hub)
             break;
 
         case RHSP_RX_STATES_PAYLOAD:
-            bytesTransferred = serialRead(hub->serialPort, &hub->rxBuffer[hub->receivedBytes], hub->bytesToReceive);
+            bytesTransferred = serialRead(hub, &hub->rxBuffer[hub->receivedBytes], hub->bytesToReceive);
             if (bytesTransferred < 0)
             {
                 return bytesTransferred;
@@ -154,7 +179,7 @@ static int parse(RhspRevHubInternal* hub)
             // fall through
             // break;
         case RHSP_RX_STATES_CRC:
-            bytesTransferred = serialRead(hub->serialPort, &hub->rxBuffer[hub->receivedBytes], hub->bytesToReceive);
+            bytesTransferred = serialRead(hub, &hub->rxBuffer[hub->receivedBytes], hub->bytesToReceive);
             if (bytesTransferred < 0)
             {
                 return bytesTransferred;
@@ -168,9 +193,14 @@ static int parse(RhspRevHubInternal* hub)
             }
             if (calcChecksum(hub->rxBuffer, hub->receivedBytes) == hub->rxBuffer[hub->receivedBytes])
             {
+                RHSP_LINK_STATS_ADD(hub, framesReceived, 1);
                 retval = 1;
+                hub->rxState = RHSP_RX_STATES_FIRST_BYTE;
+            } else
+            {
+                RHSP_LINK_STATS_ADD(hub, checksumErrors, 1);
+                resync(hub, hub->receivedBytes + RHSP_PACKET_CRC_SIZE);
             }
-            hub->rxState = RHSP_RX_STATES_FIRST_BYTE;
             break;
         default:
             /* Normally we don't reach the default section */
@@ -179,6 +209,47 @@ static int parse(RhspRevHubInternal* hub)
     return retval;
 }
 
+uint8_t nextMessageNumber(RhspRevHubInternal* hub)
+{
+    RhspSerial* serialPort = hub->serialPort;
+    if (!serialPort)
+    {
+        return 1;
+    }
+    // zero is not a valid message number
+    serialPort->messageNumber++;
+    if (serialPort->messageNumber == 0)
+    {
+        serialPort->messageNumber = 1;
+    }
+    // the number is reused, so an old command with it can no longer be answered
+    takeStaleMessage(hub, serialPort->messageNumber);
+    return serialPort->messageNumber;
+}
+
+void markMessageStale(RhspRevHubInternal* hub, uint8_t messageNumber)
+{
+    if (hub->serialPort && messageNumber != 0)
+    {
+        hub->serialPort->staleMessageNumbers[messageNumber % RHSP_SERIAL_STALE_MESSAGE_SLOTS] = messageNumber;
+    }
+}
+
+bool takeStaleMessage(RhspRevHubInternal* hub, uint8_t messageNumber)
+{
+    if (!hub->serialPort || messageNumber == 0)
+    {
+        return false;
+    }
+    uint8_t* slot = &hub->serialPort->staleMessageNumbers[messageNumber % RHSP_SERIAL_STALE_MESSAGE_SLOTS];
+    if (*slot != messageNumber)
+    {
+        return false;
+    }
+    *slot = 0;
+    return true;
+}
+
 int sendPacket(RhspRevHubInternal* hub,
                uint8_t destAddr,
                uint8_t messageNumber,
@@ -211,6 +282,8 @@ int sendPacket(RhspRevHubInternal* hub,
     int retval = serialWrite(hub->serialPort, hub->txBuffer, bytesToSend);
     if (retval >= 0)
     {
+        RHSP_LINK_STATS_ADD(hub, framesSent, 1);
+        RHSP_LINK_STATS_ADD(hub, bytesSent, bytesToSend);
         // normally serial write always write whole buffer and an assert is enough to check whether we send whole buffer
         rhsp_assert(retval == (int) bytesToSend);
     }
@@ -226,6 +299,11 @@ int sendPacket(RhspRevHubInternal* hub,
  *
  * */
 int receivePacket(RhspRevHubInternal* hub)
+{
+    return receivePacketWithTimeout(hub, hub->responseTimeoutMs);
+}
+
+int receivePacketWithTimeout(RhspRevHubInternal* hub, uint32_t timeoutMs)
 {
     int parseResult;
     int retval = RHSP_RESULT_OK;
@@ -237,10 +315,11 @@ int receivePacket(RhspRevHubInternal* hub)
     while ((parseResult = parse(hub)) == 0)
     {
         /* process timeout*/
-        if (rhsp_getSteadyClockMs() - responseTimeoutMsTimestamp >= hub->responseTimeoutMs &&
-            hub->responseTimeoutMs != 0)
+        if (rhsp_getSteadyClockMs() - responseTimeoutMsTimestamp >= timeoutMs &&
+            timeoutMs != 0)
         {
             /* no response is received. return timeout error. */
+            RHSP_LINK_STATS_ADD(hub, timeouts, 1);
             retval = RHSP_ERROR_RESPONSE_TIMEOUT;
             break;
         }
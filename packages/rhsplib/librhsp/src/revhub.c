@@ -1,8 +1,11 @@
 #include <memory.h>
 #include <stdlib.h>
 #include "rhsp/revhub.h"
+#include "rhsp/cache.h"
+#include "internal/encoder.h"
 #include "internal/module.h"
 #include "internal/revhub.h"
+#include "internal/frame.h"
 
 #define RHSP_DEFAULT_DST_ADDRESS            1    // default destination address
 
@@ -22,9 +25,15 @@ int rhsp_open(RhspRevHub* hub, RhspSerial* serialPort, uint8_t destAddress)
 RhspRevHub* rhsp_allocRevHub(RhspSerial* serialPort, uint8_t destAddress)
 {
     RhspRevHubInternal* hub = malloc(sizeof(RhspRevHubInternal));
-    hub->messageNumber = 1;
+    if (!hub)
+    {
+        return NULL;
+    }
+    memset(hub, 0, sizeof(RhspRevHubInternal));
     hub->address = RHSP_DEFAULT_DST_ADDRESS;
     hub->responseTimeoutMs = RHSP_RESPONSE_TIMEOUT_MS;
+    hub->readRetryLimit = RHSP_READ_RETRY_LIMIT;
+    rhsp_initEncoderHistory((RhspRevHub*) hub);
 
     rhsp_open((RhspRevHub*) hub, serialPort, destAddress);
 
@@ -37,6 +46,11 @@ void freeRevHub(RhspRevHub* hub)
     free(hub);
 }
 
+size_t rhsp_revHubSize(void)
+{
+    return sizeof(RhspRevHubInternal);
+}
+
 bool rhsp_isOpened(const RhspRevHub* hub)
 {
     if (!hub)
@@ -55,7 +69,11 @@ void rhsp_close(RhspRevHub* hub)
     }
     RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
     // add closure logic if it's needed
+    rhsp_stopPublishingTelemetry(hub);
     internalHub->serialPort = NULL;
+    rhsp_clearQueryCache(hub);
+    memset(&internalHub->outputFrame, 0, sizeof(internalHub->outputFrame));
+    rhsp_clearEncoderHistory(hub);
     RhspModuleInterfaceListInternal* list = (RhspModuleInterfaceListInternal*) internalHub->interfaceList;
     if (list)
     {
@@ -65,6 +83,8 @@ void rhsp_close(RhspRevHub* hub)
         }
     }
     free(list);
+    internalHub->interfaceList = NULL;
+    rhsp_clearDekaPacketIDs(hub);
 }
 
 void rhsp_setDestinationAddress(RhspRevHub* hub, uint8_t dstAddress)
@@ -74,6 +94,12 @@ void rhsp_setDestinationAddress(RhspRevHub* hub, uint8_t dstAddress)
         return;
     }
     RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    if (internalHub->address != dstAddress)
+    {
+        rhsp_clearQueryCache(hub);
+        rhsp_forgetOutputState(hub);
+        rhsp_clearEncoderHistory(hub);
+    }
     internalHub->address = dstAddress;
 }
 
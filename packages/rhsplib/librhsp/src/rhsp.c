@@ -10,8 +10,11 @@
 #include "internal/arrayutils.h"
 #include "internal/command.h"
 #include "internal/packet.h"
+#include "internal/frame.h"
 
 #define RHSP_BROADCAST_ADDRESS              0xFF
+#define RHSP_STATUS_STATE_LOST_MASK         0x07 // keep alive timeout, device reset and fail safe bits of status word
+#define RHSP_STATUS_DEVICE_RESET_MASK       0x02
 
 int rhsp_setResponseTimeoutMs(RhspRevHub* hub, uint32_t responseTimeoutMs)
 {
@@ -35,6 +38,28 @@ uint32_t rhsp_responseTimeoutMs(const RhspRevHub* hub)
     return internalHub->responseTimeoutMs;
 }
 
+int rhsp_setReadRetryLimit(RhspRevHub* hub, uint8_t retries)
+{
+    if (!hub)
+    {
+        return RHSP_ERROR;
+    }
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    internalHub->readRetryLimit = retries;
+
+    return RHSP_RESULT_OK;
+}
+
+uint8_t rhsp_readRetryLimit(const RhspRevHub* hub)
+{
+    if (!hub)
+    {
+        return 0;
+    }
+    const RhspRevHubInternal* internalHub = (const RhspRevHubInternal*) hub;
+    return internalHub->readRetryLimit;
+}
+
 int rhsp_getModuleStatus(RhspRevHub* hub,
                          uint8_t clearStatusAfterResponse,
                          RhspModuleStatus* status,
@@ -49,19 +74,35 @@ int rhsp_getModuleStatus(RhspRevHub* hub,
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
 
-    int result = rhsp_sendReadCommandInternal(hub, 0x7F03,
-                                              &clearStatusAfterResponse, sizeof(clearStatusAfterResponse),
-                                              nackReasonCode);
+    // clearing the status is not idempotent, so such a query is never repeated
+    int result = clearStatusAfterResponse
+                 ? rhsp_sendReadCommandOnceInternal(hub, 0x7F03,
+                                                    &clearStatusAfterResponse, sizeof(clearStatusAfterResponse),
+                                                    nackReasonCode)
+                 : rhsp_sendReadCommandInternal(hub, 0x7F03,
+                                                &clearStatusAfterResponse, sizeof(clearStatusAfterResponse),
+                                                nackReasonCode);
     if (result < 0)
     {
         return result;
     }
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    const uint8_t* payload = RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer);
+    if (RHSP_ARRAY_BYTE(uint8_t, payload, 0) & RHSP_STATUS_STATE_LOST_MASK)
+    {
+        rhsp_clearQueryCache(hub);
+        rhsp_forgetOutputState(hub);
+    }
+    if (RHSP_ARRAY_BYTE(uint8_t, payload, 0) & RHSP_STATUS_DEVICE_RESET_MASK)
+    {
+        // encoder counts restarted from zero
+        rhsp_clearEncoderHistory(hub);
+    }
+    RhspModuleStatus receivedStatus = {RHSP_ARRAY_BYTE(uint8_t, payload, 0), RHSP_ARRAY_BYTE(uint8_t, payload, 1)};
+    rhsp_publishModuleStatus(hub, &receivedStatus, rhsp_getSteadyClockUs());
     if (status)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        const uint8_t* payload = RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer);
-        status->statusWord = RHSP_ARRAY_BYTE(uint8_t, payload, 0);
-        status->motorAlerts = RHSP_ARRAY_BYTE(uint8_t, payload, 1);
+        *status = receivedStatus;
     }
     return RHSP_RESULT_OK;
 }
@@ -75,12 +116,41 @@ int rhsp_sendKeepAlive(RhspRevHub* hub, uint8_t* nackReasonCode)
     return rhsp_sendWriteCommandInternal(hub, 0x7F04, NULL, 0, nackReasonCode);
 }
 
+int rhsp_sendKeepAliveIfIdle(RhspRevHub* hub, uint32_t idleTimeMs, uint8_t* nackReasonCode)
+{
+    if (!hub)
+    {
+        return RHSP_ERROR;
+    }
+    if (rhsp_idleTimeMs(hub) < idleTimeMs)
+    {
+        return RHSP_RESULT_OK;
+    }
+    return rhsp_sendKeepAlive(hub, nackReasonCode);
+}
+
+uint32_t rhsp_idleTimeMs(const RhspRevHub* hub)
+{
+    if (!hub)
+    {
+        return UINT32_MAX;
+    }
+    const RhspRevHubInternal* internalHub = (const RhspRevHubInternal*) hub;
+    if (!internalHub->hasTransmitted)
+    {
+        return UINT32_MAX;
+    }
+    return rhsp_getSteadyClockMs() - internalHub->lastTransmitTimestampMs;
+}
+
 int rhsp_sendFailSafe(RhspRevHub* hub, uint8_t* nackReasonCode)
 {
     if (!hub)
     {
         return RHSP_ERROR;
     }
+    rhsp_clearQueryCache(hub);
+    rhsp_forgetOutputState(hub);
     return rhsp_sendWriteCommandInternal(hub, 0x7F05, NULL, 0, nackReasonCode);
 }
 
@@ -94,6 +164,8 @@ int rhsp_setNewModuleAddress(RhspRevHub* hub, uint8_t newModuleAddress, uint8_t*
     {
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
+    rhsp_clearQueryCache(hub);
+    rhsp_forgetOutputState(hub);
     int result = rhsp_sendWriteCommandInternal(hub, 0x7F06, &newModuleAddress, sizeof(newModuleAddress),
                                          nackReasonCode);
 
@@ -155,24 +227,25 @@ int rhsp_setModuleLedPattern(RhspRevHub* hub, const RhspLedPattern* ledPattern,
     {
         return RHSP_ERROR;
     }
-    uint32_t buffer[16];
-    buffer[0] = ledPattern->rgbtPatternStep0;
-    buffer[1] = ledPattern->rgbtPatternStep1;
-    buffer[2] = ledPattern->rgbtPatternStep2;
-    buffer[3] = ledPattern->rgbtPatternStep3;
-    buffer[4] = ledPattern->rgbtPatternStep4;
-    buffer[5] = ledPattern->rgbtPatternStep5;
-    buffer[6] = ledPattern->rgbtPatternStep6;
-    buffer[7] = ledPattern->rgbtPatternStep7;
-    buffer[8] = ledPattern->rgbtPatternStep8;
-    buffer[9] = ledPattern->rgbtPatternStep9;
-    buffer[10] = ledPattern->rgbtPatternStep10;
-    buffer[11] = ledPattern->rgbtPatternStep11;
-    buffer[12] = ledPattern->rgbtPatternStep12;
-    buffer[13] = ledPattern->rgbtPatternStep13;
-    buffer[14] = ledPattern->rgbtPatternStep14;
-    buffer[15] = ledPattern->rgbtPatternStep15;
-    return rhsp_sendWriteCommandInternal(hub, 0x7F0C, (const uint8_t*) buffer, sizeof(buffer), nackReasonCode);
+    // steps are sent little-endian regardless of the host byte order
+    uint8_t buffer[64];
+    rhsp_storeU32(buffer, ledPattern->rgbtPatternStep0);
+    rhsp_storeU32(buffer + 4, ledPattern->rgbtPatternStep1);
+    rhsp_storeU32(buffer + 8, ledPattern->rgbtPatternStep2);
+    rhsp_storeU32(buffer + 12, ledPattern->rgbtPatternStep3);
+    rhsp_storeU32(buffer + 16, ledPattern->rgbtPatternStep4);
+    rhsp_storeU32(buffer + 20, ledPattern->rgbtPatternStep5);
+    rhsp_storeU32(buffer + 24, ledPattern->rgbtPatternStep6);
+    rhsp_storeU32(buffer + 28, ledPattern->rgbtPatternStep7);
+    rhsp_storeU32(buffer + 32, ledPattern->rgbtPatternStep8);
+    rhsp_storeU32(buffer + 36, ledPattern->rgbtPatternStep9);
+    rhsp_storeU32(buffer + 40, ledPattern->rgbtPatternStep10);
+    rhsp_storeU32(buffer + 44, ledPattern->rgbtPatternStep11);
+    rhsp_storeU32(buffer + 48, ledPattern->rgbtPatternStep12);
+    rhsp_storeU32(buffer + 52, ledPattern->rgbtPatternStep13);
+    rhsp_storeU32(buffer + 56, ledPattern->rgbtPatternStep14);
+    rhsp_storeU32(buffer + 60, ledPattern->rgbtPatternStep15);
+    return rhsp_sendWriteCommandInternal(hub, 0x7F0C, buffer, sizeof(buffer), nackReasonCode);
 }
 
 int rhsp_getModuleLedPattern(RhspRevHub* hub, RhspLedPattern* ledPattern, uint8_t* nackReasonCode)
@@ -189,22 +262,23 @@ int rhsp_getModuleLedPattern(RhspRevHub* hub, RhspLedPattern* ledPattern, uint8_
     if (ledPattern)
     {
         RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        ledPattern->rgbtPatternStep0 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
-        ledPattern->rgbtPatternStep1 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 4);
-        ledPattern->rgbtPatternStep2 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 8);
-        ledPattern->rgbtPatternStep3 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 12);
-        ledPattern->rgbtPatternStep4 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 16);
-        ledPattern->rgbtPatternStep5 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 20);
-        ledPattern->rgbtPatternStep6 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 24);
-        ledPattern->rgbtPatternStep7 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 28);
-        ledPattern->rgbtPatternStep8 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 32);
-        ledPattern->rgbtPatternStep9 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 36);
-        ledPattern->rgbtPatternStep10 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 40);
-        ledPattern->rgbtPatternStep11 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 44);
-        ledPattern->rgbtPatternStep12 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 48);
-        ledPattern->rgbtPatternStep13 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 52);
-        ledPattern->rgbtPatternStep14 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 56);
-        ledPattern->rgbtPatternStep15 = RHSP_ARRAY_DWORD(uint32_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 60);
+        const uint8_t* payload = RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer);
+        ledPattern->rgbtPatternStep0 = rhsp_loadU32(payload);
+        ledPattern->rgbtPatternStep1 = rhsp_loadU32(payload + 4);
+        ledPattern->rgbtPatternStep2 = rhsp_loadU32(payload + 8);
+        ledPattern->rgbtPatternStep3 = rhsp_loadU32(payload + 12);
+        ledPattern->rgbtPatternStep4 = rhsp_loadU32(payload + 16);
+        ledPattern->rgbtPatternStep5 = rhsp_loadU32(payload + 20);
+        ledPattern->rgbtPatternStep6 = rhsp_loadU32(payload + 24);
+        ledPattern->rgbtPatternStep7 = rhsp_loadU32(payload + 28);
+        ledPattern->rgbtPatternStep8 = rhsp_loadU32(payload + 32);
+        ledPattern->rgbtPatternStep9 = rhsp_loadU32(payload + 36);
+        ledPattern->rgbtPatternStep10 = rhsp_loadU32(payload + 40);
+        ledPattern->rgbtPatternStep11 = rhsp_loadU32(payload + 44);
+        ledPattern->rgbtPatternStep12 = rhsp_loadU32(payload + 48);
+        ledPattern->rgbtPatternStep13 = rhsp_loadU32(payload + 52);
+        ledPattern->rgbtPatternStep14 = rhsp_loadU32(payload + 56);
+        ledPattern->rgbtPatternStep15 = rhsp_loadU32(payload + 60);
     }
 
     return RHSP_RESULT_OK;
@@ -253,7 +327,7 @@ int rhsp_discoverRevHubs(RhspSerial* serialPort, RhspDiscoveredAddresses* discov
     memset(discoveredAddresses, 0, sizeof(*discoveredAddresses));
 
     // Purge receive buffers to avoid unexpected responses from previous commands
-    serialPurgeRxBuffer(module->serialPort);
+    serialPurgeRxBuffer(module);
 
     /* send discovery message and wait for parent and children responses
      *
@@ -262,7 +336,7 @@ int rhsp_discoverRevHubs(RhspSerial* serialPort, RhspDiscoveredAddresses* discov
      * (timeout means "end of discovery")
      *
      * */
-    int result = sendPacket(module, RHSP_BROADCAST_ADDRESS, module->messageNumber, 0, 0x7F0F, NULL, 0);
+    int result = sendPacket(module, RHSP_BROADCAST_ADDRESS, nextMessageNumber(module), 0, 0x7F0F, NULL, 0);
     if (result < 0)
     {
         rhsp_close((RhspRevHub*) module);
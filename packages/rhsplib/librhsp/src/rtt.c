@@ -0,0 +1,148 @@
+/*
+ * rtt.c
+ *
+ * Adaptive response timeouts derived from the measured round trip time of each packet type.
+ */
+#include <string.h>
+
+#include "rhsp/rhsp.h"
+#include "internal/revhub.h"
+#include "internal/rtt.h"
+
+#define RHSP_RTT_MIN_SAMPLES        8     // the configured timeout is used until this many responses are measured
+#define RHSP_RTT_CLOCK_GRANULARITY_US 1000
+#define RHSP_RTT_MAX_BACKOFF        8
+
+static RhspRttEntry* findEntry(const RhspRttEstimator* rtt, uint16_t packetTypeID)
+{
+    for (int i = 0; i < RHSP_RTT_TABLE_SIZE; i++)
+    {
+        if (rtt->entries[i].packetID == packetTypeID)
+        {
+            return (RhspRttEntry*) &rtt->entries[i];
+        }
+    }
+    return NULL;
+}
+
+static RhspRttEntry* allocEntry(RhspRttEstimator* rtt, uint16_t packetTypeID)
+{
+    RhspRttEntry* entry = NULL;
+    for (int i = 0; i < RHSP_RTT_TABLE_SIZE; i++)
+    {
+        if (rtt->entries[i].packetID == 0)
+        {
+            entry = &rtt->entries[i];
+            break;
+        }
+    }
+    if (!entry)
+    {
+        entry = &rtt->entries[rtt->nextEviction];
+        rtt->nextEviction = (uint8_t) ((rtt->nextEviction + 1) % RHSP_RTT_TABLE_SIZE);
+    }
+    memset(entry, 0, sizeof(*entry));
+    entry->packetID = packetTypeID;
+    return entry;
+}
+
+static uint32_t entryTimeoutMs(const RhspRttEntry* entry, uint32_t maxTimeoutMs)
+{
+    uint32_t variationUs = 4 * entry->rttVariationUs;
+    if (variationUs < RHSP_RTT_CLOCK_GRANULARITY_US)
+    {
+        variationUs = RHSP_RTT_CLOCK_GRANULARITY_US;
+    }
+    // round up and add a millisecond because the timeout is checked against a millisecond clock
+    uint64_t timeoutMs = (entry->smoothedRttUs + variationUs + 999) / 1000 + 1;
+    timeoutMs <<= entry->backoff;
+    if (timeoutMs < RHSP_ADAPTIVE_RESPONSE_TIMEOUT_MIN_MS)
+    {
+        timeoutMs = RHSP_ADAPTIVE_RESPONSE_TIMEOUT_MIN_MS;
+    }
+    return (timeoutMs < maxTimeoutMs) ? (uint32_t) timeoutMs : maxTimeoutMs;
+}
+
+void rhsp_rttAddSample(RhspRevHub* hub, uint16_t packetTypeID, uint32_t rttUs)
+{
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    if (!internalHub->rtt.enabled)
+    {
+        return;
+    }
+    RhspRttEntry* entry = findEntry(&internalHub->rtt, packetTypeID);
+    if (!entry)
+    {
+        entry = allocEntry(&internalHub->rtt, packetTypeID);
+    }
+
+    if (entry->samples == 0)
+    {
+        entry->smoothedRttUs = rttUs;
+        entry->rttVariationUs = rttUs / 2;
+    } else
+    {
+        uint32_t error = (rttUs > entry->smoothedRttUs) ? rttUs - entry->smoothedRttUs : entry->smoothedRttUs - rttUs;
+        entry->rttVariationUs = entry->rttVariationUs - entry->rttVariationUs / 4 + error / 4;
+        entry->smoothedRttUs = entry->smoothedRttUs - entry->smoothedRttUs / 8 + rttUs / 8;
+    }
+    if (entry->samples < RHSP_RTT_MIN_SAMPLES)
+    {
+        entry->samples++;
+    }
+    entry->backoff = 0;
+}
+
+void rhsp_rttOnTimeout(RhspRevHub* hub, uint16_t packetTypeID)
+{
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    RhspRttEntry* entry = findEntry(&internalHub->rtt, packetTypeID);
+    if (entry && entry->backoff < RHSP_RTT_MAX_BACKOFF)
+    {
+        entry->backoff++;
+    }
+}
+
+int rhsp_setAdaptiveResponseTimeout(RhspRevHub* hub, bool enabled)
+{
+    if (!hub)
+    {
+        return RHSP_ERROR;
+    }
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    if (internalHub->rtt.enabled != enabled)
+    {
+        memset(&internalHub->rtt, 0, sizeof(internalHub->rtt));
+        internalHub->rtt.enabled = enabled;
+    }
+    return RHSP_RESULT_OK;
+}
+
+bool rhsp_isAdaptiveResponseTimeoutEnabled(const RhspRevHub* hub)
+{
+    if (!hub)
+    {
+        return false;
+    }
+    return ((const RhspRevHubInternal*) hub)->rtt.enabled;
+}
+
+uint32_t rhsp_commandResponseTimeoutMs(const RhspRevHub* hub, uint16_t packetTypeID)
+{
+    if (!hub)
+    {
+        return 0;
+    }
+    const RhspRevHubInternal* internalHub = (const RhspRevHubInternal*) hub;
+    // an infinite timeout is never shortened
+    if (!internalHub->rtt.enabled || internalHub->responseTimeoutMs == 0)
+    {
+        return internalHub->responseTimeoutMs;
+    }
+    const RhspRttEntry* entry = findEntry(&internalHub->rtt, packetTypeID);
+    if (!entry || entry->samples < RHSP_RTT_MIN_SAMPLES)
+    {
+        return internalHub->responseTimeoutMs;
+    }
+    return entryTimeoutMs(entry, internalHub->responseTimeoutMs);
+}
@@ -8,6 +8,9 @@
 #include "internal/arrayutils.h"
 #include "internal/packet.h"
 #include "internal/command.h"
+#include "internal/dekaCommands.h"
+#include "internal/cache.h"
+#include "internal/frame.h"
 #include "rhsp/module.h"
 
 #define RHSP_NUMBER_OF_SERVO_CHANNELS 6
@@ -17,7 +20,6 @@ int rhsp_setServoConfiguration(RhspRevHub* hub,
                                uint16_t framePeriod,
                                uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
     if (!hub)
     {
         return RHSP_ERROR;
@@ -30,17 +32,12 @@ int rhsp_setServoConfiguration(RhspRevHub* hub,
         return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 31, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
     uint8_t buffer[3];
     RHSP_ARRAY_SET_BYTE(buffer, 0, servoChannel);
-    RHSP_ARRAY_SET_WORD(buffer, 1, framePeriod);
+    rhsp_storeU16(buffer + 1, framePeriod);
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    rhsp_invalidateCachedQuery(hub, RHSP_CACHED_QUERY_SERVO_CONFIGURATION);
+    return rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_SET_SERVO_CONFIGURATION, buffer, sizeof(buffer), nackReasonCode);
 }
 
 int rhsp_getServoConfiguration(RhspRevHub* hub,
@@ -48,7 +45,7 @@ int rhsp_getServoConfiguration(RhspRevHub* hub,
                                uint16_t* framePeriod,
                                uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -59,21 +56,16 @@ int rhsp_getServoConfiguration(RhspRevHub* hub,
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 32, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
-    retval = rhsp_sendReadCommandInternal(hub, packetID, &servoChannel, sizeof(servoChannel), nackReasonCode);
+    int retval = rhsp_sendDekaCachedReadCommand(hub, RHSP_CACHED_QUERY_SERVO_CONFIGURATION,
+                                                RHSP_DEKA_GET_SERVO_CONFIGURATION, &servoChannel, sizeof(servoChannel),
+                                                &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
     }
     if (framePeriod)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *framePeriod = RHSP_ARRAY_WORD(uint16_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *framePeriod = rhsp_loadU16(response);
     }
     return RHSP_RESULT_OK;
 }
@@ -83,8 +75,6 @@ int rhsp_setServoPulseWidth(RhspRevHub* hub,
                             uint16_t pulseWidth,
                             uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
@@ -96,18 +86,23 @@ int rhsp_setServoPulseWidth(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
     }
-
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 33, &packetID, nackReasonCode);
-    if (retval < 0)
+    if (rhsp_isOutputFrameOpen(hub))
     {
-        return retval;
+        rhsp_frameSetServoPulseWidth(hub, servoChannel, pulseWidth, true);
+        return RHSP_RESULT_OK;
     }
 
     uint8_t buffer[3];
     RHSP_ARRAY_SET_BYTE(buffer, 0, servoChannel);
-    RHSP_ARRAY_SET_WORD(buffer, 1, pulseWidth);
+    rhsp_storeU16(buffer + 1, pulseWidth);
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    int retval = rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_SET_SERVO_PULSE_WIDTH,
+                                           buffer, sizeof(buffer), nackReasonCode);
+    if (retval >= 0)
+    {
+        rhsp_frameSetServoPulseWidth(hub, servoChannel, pulseWidth, false);
+    }
+    return retval;
 }
 
 int rhsp_getServoPulseWidth(RhspRevHub* hub,
@@ -115,7 +110,7 @@ int rhsp_getServoPulseWidth(RhspRevHub* hub,
                             uint16_t* pulseWidth,
                             uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -126,21 +121,15 @@ int rhsp_getServoPulseWidth(RhspRevHub* hub,
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 34, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
-    retval = rhsp_sendReadCommandInternal(hub, packetID, &servoChannel, sizeof(servoChannel), nackReasonCode);
+    int retval = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_GET_SERVO_PULSE_WIDTH,
+                                          &servoChannel, sizeof(servoChannel), &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
     }
     if (pulseWidth)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *pulseWidth = RHSP_ARRAY_WORD(uint16_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *pulseWidth = rhsp_loadU16(response);
     }
     return RHSP_RESULT_OK;
 }
@@ -150,8 +139,6 @@ int rhsp_setServoEnable(RhspRevHub* hub,
                         uint8_t enable,
                         uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
-
     if (!hub)
     {
         return RHSP_ERROR;
@@ -163,16 +150,20 @@ int rhsp_setServoEnable(RhspRevHub* hub,
     {
         return RHSP_ERROR_ARG_2_OUT_OF_RANGE;
     }
-
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 35, &packetID, nackReasonCode);
-    if (retval < 0)
+    if (rhsp_isOutputFrameOpen(hub))
     {
-        return retval;
+        rhsp_frameSetServoEnable(hub, servoChannel, enable, true);
+        return RHSP_RESULT_OK;
     }
 
     uint8_t buffer[2] = {servoChannel, enable};
 
-    return rhsp_sendWriteCommandInternal(hub, packetID, buffer, sizeof(buffer), nackReasonCode);
+    int retval = rhsp_sendDekaWriteCommand(hub, RHSP_DEKA_SET_SERVO_ENABLE, buffer, sizeof(buffer), nackReasonCode);
+    if (retval >= 0)
+    {
+        rhsp_frameSetServoEnable(hub, servoChannel, enable, false);
+    }
+    return retval;
 }
 
 int rhsp_getServoEnable(RhspRevHub* hub,
@@ -180,7 +171,7 @@ int rhsp_getServoEnable(RhspRevHub* hub,
                         uint8_t* enable,
                         uint8_t* nackReasonCode)
 {
-    uint16_t packetID;
+    const uint8_t* response;
 
     if (!hub)
     {
@@ -191,23 +182,16 @@ int rhsp_getServoEnable(RhspRevHub* hub,
         return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
     }
 
-    int retval = rhsp_getInterfacePacketID(hub, "DEKA", 36, &packetID, nackReasonCode);
-    if (retval < 0)
-    {
-        return retval;
-    }
-
-    retval = rhsp_sendReadCommandInternal(hub, packetID, &servoChannel, sizeof(servoChannel), nackReasonCode);
+    int retval = rhsp_sendDekaReadCommand(hub, RHSP_DEKA_GET_SERVO_ENABLE,
+                                          &servoChannel, sizeof(servoChannel), &response, nackReasonCode);
     if (retval < 0)
     {
         return retval;
     }
     if (enable)
     {
-        RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
-        *enable = RHSP_ARRAY_BYTE(uint8_t, RHSP_PACKET_PAYLOAD_PTR(internalHub->rxBuffer), 0);
+        *enable = RHSP_ARRAY_BYTE(uint8_t, response, 0);
     }
     return RHSP_RESULT_OK;
 }
 
-
@@ -0,0 +1,282 @@
+/*
+ * telemetry.c
+ *
+ * Shared memory segment with the latest state of a module, updated under a seqlock.
+ */
+#include <string.h>
+
+#include "rhsp/rhsp.h"
+#include "rhsp/telemetry.h"
+#include "rhsp/errors.h"
+#include "rhsp/time.h"
+#include "internal/revhub.h"
+#include "internal/linkStats.h"
+#include "internal/telemetry.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static uint32_t loadAcquire(const uint32_t* value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    uint32_t loaded = *(const volatile uint32_t*) value;
+    _ReadWriteBarrier();
+    return loaded;
+#else
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static void acquireFence(void)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    MemoryBarrier();
+#else
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+#endif
+}
+
+// the publisher is the only writer, so the sequence is incremented without a read-modify-write
+static void beginUpdate(RhspTelemetrySegment* segment)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    *(volatile uint32_t*) &segment->sequence = segment->sequence + 1;
+    MemoryBarrier();
+#else
+    __atomic_store_n(&segment->sequence, segment->sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+#endif
+}
+
+static void endUpdate(RhspTelemetrySegment* segment, uint32_t timestampUs)
+{
+    segment->data.updateTimestampUs = timestampUs;
+#if defined(_MSC_VER) && !defined(__clang__)
+    MemoryBarrier();
+    *(volatile uint32_t*) &segment->sequence = segment->sequence + 1;
+#else
+    __atomic_store_n(&segment->sequence, segment->sequence + 1, __ATOMIC_RELEASE);
+#endif
+}
+
+static void publishLinkStats(RhspRevHub* hub, RhspTelemetryLinkStats* linkStats)
+{
+    const RhspLinkStats* stats = &((const RhspRevHubInternal*) hub)->linkStats;
+    linkStats->framesSent = rhsp_linkStatsLoad(&stats->framesSent);
+    linkStats->framesReceived = rhsp_linkStatsLoad(&stats->framesReceived);
+    linkStats->bytesSent = rhsp_linkStatsLoad(&stats->bytesSent);
+    linkStats->bytesReceived = rhsp_linkStatsLoad(&stats->bytesReceived);
+    linkStats->checksumErrors = rhsp_linkStatsLoad(&stats->checksumErrors);
+    linkStats->resyncs = rhsp_linkStatsLoad(&stats->resyncs);
+    linkStats->discardedBytes = rhsp_linkStatsLoad(&stats->discardedBytes);
+    linkStats->timeouts = rhsp_linkStatsLoad(&stats->timeouts);
+    linkStats->nacks = rhsp_linkStatsLoad(&stats->nacks);
+    linkStats->attentionRequired = rhsp_linkStatsLoad(&stats->attentionRequired);
+    linkStats->retries = rhsp_linkStatsLoad(&stats->retries);
+}
+
+static RhspTelemetrySegment* publishedSegment(RhspRevHub* hub)
+{
+    return hub ? ((RhspRevHubInternal*) hub)->telemetry.segment : NULL;
+}
+
+void rhsp_publishBulkInputData(RhspRevHub* hub, const RhspBulkInputData* data, uint32_t timestampUs)
+{
+    RhspTelemetrySegment* segment = publishedSegment(hub);
+    if (!segment)
+    {
+        return;
+    }
+    beginUpdate(segment);
+    segment->data.bulkInputTimestampUs = timestampUs;
+    segment->data.bulkInputData = *data;
+    publishLinkStats(hub, &segment->data.linkStats);
+    endUpdate(segment, timestampUs);
+}
+
+void rhsp_publishAdcValue(RhspRevHub* hub, uint8_t adcChannel, int16_t value, uint32_t timestampUs)
+{
+    RhspTelemetrySegment* segment = publishedSegment(hub);
+    if (!segment || adcChannel >= RHSP_NUMBER_OF_ADC_CHANNELS)
+    {
+        return;
+    }
+    beginUpdate(segment);
+    segment->data.adcTimestampUs[adcChannel] = timestampUs;
+    segment->data.adcValues[adcChannel] = value;
+    publishLinkStats(hub, &segment->data.linkStats);
+    endUpdate(segment, timestampUs);
+}
+
+void rhsp_publishModuleStatus(RhspRevHub* hub, const RhspModuleStatus* status, uint32_t timestampUs)
+{
+    RhspTelemetrySegment* segment = publishedSegment(hub);
+    if (!segment)
+    {
+        return;
+    }
+    beginUpdate(segment);
+    segment->data.moduleStatusTimestampUs = timestampUs;
+    segment->data.moduleStatus = *status;
+    publishLinkStats(hub, &segment->data.linkStats);
+    endUpdate(segment, timestampUs);
+}
+
+#if defined(_WIN32)
+
+int rhsp_publishTelemetry(RhspRevHub* hub, const char* name)
+{
+    (void) hub;
+    (void) name;
+    return RHSP_ERROR;
+}
+
+void rhsp_stopPublishingTelemetry(RhspRevHub* hub)
+{
+    (void) hub;
+}
+
+int rhsp_openTelemetry(const char* name, const RhspTelemetrySegment** segment)
+{
+    (void) name;
+    (void) segment;
+    return RHSP_ERROR;
+}
+
+void rhsp_closeTelemetry(const RhspTelemetrySegment* segment)
+{
+    (void) segment;
+}
+
+#else
+
+int rhsp_publishTelemetry(RhspRevHub* hub, const char* name)
+{
+    if (!hub || !name)
+    {
+        return RHSP_ERROR;
+    }
+    if (strlen(name) >= RHSP_TELEMETRY_MAX_NAME_LENGTH)
+    {
+        return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
+    }
+    rhsp_stopPublishingTelemetry(hub);
+
+    // another publisher may be writing an existing segment
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        return RHSP_ERROR;
+    }
+    if (ftruncate(fd, sizeof(RhspTelemetrySegment)) < 0)
+    {
+        close(fd);
+        shm_unlink(name);
+        return RHSP_ERROR;
+    }
+    void* mapping = mmap(NULL, sizeof(RhspTelemetrySegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return RHSP_ERROR;
+    }
+
+    // the new segment is zero filled, and readers ignore it until magic is set
+    RhspTelemetrySegment* segment = (RhspTelemetrySegment*) mapping;
+    segment->version = RHSP_TELEMETRY_VERSION;
+    segment->size = sizeof(RhspTelemetrySegment);
+    segment->sequence = 0;
+    segment->address = ((RhspRevHubInternal*) hub)->address;
+    publishLinkStats(hub, &segment->data.linkStats);
+    __atomic_store_n(&segment->magic, RHSP_TELEMETRY_MAGIC, __ATOMIC_RELEASE);
+
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    internalHub->telemetry.segment = segment;
+    strcpy(internalHub->telemetry.name, name);
+    return RHSP_RESULT_OK;
+}
+
+void rhsp_stopPublishingTelemetry(RhspRevHub* hub)
+{
+    RhspTelemetrySegment* segment = publishedSegment(hub);
+    if (!segment)
+    {
+        return;
+    }
+    RhspRevHubInternal* internalHub = (RhspRevHubInternal*) hub;
+    munmap(segment, sizeof(RhspTelemetrySegment));
+    shm_unlink(internalHub->telemetry.name);
+    memset(&internalHub->telemetry, 0, sizeof(internalHub->telemetry));
+}
+
+int rhsp_openTelemetry(const char* name, const RhspTelemetrySegment** segment)
+{
+    if (!name || !segment)
+    {
+        return RHSP_ERROR;
+    }
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return RHSP_ERROR;
+    }
+    struct stat status;
+    if (fstat(fd, &status) < 0 || status.st_size < (off_t) sizeof(RhspTelemetrySegment))
+    {
+        close(fd);
+        return RHSP_ERROR;
+    }
+    void* mapping = mmap(NULL, sizeof(RhspTelemetrySegment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return RHSP_ERROR;
+    }
+    *segment = (const RhspTelemetrySegment*) mapping;
+    return RHSP_RESULT_OK;
+}
+
+void rhsp_closeTelemetry(const RhspTelemetrySegment* segment)
+{
+    if (segment)
+    {
+        munmap((void*) segment, sizeof(RhspTelemetrySegment));
+    }
+}
+
+#endif
+
+int rhsp_readTelemetry(const RhspTelemetrySegment* segment, RhspTelemetryData* data)
+{
+    if (!segment || !data)
+    {
+        return RHSP_ERROR;
+    }
+    if (loadAcquire(&segment->magic) != RHSP_TELEMETRY_MAGIC || segment->version != RHSP_TELEMETRY_VERSION ||
+        segment->size != sizeof(RhspTelemetrySegment))
+    {
+        return RHSP_ERROR;
+    }
+    for (int attempt = 0; attempt < RHSP_TELEMETRY_READ_ATTEMPTS; attempt++)
+    {
+        uint32_t sequence = loadAcquire(&segment->sequence);
+        if (sequence & 1)
+        {
+            continue;
+        }
+        memcpy(data, &segment->data, sizeof(*data));
+        acquireFence();
+        if (loadAcquire(&segment->sequence) == sequence)
+        {
+            return RHSP_RESULT_OK;
+        }
+    }
+    return RHSP_ERROR;
+}
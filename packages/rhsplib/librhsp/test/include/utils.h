@@ -12,6 +12,10 @@
 
 #define RHSP_TEST(test_suite_name, test_name, ...)  \
     TEST(test_suite_name, test_name) {              \
+        if (!RhspEnvironment::hub)                  \
+        {                                           \
+            GTEST_SKIP_("no hub found");            \
+        }                                           \
         RhspEnvironment::prepareTest();             \
         {                                           \
             __VA_ARGS__                             \
@@ -1,11 +1,18 @@
 
 #include "gtest/gtest.h"
 #include "rhsp/rhsp.h"
+#include "rhsp/rhsp.hpp"
 #include "Environment.h"
 #include "utils.h"
+#include "internal/rtt.h"
 
 #ifdef _WIN32
 #define random() rand()
+#else
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
 #endif
 
 RHSP_TEST(Basic, GetModuleStatus, {
@@ -106,3 +113,212 @@ RHSP_TEST(Basic, SetInvalidModuleAddress, {
         ASSERT_EQ(result, -51);
     }
 })
+
+RHSP_TEST(Basic, KeepAliveIfIdle, {
+    WITH_HUB
+
+    EXPECT_GE(rhsp_sendKeepAlive(hub, nullptr), 0);
+    EXPECT_LT(rhsp_idleTimeMs(hub), 100u);
+
+    // a command has just been sent, so the module does not need keep alive
+    delay(50);
+    RHSP_CHECK(rhsp_sendKeepAliveIfIdle, 1000)
+    EXPECT_GE(rhsp_idleTimeMs(hub), 50u);
+
+    RHSP_CHECK(rhsp_sendKeepAliveIfIdle, 40)
+    EXPECT_LT(rhsp_idleTimeMs(hub), 50u);
+})
+
+RHSP_TEST(Basic, AdaptiveResponseTimeout, {
+    WITH_HUB
+    const uint16_t keepAlivePacketID = 0x7F04;
+    uint32_t configuredTimeoutMs = rhsp_responseTimeoutMs(hub);
+
+    EXPECT_FALSE(rhsp_isAdaptiveResponseTimeoutEnabled(hub));
+    EXPECT_EQ(rhsp_setAdaptiveResponseTimeout(hub, true), 0);
+    EXPECT_TRUE(rhsp_isAdaptiveResponseTimeoutEnabled(hub));
+    EXPECT_EQ(rhsp_commandResponseTimeoutMs(hub, keepAlivePacketID), configuredTimeoutMs);
+
+    for (int i = 0; i < 20; i++)
+    {
+        EXPECT_GE(rhsp_sendKeepAlive(hub, nullptr), 0);
+    }
+    uint32_t adaptiveTimeoutMs = rhsp_commandResponseTimeoutMs(hub, keepAlivePacketID);
+    EXPECT_GE(adaptiveTimeoutMs, (uint32_t) RHSP_ADAPTIVE_RESPONSE_TIMEOUT_MIN_MS);
+    EXPECT_LT(adaptiveTimeoutMs, configuredTimeoutMs);
+
+    EXPECT_EQ(rhsp_setAdaptiveResponseTimeout(hub, false), 0);
+    EXPECT_EQ(rhsp_commandResponseTimeoutMs(hub, keepAlivePacketID), configuredTimeoutMs);
+})
+
+RHSP_TEST(Basic, ReadRetryLimit, {
+    WITH_HUB
+    EXPECT_EQ(rhsp_readRetryLimit(hub), RHSP_READ_RETRY_LIMIT);
+
+    EXPECT_EQ(rhsp_setReadRetryLimit(hub, 0), 0);
+    EXPECT_EQ(rhsp_readRetryLimit(hub), 0);
+    RhspBulkInputData data;
+    RHSP_CHECK(rhsp_getBulkInputData, &data)
+
+    EXPECT_EQ(rhsp_setReadRetryLimit(hub, RHSP_READ_RETRY_LIMIT), 0);
+    RHSP_CHECK(rhsp_getBulkInputData, &data)
+})
+
+// the estimator is fed directly, so this also runs without a hub
+TEST(Basic, AdaptiveResponseTimeoutConvergesAndBacksOff) {
+    const uint16_t packetID = 0x7F04;
+    const uint16_t otherPacketID = 0x7F07;
+    RhspSerial serial;
+    rhsp_serialInit(&serial);
+    RhspRevHub* hub = rhsp_allocRevHub(&serial, 2);
+    ASSERT_EQ(rhsp_setResponseTimeoutMs(hub, 1000), 0);
+    ASSERT_EQ(rhsp_setAdaptiveResponseTimeout(hub, true), 0);
+
+    // the configured timeout is used until enough responses have been measured
+    for (int i = 0; i < 7; i++)
+    {
+        rhsp_rttAddSample(hub, packetID, 20000);
+    }
+    EXPECT_EQ(rhsp_commandResponseTimeoutMs(hub, packetID), 1000u);
+    rhsp_rttAddSample(hub, packetID, 20000);
+    EXPECT_LT(rhsp_commandResponseTimeoutMs(hub, packetID), 1000u);
+
+    // once the variation has decayed, 20 ms rounded up, one clock granularity and one millisecond
+    for (int i = 0; i < 100; i++)
+    {
+        rhsp_rttAddSample(hub, packetID, 20000);
+    }
+    EXPECT_EQ(rhsp_commandResponseTimeoutMs(hub, packetID), 22u);
+    EXPECT_EQ(rhsp_commandResponseTimeoutMs(hub, otherPacketID), 1000u);
+
+    // each timeout doubles the timeout, up to the configured one
+    rhsp_rttOnTimeout(hub, packetID);
+    EXPECT_EQ(rhsp_commandResponseTimeoutMs(hub, packetID), 44u);
+    rhsp_rttOnTimeout(hub, packetID);
+    EXPECT_EQ(rhsp_commandResponseTimeoutMs(hub, packetID), 88u);
+    for (int i = 0; i < 10; i++)
+    {
+        rhsp_rttOnTimeout(hub, packetID);
+    }
+    EXPECT_EQ(rhsp_commandResponseTimeoutMs(hub, packetID), 1000u);
+
+    // a response ends the backoff, and the estimate follows a faster link
+    for (int i = 0; i < 100; i++)
+    {
+        rhsp_rttAddSample(hub, packetID, 5000);
+    }
+    EXPECT_GE(rhsp_commandResponseTimeoutMs(hub, packetID), 7u);
+    EXPECT_LE(rhsp_commandResponseTimeoutMs(hub, packetID), 8u);
+
+    // never below the lower bound
+    for (int i = 0; i < 100; i++)
+    {
+        rhsp_rttAddSample(hub, packetID, 100);
+    }
+    EXPECT_EQ(rhsp_commandResponseTimeoutMs(hub, packetID), (uint32_t) RHSP_ADAPTIVE_RESPONSE_TIMEOUT_MIN_MS);
+
+    EXPECT_EQ(rhsp_setAdaptiveResponseTimeout(hub, false), 0);
+    EXPECT_EQ(rhsp_commandResponseTimeoutMs(hub, packetID), 1000u);
+    freeRevHub(hub);
+}
+
+#ifndef _WIN32
+// a pseudo terminal that never answers stands in for the hub, so this also runs without one
+TEST(Basic, QueriesAreRetriedUpToTheLimit) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_GE(master, 0);
+    ASSERT_EQ(grantpt(master), 0);
+    ASSERT_EQ(unlockpt(master), 0);
+    struct termios attributes;
+    tcgetattr(master, &attributes);
+    cfmakeraw(&attributes);
+    tcsetattr(master, TCSANOW, &attributes);
+
+    RhspSerial serial;
+    rhsp_serialInit(&serial);
+    ASSERT_EQ(rhsp_serialOpen(&serial, ptsname(master), 460800, 8, RHSP_SERIAL_PARITY_NONE, 1,
+                              RHSP_SERIAL_FLOW_CONTROL_NONE), RHSP_SERIAL_NOERROR);
+    RhspRevHub* hub = rhsp_allocRevHub(&serial, 2);
+    ASSERT_EQ(rhsp_setResponseTimeoutMs(hub, 5), 0);
+
+    RhspBulkInputData data;
+    RhspLinkStats stats;
+    ASSERT_EQ(rhsp_setReadRetryLimit(hub, 2), 0);
+    EXPECT_EQ(rhsp_getBulkInputData(hub, &data, nullptr), RHSP_ERROR_RESPONSE_TIMEOUT);
+    ASSERT_EQ(rhsp_getLinkStats(hub, &stats), 0);
+    EXPECT_EQ(stats.framesSent, 3u);
+    EXPECT_EQ(stats.retries, 2u);
+    EXPECT_EQ(stats.timeouts, 3u);
+
+    ASSERT_EQ(rhsp_setReadRetryLimit(hub, 0), 0);
+    EXPECT_EQ(rhsp_getBulkInputData(hub, &data, nullptr), RHSP_ERROR_RESPONSE_TIMEOUT);
+    ASSERT_EQ(rhsp_getLinkStats(hub, &stats), 0);
+    EXPECT_EQ(stats.framesSent, 4u);
+    EXPECT_EQ(stats.retries, 2u);
+
+    // writes are never repeated
+    EXPECT_EQ(rhsp_setReadRetryLimit(hub, 2), 0);
+    EXPECT_EQ(rhsp_sendKeepAlive(hub, nullptr), RHSP_ERROR_RESPONSE_TIMEOUT);
+    ASSERT_EQ(rhsp_getLinkStats(hub, &stats), 0);
+    EXPECT_EQ(stats.framesSent, 5u);
+
+    rhsp_close(hub);
+    freeRevHub(hub);
+    rhsp_serialClose(&serial);
+    close(master);
+}
+#endif
+
+RHSP_TEST(Basic, LinkStats, {
+    WITH_HUB
+    WITH_SERIAL
+    RhspLinkStats before;
+    RhspLinkStats portBefore;
+    EXPECT_EQ(rhsp_getLinkStats(hub, &before), 0);
+    EXPECT_EQ(rhsp_getSerialLinkStats(serial, &portBefore), 0);
+
+    EXPECT_GE(rhsp_sendKeepAlive(hub, nullptr), 0);
+
+    RhspLinkStats after;
+    RhspLinkStats portAfter;
+    EXPECT_EQ(rhsp_getLinkStats(hub, &after), 0);
+    EXPECT_EQ(rhsp_getSerialLinkStats(serial, &portAfter), 0);
+    EXPECT_EQ(after.framesSent - before.framesSent, 1u);
+    EXPECT_EQ(after.framesReceived - before.framesReceived, 1u);
+    EXPECT_GE(after.bytesReceived - before.bytesReceived, 11u);
+    EXPECT_EQ(portAfter.framesSent - portBefore.framesSent, 1u);
+})
+
+RHSP_TEST(Basic, CppApi, {
+    WITH_HUB
+    WITH_SERIAL
+    rhsp::Hub cppHub(serial, rhsp_getDestinationAddress(hub));
+    ASSERT_TRUE(cppHub);
+
+    EXPECT_TRUE(cppHub.sendKeepAlive());
+    rhsp::Result<RhspVersion> version = cppHub.readVersion();
+    ASSERT_TRUE(version);
+    EXPECT_GT(version->majorVersion + version->minorVersion + version->engineeringRevision, 0);
+
+    rhsp::Result<int16_t> adc = cppHub.getADC(200);
+    ASSERT_FALSE(adc);
+    EXPECT_EQ(adc.error().code, RHSP_ERROR_ARG_1_OUT_OF_RANGE);
+
+    int32_t position;
+    EXPECT_TRUE(cppHub.call(rhsp_getEncoderPosition, 0, &position));
+
+    // keep alive, answered by an empty ack
+    rhsp::Result<rhsp::ByteView> response = cppHub.sendWriteCommand(0x7F04);
+    ASSERT_TRUE(response);
+    EXPECT_TRUE(response->empty());
+
+    // module status without clearing it
+    uint8_t clearStatus[] = {0};
+    response = cppHub.sendReadCommand(0x7F03, clearStatus);
+    ASSERT_TRUE(response);
+    EXPECT_EQ(response->size(), 2u);
+
+    rhsp::Hub moved(std::move(cppHub));
+    EXPECT_FALSE(cppHub);
+    EXPECT_TRUE(moved.getBulkInputData());
+})
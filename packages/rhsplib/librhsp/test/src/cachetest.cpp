@@ -0,0 +1,75 @@
+#include "utils.h"
+#include "rhsp/cache.h"
+#include "rhsp/servo.h"
+#include "rhsp/dio.h"
+
+RHSP_TEST(Cache, SetTtl, {
+    WITH_HUB
+
+    EXPECT_EQ(rhsp_queryCacheTtlMs(hub, RHSP_CACHED_QUERY_SERVO_CONFIGURATION), 0);
+    EXPECT_EQ(rhsp_setQueryCacheTtlMs(hub, RHSP_CACHED_QUERY_SERVO_CONFIGURATION, 5000), 0);
+    EXPECT_EQ(rhsp_queryCacheTtlMs(hub, RHSP_CACHED_QUERY_SERVO_CONFIGURATION), 5000);
+    EXPECT_EQ(rhsp_setQueryCacheTtlMs(hub, RHSP_CACHED_QUERY_COUNT, 5000), -51);
+
+    rhsp_setQueryCacheTtlMs(hub, RHSP_CACHED_QUERY_SERVO_CONFIGURATION, 0);
+})
+
+RHSP_TEST(Cache, SetterInvalidatesCachedValue, {
+    WITH_HUB
+    WITH_SERVO_CHANNEL
+
+    rhsp_setQueryCacheTtlMs(hub, RHSP_CACHED_QUERY_SERVO_CONFIGURATION, 5000);
+
+    uint16_t values[] = {20000, 30000};
+    for (auto value: values)
+    {
+        RHSP_CHECK(rhsp_setServoConfiguration, servoChannel, value)
+
+        uint16_t framePeriod;
+        RHSP_CHECK(rhsp_getServoConfiguration, servoChannel, &framePeriod)
+        EXPECT_EQ(value, framePeriod);
+
+        // second read is answered from the cache
+        RHSP_CHECK(rhsp_getServoConfiguration, servoChannel, &framePeriod)
+        EXPECT_EQ(value, framePeriod);
+    }
+
+    rhsp_setQueryCacheTtlMs(hub, RHSP_CACHED_QUERY_SERVO_CONFIGURATION, 0);
+})
+
+RHSP_TEST(Cache, FailSafeClearsCache, {
+    WITH_HUB
+    WITH_SERVO_CHANNEL
+
+    rhsp_setQueryCacheTtlMs(hub, RHSP_CACHED_QUERY_SERVO_CONFIGURATION, 5000);
+
+    uint16_t framePeriod;
+    RHSP_CHECK(rhsp_setServoConfiguration, servoChannel, 20000)
+    RHSP_CHECK(rhsp_getServoConfiguration, servoChannel, &framePeriod)
+    EXPECT_GE(rhsp_sendFailSafe(hub, nullptr), 0);
+    RHSP_CHECK(rhsp_getServoConfiguration, servoChannel, &framePeriod)
+    EXPECT_EQ(framePeriod, 20000);
+
+    rhsp_setQueryCacheTtlMs(hub, RHSP_CACHED_QUERY_SERVO_CONFIGURATION, 0);
+})
+
+RHSP_TEST(Cache, BulkOutputInvalidatesDirection, {
+    WITH_HUB
+    WITH_OUTPUT_PIN
+
+    rhsp_setQueryCacheTtlMs(hub, RHSP_CACHED_QUERY_DIO_DIRECTION, 5000);
+
+    uint8_t direction;
+    RHSP_CHECK(rhsp_setDirection, outPin, 0)
+    RHSP_CHECK(rhsp_getDirection, outPin, &direction)
+    EXPECT_EQ(direction, 0);
+
+    RhspBulkOutputData outputs = {};
+    outputs.digitalDirections = 1 << outPin;
+    RhspBulkInputData inputs;
+    RHSP_CHECK(rhsp_setBulkOutputData, &outputs, &inputs)
+    RHSP_CHECK(rhsp_getDirection, outPin, &direction)
+    EXPECT_EQ(direction, 1);
+
+    rhsp_setQueryCacheTtlMs(hub, RHSP_CACHED_QUERY_DIO_DIRECTION, 0);
+})
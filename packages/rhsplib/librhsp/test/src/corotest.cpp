@@ -0,0 +1,128 @@
+#include "gtest/gtest.h"
+#include "rhsp/coro.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// coro.hpp needs C++20, so these tests are built into an executable of their own. Commands are plain functions on
+// the executor or go to a hub whose port is not opened, so they run without a hub.
+
+using namespace rhsp;
+
+namespace {
+Task<int> twice(PortExecutor& executor, int value)
+{
+    Result<int> result = co_await Command<int>(executor, [value] { return Result<int>(value * 2); });
+    co_return *result;
+}
+
+Task<int> sumOfTwice(PortExecutor& executor, int count)
+{
+    int sum = 0;
+    for (int i = 0; i < count; i++)
+    {
+        sum += co_await twice(executor, i);
+    }
+    co_return sum;
+}
+
+Task<int> fail(PortExecutor& executor)
+{
+    co_await Command<int>(executor, [] { return Result<int>(0); });
+    throw std::runtime_error("failed");
+}
+}
+
+TEST(Coro, SyncWaitReturnsResultOfNestedTasks) {
+    PortExecutor executor;
+    EXPECT_EQ(syncWait(sumOfTwice(executor, 1000)), 999 * 1000);
+}
+
+TEST(Coro, CommandsRunOnExecutorThread) {
+    PortExecutor executor;
+    bool onExecutor = false;
+    syncWait([](PortExecutor& executor, bool& onExecutor) -> Task<void> {
+        co_await Command<void>(executor, [&] {
+            onExecutor = executor.isCurrentThread();
+            return Result<void>();
+        });
+        // the task continues on the executor
+        EXPECT_TRUE(executor.isCurrentThread());
+    }(executor, onExecutor));
+    EXPECT_TRUE(onExecutor);
+    EXPECT_FALSE(executor.isCurrentThread());
+}
+
+TEST(Coro, ExceptionIsRethrownByAwaitingTask) {
+    PortExecutor executor;
+    EXPECT_THROW(syncWait(fail(executor)), std::runtime_error);
+
+    bool caught = syncWait([](PortExecutor& executor) -> Task<bool> {
+        try
+        {
+            co_await fail(executor);
+        } catch (const std::runtime_error&)
+        {
+            co_return true;
+        }
+        co_return false;
+    }(executor));
+    EXPECT_TRUE(caught);
+}
+
+TEST(Coro, CommandsRunInOrderTheyAreAwaited) {
+    std::vector<int> order;
+    {
+        PortExecutor executor;
+        for (int i = 0; i < 100; i++)
+        {
+            spawn(executor, [](PortExecutor& executor, std::vector<int>& order, int i) -> Task<void> {
+                co_await Command<void>(executor, [&order, i] {
+                    order.push_back(i);
+                    return Result<void>();
+                });
+            }(executor, order, i));
+        }
+        // queued jobs still run when the executor stops
+    }
+    ASSERT_EQ(order.size(), 100u);
+    for (int i = 0; i < 100; i++)
+    {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+TEST(Coro, JobsPostedBeforeStopAreRun) {
+    std::atomic<int> jobsRun{0};
+    PortExecutor executor;
+    for (int i = 0; i < 1000; i++)
+    {
+        executor.post([&jobsRun] { jobsRun++; });
+    }
+    executor.stop();
+    EXPECT_EQ(jobsRun, 1000);
+    // stopping again and destroying a stopped executor do nothing
+    executor.stop();
+}
+
+TEST(Coro, ErrorOfHubIsReturned) {
+    PortExecutor executor;
+    RhspSerial serial;
+    rhsp_serialInit(&serial);
+    Hub hub(&serial, 2);
+    AsyncHub asyncHub(hub, executor);
+
+    Result<int32_t> position = syncWait([](AsyncHub& asyncHub) -> Task<Result<int32_t>> {
+        co_return co_await asyncHub.getEncoderPosition(0);
+    }(asyncHub));
+    ASSERT_FALSE(position);
+    EXPECT_EQ(position.error().code, hub.getEncoderPosition(0).error().code);
+
+    Result<void> result = syncWait([](AsyncHub& asyncHub) -> Task<Result<void>> {
+        co_return co_await asyncHub.setMotorConstantPower(0, 0.5);
+    }(asyncHub));
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, hub.call(rhsp_setMotorConstantPower, 0, 0.5).error().code);
+}
@@ -9,6 +9,23 @@ RHSP_TEST(DeviceControl, BulkRead, {
     RHSP_CHECK(rhsp_getBulkInputData, &data)
 })
 
+RHSP_TEST(DeviceControl, BulkReadFromHubs, {
+    WITH_HUB
+    RhspRevHub* hubs[] = {hub};
+    RhspHubBulkInputData data[1];
+    EXPECT_EQ(rhsp_getBulkInputDataFromHubs(hubs, 1, data), RHSP_RESULT_OK);
+    EXPECT_EQ(data[0].resultCode, RHSP_RESULT_OK);
+})
+
+RHSP_TEST(DeviceControl, BulkReadFromSameHubTwice, {
+    WITH_HUB
+    RhspRevHub* hubs[] = {hub, hub};
+    RhspHubBulkInputData data[2];
+    EXPECT_EQ(rhsp_getBulkInputDataFromHubs(hubs, 2, data), RHSP_RESULT_OK);
+    EXPECT_EQ(data[0].resultCode, RHSP_RESULT_OK);
+    EXPECT_EQ(data[1].resultCode, RHSP_RESULT_OK);
+})
+
 RHSP_TEST(DeviceControl, BulkWrite, {
     GTEST_SKIP_("This method is not implemented");
     WITH_HUB
@@ -117,6 +134,36 @@ RHSP_TEST(DeviceControl, ADC, {
     }
 })
 
+RHSP_TEST(DeviceControl, ADCSweep, {
+    WITH_HUB
+
+    uint8_t channels[RHSP_NUMBER_OF_ADC_CHANNELS];
+    for (uint8_t i = 0; i < RHSP_NUMBER_OF_ADC_CHANNELS; i++)
+    {
+        channels[i] = i;
+    }
+
+    int16_t values[RHSP_NUMBER_OF_ADC_CHANNELS];
+    uint32_t timestampMs;
+    RHSP_CHECK(rhsp_getADCSweep, channels, RHSP_NUMBER_OF_ADC_CHANNELS, 1, values, &timestampMs)
+
+    // the sweep must return the same values as single reads, allowing for noise on the raw counts
+    int16_t value;
+    RHSP_CHECK(rhsp_getADC, 0, 1, &value)
+    EXPECT_NEAR(values[0], value, 100);
+})
+
+RHSP_TEST(DeviceControl, ADCSweepInvalidChannel, {
+    WITH_HUB
+
+    uint8_t channels[] = {0, 15};
+    uint8_t nackCode;
+    int16_t values[2];
+    int result = rhsp_getADCSweep(hub, channels, 2, 0, values, nullptr, &nackCode);
+
+    ASSERT_EQ(result, -51);
+})
+
 RHSP_TEST(DeviceControl, AdcInvalidChannel, {
     WITH_HUB
 
@@ -0,0 +1,36 @@
+#include "utils.h"
+#include "rhsp/frame.h"
+#include "rhsp/servo.h"
+#include "rhsp/dio.h"
+
+RHSP_TEST(Frame, SettersAreDeferredUntilCommit, {
+    WITH_HUB
+    WITH_SERVO_CHANNEL
+
+    RHSP_CHECK(rhsp_setServoPulseWidth, servoChannel, 1000)
+
+    EXPECT_EQ(rhsp_beginOutputFrame(hub), 0);
+    EXPECT_TRUE(rhsp_isOutputFrameOpen(hub));
+    RHSP_CHECK(rhsp_setServoPulseWidth, servoChannel, 1500)
+    RHSP_CHECK(rhsp_setServoPulseWidth, servoChannel, 2000)
+
+    uint16_t pulseWidth;
+    RHSP_CHECK(rhsp_getServoPulseWidth, servoChannel, &pulseWidth)
+    EXPECT_EQ(pulseWidth, 1000);
+
+    RhspBulkInputData bulkInputData;
+    RHSP_CHECK(rhsp_commitOutputFrame, &bulkInputData)
+    EXPECT_FALSE(rhsp_isOutputFrameOpen(hub));
+
+    RHSP_CHECK(rhsp_getServoPulseWidth, servoChannel, &pulseWidth)
+    EXPECT_EQ(pulseWidth, 2000);
+})
+
+RHSP_TEST(Frame, InvalidArgumentsAreRejectedInFrame, {
+    WITH_HUB
+
+    rhsp_beginOutputFrame(hub);
+    EXPECT_EQ(rhsp_setSingleOutput(hub, 10, 1, nullptr), -51);
+    EXPECT_EQ(rhsp_setServoPulseWidth(hub, 10, 1500, nullptr), -51);
+    RHSP_CHECK(rhsp_commitOutputFrame, nullptr)
+})
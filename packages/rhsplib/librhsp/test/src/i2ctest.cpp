@@ -49,3 +49,61 @@ RHSP_TEST(I2C, ConfigureQueryInvalidChannel, {
     int result = rhsp_configureI2cQuery(hub, channel, &speedCode, &nackCode);
     EXPECT_EQ(result, -51);
 })
+
+RHSP_TEST(I2C, ReadBlockingInvalidChannel, {
+    WITH_HUB
+    int channel = 10;
+    uint8_t nackCode;
+    uint8_t bytesRead;
+    uint8_t payload[4];
+
+    int result = rhsp_writeReadMultipleBytesBlocking(hub, channel, 0x29, 4, 0, nullptr, &bytesRead, payload, &nackCode);
+    EXPECT_EQ(result, -51);
+})
+
+RHSP_TEST(I2C, ReadBlockingFromMissingDeviceCompletes, {
+    WITH_HUB
+    uint8_t nackCode = 0;
+    uint8_t statusByte;
+    uint8_t bytesRead;
+    uint8_t payload[4];
+
+    // nothing answers on this address, so the module should report the failure instead of staying busy
+    int result = rhsp_readMultipleBytesBlocking(hub, 0, 0x7E, 4, &statusByte, &bytesRead, payload, &nackCode);
+    EXPECT_NE(result, RHSP_ERROR_RESPONSE_TIMEOUT);
+})
+
+RHSP_TEST(I2C, ReadBlockingWaitsThroughWaitFunction, {
+    WITH_HUB
+    uint8_t nackCode = 0;
+    uint8_t bytesRead;
+    uint8_t payload[4];
+    int waits = 0;
+
+    rhsp_setI2cWaitFunction(hub, [](void* context, uint32_t delayUs) {
+        (*static_cast<int*>(context))++;
+        rhsp_sleepUs(delayUs);
+    }, &waits);
+    int result = rhsp_readMultipleBytesBlocking(hub, 0, 0x7E, 4, nullptr, &bytesRead, payload, &nackCode);
+    rhsp_setI2cWaitFunction(hub, nullptr, nullptr);
+
+    EXPECT_NE(result, RHSP_ERROR_RESPONSE_TIMEOUT);
+    EXPECT_GE(waits, 1);
+})
+
+RHSP_TEST(I2C, RunOperationsRejectsInvalidOperation, {
+    WITH_HUB
+    uint8_t nackCode;
+    size_t completed = 1;
+    RhspI2cOperation operations[2] = {};
+    operations[0].type = RHSP_I2C_OPERATION_WRITE;
+    operations[0].slaveAddress = 0x29;
+    operations[0].length = 2;
+    operations[1].type = RHSP_I2C_OPERATION_READ_REGISTER;
+    operations[1].slaveAddress = 0x29;
+    operations[1].length = 0;
+
+    int result = rhsp_runI2cOperations(hub, 0, operations, 2, &completed, &nackCode);
+    EXPECT_EQ(result, -52);
+    EXPECT_EQ(completed, 1);  // nothing has been sent
+})
@@ -6,6 +6,8 @@
 #include "utils.h"
 #include "rhsp/time.h"
 
+#include <cmath>
+
 RHSP_TEST(Motor, Enable, {
     WITH_HUB
     int channel = 3;
@@ -582,3 +584,63 @@ RHSP_TEST(Motor, GetPidfCoefficientsInvalidChannel, {
 
     EXPECT_EQ(result, -51);
 })
+
+RHSP_TEST(Motor, EncoderHistory, {
+    WITH_HUB
+    rhsp_clearEncoderHistory(hub);
+
+    RhspEncoderSample latest;
+    EXPECT_LT(rhsp_getLatestEncoderSample(hub, &latest), 0);
+
+    RhspBulkInputData data;
+    for (int i = 0; i < 3; i++)
+    {
+        RHSP_CHECK(rhsp_getBulkInputData, &data)
+    }
+
+    RhspEncoderSample samples[RHSP_ENCODER_HISTORY_SIZE];
+    size_t count = rhsp_getEncoderHistory(hub, samples, RHSP_ENCODER_HISTORY_SIZE);
+    EXPECT_EQ(count, 3);
+    EXPECT_EQ(samples[0].position[0], data.motor0position_enc);
+    EXPECT_EQ(samples[0].velocity[3], data.motor3velocity_cps);
+    EXPECT_GE((int32_t) (samples[0].timestampUs - samples[2].timestampUs), 0);
+
+    EXPECT_EQ(rhsp_getLatestEncoderSample(hub, &latest), 0);
+    EXPECT_EQ(latest.timestampUs, samples[0].timestampUs);
+})
+
+RHSP_TEST(Motor, EncoderFilterGains, {
+    WITH_HUB
+    EXPECT_EQ(rhsp_setEncoderFilterGains(hub, 0.3, 0.2, 0.05), 0);
+    EXPECT_EQ(rhsp_setEncoderFilterGains(hub, 0, 0.2, 0.05), -51);
+    EXPECT_EQ(rhsp_setEncoderFilterGains(hub, 0.3, 3, 0.05), -52);
+    EXPECT_EQ(rhsp_setEncoderFilterGains(hub, 0.3, 0.2, -1), -53);
+    rhsp_setEncoderFilterGains(hub, 0.5, 0.2, 0.02);
+})
+
+// planning does not communicate with the hub, so this also runs without one
+TEST(Motor, MotionProfileRespectsLimits) {
+    RhspMotionConstraints constraints = {-5000, 2000, 4000, 20000};
+    RhspMotionProfile profile;
+    ASSERT_EQ(rhsp_planMotionProfile(&constraints, &profile), 0);
+
+    RhspMotionState state;
+    for (double time = 0; time <= profile.duration; time += 0.001)
+    {
+        rhsp_sampleMotionProfile(&profile, time, &state);
+        EXPECT_LE(std::fabs(state.velocity), 2000 + 1e-6);
+        EXPECT_LE(std::fabs(state.acceleration), 4000 + 1e-6);
+    }
+    rhsp_sampleMotionProfile(&profile, profile.duration, &state);
+    EXPECT_NEAR(state.position, -5000, 1e-6);
+    EXPECT_NEAR(state.velocity, 0, 1e-6);
+
+    // too short to reach the velocity limit
+    constraints = {100, 2000, 4000, 0};
+    ASSERT_EQ(rhsp_planMotionProfile(&constraints, &profile), 0);
+    EXPECT_LT(profile.peakVelocity, 2000);
+    EXPECT_NEAR(profile.cruiseTime, 0, 1e-9);  // what the search leaves over is covered by cruising
+
+    constraints = {100, 0, 4000, 0};
+    EXPECT_EQ(rhsp_planMotionProfile(&constraints, &profile), -1);
+}
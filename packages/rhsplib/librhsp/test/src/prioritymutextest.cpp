@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+#include "PriorityMutex.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// The priority mutex of the node addon does not communicate with the hub, so
+// these tests run without one.
+
+namespace {
+void waitUntilWaiting(const PriorityMutex& mutex, CommandPriority priority, uint32_t waiting)
+{
+    while (mutex.stats(priority).waiting < waiting)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+// take the mutex from a new thread and record when it got it
+std::thread lockInThread(PriorityMutex& mutex, CommandPriority priority, std::vector<CommandPriority>& order)
+{
+    std::thread thread([&mutex, priority, &order] {
+        PriorityLock lock{mutex, priority};
+        order.push_back(priority);
+    });
+    waitUntilWaiting(mutex, priority, 1);
+    return thread;
+}
+}
+
+TEST(PriorityMutex, WaitersAreServedByPriority) {
+    PriorityMutex mutex;
+    std::vector<CommandPriority> order;
+    std::vector<std::thread> threads;
+
+    mutex.lock(CommandPriority::Telemetry);
+    threads.push_back(lockInThread(mutex, CommandPriority::Diagnostics, order));
+    threads.push_back(lockInThread(mutex, CommandPriority::Telemetry, order));
+    threads.push_back(lockInThread(mutex, CommandPriority::Actuation, order));
+    threads.push_back(lockInThread(mutex, CommandPriority::Safety, order));
+    mutex.unlock();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::vector<CommandPriority> expected = {CommandPriority::Safety, CommandPriority::Actuation,
+                                             CommandPriority::Telemetry, CommandPriority::Diagnostics};
+    EXPECT_EQ(order, expected);
+    EXPECT_EQ(mutex.stats(CommandPriority::Telemetry).acquired, 2);
+    EXPECT_EQ(mutex.stats(CommandPriority::Telemetry).waiting, 0);
+    EXPECT_EQ(mutex.stats(CommandPriority::Diagnostics).promoted, 0);
+}
+
+TEST(PriorityMutex, WaiterIsPromotedAfterMaxWait) {
+    PriorityMutex mutex;
+    std::vector<CommandPriority> order;
+    std::vector<std::thread> threads;
+
+    mutex.lock(CommandPriority::Telemetry);
+    threads.push_back(lockInThread(mutex, CommandPriority::Diagnostics, order));
+    std::this_thread::sleep_for(PriorityMutex::maxWait[static_cast<size_t>(CommandPriority::Diagnostics)] +
+                                std::chrono::milliseconds(10));
+    threads.push_back(lockInThread(mutex, CommandPriority::Telemetry, order));
+    mutex.unlock();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::vector<CommandPriority> expected = {CommandPriority::Diagnostics, CommandPriority::Telemetry};
+    EXPECT_EQ(order, expected);
+    CommandQueueStats stats = mutex.stats(CommandPriority::Diagnostics);
+    EXPECT_EQ(stats.promoted, 1);
+    EXPECT_GE(stats.maxWaitUs, 100000);
+}
+
+TEST(PriorityMutex, SafetyIsNotPassedByPromotedWaiters) {
+    PriorityMutex mutex;
+    std::vector<CommandPriority> order;
+    std::vector<std::thread> threads;
+
+    mutex.lock(CommandPriority::Telemetry);
+    threads.push_back(lockInThread(mutex, CommandPriority::Diagnostics, order));
+    std::this_thread::sleep_for(PriorityMutex::maxWait[static_cast<size_t>(CommandPriority::Diagnostics)] +
+                                std::chrono::milliseconds(10));
+    threads.push_back(lockInThread(mutex, CommandPriority::Safety, order));
+    mutex.unlock();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::vector<CommandPriority> expected = {CommandPriority::Safety, CommandPriority::Diagnostics};
+    EXPECT_EQ(order, expected);
+}
+
+TEST(PriorityMutex, YieldLetsWaitersRun) {
+    PriorityMutex mutex;
+    std::vector<CommandPriority> order;
+
+    mutex.lock(CommandPriority::Telemetry);
+    std::thread thread = lockInThread(mutex, CommandPriority::Actuation, order);
+    mutex.yield(std::chrono::milliseconds(1));
+    // the waiter has run, and the mutex is held again
+    EXPECT_EQ(order.size(), 1);
+    EXPECT_EQ(mutex.stats(CommandPriority::Telemetry).acquired, 2);
+    mutex.unlock();
+    thread.join();
+}
@@ -0,0 +1,125 @@
+#include "utils.h"
+#include "rhsp/revhub.h"
+#include "rhsp/serial.h"
+#include "rhsp/telemetry.h"
+#include "internal/telemetry.h"
+
+#include <atomic>
+#include <thread>
+
+RHSP_TEST(Telemetry, BulkInputDataIsPublished, {
+    WITH_HUB
+
+    ASSERT_EQ(rhsp_publishTelemetry(hub, "/rhsp-test-telemetry"), RHSP_RESULT_OK);
+    const RhspTelemetrySegment* segment;
+    ASSERT_EQ(rhsp_openTelemetry("/rhsp-test-telemetry", &segment), RHSP_RESULT_OK);
+
+    RhspBulkInputData bulkInputData;
+    RHSP_CHECK(rhsp_getBulkInputData, &bulkInputData)
+
+    RhspTelemetryData data;
+    EXPECT_EQ(rhsp_readTelemetry(segment, &data), RHSP_RESULT_OK);
+    EXPECT_NE(data.bulkInputTimestampUs, 0u);
+    EXPECT_EQ(data.bulkInputData.motor0position_enc, bulkInputData.motor0position_enc);
+    EXPECT_EQ(data.moduleStatusTimestampUs, 0u);
+
+    rhsp_closeTelemetry(segment);
+    rhsp_stopPublishingTelemetry(hub);
+})
+
+RHSP_TEST(Telemetry, SegmentIsUnlinkedWhenPublishingStops, {
+    WITH_HUB
+
+    ASSERT_EQ(rhsp_publishTelemetry(hub, "/rhsp-test-telemetry"), RHSP_RESULT_OK);
+    rhsp_stopPublishingTelemetry(hub);
+
+    const RhspTelemetrySegment* segment;
+    EXPECT_EQ(rhsp_openTelemetry("/rhsp-test-telemetry", &segment), RHSP_ERROR);
+})
+
+// publishing and reading do not communicate with the hub, so the following tests run without one
+
+TEST(Telemetry, ReadRetriesWhileUpdateIsInProgress) {
+    RhspTelemetrySegment segment{};
+    segment.magic = RHSP_TELEMETRY_MAGIC;
+    segment.version = RHSP_TELEMETRY_VERSION;
+    segment.size = sizeof(RhspTelemetrySegment);
+    segment.data.bulkInputTimestampUs = 5;
+    RhspTelemetryData data;
+
+    // odd while the publisher is writing
+    segment.sequence = 3;
+    EXPECT_EQ(rhsp_readTelemetry(&segment, &data), RHSP_ERROR);
+
+    segment.sequence = 4;
+    EXPECT_EQ(rhsp_readTelemetry(&segment, &data), RHSP_RESULT_OK);
+    EXPECT_EQ(data.bulkInputTimestampUs, 5u);
+
+    segment.version = RHSP_TELEMETRY_VERSION + 1;
+    EXPECT_EQ(rhsp_readTelemetry(&segment, &data), RHSP_ERROR);
+}
+
+TEST(Telemetry, ReaderOnlySeesCompleteUpdates) {
+    RhspSerial serial;
+    rhsp_serialInit(&serial);
+    RhspRevHub* hub = rhsp_allocRevHub(&serial, 2);
+    ASSERT_EQ(rhsp_publishTelemetry(hub, "/rhsp-test-seqlock"), RHSP_RESULT_OK);
+    const RhspTelemetrySegment* segment;
+    ASSERT_EQ(rhsp_openTelemetry("/rhsp-test-seqlock", &segment), RHSP_RESULT_OK);
+
+    std::atomic<bool> published{false};
+    std::thread publisher([hub, &published] {
+        RhspBulkInputData bulkInputData{};
+        for (int32_t i = 1; i <= 200000; i++)
+        {
+            bulkInputData.motor0position_enc = i;
+            bulkInputData.motor1position_enc = i;
+            bulkInputData.motor2position_enc = i;
+            bulkInputData.motor3position_enc = i;
+            rhsp_publishBulkInputData(hub, &bulkInputData, (uint32_t) i);
+        }
+        published = true;
+    });
+
+    int reads = 0;
+    int32_t lastPosition = 0;
+    while (!published)
+    {
+        RhspTelemetryData data;
+        if (rhsp_readTelemetry(segment, &data) != RHSP_RESULT_OK)
+        {
+            continue;
+        }
+        reads++;
+        const RhspBulkInputData& bulkInputData = data.bulkInputData;
+        ASSERT_EQ(bulkInputData.motor1position_enc, bulkInputData.motor0position_enc);
+        ASSERT_EQ(bulkInputData.motor2position_enc, bulkInputData.motor0position_enc);
+        ASSERT_EQ(bulkInputData.motor3position_enc, bulkInputData.motor0position_enc);
+        ASSERT_EQ(data.bulkInputTimestampUs, (uint32_t) bulkInputData.motor0position_enc);
+        ASSERT_GE(bulkInputData.motor0position_enc, lastPosition);
+        lastPosition = bulkInputData.motor0position_enc;
+    }
+    publisher.join();
+    EXPECT_GT(reads, 0);
+
+    rhsp_closeTelemetry(segment);
+    rhsp_stopPublishingTelemetry(hub);
+    freeRevHub(hub);
+}
+
+TEST(Telemetry, ExistingSegmentIsNotTakenOver) {
+    RhspSerial serial;
+    rhsp_serialInit(&serial);
+    RhspRevHub* hub = rhsp_allocRevHub(&serial, 2);
+    RhspRevHub* otherHub = rhsp_allocRevHub(&serial, 3);
+
+    ASSERT_EQ(rhsp_publishTelemetry(hub, "/rhsp-test-exclusive"), RHSP_RESULT_OK);
+    EXPECT_EQ(rhsp_publishTelemetry(otherHub, "/rhsp-test-exclusive"), RHSP_ERROR);
+
+    rhsp_stopPublishingTelemetry(hub);
+    EXPECT_EQ(rhsp_publishTelemetry(otherHub, "/rhsp-test-exclusive"), RHSP_RESULT_OK);
+    rhsp_stopPublishingTelemetry(otherHub);
+
+    freeRevHub(hub);
+    freeRevHub(otherHub);
+}
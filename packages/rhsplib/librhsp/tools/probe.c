@@ -0,0 +1,347 @@
+/*
+ * probe.c
+ *
+ * Measures round trip latency and throughput of RHSP traffic for a serial port configuration.
+ *
+ * usage: rhsp-probe --serial <path> [--baud <rate>] [--flow none|hardware|software]
+ *                   [--address <module address>] [--count <commands per run>]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rhsp/rhsp.h"
+#include "internal/command.h"
+#include "internal/dekaCommands.h"
+#include "internal/packet.h"
+#include "internal/revhub.h"
+
+#define PROBE_DEFAULT_BAUDRATE  460800
+#define PROBE_DEFAULT_COUNT     1000
+
+typedef struct {
+    int timeouts;        // includes responses dropped for a bad checksum or sync bytes, see the link stats
+    int sequenceErrors;  // response did not match the message number of the command
+    int nacks;
+    int otherErrors;
+} ProbeErrors;
+
+typedef struct {
+    const char* name;
+    size_t depth;
+    size_t count;
+    uint32_t* latenciesUs;  // one entry per successful round trip
+    size_t numberOfLatencies;
+    uint64_t bytes;         // bytes sent and received
+    uint32_t elapsedUs;
+    ProbeErrors errors;
+    RhspLinkStats linkStatsBefore;
+} ProbeRun;
+
+static uint32_t lastRxPacketSize(RhspRevHub* hub)
+{
+    return RHSP_PACKET_SIZE(((RhspRevHubInternal*) hub)->rxBuffer);
+}
+
+static uint32_t packetSize(uint16_t payloadSize)
+{
+    return RHSP_PACKET_HEADER_SIZE + payloadSize + RHSP_PACKET_CRC_SIZE;
+}
+
+static void countError(ProbeErrors* errors, int result)
+{
+    switch (result)
+    {
+        case RHSP_ERROR_RESPONSE_TIMEOUT:
+            errors->timeouts++;
+            break;
+        case RHSP_ERROR_MSG_NUMBER_MISMATCH:
+        case RHSP_ERROR_UNEXPECTED_RESPONSE:
+            errors->sequenceErrors++;
+            break;
+        case RHSP_ERROR_NACK_RECEIVED:
+            errors->nacks++;
+            break;
+        default:
+            errors->otherErrors++;
+            break;
+    }
+}
+
+static int compareLatencies(const void* a, const void* b)
+{
+    uint32_t left = *(const uint32_t*) a;
+    uint32_t right = *(const uint32_t*) b;
+    return (left > right) - (left < right);
+}
+
+static uint32_t percentile(const uint32_t* sortedValues, size_t count, unsigned percent)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    size_t index = (count * percent + 99) / 100;
+    return sortedValues[(index > 0) ? index - 1 : 0];
+}
+
+static void printHeader(void)
+{
+    printf("%-12s %5s %7s %7s %8s %8s %8s %10s %9s\n",
+           "test", "depth", "ok", "errors", "p50 us", "p99 us", "max us", "bytes/s", "cmds/s");
+}
+
+static void printRun(RhspRevHub* hub, ProbeRun* run)
+{
+    qsort(run->latenciesUs, run->numberOfLatencies, sizeof(uint32_t), compareLatencies);
+    int errors = run->errors.timeouts + run->errors.sequenceErrors + run->errors.nacks + run->errors.otherErrors;
+    double seconds = (run->elapsedUs > 0) ? run->elapsedUs / 1e6 : 1e-6;
+
+    printf("%-12s %5zu %7zu %7d %8u %8u %8u %10.0f %9.0f\n",
+           run->name, run->depth, run->count - (size_t) errors, errors,
+           percentile(run->latenciesUs, run->numberOfLatencies, 50),
+           percentile(run->latenciesUs, run->numberOfLatencies, 99),
+           percentile(run->latenciesUs, run->numberOfLatencies, 100),
+           run->bytes / seconds,
+           (run->count - (size_t) errors) / seconds);
+    if (errors > 0)
+    {
+        printf("%-12s       timeouts %d, sequence errors %d, nacks %d, other %d\n", "",
+               run->errors.timeouts, run->errors.sequenceErrors, run->errors.nacks, run->errors.otherErrors);
+    }
+
+    RhspLinkStats linkStats;
+    rhsp_getLinkStats(hub, &linkStats);
+    uint32_t checksumErrors = linkStats.checksumErrors - run->linkStatsBefore.checksumErrors;
+    uint32_t resyncs = linkStats.resyncs - run->linkStatsBefore.resyncs;
+    uint32_t discardedBytes = linkStats.discardedBytes - run->linkStatsBefore.discardedBytes;
+    if (checksumErrors > 0 || resyncs > 0 || discardedBytes > 0)
+    {
+        printf("%-12s       checksum errors %u, resyncs %u, discarded bytes %u\n", "",
+               checksumErrors, resyncs, discardedBytes);
+    }
+}
+
+static void runKeepAlive(RhspRevHub* hub, ProbeRun* run)
+{
+    uint32_t start = rhsp_getSteadyClockUs();
+    for (size_t i = 0; i < run->count; i++)
+    {
+        uint32_t sentUs = rhsp_getSteadyClockUs();
+        int result = rhsp_sendKeepAlive(hub, NULL);
+        if (result < 0)
+        {
+            countError(&run->errors, result);
+            continue;
+        }
+        run->latenciesUs[run->numberOfLatencies++] = rhsp_getSteadyClockUs() - sentUs;
+        run->bytes += packetSize(0) + lastRxPacketSize(hub);
+    }
+    run->elapsedUs = rhsp_getSteadyClockUs() - start;
+}
+
+static void runMaxPayload(RhspRevHub* hub, ProbeRun* run)
+{
+    // RHSP has no echo command. The data log hint has the largest request payload and is answered by an ACK.
+    char hint[RHSP_INJECT_DATA_LOG_MAX_HINT_TEXT_LENGTH + 1];
+    memset(hint, 'x', RHSP_INJECT_DATA_LOG_MAX_HINT_TEXT_LENGTH);
+    hint[RHSP_INJECT_DATA_LOG_MAX_HINT_TEXT_LENGTH] = '\0';
+
+    uint32_t start = rhsp_getSteadyClockUs();
+    for (size_t i = 0; i < run->count; i++)
+    {
+        uint32_t sentUs = rhsp_getSteadyClockUs();
+        int result = rhsp_injectDataLogHint(hub, hint, NULL);
+        if (result < 0)
+        {
+            countError(&run->errors, result);
+            continue;
+        }
+        run->latenciesUs[run->numberOfLatencies++] = rhsp_getSteadyClockUs() - sentUs;
+        run->bytes += packetSize(1 + RHSP_INJECT_DATA_LOG_MAX_HINT_TEXT_LENGTH) + lastRxPacketSize(hub);
+    }
+    run->elapsedUs = rhsp_getSteadyClockUs() - start;
+}
+
+typedef struct {
+    RhspRevHub* hub;
+    ProbeRun* run;
+    uint32_t batchStartUs;
+} BulkReadContext;
+
+static void onBulkReadResponse(void* context, size_t commandIndex, const uint8_t* responsePayload)
+{
+    (void) commandIndex;
+    (void) responsePayload;
+    BulkReadContext* bulkRead = (BulkReadContext*) context;
+    // with several commands in flight, latency is measured from the start of the batch
+    bulkRead->run->latenciesUs[bulkRead->run->numberOfLatencies++] =
+            rhsp_getSteadyClockUs() - bulkRead->batchStartUs;
+    bulkRead->run->bytes += packetSize(0) + lastRxPacketSize(bulkRead->hub);
+}
+
+static void runBulkRead(RhspRevHub* hub, uint16_t packetID, ProbeRun* run)
+{
+    BulkReadContext context = {hub, run, 0};
+    uint32_t start = rhsp_getSteadyClockUs();
+    size_t done = 0;
+    while (done < run->count)
+    {
+        size_t batch = run->count - done;
+        if (batch > run->depth)
+        {
+            batch = run->depth;
+        }
+        size_t before = run->numberOfLatencies;
+        context.batchStartUs = rhsp_getSteadyClockUs();
+        int result = rhsp_sendPipelinedReadCommandsInternal(hub, packetID, NULL, 0, batch,
+                                                            onBulkReadResponse, &context, NULL);
+        if (result < 0)
+        {
+            // every command of the batch without a response is counted as failed
+            for (size_t i = run->numberOfLatencies - before; i < batch; i++)
+            {
+                countError(&run->errors, result);
+            }
+        }
+        done += batch;
+    }
+    run->elapsedUs = rhsp_getSteadyClockUs() - start;
+}
+
+static int parseFlowControl(const char* value, RhspSerialFlowControl* flowControl)
+{
+    if (strcmp(value, "none") == 0)
+    {
+        *flowControl = RHSP_SERIAL_FLOW_CONTROL_NONE;
+    } else if (strcmp(value, "hardware") == 0)
+    {
+        *flowControl = RHSP_SERIAL_FLOW_CONTROL_HARDWARE;
+    } else if (strcmp(value, "software") == 0)
+    {
+        *flowControl = RHSP_SERIAL_FLOW_CONTROL_SOFTWARE;
+    } else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "usage: %s --serial <path> [--baud <rate>] [--flow none|hardware|software]\n"
+                    "       [--address <module address>] [--count <commands per run>]\n", program);
+}
+
+int main(int argc, char** argv)
+{
+    const char* serialPath = NULL;
+    uint32_t baudrate = PROBE_DEFAULT_BAUDRATE;
+    RhspSerialFlowControl flowControl = RHSP_SERIAL_FLOW_CONTROL_NONE;
+    int address = -1;
+    size_t count = PROBE_DEFAULT_COUNT;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (!value)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--serial") == 0)
+        {
+            serialPath = value;
+        } else if (strcmp(argv[i], "--baud") == 0)
+        {
+            baudrate = (uint32_t) strtoul(value, NULL, 10);
+        } else if (strcmp(argv[i], "--flow") == 0)
+        {
+            if (parseFlowControl(value, &flowControl) < 0)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--address") == 0)
+        {
+            address = atoi(value);
+        } else if (strcmp(argv[i], "--count") == 0)
+        {
+            count = strtoul(value, NULL, 10);
+        } else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (!serialPath || count == 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    RhspSerial serial;
+    rhsp_serialInit(&serial);
+    int result = rhsp_serialOpen(&serial, serialPath, baudrate, 8, RHSP_SERIAL_PARITY_NONE, 1, flowControl);
+    if (result != RHSP_SERIAL_NOERROR)
+    {
+        fprintf(stderr, "Unable to open %s: %d\n", serialPath, result);
+        return 1;
+    }
+
+    if (address < 0)
+    {
+        RhspDiscoveredAddresses addresses;
+        memset(&addresses, 0, sizeof(addresses));
+        result = rhsp_discoverRevHubs(&serial, &addresses);
+        if (result < 0)
+        {
+            fprintf(stderr, "Unable to discover a hub: %d\n", result);
+            rhsp_serialClose(&serial);
+            return 1;
+        }
+        address = addresses.parentAddress;
+    }
+
+    RhspRevHub* hub = rhsp_allocRevHub(&serial, (uint8_t) address);
+    uint16_t bulkReadPacketID;
+    result = rhsp_getDekaPacketID(hub, RHSP_DEKA_GET_BULK_INPUT_DATA, &bulkReadPacketID, NULL);
+    uint32_t* latenciesUs = malloc(count * sizeof(uint32_t));
+    if (result < 0 || !latenciesUs)
+    {
+        fprintf(stderr, "Unable to query the hub: %d\n", result);
+        free(latenciesUs);
+        freeRevHub(hub);
+        rhsp_serialClose(&serial);
+        return 1;
+    }
+
+    printf("%s, %u baud, module %d, %zu commands per run\n", serialPath, baudrate, address, count);
+    printHeader();
+
+    ProbeRun run = {"keep-alive", 1, count, latenciesUs};
+    rhsp_getLinkStats(hub, &run.linkStatsBefore);
+    runKeepAlive(hub, &run);
+    printRun(hub, &run);
+
+    run = (ProbeRun) {"max-payload", 1, count, latenciesUs};
+    rhsp_getLinkStats(hub, &run.linkStatsBefore);
+    runMaxPayload(hub, &run);
+    printRun(hub, &run);
+
+    for (size_t depth = 1; depth <= RHSP_PIPELINE_DEPTH; depth++)
+    {
+        run = (ProbeRun) {"bulk-read", depth, count, latenciesUs};
+        rhsp_getLinkStats(hub, &run.linkStatsBefore);
+        runBulkRead(hub, bulkReadPacketID, &run);
+        printRun(hub, &run);
+    }
+
+    rhsp_sendFailSafe(hub, NULL);
+    free(latenciesUs);
+    rhsp_close(hub);
+    freeRevHub(hub);
+    rhsp_serialClose(&serial);
+    return 0;
+}
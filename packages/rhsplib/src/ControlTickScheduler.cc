@@ -0,0 +1,363 @@
+#include "ControlTickScheduler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+#include "RevHubWrapper.h"
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+namespace {
+size_t histogramBucket(uint64_t us) {
+    const auto &buckets = ControlTickScheduler::histogramBucketsUs;
+    return std::upper_bound(buckets.begin(), buckets.end(), us) -
+           buckets.begin();
+}
+
+uint64_t toUs(std::chrono::steady_clock::duration duration) {
+    auto us =
+        std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    return us > 0 ? us : 0;
+}
+}  // namespace
+
+ControlTickScheduler::ControlTickScheduler(
+    RhspRevHub *hub, std::shared_ptr<PriorityMutex> mutex, uint32_t periodMs,
+    ControlTickPlan plan, Napi::ThreadSafeFunction onTick,
+    const RealtimeOptions &realtimeOptions)
+    : hub(hub),
+      mutex(std::move(mutex)),
+      period(std::chrono::milliseconds(std::max<uint32_t>(periodMs, 1))),
+      plan(std::move(plan)),
+      onTick(onTick) {
+    realtime.request(realtimeOptions);
+    startTime = clock::now();
+#if defined(__linux__)
+    // Without a timerfd, ticks are timed with the condition variable
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    stopFd = eventfd(0, EFD_CLOEXEC);
+    if (timerFd >= 0 && stopFd >= 0) {
+        // steady_clock is CLOCK_MONOTONIC, so ticks expire exactly at
+        // startTime + n * period
+        auto toTimespec = [](clock::duration duration) {
+            auto ns =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+                    .count();
+            timespec time;
+            time.tv_sec = ns / 1000000000;
+            time.tv_nsec = ns % 1000000000;
+            return time;
+        };
+        itimerspec spec{};
+        spec.it_interval = toTimespec(period);
+        spec.it_value = toTimespec(startTime.time_since_epoch() + period);
+        if (timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) != 0) {
+            close(timerFd);
+            timerFd = -1;
+        }
+    } else if (timerFd >= 0) {
+        close(timerFd);
+        timerFd = -1;
+    }
+#endif
+    thread = std::thread(&ControlTickScheduler::run, this);
+}
+
+ControlTickScheduler::~ControlTickScheduler() {
+    {
+        std::scoped_lock<std::mutex> lock{stateMutex};
+        stopRequested = true;
+    }
+    stopCondition.notify_all();
+#if defined(__linux__)
+    if (stopFd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(stopFd, &one, sizeof(one));
+        (void)written;
+    }
+#endif
+    thread.join();
+#if defined(__linux__)
+    if (timerFd >= 0) close(timerFd);
+    if (stopFd >= 0) close(stopFd);
+#endif
+    onTick.Release();
+}
+
+ControlTickScheduler::LatchedOutput *ControlTickScheduler::latchedOutputs(
+    ControlTickOutput output, int &numberOfChannels) {
+    switch (output) {
+        case ControlTickOutput::MotorConstantPower:
+            numberOfChannels = numberOfMotorChannels;
+            return motorConstantPower;
+        case ControlTickOutput::MotorTargetVelocity:
+            numberOfChannels = numberOfMotorChannels;
+            return motorTargetVelocity;
+        default:
+            numberOfChannels = numberOfServoChannels;
+            return servoPulseWidth;
+    }
+}
+
+int ControlTickScheduler::setOutput(ControlTickOutput output, uint8_t channel,
+                                    double value) {
+    int numberOfChannels;
+    LatchedOutput *outputs = latchedOutputs(output, numberOfChannels);
+    if (channel >= numberOfChannels) {
+        return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
+    }
+
+    std::scoped_lock<std::mutex> lock{outputMutex};
+    outputs[channel].value = value;
+    outputs[channel].changed = true;
+    return RHSP_RESULT_OK;
+}
+
+ControlTickScheduler::Stats ControlTickScheduler::stats() const {
+    Stats stats;
+    stats.ticks = ticks.load();
+    stats.missedTicks = missedTicks.load();
+    stats.overruns = overruns.load();
+    stats.droppedResults = droppedResults.load();
+    for (size_t i = 0; i < numberOfHistogramBuckets; i++) {
+        stats.jitterHistogram[i] = jitterHistogram[i].load();
+        stats.durationHistogram[i] = durationHistogram[i].load();
+    }
+    return stats;
+}
+
+uint64_t ControlTickScheduler::waitForTick(uint64_t tick) {
+#if defined(__linux__)
+    if (timerFd >= 0) {
+        pollfd fds[2] = {{timerFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+        while (true) {
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                return 0;
+            }
+            if (fds[1].revents != 0) {
+                return 0;
+            }
+            uint64_t expirations;
+            if (read(timerFd, &expirations, sizeof(expirations)) ==
+                sizeof(expirations)) {
+                return expirations;
+            }
+        }
+    }
+#endif
+    std::unique_lock<std::mutex> lock{stateMutex};
+    stopCondition.wait_until(lock, startTime + (tick + 1) * period,
+                             [this] { return stopRequested; });
+    if (stopRequested) {
+        return 0;
+    }
+    return (clock::now() - startTime) / period - tick;
+}
+
+void ControlTickScheduler::tick(Result &result) {
+    PriorityLock rhspLock{*mutex, CommandPriority::Actuation};
+
+    // Take the outputs that have changed. While javascript has a frame open
+    // they stay latched, since they would be recorded into its frame.
+    struct PendingOutput {
+        ControlTickOutput output;
+        uint8_t channel;
+        double value;
+    };
+    PendingOutput pending[2 * numberOfMotorChannels + numberOfServoChannels];
+    int numberOfPending = 0;
+    if (!rhsp_isOutputFrameOpen(hub)) {
+        std::scoped_lock<std::mutex> lock{outputMutex};
+        auto take = [&](ControlTickOutput output, LatchedOutput *outputs,
+                        int numberOfChannels) {
+            for (int i = 0; i < numberOfChannels; i++) {
+                if (!outputs[i].changed) continue;
+                outputs[i].changed = false;
+                pending[numberOfPending++] = {output, static_cast<uint8_t>(i),
+                                              outputs[i].value};
+            }
+        };
+        take(ControlTickOutput::MotorConstantPower, motorConstantPower,
+             numberOfMotorChannels);
+        take(ControlTickOutput::MotorTargetVelocity, motorTargetVelocity,
+             numberOfMotorChannels);
+        take(ControlTickOutput::ServoPulseWidth, servoPulseWidth,
+             numberOfServoChannels);
+    }
+
+    result.resultCode = RHSP_RESULT_OK;
+    if (numberOfPending > 0) {
+        rhsp_beginOutputFrame(hub);
+        for (int i = 0; i < numberOfPending; i++) {
+            const PendingOutput &output = pending[i];
+            int setResult = RHSP_RESULT_OK;
+            switch (output.output) {
+                case ControlTickOutput::MotorConstantPower:
+                    setResult = rhsp_setMotorConstantPower(
+                        hub, output.channel, output.value, &result.nackCode);
+                    break;
+                case ControlTickOutput::MotorTargetVelocity:
+                    setResult = rhsp_setMotorTargetVelocity(
+                        hub, output.channel,
+                        static_cast<int16_t>(std::clamp(
+                            std::lround(output.value), -32768L, 32767L)),
+                        &result.nackCode);
+                    break;
+                case ControlTickOutput::ServoPulseWidth:
+                    setResult = rhsp_setServoPulseWidth(
+                        hub, output.channel,
+                        static_cast<uint16_t>(std::clamp(
+                            std::lround(output.value), 0L, 65535L)),
+                        &result.nackCode);
+                    break;
+            }
+            // a rejected value is reported, but not latched again
+            if (setResult < 0 && result.resultCode >= 0) {
+                result.resultCode = setResult;
+            }
+        }
+        int commitResult = rhsp_commitOutputFrame(hub, &result.bulkInputData,
+                                                  &result.nackCode);
+        if (commitResult < 0) {
+            // The frame drops its values even if they have not been sent, so
+            // latch them again for the next tick, unless javascript has
+            // written a newer value meanwhile.
+            std::scoped_lock<std::mutex> lock{outputMutex};
+            for (int i = 0; i < numberOfPending; i++) {
+                const PendingOutput &output = pending[i];
+                int numberOfChannels;
+                LatchedOutput &latched = latchedOutputs(
+                    output.output, numberOfChannels)[output.channel];
+                if (!latched.changed) {
+                    latched.value = output.value;
+                    latched.changed = true;
+                }
+            }
+            result.resultCode = commitResult;
+        }
+        result.hasBulkInputData = commitResult >= 0 && plan.bulkInput;
+    } else if (plan.bulkInput) {
+        result.resultCode = rhsp_getBulkInputData(hub, &result.bulkInputData,
+                                                  &result.nackCode);
+        result.hasBulkInputData = result.resultCode >= 0;
+    }
+
+    // the i2c wait function releases the lock between operations and polls
+    result.i2cReads.resize(plan.i2cReads.size());
+    for (size_t i = 0; i < plan.i2cReads.size(); i++) {
+        ControlTickPlan::I2CRead &read = plan.i2cReads[i];
+        I2CSample &sample = result.i2cReads[i];
+        sample.resultCode = rhsp_runI2cOperations(
+            hub, read.i2cChannel, read.operations.data(),
+            read.operations.size(), nullptr, &sample.nackCode);
+        sample.timestampMs = std::chrono::duration<double, std::milli>(
+                                 clock::now().time_since_epoch())
+                                 .count();
+        sample.numBytes = 0;
+        if (sample.resultCode < 0) continue;
+        for (const RhspI2cOperation &operation : read.operations) {
+            if (operation.type == RHSP_I2C_OPERATION_WRITE) continue;
+            size_t numBytes = std::min<size_t>(
+                operation.length, sizeof(sample.bytes) - sample.numBytes);
+            memcpy(&sample.bytes[sample.numBytes], operation.buffer, numBytes);
+            sample.numBytes += numBytes;
+        }
+    }
+}
+
+void ControlTickScheduler::publish(Result *result) {
+    napi_status status = onTick.NonBlockingCall(
+        result, [](Napi::Env env, Napi::Function callback, Result *result) {
+            Napi::Object resultObj = Napi::Object::New(env);
+            resultObj.Set("tick", static_cast<double>(result->tick));
+            resultObj.Set("timestampMs", result->timestampMs);
+            resultObj.Set("jitterUs", result->jitterUs);
+            resultObj.Set("missedTicks", result->missedTicks);
+            if (result->resultCode < 0) {
+                Napi::Object errorObj = Napi::Object::New(env);
+                errorObj.Set("errorCode", result->resultCode);
+                if (result->resultCode == RHSP_ERROR_NACK_RECEIVED) {
+                    errorObj.Set("nackCode", result->nackCode);
+                }
+                resultObj.Set("error", errorObj);
+            }
+            if (result->hasBulkInputData) {
+                resultObj.Set("bulkInputData",
+                              bulkInputDataToObject(env, result->bulkInputData));
+            }
+            Napi::Array i2cReads = Napi::Array::New(env, result->i2cReads.size());
+            for (uint32_t i = 0; i < result->i2cReads.size(); i++) {
+                const I2CSample &sample = result->i2cReads[i];
+                Napi::Object sampleObj = Napi::Object::New(env);
+                sampleObj.Set("timestampMs", sample.timestampMs);
+                if (sample.resultCode < 0) {
+                    Napi::Object errorObj = Napi::Object::New(env);
+                    errorObj.Set("errorCode", sample.resultCode);
+                    if (sample.resultCode == RHSP_ERROR_NACK_RECEIVED) {
+                        errorObj.Set("nackCode", sample.nackCode);
+                    }
+                    sampleObj.Set("error", errorObj);
+                }
+                Napi::Array bytes = Napi::Array::New(env, sample.numBytes);
+                for (int j = 0; j < sample.numBytes; j++) {
+                    bytes[j] = sample.bytes[j];
+                }
+                sampleObj.Set("bytes", bytes);
+                i2cReads[i] = sampleObj;
+            }
+            resultObj.Set("i2cReads", i2cReads);
+            delete result;
+            callback.Call({resultObj});
+        });
+    if (status != napi_ok) {
+        droppedResults++;
+        delete result;
+    }
+}
+
+void ControlTickScheduler::run() {
+    uint64_t tickIndex = 0;
+    while (true) {
+        uint64_t elapsedTicks = waitForTick(tickIndex);
+        if (elapsedTicks == 0) {
+            break;
+        }
+        tickIndex += elapsedTicks;
+        realtime.applyPending(this, sizeof(*this));
+
+        auto deadline = startTime + tickIndex * period;
+        auto tickStart = clock::now();
+        realtime.recordWake(deadline);
+        realtime.recordMissedDeadlines(elapsedTicks - 1);
+
+        auto result = new Result{};
+        result->tick = tickIndex;
+        result->timestampMs = std::chrono::duration<double, std::milli>(
+                                  tickStart.time_since_epoch())
+                                  .count();
+        result->jitterUs = static_cast<uint32_t>(
+            std::min<uint64_t>(toUs(tickStart - deadline), UINT32_MAX));
+        result->missedTicks = static_cast<uint32_t>(elapsedTicks - 1);
+        tick(*result);
+        auto duration = clock::now() - tickStart;
+
+        ticks++;
+        missedTicks += elapsedTicks - 1;
+        if (duration > period) {
+            overruns++;
+        }
+        jitterHistogram[histogramBucket(result->jitterUs)]++;
+        durationHistogram[histogramBucket(toUs(duration))]++;
+
+        publish(result);
+    }
+    realtime.release();
+}
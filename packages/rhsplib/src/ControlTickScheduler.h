@@ -0,0 +1,168 @@
+#ifndef CONTROL_TICK_SCHEDULER_H_
+#define CONTROL_TICK_SCHEDULER_H_
+
+#include <napi.h>
+#include "rhsp/rhsp.h"
+#include "I2CSampler.h"
+#include "PriorityMutex.h"
+#include "RealtimeControl.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief What a control tick does, besides sending the outputs that have
+ * changed since the previous tick.
+ */
+struct ControlTickPlan {
+    struct I2CRead {
+        uint8_t i2cChannel;
+        std::vector<RhspI2cOperation> operations;
+    };
+
+    bool bulkInput = false;
+    std::vector<I2CRead> i2cReads;
+};
+
+enum class ControlTickOutput {
+    MotorConstantPower,
+    MotorTargetVelocity,
+    ServoPulseWidth,
+};
+
+/**
+ * @brief Runs a control tick plan at a fixed period from a native thread and
+ * publishes the results of each tick to javascript with one callback. On
+ * Linux, ticks are timed with a timerfd, so the kernel counts the ticks that
+ * have been missed.
+ *
+ * Outputs are latched by javascript at any time and sent by the next tick in
+ * one output frame, whose commit also reads the bulk input data.
+ */
+class ControlTickScheduler {
+  public:
+    // upper bounds of the histogram buckets in us. The last bucket is open.
+    static constexpr std::array<uint32_t, 9> histogramBucketsUs = {
+        50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000};
+    static constexpr size_t numberOfHistogramBuckets =
+        histogramBucketsUs.size() + 1;
+    // results waiting for the javascript thread. Older results are of little
+    // use to a control loop, so newer ones are dropped instead of queued.
+    static constexpr size_t maxQueuedResults = 4;
+    static constexpr int numberOfMotorChannels = 4;
+    static constexpr int numberOfServoChannels = 6;
+
+    /**
+     * @brief Results of one tick, passed to the callback.
+     */
+    struct Result {
+        uint64_t tick;         // index of the tick since the start
+        double timestampMs;    // steady clock time when the tick started
+        uint32_t jitterUs;     // how late the tick started
+        uint32_t missedTicks;  // ticks skipped right before this one
+        int resultCode;        // result of sending outputs and reading bulk input
+        uint8_t nackCode;
+        bool hasBulkInputData;
+        RhspBulkInputData bulkInputData;
+        std::vector<I2CSample> i2cReads;  // one per ControlTickPlan::I2CRead
+    };
+
+    struct Stats {
+        uint64_t ticks;
+        uint64_t missedTicks;
+        uint64_t overruns;  // ticks that took longer than the period
+        uint64_t droppedResults;  // results javascript did not take in time
+        std::array<uint64_t, numberOfHistogramBuckets> jitterHistogram;
+        std::array<uint64_t, numberOfHistogramBuckets> durationHistogram;
+    };
+
+    /**
+     * @brief Start ticking.
+     *
+     * @param hub Hub to control
+     * @param mutex Mutex of the serial port of the hub
+     * @param periodMs Time between the start of two ticks
+     * @param plan What each tick does
+     * @param onTick Receives a Result* after each tick
+     * @param realtimeOptions Scheduling options of the thread
+     */
+    ControlTickScheduler(RhspRevHub *hub, std::shared_ptr<PriorityMutex> mutex,
+                         uint32_t periodMs,
+                         ControlTickPlan plan, Napi::ThreadSafeFunction onTick,
+                         const RealtimeOptions &realtimeOptions);
+
+    /**
+     * @brief Stop ticking and wait for the thread to finish.
+     */
+    ~ControlTickScheduler();
+
+    ControlTickScheduler(const ControlTickScheduler &) = delete;
+    ControlTickScheduler &operator=(const ControlTickScheduler &) = delete;
+
+    /**
+     * @brief Latch an output value to be sent by the next tick.
+     *
+     * @return RHSP_RESULT_OK, or RHSP_ERROR_ARG_1_OUT_OF_RANGE if the channel
+     * does not exist
+     */
+    int setOutput(ControlTickOutput output, uint8_t channel, double value);
+
+    Stats stats() const;
+
+    void setRealtimeOptions(const RealtimeOptions &options) {
+        realtime.request(options);
+    }
+
+    RealtimeStats realtimeStats() const { return realtime.stats(); }
+
+  private:
+    using clock = RealtimeControl::clock;
+
+    struct LatchedOutput {
+        double value = 0;
+        bool changed = false;
+    };
+
+    LatchedOutput *latchedOutputs(ControlTickOutput output,
+                                  int &numberOfChannels);
+    void run();
+    uint64_t waitForTick(uint64_t tick);
+    void tick(Result &result);
+    void publish(Result *result);
+
+    RhspRevHub *hub;
+    std::shared_ptr<PriorityMutex> mutex;
+    clock::duration period;
+    ControlTickPlan plan;
+    Napi::ThreadSafeFunction onTick;
+    clock::time_point startTime;
+
+    std::mutex outputMutex;
+    LatchedOutput motorConstantPower[numberOfMotorChannels];
+    LatchedOutput motorTargetVelocity[numberOfMotorChannels];
+    LatchedOutput servoPulseWidth[numberOfServoChannels];
+
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<uint64_t> missedTicks{0};
+    std::atomic<uint64_t> overruns{0};
+    std::atomic<uint64_t> droppedResults{0};
+    std::array<std::atomic<uint64_t>, numberOfHistogramBuckets> jitterHistogram{};
+    std::array<std::atomic<uint64_t>, numberOfHistogramBuckets> durationHistogram{};
+
+    RealtimeControl realtime;
+
+    int timerFd = -1;  // Linux only
+    int stopFd = -1;   // Linux only, signalled to wake the thread up
+    std::mutex stateMutex;
+    std::condition_variable stopCondition;
+    bool stopRequested = false;
+    std::thread thread;
+};
+
+#endif
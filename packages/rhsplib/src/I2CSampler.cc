@@ -0,0 +1,103 @@
+#include "I2CSampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+I2CSampler::I2CSampler(RhspRevHub *hub, std::shared_ptr<PriorityMutex> mutex,
+                       uint8_t i2cChannel,
+                       std::vector<RhspI2cOperation> operations,
+                       uint32_t periodMs, size_t capacity,
+                       const RealtimeOptions &realtimeOptions)
+    : hub(hub),
+      mutex(std::move(mutex)),
+      i2cChannel(i2cChannel),
+      operations(std::move(operations)),
+      periodMs(std::max<uint32_t>(periodMs, 1)),
+      // one slot stays empty to tell a full ring from an empty one
+      ring(new I2CSample[capacity + 1]),
+      capacity(capacity + 1) {
+    realtime.request(realtimeOptions);
+    thread = std::thread(&I2CSampler::run, this);
+}
+
+I2CSampler::~I2CSampler() {
+    {
+        std::scoped_lock<std::mutex> lock{stateMutex};
+        stopRequested = true;
+    }
+    stopCondition.notify_all();
+    thread.join();
+}
+
+uint32_t I2CSampler::drain(std::vector<I2CSample> &out) {
+    size_t currentTail = tail.load(std::memory_order_relaxed);
+    size_t currentHead = head.load(std::memory_order_acquire);
+    while (currentTail != currentHead) {
+        out.push_back(ring[currentTail]);
+        currentTail = (currentTail + 1) % capacity;
+    }
+    tail.store(currentTail, std::memory_order_release);
+    return droppedSamples.exchange(0);
+}
+
+void I2CSampler::push(const I2CSample &sample) {
+    size_t currentHead = head.load(std::memory_order_relaxed);
+    size_t nextHead = (currentHead + 1) % capacity;
+    if (nextHead == tail.load(std::memory_order_acquire)) {
+        droppedSamples++;
+        return;
+    }
+    ring[currentHead] = sample;
+    head.store(nextHead, std::memory_order_release);
+}
+
+void I2CSampler::run() {
+    using clock = RealtimeControl::clock;
+    const auto period = std::chrono::milliseconds(periodMs);
+    auto nextSampleTime = clock::now();
+
+    // sized once, so that copying the operations does not allocate
+    std::vector<RhspI2cOperation> scratch = operations;
+    std::unique_lock<std::mutex> lock{stateMutex};
+    while (!stopRequested) {
+        lock.unlock();
+        realtime.applyPending(ring.get(), capacity * sizeof(I2CSample));
+        realtime.recordWake(nextSampleTime);
+
+        I2CSample sample{};
+        scratch = operations;
+        {
+            // released between operations and polls by the i2c wait function
+            PriorityLock rhspLock{*mutex, CommandPriority::Telemetry};
+            sample.resultCode =
+                rhsp_runI2cOperations(hub, i2cChannel, scratch.data(),
+                                      scratch.size(), nullptr, &sample.nackCode);
+        }
+        sample.timestampMs =
+            std::chrono::duration<double, std::milli>(
+                clock::now().time_since_epoch())
+                .count();
+        if (sample.resultCode >= 0) {
+            for (const RhspI2cOperation &operation : scratch) {
+                if (operation.type == RHSP_I2C_OPERATION_WRITE) continue;
+                size_t numBytes = std::min<size_t>(
+                    operation.length, sizeof(sample.bytes) - sample.numBytes);
+                memcpy(&sample.bytes[sample.numBytes], operation.buffer,
+                       numBytes);
+                sample.numBytes += numBytes;
+            }
+        }
+        push(sample);
+
+        // Keep a fixed rate. Periods that have been missed because the bus was
+        // slow are skipped instead of being run back to back.
+        nextSampleTime = realtime.nextDeadline(nextSampleTime, period);
+
+        lock.lock();
+        stopCondition.wait_until(lock, nextSampleTime,
+                                 [this] { return stopRequested; });
+    }
+    lock.unlock();
+    realtime.release();
+}
@@ -0,0 +1,107 @@
+#ifndef I2C_SAMPLER_H_
+#define I2C_SAMPLER_H_
+
+#include "rhsp/rhsp.h"
+#include "PriorityMutex.h"
+#include "RealtimeControl.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief One run of the sampler's operations.
+ */
+struct I2CSample {
+    double timestampMs;  // steady clock time when the operations completed
+    int resultCode;
+    uint8_t nackCode;
+    uint8_t numBytes;
+    uint8_t bytes[RHSP_I2C_OPERATION_MAX_BUFFER_SIZE];  // bytes of all reads
+};
+
+/**
+ * @brief Runs a list of I2C operations on one channel at a fixed period from a
+ * native thread and stores the results in a ring buffer that javascript drains.
+ * The ring has a single producer (the sampler thread) and a single consumer
+ * (the javascript thread), so it needs no lock. If the consumer falls behind,
+ * new samples are dropped and counted.
+ */
+class I2CSampler {
+  public:
+    static constexpr size_t maxCapacity = 4096;
+
+    /**
+     * @brief Start sampling.
+     *
+     * @param hub Hub to sample from
+     * @param mutex Mutex of the serial port of the hub
+     * @param i2cChannel I2C channel
+     * @param operations Operations to run for each sample
+     * @param periodMs Time between the start of two samples, at least 1
+     * @param capacity Number of samples the ring can hold, in range 1 -
+     * maxCapacity
+     * @param realtimeOptions Scheduling options of the thread
+     */
+    I2CSampler(RhspRevHub *hub, std::shared_ptr<PriorityMutex> mutex,
+               uint8_t i2cChannel,
+               std::vector<RhspI2cOperation> operations, uint32_t periodMs,
+               size_t capacity, const RealtimeOptions &realtimeOptions);
+
+    /**
+     * @brief Stop sampling and wait for the thread to finish.
+     */
+    ~I2CSampler();
+
+    I2CSampler(const I2CSampler &) = delete;
+    I2CSampler &operator=(const I2CSampler &) = delete;
+
+    /**
+     * @brief Move all available samples to out.
+     *
+     * @return number of samples dropped since the last call
+     */
+    uint32_t drain(std::vector<I2CSample> &out);
+
+    /**
+     * @brief Change the scheduling options. They are applied before the next
+     * sample. Locking memory also locks the ring.
+     */
+    void setRealtimeOptions(const RealtimeOptions &options) {
+        realtime.request(options);
+    }
+
+    /**
+     * @brief Get the timing of the thread. A deadline is missed if a period
+     * is skipped.
+     */
+    RealtimeStats realtimeStats() const { return realtime.stats(); }
+
+  private:
+    void run();
+    void push(const I2CSample &sample);
+
+    RhspRevHub *hub;
+    std::shared_ptr<PriorityMutex> mutex;
+    uint8_t i2cChannel;
+    std::vector<RhspI2cOperation> operations;
+    uint32_t periodMs;
+
+    std::unique_ptr<I2CSample[]> ring;
+    size_t capacity;
+    std::atomic<size_t> head{0};  // next slot to write, owned by the sampler
+    std::atomic<size_t> tail{0};  // next slot to read, owned by javascript
+    std::atomic<uint32_t> droppedSamples{0};
+
+    RealtimeControl realtime;
+
+    std::mutex stateMutex;
+    std::condition_variable stopCondition;
+    bool stopRequested = false;
+    std::thread thread;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef INLINEFUNCTION_H_
+#define INLINEFUNCTION_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, size_t Capacity>
+class InlineFunction;
+
+/**
+ * @brief Callable holder that keeps the callable in fixed-size storage
+ * inside the object instead of on the heap. Callables larger than Capacity
+ * still work, but are heap allocated; isHeapAllocated() reports this so that
+ * the caller can count it.
+ *
+ * @tparam R Return type
+ * @tparam Args Parameter types
+ * @tparam Capacity Size of the inline storage in bytes
+ */
+template <typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity> {
+  public:
+    InlineFunction() = default;
+    ~InlineFunction() { reset(); }
+
+    InlineFunction(const InlineFunction &) = delete;
+    InlineFunction &operator=(const InlineFunction &) = delete;
+
+    /**
+     * @brief Replace the stored callable.
+     *
+     * @param f Callable accepting Args... and returning R
+     */
+    template <typename Function>
+    void assign(Function &&f) {
+        using Callable = std::decay_t<Function>;
+        reset();
+        if constexpr (sizeof(Callable) <= Capacity &&
+                      alignof(Callable) <= alignof(std::max_align_t)) {
+            object = new (&storage) Callable(std::forward<Function>(f));
+            heapAllocated = false;
+        } else {
+            object = new Callable(std::forward<Function>(f));
+            heapAllocated = true;
+        }
+        invokeFunction = [](void *callable, Args... args) -> R {
+            return (*static_cast<Callable *>(callable))(
+                std::forward<Args>(args)...);
+        };
+        destroyFunction = [](void *callable, bool heap) {
+            if (heap) {
+                delete static_cast<Callable *>(callable);
+            } else {
+                static_cast<Callable *>(callable)->~Callable();
+            }
+        };
+    }
+
+    /**
+     * @brief Destroy the stored callable, releasing everything it captured.
+     */
+    void reset() {
+        if (object) {
+            destroyFunction(object, heapAllocated);
+            object = nullptr;
+        }
+    }
+
+    bool isHeapAllocated() const { return object && heapAllocated; }
+
+    explicit operator bool() const { return object != nullptr; }
+
+    R operator()(Args... args) {
+        return invokeFunction(object, std::forward<Args>(args)...);
+    }
+
+  private:
+    alignas(std::max_align_t) unsigned char storage[Capacity];
+    void *object = nullptr;
+    bool heapAllocated = false;
+    R (*invokeFunction)(void *, Args...) = nullptr;
+    void (*destroyFunction)(void *, bool) = nullptr;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "KeepAliveThread.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+struct KeepAliveError {
+    int errorCode;
+    uint8_t nackCode;
+};
+}  // namespace
+
+KeepAliveThread::KeepAliveThread(RhspRevHub *hub,
+                                 std::shared_ptr<PriorityMutex> mutex,
+                                 uint32_t intervalMs,
+                                 Napi::ThreadSafeFunction onError,
+                                 const RealtimeOptions &realtimeOptions)
+    : hub(hub),
+      mutex(std::move(mutex)),
+      intervalMs(std::max(intervalMs, minIntervalMs)),
+      onError(onError) {
+    realtime.request(realtimeOptions);
+    thread = std::thread(&KeepAliveThread::run, this);
+}
+
+KeepAliveThread::~KeepAliveThread() {
+    {
+        std::scoped_lock<std::mutex> lock{stateMutex};
+        stopRequested = true;
+    }
+    stopCondition.notify_all();
+    thread.join();
+    onError.Release();
+}
+
+void KeepAliveThread::run() {
+    using clock = RealtimeControl::clock;
+    auto deadline = clock::now();
+
+    std::unique_lock<std::mutex> lock{stateMutex};
+    while (!stopRequested) {
+        lock.unlock();
+        realtime.applyPending();
+        realtime.recordWake(deadline);
+
+        int result;
+        uint8_t nackCode = 0;
+        uint32_t idleTimeMs;
+        {
+            PriorityLock rhspLock{*mutex, CommandPriority::Actuation};
+            if (rhsp_idleTimeMs(hub) > intervalMs) {
+                realtime.recordMissedDeadlines(1);
+            }
+            result = rhsp_sendKeepAliveIfIdle(hub, intervalMs, &nackCode);
+            idleTimeMs = rhsp_idleTimeMs(hub);
+        }
+
+        if (result < 0) {
+            auto error = new KeepAliveError{result, nackCode};
+            napi_status status = onError.NonBlockingCall(
+                error, [](Napi::Env env, Napi::Function callback,
+                          KeepAliveError *error) {
+                    Napi::Object errorObj = Napi::Object::New(env);
+                    errorObj.Set("errorCode", error->errorCode);
+                    if (error->errorCode == RHSP_ERROR_NACK_RECEIVED) {
+                        errorObj.Set("nackCode", error->nackCode);
+                    }
+                    delete error;
+                    callback.Call({errorObj});
+                });
+            if (status != napi_ok) {
+                delete error;
+            }
+        }
+
+        // Sleep until the hub has been idle for the whole interval. If keep
+        // alive failed, retry after a full interval.
+        uint32_t sleepMs = intervalMs;
+        if (result >= 0 && idleTimeMs < intervalMs) {
+            sleepMs = intervalMs - idleTimeMs;
+        }
+
+        deadline = clock::now() + std::chrono::milliseconds(sleepMs);
+        lock.lock();
+        stopCondition.wait_until(lock, deadline,
+                                 [this] { return stopRequested; });
+    }
+    lock.unlock();
+    realtime.release();
+}
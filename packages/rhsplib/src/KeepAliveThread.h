@@ -0,0 +1,77 @@
+#ifndef KEEP_ALIVE_THREAD_H_
+#define KEEP_ALIVE_THREAD_H_
+
+#include <napi.h>
+#include "rhsp/rhsp.h"
+#include "PriorityMutex.h"
+#include "RealtimeControl.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Sends keep alive to a hub from a native thread, so that garbage
+ * collection pauses and a busy event loop cannot make the hub fail safe.
+ * Keep alive is only sent if no other command has been sent to the hub during
+ * the interval.
+ */
+class KeepAliveThread {
+  public:
+    // shorter intervals would keep the hub busy with keep alive
+    static constexpr uint32_t minIntervalMs = 20;
+
+    /**
+     * @brief Start the thread.
+     *
+     * @param hub Hub to keep alive
+     * @param mutex Mutex of the serial port of the hub
+     * @param intervalMs Maximum time between two commands, at least
+     * minIntervalMs
+     * @param onError Called with an error object if sending keep alive fails
+     * @param realtimeOptions Scheduling options of the thread
+     */
+    KeepAliveThread(RhspRevHub *hub, std::shared_ptr<PriorityMutex> mutex,
+                    uint32_t intervalMs,
+                    Napi::ThreadSafeFunction onError,
+                    const RealtimeOptions &realtimeOptions);
+
+    /**
+     * @brief Stop the thread and wait for it to finish.
+     */
+    ~KeepAliveThread();
+
+    KeepAliveThread(const KeepAliveThread &) = delete;
+    KeepAliveThread &operator=(const KeepAliveThread &) = delete;
+
+    /**
+     * @brief Change the scheduling options. They are applied before the next
+     * keep alive.
+     */
+    void setRealtimeOptions(const RealtimeOptions &options) {
+        realtime.request(options);
+    }
+
+    /**
+     * @brief Get the timing of the thread. A deadline is missed if the hub
+     * has been idle for longer than the interval when keep alive is sent.
+     */
+    RealtimeStats realtimeStats() const { return realtime.stats(); }
+
+  private:
+    void run();
+
+    RhspRevHub *hub;
+    std::shared_ptr<PriorityMutex> mutex;
+    uint32_t intervalMs;
+    Napi::ThreadSafeFunction onError;
+    RealtimeControl realtime;
+
+    std::mutex stateMutex;
+    std::condition_variable stopCondition;
+    bool stopRequested = false;
+    std::thread thread;
+};
+
+#endif
@@ -0,0 +1,232 @@
+#include "MotionProfileExecutor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+int32_t encoderPosition(const RhspBulkInputData &data, int motorChannel) {
+    switch (motorChannel) {
+        case 0:
+            return data.motor0position_enc;
+        case 1:
+            return data.motor1position_enc;
+        case 2:
+            return data.motor2position_enc;
+        default:
+            return data.motor3position_enc;
+    }
+}
+
+int16_t velocitySetpoint(double velocity) {
+    return static_cast<int16_t>(
+        std::clamp(std::lround(velocity), -32768L, 32767L));
+}
+
+// state of a channel copied out of the lock for one period
+struct Step {
+    bool active = false;
+    uint64_t generation;
+    bool started;
+    bool cancelRequested;
+    RhspMotionProfile profile;
+    double positionGain;
+    int32_t startPosition;
+    std::chrono::steady_clock::time_point startTime;
+    bool finished = false;
+};
+}  // namespace
+
+MotionProfileExecutor::MotionProfileExecutor(
+    RhspRevHub *hub, std::shared_ptr<PriorityMutex> mutex, uint32_t periodMs,
+    const RealtimeOptions &realtimeOptions)
+    : hub(hub), mutex(std::move(mutex)), period(std::max<uint32_t>(periodMs, 1)) {
+    realtime.request(realtimeOptions);
+    thread = std::thread(&MotionProfileExecutor::run, this);
+}
+
+MotionProfileExecutor::~MotionProfileExecutor() {
+    {
+        std::scoped_lock<std::mutex> lock{stateMutex};
+        stopRequested = true;
+    }
+    stateCondition.notify_all();
+    thread.join();
+
+    for (Channel &channel : channels) {
+        if (channel.active) {
+            complete(channel, {RHSP_RESULT_OK, 0, channel.position, true});
+        }
+    }
+}
+
+void MotionProfileExecutor::start(uint8_t motorChannel,
+                                  const RhspMotionProfile &profile,
+                                  double positionGain,
+                                  Napi::ThreadSafeFunction onComplete) {
+    {
+        std::scoped_lock<std::mutex> lock{stateMutex};
+        Channel &channel = channels[motorChannel];
+        if (channel.active) {
+            complete(channel, {RHSP_RESULT_OK, 0, channel.position, true});
+        }
+        channel.active = true;
+        channel.generation++;
+        channel.started = false;
+        channel.cancelRequested = false;
+        channel.profile = profile;
+        channel.positionGain = positionGain;
+        channel.onComplete = onComplete;
+    }
+    stateCondition.notify_all();
+}
+
+void MotionProfileExecutor::cancel(uint8_t motorChannel) {
+    std::scoped_lock<std::mutex> lock{stateMutex};
+    channels[motorChannel].cancelRequested = true;
+}
+
+void MotionProfileExecutor::complete(Channel &channel,
+                                     const Completion &completion) {
+    auto result = new Completion(completion);
+    napi_status status = channel.onComplete.NonBlockingCall(
+        result,
+        [](Napi::Env env, Napi::Function callback, Completion *result) {
+            Napi::Object resultObj = Napi::Object::New(env);
+            resultObj.Set("position", result->position);
+            resultObj.Set("cancelled", result->cancelled);
+            if (result->resultCode < 0) {
+                Napi::Object errorObj = Napi::Object::New(env);
+                errorObj.Set("errorCode", result->resultCode);
+                if (result->resultCode == RHSP_ERROR_NACK_RECEIVED) {
+                    errorObj.Set("nackCode", result->nackCode);
+                }
+                resultObj.Set("error", errorObj);
+            }
+            delete result;
+            callback.Call({resultObj});
+        });
+    if (status != napi_ok) {
+        delete result;
+    }
+    channel.onComplete.Release();
+    channel.active = false;
+}
+
+void MotionProfileExecutor::run() {
+    auto nextStepTime = clock::now();
+    Step steps[numberOfMotorChannels];
+
+    std::unique_lock<std::mutex> lock{stateMutex};
+    while (!stopRequested) {
+        bool anyActive = false;
+        bool anyStarting = false;
+        for (int i = 0; i < numberOfMotorChannels; i++) {
+            const Channel &channel = channels[i];
+            Step &step = steps[i];
+            step = Step{};
+            if (!channel.active) continue;
+            step.active = true;
+            step.generation = channel.generation;
+            step.started = channel.started;
+            step.cancelRequested = channel.cancelRequested;
+            step.profile = channel.profile;
+            step.positionGain = channel.positionGain;
+            step.startPosition = channel.startPosition;
+            step.startTime = channel.startTime;
+            anyActive = true;
+            anyStarting = anyStarting || !channel.started;
+        }
+        if (!anyActive) {
+            stateCondition.wait(lock);
+            nextStepTime = clock::now();
+            continue;
+        }
+        lock.unlock();
+        realtime.applyPending(this, sizeof(*this));
+        realtime.recordWake(nextStepTime);
+
+        int result = RHSP_RESULT_OK;
+        uint8_t nackCode = 0;
+        bool stepTaken = false;
+        RhspBulkInputData bulkInputData{};
+        {
+            PriorityLock rhspLock{*mutex, CommandPriority::Actuation};
+            // Leave a frame that javascript has opened alone and try again in
+            // the next period
+            if (!rhsp_isOutputFrameOpen(hub)) {
+                stepTaken = true;
+                auto now = clock::now();
+                if (anyStarting) {
+                    result = rhsp_getBulkInputData(hub, &bulkInputData, &nackCode);
+                    for (int i = 0; result >= 0 && i < numberOfMotorChannels; i++) {
+                        if (steps[i].active && !steps[i].started) {
+                            steps[i].started = true;
+                            steps[i].startPosition = encoderPosition(bulkInputData, i);
+                            steps[i].startTime = now;
+                        }
+                    }
+                } else {
+                    RhspEncoderSample latest;
+                    if (rhsp_getLatestEncoderSample(hub, &latest) >= 0) {
+                        bulkInputData.motor0position_enc = latest.position[0];
+                        bulkInputData.motor1position_enc = latest.position[1];
+                        bulkInputData.motor2position_enc = latest.position[2];
+                        bulkInputData.motor3position_enc = latest.position[3];
+                    }
+                }
+
+                if (result >= 0) {
+                    rhsp_beginOutputFrame(hub);
+                    for (int i = 0; i < numberOfMotorChannels; i++) {
+                        Step &step = steps[i];
+                        if (!step.active) continue;
+                        double time = std::chrono::duration<double>(now - step.startTime).count();
+                        double velocity = 0;
+                        if (step.cancelRequested || time >= step.profile.duration) {
+                            step.finished = true;
+                        } else {
+                            RhspMotionState state;
+                            rhsp_sampleMotionProfile(&step.profile, time, &state);
+                            double error = step.startPosition + state.position -
+                                           encoderPosition(bulkInputData, i);
+                            velocity = state.velocity + step.positionGain * error;
+                        }
+                        rhsp_setMotorTargetVelocity(hub, i, velocitySetpoint(velocity), &nackCode);
+                    }
+                    result = rhsp_commitOutputFrame(hub, &bulkInputData, &nackCode);
+                }
+            }
+        }
+
+        lock.lock();
+        for (int i = 0; stepTaken && i < numberOfMotorChannels; i++) {
+            Channel &channel = channels[i];
+            const Step &step = steps[i];
+            // skip channels that have been restarted in the meantime
+            if (!step.active || !channel.active ||
+                channel.generation != step.generation) {
+                continue;
+            }
+            channel.started = step.started;
+            channel.startPosition = step.startPosition;
+            channel.startTime = step.startTime;
+            if (result >= 0) {
+                channel.position = encoderPosition(bulkInputData, i);
+            }
+            if (result < 0) {
+                complete(channel, {result, nackCode, channel.position, false});
+            } else if (step.finished) {
+                complete(channel, {result, 0, channel.position,
+                                   step.cancelRequested});
+            }
+        }
+
+        // Keep a fixed rate. Periods that have been missed because the link
+        // was slow are skipped instead of being sent back to back.
+        nextStepTime = realtime.nextDeadline(nextStepTime, period);
+        stateCondition.wait_until(lock, nextStepTime,
+                                  [this] { return stopRequested; });
+    }
+    lock.unlock();
+    realtime.release();
+}
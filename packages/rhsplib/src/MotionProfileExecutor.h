@@ -0,0 +1,121 @@
+#ifndef MOTION_PROFILE_EXECUTOR_H_
+#define MOTION_PROFILE_EXECUTOR_H_
+
+#include <napi.h>
+#include "rhsp/rhsp.h"
+#include "PriorityMutex.h"
+#include "RealtimeControl.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Streams motion profile setpoints to the motors of a hub from a native
+ * thread. Every period, the velocity setpoints of all running profiles are
+ * sent with rhsp_setMotorTargetVelocity in one output frame, so moves on
+ * several channels share one transaction. The motors must be enabled and in
+ * MOTOR_MODE_REGULATED_VELOCITY.
+ */
+class MotionProfileExecutor {
+  public:
+    static constexpr int numberOfMotorChannels = RHSP_ENCODER_NUMBER_OF_MOTORS;
+
+    /**
+     * @brief Called on the javascript thread once a profile has ended.
+     * resultCode is negative if sending a setpoint failed.
+     */
+    struct Completion {
+        int resultCode;
+        uint8_t nackCode;
+        int32_t position;  // encoder position at the end of the profile
+        bool cancelled;
+    };
+
+    /**
+     * @brief Start the thread.
+     *
+     * @param hub Hub whose motors are driven
+     * @param mutex Mutex of the serial port of the hub
+     * @param periodMs Time between two setpoints
+     * @param realtimeOptions Scheduling options of the thread
+     */
+    MotionProfileExecutor(RhspRevHub *hub, std::shared_ptr<PriorityMutex> mutex,
+                          uint32_t periodMs,
+                          const RealtimeOptions &realtimeOptions);
+
+    /**
+     * @brief Cancel all profiles and wait for the thread to finish.
+     */
+    ~MotionProfileExecutor();
+
+    MotionProfileExecutor(const MotionProfileExecutor &) = delete;
+    MotionProfileExecutor &operator=(const MotionProfileExecutor &) = delete;
+
+    /**
+     * @brief Start a profile on a channel. A profile already running on the
+     * channel is cancelled.
+     *
+     * @param motorChannel Motor channel
+     * @param profile Planned profile, relative to the current encoder position
+     * @param positionGain Velocity added per count of position error, in 1/s.
+     * 0 streams the profile velocity only.
+     * @param onComplete Receives a Completion* once the profile has ended
+     */
+    void start(uint8_t motorChannel, const RhspMotionProfile &profile,
+               double positionGain, Napi::ThreadSafeFunction onComplete);
+
+    /**
+     * @brief Cancel the profile of a channel. The motor is stopped with the
+     * next setpoint.
+     */
+    void cancel(uint8_t motorChannel);
+
+    /**
+     * @brief Change the scheduling options. They are applied before the next
+     * setpoint.
+     */
+    void setRealtimeOptions(const RealtimeOptions &options) {
+        realtime.request(options);
+    }
+
+    /**
+     * @brief Get the timing of the thread. A deadline is missed if a period
+     * is skipped.
+     */
+    RealtimeStats realtimeStats() const { return realtime.stats(); }
+
+  private:
+    using clock = std::chrono::steady_clock;
+
+    struct Channel {
+        bool active = false;
+        uint64_t generation = 0;  // incremented by start()
+        bool cancelRequested = false;
+        bool started = false;  // start position and time are known
+        RhspMotionProfile profile;
+        double positionGain;
+        int32_t startPosition;
+        clock::time_point startTime;
+        int32_t position = 0;  // last encoder position received
+        Napi::ThreadSafeFunction onComplete;
+    };
+
+    void run();
+    void complete(Channel &channel, const Completion &completion);
+
+    RhspRevHub *hub;
+    std::shared_ptr<PriorityMutex> mutex;
+    std::chrono::milliseconds period;
+    Channel channels[numberOfMotorChannels];
+    RealtimeControl realtime;
+
+    std::mutex stateMutex;
+    std::condition_variable stateCondition;
+    bool stopRequested = false;
+    std::thread thread;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "PriorityMutex.h"
+
+#include <algorithm>
+#include <thread>
+
+constexpr std::array<PriorityMutex::clock::duration, numberOfCommandPriorities>
+    PriorityMutex::maxWait;
+
+void PriorityMutex::lock(CommandPriority priority) {
+    std::unique_lock<std::mutex> lock{stateMutex};
+    clock::time_point enqueued = clock::now();
+    if (!locked && waiters.empty()) {
+        locked = true;
+        holderPriority = priority;
+        recordAcquired(priority, enqueued, false);
+        return;
+    }
+
+    Waiter waiter{priority, enqueued};
+    waiters.push_back(&waiter);
+    CommandQueueStats &stats = queueStats[static_cast<size_t>(priority)];
+    stats.waiting++;
+    stats.maxWaiting = std::max(stats.maxWaiting, stats.waiting);
+    waiter.condition.wait(lock, [&waiter] { return waiter.granted; });
+}
+
+void PriorityMutex::unlock() {
+    std::scoped_lock<std::mutex> lock{stateMutex};
+    if (waiters.empty()) {
+        locked = false;
+        return;
+    }
+
+    // the highest class waiting, first come first served
+    auto byPriority = [](const Waiter *a, const Waiter *b) {
+        return a->priority < b->priority;
+    };
+    auto next = std::min_element(waiters.begin(), waiters.end(), byPriority);
+    bool promoted = false;
+    if ((*next)->priority != CommandPriority::Safety) {
+        // unless a waiter has waited too long, the one with the earliest
+        // deadline first
+        clock::time_point now = clock::now();
+        auto deadline = [](const Waiter *waiter) {
+            return waiter->enqueued +
+                   maxWait[static_cast<size_t>(waiter->priority)];
+        };
+        auto overdue = std::min_element(
+            waiters.begin(), waiters.end(),
+            [&deadline](const Waiter *a, const Waiter *b) {
+                return deadline(a) < deadline(b);
+            });
+        if (deadline(*overdue) < now &&
+            (*overdue)->priority != (*next)->priority) {
+            next = overdue;
+            promoted = true;
+        }
+    }
+
+    Waiter *waiter = *next;
+    waiters.erase(next);
+    queueStats[static_cast<size_t>(waiter->priority)].waiting--;
+    holderPriority = waiter->priority;
+    recordAcquired(waiter->priority, waiter->enqueued, promoted);
+    // the lock is handed over without being released
+    waiter->granted = true;
+    waiter->condition.notify_one();
+}
+
+void PriorityMutex::yield(clock::duration duration) {
+    CommandPriority priority;
+    {
+        std::scoped_lock<std::mutex> lock{stateMutex};
+        priority = holderPriority;
+    }
+    unlock();
+    if (duration > clock::duration::zero()) {
+        std::this_thread::sleep_for(duration);
+    }
+    lock(priority);
+}
+
+CommandQueueStats PriorityMutex::stats(CommandPriority priority) const {
+    std::scoped_lock<std::mutex> lock{stateMutex};
+    return queueStats[static_cast<size_t>(priority)];
+}
+
+void PriorityMutex::recordAcquired(CommandPriority priority,
+                                   clock::time_point enqueued, bool promoted) {
+    CommandQueueStats &stats = queueStats[static_cast<size_t>(priority)];
+    auto waitUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                      clock::now() - enqueued)
+                      .count();
+    uint32_t clampedWaitUs =
+        waitUs > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(waitUs);
+    stats.acquired++;
+    stats.promoted += promoted ? 1 : 0;
+    stats.totalWaitUs += clampedWaitUs;
+    stats.maxWaitUs = std::max(stats.maxWaitUs, clampedWaitUs);
+}
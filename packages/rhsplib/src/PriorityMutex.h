@@ -0,0 +1,102 @@
+#ifndef PRIORITY_MUTEX_H_
+#define PRIORITY_MUTEX_H_
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Priority class of a command waiting for RHSPlib, highest first.
+ */
+enum class CommandPriority {
+    Safety,       // fail safe
+    Actuation,    // outputs and their configuration, keep alive
+    Telemetry,    // sensor and status reads
+    Diagnostics,  // versions, LEDs, discovery, logging
+};
+
+constexpr size_t numberOfCommandPriorities = 4;
+
+/**
+ * @brief Queue of one priority class, see PriorityMutex::stats.
+ */
+struct CommandQueueStats {
+    uint32_t waiting;     // commands waiting now
+    uint32_t maxWaiting;  // most commands that have waited at once
+    uint64_t acquired;
+    uint64_t promoted;    // acquired ahead of their class after waiting too long
+    uint64_t totalWaitUs;
+    uint32_t maxWaitUs;
+};
+
+/**
+ * @brief Mutex whose waiters are granted the lock by priority class instead
+ * of in arrival order, so a fail safe or motor command only waits for the
+ * command that is running. A waiter that has waited longer than the bound of
+ * its class is served before everything but safety commands, so lower classes
+ * are delayed but never starved.
+ */
+class PriorityMutex {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    // longest wait before a waiter is served ahead of higher classes
+    static constexpr std::array<clock::duration, numberOfCommandPriorities>
+        maxWait = {std::chrono::milliseconds(0), std::chrono::milliseconds(5),
+                   std::chrono::milliseconds(20),
+                   std::chrono::milliseconds(100)};
+
+    void lock(CommandPriority priority);
+    void unlock();
+
+    /**
+     * @brief Release the mutex for at least duration, then take it back with
+     * the priority it was held with. Waiters run in between. Must be called
+     * by the holder.
+     */
+    void yield(clock::duration duration);
+
+    CommandQueueStats stats(CommandPriority priority) const;
+
+  private:
+    struct Waiter {
+        CommandPriority priority;
+        clock::time_point enqueued;
+        std::condition_variable condition;
+        bool granted = false;
+    };
+
+    void recordAcquired(CommandPriority priority, clock::time_point enqueued,
+                        bool promoted);
+
+    mutable std::mutex stateMutex;
+    bool locked = false;
+    CommandPriority holderPriority = CommandPriority::Diagnostics;
+    std::vector<Waiter *> waiters;  // in arrival order
+    std::array<CommandQueueStats, numberOfCommandPriorities> queueStats{};
+};
+
+/**
+ * @brief Holds a PriorityMutex for a scope.
+ */
+class PriorityLock {
+  public:
+    PriorityLock(PriorityMutex &mutex, CommandPriority priority)
+        : mutex(mutex) {
+        mutex.lock(priority);
+    }
+
+    ~PriorityLock() { mutex.unlock(); }
+
+    PriorityLock(const PriorityLock &) = delete;
+    PriorityLock &operator=(const PriorityLock &) = delete;
+
+  private:
+    PriorityMutex &mutex;
+};
+
+#endif
@@ -1,3 +1,19 @@
 #include "RHSPlibWorker.h"
 
-std::mutex RHSPlibWorkerBase::m_mutex;
+std::mutex RHSPlibWorkerBase::m_poolMutex;
+std::atomic<uint64_t> RHSPlibWorkerBase::m_createdWorkers{0};
+std::atomic<uint64_t> RHSPlibWorkerBase::m_reusedWorkers{0};
+std::atomic<uint64_t> RHSPlibWorkerBase::m_heapCallables{0};
+std::atomic<uint64_t> RHSPlibWorkerBase::m_supersededCommands{0};
+
+Napi::Value RHSPlibWorkerBase::GetStats(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("createdWorkers", static_cast<double>(m_createdWorkers.load()));
+    stats.Set("reusedWorkers", static_cast<double>(m_reusedWorkers.load()));
+    stats.Set("heapCallables", static_cast<double>(m_heapCallables.load()));
+    stats.Set("supersededCommands",
+              static_cast<double>(m_supersededCommands.load()));
+    return stats;
+}
@@ -3,10 +3,19 @@
 
 #include <napi.h>
 #include "rhsp/rhsp.h"
+#include "InlineFunction.h"
+#include "PriorityMutex.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <tuple>
+#include <vector>
 
 /* Macros for writing lambda functions */
 
@@ -15,13 +24,15 @@
  *
  * @param NAME Name of the worker to create
  * @param ENV Napi::Env
+ * @param MUTEX std::shared_ptr<PriorityMutex> of the serial port the work
+ * function uses
  * @param RETURN Return type of work function
  * @param FUNCTION_BODY Lambda function body enclosed in curly braces. `_code`
  * should be set to the work function's return code (int), and `_data` should be
  * set to the work function's return data
  */
-#define CREATE_WORKER(NAME, ENV, RETURN, FUNCTION_BODY) \
-    auto NAME = new RHSPlibWorker<RETURN>(ENV, [=         \
+#define CREATE_WORKER(NAME, ENV, MUTEX, RETURN, FUNCTION_BODY) \
+    auto NAME = RHSPlibWorker<RETURN>::Acquire(ENV, MUTEX, [=        \
     ](int &_code, RETURN &_data, uint8_t &_nackCode) mutable FUNCTION_BODY)
 
 /**
@@ -29,12 +40,14 @@
  *
  * @param NAME Name of the worker to create
  * @param ENV Napi::Env
+ * @param MUTEX std::shared_ptr<PriorityMutex> of the serial port the work
+ * function uses
  * @param FUNCTION_BODY Lambda function body enclosed in curly braces. `_code`
  * should be set to the work function's return code (int)
  */
-#define CREATE_VOID_WORKER(NAME, ENV, FUNCTION_BODY) \
-    auto NAME = new RHSPlibWorker<void>(               \
-        ENV, [=](int &_code, uint8_t &_nackCode) mutable FUNCTION_BODY)
+#define CREATE_VOID_WORKER(NAME, ENV, MUTEX, FUNCTION_BODY) \
+    auto NAME = RHSPlibWorker<void>::Acquire(                 \
+        ENV, MUTEX, [=](int &_code, uint8_t &_nackCode) mutable FUNCTION_BODY)
 
 /**
  * @brief Set the callback function for a worker.
@@ -57,53 +70,238 @@
     NAME->Queue();           \
     return NAME->GetPromise();
 
+/* Inline storage for the work and callback lambdas. The work functions that
+ * copy a whole payload (RHSP_MAX_PAYLOAD_SIZE bytes) fit in it. */
+#define RHSPLIB_WORKER_FUNCTION_CAPACITY 640
+#define RHSPLIB_WORKER_CALLBACK_CAPACITY 64
+
+/* Idle workers kept per return type and environment. Workers completing while
+ * the pool is full are deleted. */
+#define RHSPLIB_WORKER_POOL_SIZE 16
+
 /**
- * @brief Base class for the RHSPlibWorker. The sole responsibility of this
- * class is to contain the static mutex that will be used by the templated
- * RHSPlibWorker class.
+ * @brief What a write command sets: the hub, the command and the channel. A
+ * newer write with the same key makes an older one that has not been sent yet
+ * obsolete.
+ */
+struct SupersessionKey {
+    const void *hub;
+    int command;
+    int channel;
+
+    bool operator<(const SupersessionKey &other) const {
+        return std::tie(hub, command, channel) <
+               std::tie(other.hub, other.command, other.channel);
+    }
+};
+
+/**
+ * @brief Base class for the RHSPlibWorker. Contains the mutex of the serial
+ * port the work function uses and the allocation counters of the worker
+ * pools. Each serial port has its own mutex, so commands to hubs on
+ * different ports run in parallel. Code that calls RHSPlib outside of a
+ * worker must hold the mutex of the port, with a PriorityLock of the class of
+ * its commands.
  */
 class RHSPlibWorkerBase {
+  public:
+    /**
+     * @brief Get the worker allocation counters: createdWorkers,
+     * reusedWorkers and heapCallables. Once the pools are warm, only
+     * reusedWorkers should grow. Also gets the number of superseded write
+     * commands.
+     */
+    static Napi::Value GetStats(const Napi::CallbackInfo &info);
+
+    /**
+     * @brief Set the priority class the work function waits for the mutex
+     * with. Workers default to CommandPriority::Telemetry.
+     */
+    void SetPriority(CommandPriority priority) { m_priority = priority; }
+
+    /**
+     * @brief Fail the command with RHSP_ERROR_CANCELLED if a fail safe is
+     * queued for its hub before the command gets the mutex. The fail safe
+     * jumps ahead of it, so an output write must not run after the fail safe
+     * and turn the output back on.
+     *
+     * @param failSafes Number of fail safes queued for the hub so far
+     */
+    void CancelOnFailSafe(const std::atomic<uint64_t> &failSafes) {
+        m_failSafes = &failSafes;
+        m_failSafesBefore = failSafes.load();
+    }
+
   protected:
-    static std::mutex m_mutex;
+    static void CountCallable(bool heapAllocated) {
+        if (heapAllocated) {
+            m_heapCallables++;
+        }
+    }
+
+    bool IsCancelled() const {
+        return m_failSafes && m_failSafes->load() != m_failSafesBefore;
+    }
+
+    void Reset(std::shared_ptr<PriorityMutex> mutex) {
+        m_mutex = std::move(mutex);
+        m_priority = CommandPriority::Telemetry;
+        m_failSafes = nullptr;
+    }
+
+    static std::mutex m_poolMutex;
+    static std::atomic<uint64_t> m_createdWorkers;
+    static std::atomic<uint64_t> m_reusedWorkers;
+    static std::atomic<uint64_t> m_heapCallables;
+    static std::atomic<uint64_t> m_supersededCommands;
+
+    std::shared_ptr<PriorityMutex> m_mutex;
+    CommandPriority m_priority = CommandPriority::Telemetry;
+    const std::atomic<uint64_t> *m_failSafes = nullptr;
+    uint64_t m_failSafesBefore = 0;
+};
+
+/**
+ * @brief Idle workers of one worker type. A napi_async_work belongs to the
+ * environment that created it, so workers are only reused within their
+ * environment and are deleted when it is torn down.
+ *
+ * @tparam Worker Worker type
+ */
+template <typename Worker>
+class RHSPlibWorkerPool : public RHSPlibWorkerBase {
+  public:
+    /**
+     * @brief Take an idle worker of the environment.
+     *
+     * @return Worker or nullptr if there is none
+     */
+    static Worker *Take(napi_env env) {
+        std::scoped_lock<std::mutex> lock{m_poolMutex};
+        if (std::find(envs().begin(), envs().end(), env) == envs().end()) {
+            if (napi_add_env_cleanup_hook(env, DestroyWorkers, env) == napi_ok) {
+                envs().push_back(env);
+            }
+            return nullptr;
+        }
+        std::vector<Worker *> &idle = workers();
+        for (auto it = idle.rbegin(); it != idle.rend(); ++it) {
+            if (napi_env((*it)->Env()) == env) {
+                Worker *worker = *it;
+                idle.erase(std::next(it).base());
+                return worker;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Return a completed worker to the pool.
+     *
+     * @return false if the worker was not taken and must be deleted
+     */
+    static bool Put(Worker *worker) {
+        std::scoped_lock<std::mutex> lock{m_poolMutex};
+        napi_env env = worker->Env();
+        if (std::find(envs().begin(), envs().end(), env) == envs().end()) {
+            return false;
+        }
+        size_t pooled = std::count_if(
+            workers().begin(), workers().end(),
+            [env](Worker *idle) { return napi_env(idle->Env()) == env; });
+        if (pooled >= RHSPLIB_WORKER_POOL_SIZE) {
+            return false;
+        }
+        workers().push_back(worker);
+        return true;
+    }
+
+  private:
+    static void DestroyWorkers(void *arg) {
+        napi_env env = static_cast<napi_env>(arg);
+        std::vector<Worker *> destroyed;
+        {
+            std::scoped_lock<std::mutex> lock{m_poolMutex};
+            envs().erase(std::remove(envs().begin(), envs().end(), env),
+                         envs().end());
+            auto it = std::stable_partition(
+                workers().begin(), workers().end(),
+                [env](Worker *idle) { return napi_env(idle->Env()) != env; });
+            destroyed.assign(it, workers().end());
+            workers().erase(it, workers().end());
+        }
+        for (Worker *worker : destroyed) {
+            delete worker;
+        }
+    }
+
+    static std::vector<Worker *> &workers() {
+        static std::vector<Worker *> idle;
+        return idle;
+    }
+
+    static std::vector<napi_env> &envs() {
+        static std::vector<napi_env> registered;
+        return registered;
+    }
 };
 
 /**
  * @brief Async worker class for handling blocking calls from RHSPlib.
+ * Workers are pooled: a completed worker keeps its napi_async_work and its
+ * inline function storage and is reused by the next call with the same return
+ * type, so a call does not allocate once the pool is warm.
  *
  * @tparam TReturn Return type of the work function
  */
 template <typename TReturn>
 class RHSPlibWorker : public Napi::AsyncWorker, public RHSPlibWorkerBase {
   public:
-      /**
-     * @brief Create a worker and set the work function to be run asynchronously
-     * in Execute().
+    /**
+     * @brief Get an idle worker, or create one, and set the work function to
+     * be run asynchronously in Execute().
      *
      * @tparam Function Must be a lambda function that returns void and accepts
-     * the following parameters: (Napi::Env env, int &returnCode, TReturn
-     * &returnData);
+     * the following parameters: (int &returnCode, TReturn &returnData,
+     * uint8_t &nackCode);
      * @param env Napi::Env
+     * @param mutex Mutex of the serial port the work function uses
      * @param f Work function
      */
     template <typename Function>
-    RHSPlibWorker(Napi::Env env, Function &&f)
-        : Napi::AsyncWorker(env),
-          deferred(env),
-          workFunction(std::forward<Function>(f)) {}
-
-    ~RHSPlibWorker() {}
+    static RHSPlibWorker *Acquire(Napi::Env env,
+                                  std::shared_ptr<PriorityMutex> mutex,
+                                  Function &&f) {
+        RHSPlibWorker *worker = RHSPlibWorkerPool<RHSPlibWorker>::Take(env);
+        if (worker) {
+            m_reusedWorkers++;
+        } else {
+            worker = new RHSPlibWorker(env);
+            m_createdWorkers++;
+        }
+        worker->deferred.emplace(env);
+        worker->workFunction.assign(std::forward<Function>(f));
+        CountCallable(worker->workFunction.isHeapAllocated());
+        worker->returnData = TReturn{};
+        worker->resultCode = 0;
+        worker->nackCode = 0;
+        worker->Reset(std::move(mutex));
+        return worker;
+    }
 
     /**
      * @brief Set the callback function that handles how data is sent to
      * javascript.
      *
      * @tparam Function Must be a lambda function that returns Napi::Value and
-     * accepts the following parameters: (Napi::Env env, TReturn &returnData).
+     * accepts the following parameters: (Napi::Env env, int &returnCode,
+     * TReturn &returnData).
      * @param f Callback function
      */
     template <typename Function>
     void SetCallback(Function &&f) {
-        callbackFunction = f;
+        callbackFunction.assign(std::forward<Function>(f));
+        CountCallable(callbackFunction.isHeapAllocated());
     }
 
     /**
@@ -111,14 +309,18 @@ class RHSPlibWorker : public Napi::AsyncWorker, public RHSPlibWorkerBase {
      *
      * @return Napi::Promise
      */
-    Napi::Promise GetPromise() { return deferred.Promise(); }
+    Napi::Promise GetPromise() { return deferred->Promise(); }
 
     /**
      * @brief Run the work function. `resultCode` and `returnData` are passed by
      * reference to be set by the work function.
      */
     void Execute() override {
-        std::scoped_lock<std::mutex> lock{m_mutex};
+        PriorityLock lock{*m_mutex, m_priority};
+        if (IsCancelled()) {
+            resultCode = RHSP_ERROR_CANCELLED;
+            return;
+        }
         workFunction(resultCode, returnData, nackCode);
     }
 
@@ -129,14 +331,14 @@ class RHSPlibWorker : public Napi::AsyncWorker, public RHSPlibWorkerBase {
      */
     void OnOK() override {
         if (resultCode >= 0 && callbackFunction) {
-            deferred.Resolve(callbackFunction(Env(), resultCode, returnData));
+            deferred->Resolve(callbackFunction(Env(), resultCode, returnData));
         } else {
             Napi::Object errorObj = Napi::Object::New(Env());
             errorObj.Set("errorCode", resultCode);
             if (resultCode == RHSP_ERROR_NACK_RECEIVED) {
                 errorObj.Set("nackCode", nackCode);
             }
-            deferred.Reject(errorObj);
+            deferred->Reject(errorObj);
         }
     }
 
@@ -145,12 +347,33 @@ class RHSPlibWorker : public Napi::AsyncWorker, public RHSPlibWorkerBase {
      *
      * @param e Error
      */
-    void OnError(const Napi::Error &e) override { deferred.Reject(e.Value()); }
+    void OnError(const Napi::Error &e) override { deferred->Reject(e.Value()); }
+
+  protected:
+    /**
+     * @brief Called once the worker has completed. Releases what the lambdas
+     * captured and returns the worker to the pool.
+     */
+    void Destroy() override {
+        workFunction.reset();
+        callbackFunction.reset();
+        deferred.reset();
+        m_mutex.reset();
+        if (!RHSPlibWorkerPool<RHSPlibWorker>::Put(this)) {
+            delete this;
+        }
+    }
 
 private:
-    Napi::Promise::Deferred deferred;
-    std::function<void(int &, TReturn &, uint8_t &)> workFunction;
-    std::function<Napi::Value(Napi::Env, int &, TReturn &)> callbackFunction;
+    explicit RHSPlibWorker(Napi::Env env) : Napi::AsyncWorker(env) {}
+
+    std::optional<Napi::Promise::Deferred> deferred;
+    InlineFunction<void(int &, TReturn &, uint8_t &),
+                   RHSPLIB_WORKER_FUNCTION_CAPACITY>
+        workFunction;
+    InlineFunction<Napi::Value(Napi::Env, int &, TReturn &),
+                   RHSPLIB_WORKER_CALLBACK_CAPACITY>
+        callbackFunction;
     TReturn returnData;
     int resultCode;
     uint8_t nackCode;
@@ -166,36 +389,74 @@ template <>
 class RHSPlibWorker<void> : public Napi::AsyncWorker, public RHSPlibWorkerBase {
   public:
     /**
-     * @brief Create a worker and set the work function to be run asynchronously
-     * in Execute().
+     * @brief Get an idle worker, or create one, and set the work function to
+     * be run asynchronously in Execute().
      *
      * @tparam Function Must be a lambda function that returns void and accepts
-     * the following parameters: (Napi::Env env, int &returnCode);
+     * the following parameters: (int &returnCode, uint8_t &nackCode);
      * @param env Napi::Env
+     * @param mutex Mutex of the serial port the work function uses
      * @param f Work function
      */
     template <typename Function>
-    RHSPlibWorker(Napi::Env env, Function &&f)
-        : Napi::AsyncWorker(env),
-          deferred(env),
-          workFunction(std::forward<Function>(f)) {}
-
-    ~RHSPlibWorker() {}
+    static RHSPlibWorker *Acquire(Napi::Env env,
+                                  std::shared_ptr<PriorityMutex> mutex,
+                                  Function &&f) {
+        RHSPlibWorker *worker = RHSPlibWorkerPool<RHSPlibWorker>::Take(env);
+        if (worker) {
+            m_reusedWorkers++;
+        } else {
+            worker = new RHSPlibWorker(env);
+            m_createdWorkers++;
+        }
+        worker->deferred.emplace(env);
+        worker->workFunction.assign(std::forward<Function>(f));
+        CountCallable(worker->workFunction.isHeapAllocated());
+        worker->resultCode = 0;
+        worker->nackCode = 0;
+        worker->Reset(std::move(mutex));
+        worker->supersessionKey.reset();
+        return worker;
+    }
 
     /**
      * @brief Get the Promise object owned by the worker to return to javascript.
      *
      * @return Napi::Promise
      */
-    Napi::Promise GetPromise() { return deferred.Promise(); }
+    Napi::Promise GetPromise() { return deferred->Promise(); }
+
+    /**
+     * @brief Let newer writes with the same key replace this one while it is
+     * queued. Whichever of them gets the mutex first sends the newest value,
+     * and they all resolve with the result of that command. Only for writes
+     * whose effect is entirely replaced by a newer one, and whose arguments
+     * are valid: an invalid newest write would fail the older ones.
+     *
+     * @param key What the write command sets
+     */
+    void SetSupersessionKey(const SupersessionKey &key) {
+        std::scoped_lock<std::mutex> lock{supersessionMutex()};
+        SupersessionSlot &slot = supersessionSlots()[key];
+        slot.latest = this;
+        slot.pending++;
+        supersessionKey = key;
+        supersessionGeneration = ++slot.latestGeneration;
+    }
 
     /**
      * @brief Run the work function. `resultCode` is passed by reference to be set
      * by the work function.
      */
     void Execute() override {
-        std::scoped_lock<std::mutex> lock{m_mutex};
-        workFunction(resultCode, nackCode);
+        PriorityLock lock{*m_mutex, m_priority};
+        if (supersessionKey) {
+            ExecuteLatest();
+        } else if (IsCancelled()) {
+            resultCode = RHSP_ERROR_CANCELLED;
+        } else {
+            workFunction(resultCode, nackCode);
+        }
     }
 
     /**
@@ -204,14 +465,14 @@ class RHSPlibWorker<void> : public Napi::AsyncWorker, public RHSPlibWorkerBase {
      */
     void OnOK() override {
         if (resultCode >= 0) {
-            deferred.Resolve(Env().Undefined());
+            deferred->Resolve(Env().Undefined());
         } else {
             Napi::Object errorObj = Napi::Object::New(Env());
             errorObj.Set("errorCode", resultCode);
             if (resultCode == RHSP_ERROR_NACK_RECEIVED) {
                 errorObj.Set("nackCode", nackCode);
             }
-            deferred.Reject(errorObj);
+            deferred->Reject(errorObj);
         }
     }
 
@@ -220,13 +481,94 @@ class RHSPlibWorker<void> : public Napi::AsyncWorker, public RHSPlibWorkerBase {
      *
      * @param e Error
      */
-    void OnError(const Napi::Error &e) override { deferred.Reject(e.Value()); }
+    void OnError(const Napi::Error &e) override { deferred->Reject(e.Value()); }
+
+  protected:
+    /**
+     * @brief Called once the worker has completed. Releases what the lambda
+     * captured and returns the worker to the pool.
+     */
+    void Destroy() override {
+        workFunction.reset();
+        deferred.reset();
+        m_mutex.reset();
+        if (!RHSPlibWorkerPool<RHSPlibWorker>::Put(this)) {
+            delete this;
+        }
+    }
 
 private:
-    Napi::Promise::Deferred deferred;
-    std::function<void(int &, uint8_t &)> workFunction;
+    /**
+     * @brief Writes with the same supersession key that are queued.
+     */
+    struct SupersessionSlot {
+        RHSPlibWorker *latest = nullptr;  // newest write, not yet executed
+        uint64_t latestGeneration = 0;
+        uint64_t sentGeneration = 0;  // newest write that has been sent
+        int resultCode = 0;           // result of sending it
+        uint8_t nackCode = 0;
+        size_t pending = 0;  // writes that have not executed yet
+    };
+
+    explicit RHSPlibWorker(Napi::Env env) : Napi::AsyncWorker(env) {}
+
+    /**
+     * @brief Send the newest write of the supersession key unless it has been
+     * sent already, and take the result. Called with the mutex held. A write
+     * cancelled by a fail safe sends nothing, since the newest write may have
+     * been queued after the fail safe.
+     */
+    void ExecuteLatest() {
+        std::unique_lock<std::mutex> lock{supersessionMutex()};
+        auto slotIt = supersessionSlots().find(*supersessionKey);
+        SupersessionSlot &slot = slotIt->second;
+        bool sent = slot.sentGeneration >= supersessionGeneration;
+        if (!sent && IsCancelled()) {
+            resultCode = RHSP_ERROR_CANCELLED;
+        } else {
+            if (!sent) {
+                // the newest write cannot complete before it is sent, so it
+                // is still alive. Newer writes may be queued while it is sent.
+                RHSPlibWorker *latest = slot.latest;
+                uint64_t latestGeneration = slot.latestGeneration;
+                lock.unlock();
+                int code = 0;
+                uint8_t nack = 0;
+                latest->workFunction(code, nack);
+                lock.lock();
+                slot.sentGeneration = latestGeneration;
+                slot.resultCode = code;
+                slot.nackCode = nack;
+            }
+            if (slot.sentGeneration != supersessionGeneration) {
+                m_supersededCommands++;
+            }
+            resultCode = slot.resultCode;
+            nackCode = slot.nackCode;
+        }
+        if (--slot.pending == 0) {
+            supersessionSlots().erase(slotIt);
+        }
+        supersessionKey.reset();
+    }
+
+    static std::mutex &supersessionMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::map<SupersessionKey, SupersessionSlot> &supersessionSlots() {
+        static std::map<SupersessionKey, SupersessionSlot> slots;
+        return slots;
+    }
+
+    std::optional<Napi::Promise::Deferred> deferred;
+    InlineFunction<void(int &, uint8_t &), RHSPLIB_WORKER_FUNCTION_CAPACITY>
+        workFunction;
     int resultCode;
     uint8_t nackCode;
+    std::optional<SupersessionKey> supersessionKey;
+    uint64_t supersessionGeneration = 0;
 };
 
 #endif
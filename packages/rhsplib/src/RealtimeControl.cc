@@ -0,0 +1,154 @@
+#include "RealtimeControl.h"
+
+#include "rhsp/errors.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+namespace {
+// stack below the frame of applyPending that is pre-faulted and locked. The
+// threads of a hub do not go deeper than this during a period.
+constexpr size_t lockedStackSize = 64 * 1024;
+
+constexpr int maxPriority = 99;
+}  // namespace
+
+int validateRealtimeOptions(const RealtimeOptions &options) {
+    if (options.priority < 0 || options.priority > maxPriority) {
+        return RHSP_ERROR_ARG_0_OUT_OF_RANGE;
+    }
+#if defined(__linux__)
+    if (options.cpu < -1 || options.cpu >= CPU_SETSIZE) {
+        return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
+    }
+#else
+    if (options.cpu < -1) {
+        return RHSP_ERROR_ARG_1_OUT_OF_RANGE;
+    }
+#endif
+    return RHSP_RESULT_OK;
+}
+
+int lockMemory(const void *buffer, size_t size, bool lock) {
+    if (!buffer || size == 0) {
+        return RHSP_RESULT_OK;
+    }
+#if defined(__linux__)
+    // mlock faults the pages in, so locked memory is also pre-faulted
+    int result = lock ? mlock(buffer, size) : munlock(buffer, size);
+    return result == 0 ? RHSP_RESULT_OK : RHSP_ERROR;
+#else
+    return lock ? RHSP_ERROR : RHSP_RESULT_OK;
+#endif
+}
+
+void RealtimeControl::release() {
+    lockMemory(lockedStack, lockedStack ? lockedStackSize : 0, false);
+    lockMemory(lockedBuffer, lockedSize, false);
+    lockedStack = nullptr;
+    lockedBuffer = nullptr;
+    lockedSize = 0;
+}
+
+void RealtimeControl::request(const RealtimeOptions &options) {
+    std::scoped_lock<std::mutex> lock{requestMutex};
+    pendingOptions = options;
+}
+
+void RealtimeControl::applyPending(const void *buffer, size_t size) {
+    std::optional<RealtimeOptions> options;
+    {
+        std::scoped_lock<std::mutex> lock{requestMutex};
+        options.swap(pendingOptions);
+    }
+    if (!options) {
+        return;
+    }
+
+    int result = RHSP_RESULT_OK;
+    release();
+#if defined(__linux__)
+    sched_param param{};
+    param.sched_priority = options->priority;
+    int policy = options->priority > 0 ? SCHED_FIFO : SCHED_OTHER;
+    if (pthread_setschedparam(pthread_self(), policy, &param) != 0) {
+        result = RHSP_ERROR;
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (options->cpu >= 0) {
+        CPU_SET(options->cpu, &cpus);
+    } else {
+        // the kernel drops CPUs that do not exist or are not allowed
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+        result = RHSP_ERROR;
+    }
+
+    if (options->lockMemory) {
+        auto frame = static_cast<const char *>(__builtin_frame_address(0));
+        const void *stack = frame - lockedStackSize;
+        if (lockMemory(stack, lockedStackSize, true) == RHSP_RESULT_OK) {
+            lockedStack = stack;
+        } else {
+            result = RHSP_ERROR;
+        }
+        if (lockMemory(buffer, size, true) == RHSP_RESULT_OK) {
+            lockedBuffer = buffer;
+            lockedSize = size;
+        } else {
+            result = RHSP_ERROR;
+        }
+    }
+#else
+    if (options->priority != 0 || options->cpu >= 0 || options->lockMemory) {
+        result = RHSP_ERROR;
+    }
+#endif
+    resultCode = result;
+}
+
+void RealtimeControl::recordWake(clock::time_point deadline) {
+    periods++;
+    auto lateness = std::chrono::duration_cast<std::chrono::microseconds>(
+                        clock::now() - deadline)
+                        .count();
+    if (lateness <= 0) {
+        return;
+    }
+    uint32_t latenessUs = lateness > UINT32_MAX
+                              ? UINT32_MAX
+                              : static_cast<uint32_t>(lateness);
+    uint32_t currentMax = maxLatenessUs.load();
+    while (latenessUs > currentMax &&
+           !maxLatenessUs.compare_exchange_weak(currentMax, latenessUs)) {
+    }
+}
+
+void RealtimeControl::recordMissedDeadlines(uint64_t count) {
+    missedDeadlines += count;
+}
+
+RealtimeControl::clock::time_point RealtimeControl::nextDeadline(
+    clock::time_point deadline, clock::duration period) {
+    deadline += period;
+    auto now = clock::now();
+    if (deadline < now) {
+        auto skippedPeriods = (now - deadline) / period + 1;
+        recordMissedDeadlines(skippedPeriods);
+        deadline += skippedPeriods * period;
+    }
+    return deadline;
+}
+
+RealtimeStats RealtimeControl::stats() const {
+    return {periods.load(), missedDeadlines.load(), maxLatenessUs.load(),
+            resultCode.load()};
+}
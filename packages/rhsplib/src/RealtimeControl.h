@@ -0,0 +1,115 @@
+#ifndef REALTIME_CONTROL_H_
+#define REALTIME_CONTROL_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+/**
+ * @brief Scheduling options for the native threads of a hub.
+ */
+struct RealtimeOptions {
+    int priority = 0;  // SCHED_FIFO priority from 1 to 99, 0 for the default scheduler
+    int cpu = -1;      // CPU to run on, -1 for any
+    bool lockMemory = false;  // pre-fault and lock the stack and buffers
+};
+
+/**
+ * @brief Timing of a native thread, see RealtimeControl::stats.
+ */
+struct RealtimeStats {
+    uint64_t periods;
+    uint64_t missedDeadlines;
+    uint32_t maxLatenessUs;  // latest wake up after a deadline
+    int resultCode;          // result of applying the last options
+};
+
+/**
+ * @brief Real-time scheduling and deadline accounting of one native thread.
+ * Options are requested from the javascript thread and applied by the thread
+ * itself at the start of its next period, since the stack can only be
+ * pre-faulted from the thread that owns it. Scheduling options are only
+ * supported on Linux; elsewhere, applying anything but the defaults fails
+ * with RHSP_ERROR.
+ */
+class RealtimeControl {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Unlock the buffer. Must be called on the thread that applied the
+     * options, before it exits.
+     */
+    void release();
+
+    /**
+     * @brief Request options to be applied by the thread.
+     */
+    void request(const RealtimeOptions &options);
+
+    /**
+     * @brief Apply requested options to the calling thread. Called by the
+     * thread at the start of each period.
+     *
+     * @param buffer Memory the thread uses every period, locked with the
+     * stack if lockMemory is set
+     * @param size Size of buffer in bytes
+     */
+    void applyPending(const void *buffer = nullptr, size_t size = 0);
+
+    /**
+     * @brief Record that the thread has woken up for a deadline.
+     */
+    void recordWake(clock::time_point deadline);
+
+    /**
+     * @brief Record deadlines that have passed without the thread running.
+     */
+    void recordMissedDeadlines(uint64_t count);
+
+    /**
+     * @brief Advance a deadline by one period. Periods that have already
+     * passed because the previous one overran are skipped instead of being run
+     * back to back, and are counted as missed.
+     *
+     * @return the next deadline after now
+     */
+    clock::time_point nextDeadline(clock::time_point deadline,
+                                   clock::duration period);
+
+    RealtimeStats stats() const;
+
+  private:
+    std::mutex requestMutex;
+    std::optional<RealtimeOptions> pendingOptions;
+
+    // owned by the thread
+    const void *lockedStack = nullptr;
+    const void *lockedBuffer = nullptr;
+    size_t lockedSize = 0;
+
+    std::atomic<uint64_t> periods{0};
+    std::atomic<uint64_t> missedDeadlines{0};
+    std::atomic<uint32_t> maxLatenessUs{0};
+    std::atomic<int> resultCode{0};
+};
+
+/**
+ * @brief Check that options can be requested. Does not check privileges.
+ *
+ * @return RHSP_RESULT_OK, RHSP_ERROR_ARG_0_OUT_OF_RANGE for a bad priority or
+ * RHSP_ERROR_ARG_1_OUT_OF_RANGE for a bad CPU
+ */
+int validateRealtimeOptions(const RealtimeOptions &options);
+
+/**
+ * @brief Lock a range of memory, or unlock it if lock is false.
+ *
+ * @return RHSP_RESULT_OK or RHSP_ERROR
+ */
+int lockMemory(const void *buffer, size_t size, bool lock);
+
+#endif
@@ -8,6 +8,216 @@
 #include "napi.h"
 #include "serialWrapper.h"
 
+#include <optional>
+#include <vector>
+
+Napi::Object bulkInputDataToObject(Napi::Env env,
+                                   const RhspBulkInputData &data) {
+    Napi::Object bulkInputDataObj = Napi::Object::New(env);
+    bulkInputDataObj.Set("digitalInputs", data.digitalInputs);
+    bulkInputDataObj.Set("motor0position_enc", data.motor0position_enc);
+    bulkInputDataObj.Set("motor1position_enc", data.motor1position_enc);
+    bulkInputDataObj.Set("motor2position_enc", data.motor2position_enc);
+    bulkInputDataObj.Set("motor3position_enc", data.motor3position_enc);
+    bulkInputDataObj.Set("motorStatus", data.motorStatus);
+    bulkInputDataObj.Set("motor0velocity_cps", data.motor0velocity_cps);
+    bulkInputDataObj.Set("motor1velocity_cps", data.motor1velocity_cps);
+    bulkInputDataObj.Set("motor2velocity_cps", data.motor2velocity_cps);
+    bulkInputDataObj.Set("motor3velocity_cps", data.motor3velocity_cps);
+    bulkInputDataObj.Set("analog0_mV", data.analog0_mV);
+    bulkInputDataObj.Set("analog1_mV", data.analog1_mV);
+    bulkInputDataObj.Set("analog2_mV", data.analog2_mV);
+    bulkInputDataObj.Set("analog3_mV", data.analog3_mV);
+    bulkInputDataObj.Set("attentionRequired", data.attentionRequired);
+    return bulkInputDataObj;
+}
+
+static Napi::Object encoderSampleToObject(Napi::Env env,
+                                          const RhspEncoderSample &sample) {
+    Napi::Array position = Napi::Array::New(env, RHSP_ENCODER_NUMBER_OF_MOTORS);
+    Napi::Array velocity = Napi::Array::New(env, RHSP_ENCODER_NUMBER_OF_MOTORS);
+    Napi::Array filteredVelocity =
+        Napi::Array::New(env, RHSP_ENCODER_NUMBER_OF_MOTORS);
+    Napi::Array filteredAcceleration =
+        Napi::Array::New(env, RHSP_ENCODER_NUMBER_OF_MOTORS);
+    for (uint32_t i = 0; i < RHSP_ENCODER_NUMBER_OF_MOTORS; i++) {
+        position[i] = sample.position[i];
+        velocity[i] = sample.velocity[i];
+        filteredVelocity[i] = sample.filteredVelocity[i];
+        filteredAcceleration[i] = sample.filteredAcceleration[i];
+    }
+
+    Napi::Object sampleObj = Napi::Object::New(env);
+    sampleObj.Set("timestampUs", sample.timestampUs);
+    sampleObj.Set("position", position);
+    sampleObj.Set("velocity", velocity);
+    sampleObj.Set("filteredVelocity", filteredVelocity);
+    sampleObj.Set("filteredAcceleration", filteredAcceleration);
+    return sampleObj;
+}
+
+static std::vector<RhspI2cOperation> i2cOperationsFromArray(
+    Napi::Array operationsArray) {
+    std::vector<RhspI2cOperation> operations(operationsArray.Length());
+    for (uint32_t i = 0; i < operationsArray.Length(); i++) {
+        Napi::Object operationObj = operationsArray.Get(i).As<Napi::Object>();
+        RhspI2cOperation &operation = operations[i];
+        operation.slaveAddress =
+            operationObj.Get("address").As<Napi::Number>().Uint32Value();
+
+        std::string type = operationObj.Get("type").As<Napi::String>();
+        if (type == "write") {
+            Napi::Array bytesArray = operationObj.Get("bytes").As<Napi::Array>();
+            operation.type = RHSP_I2C_OPERATION_WRITE;
+            // an oversized write is rejected by rhsp_runI2cOperations
+            operation.length =
+                bytesArray.Length() <= RHSP_I2C_OPERATION_MAX_BUFFER_SIZE
+                    ? bytesArray.Length()
+                    : 0;
+            for (int j = 0; j < operation.length; j++) {
+                operation.buffer[j] =
+                    bytesArray.Get(j).As<Napi::Number>().Uint32Value();
+            }
+        } else {
+            uint32_t numBytes =
+                operationObj.Get("numBytes").As<Napi::Number>().Uint32Value();
+            Napi::Value reg = operationObj.Get("register");
+            operation.type = reg.IsNumber() ? RHSP_I2C_OPERATION_READ_REGISTER
+                                            : RHSP_I2C_OPERATION_READ;
+            operation.startAddress =
+                reg.IsNumber() ? reg.As<Napi::Number>().Uint32Value() : 0;
+            operation.length =
+                numBytes <= RHSP_I2C_OPERATION_MAX_BUFFER_SIZE ? numBytes : 0;
+        }
+    }
+    return operations;
+}
+
+/**
+ * @brief A setter recorded by an output frame in javascript, see
+ * commitOutputFrame. The arguments are converted like the arguments of the
+ * method of the same name.
+ */
+struct OutputFrameSetter {
+    enum class Method {
+        SetDigitalSingleOutput,
+        SetDigitalAllOutputs,
+        SetDigitalDirection,
+        SetMotorChannelMode,
+        SetMotorChannelEnable,
+        SetMotorConstantPower,
+        SetMotorTargetVelocity,
+        SetMotorTargetPosition,
+        SetServoPulseWidth,
+        SetServoEnable,
+        Unknown,
+    };
+
+    Method method = Method::Unknown;
+    uint8_t channel = 0;
+    int32_t value = 0;  // every value but the motor power
+    double power = 0;
+    uint16_t tolerance = 0;  // of a target position
+    bool floatAtZero = false;
+};
+
+static OutputFrameSetter outputFrameSetterFromObject(Napi::Object setterObj) {
+    using Method = OutputFrameSetter::Method;
+    std::string method = setterObj.Get("method").As<Napi::String>();
+    Napi::Array args = setterObj.Get("args").As<Napi::Array>();
+    auto uintArg = [&args](uint32_t i) {
+        return args.Get(i).As<Napi::Number>().Uint32Value();
+    };
+    auto boolArg = [&args](uint32_t i) {
+        return args.Get(i).As<Napi::Boolean>().Value();
+    };
+
+    OutputFrameSetter setter;
+    if (method == "setDigitalAllOutputs") {
+        setter.method = Method::SetDigitalAllOutputs;
+        setter.value = static_cast<uint8_t>(uintArg(0));
+        return setter;
+    }
+    setter.channel = uintArg(0);
+    if (method == "setDigitalSingleOutput") {
+        setter.method = Method::SetDigitalSingleOutput;
+        setter.value = boolArg(1);
+    } else if (method == "setDigitalDirection") {
+        setter.method = Method::SetDigitalDirection;
+        setter.value = static_cast<uint8_t>(uintArg(1));
+    } else if (method == "setMotorChannelMode") {
+        setter.method = Method::SetMotorChannelMode;
+        setter.value = static_cast<uint8_t>(uintArg(1));
+        setter.floatAtZero = boolArg(2);
+    } else if (method == "setMotorChannelEnable") {
+        setter.method = Method::SetMotorChannelEnable;
+        setter.value = boolArg(1);
+    } else if (method == "setMotorConstantPower") {
+        setter.method = Method::SetMotorConstantPower;
+        setter.power = args.Get(1).As<Napi::Number>().DoubleValue();
+    } else if (method == "setMotorTargetVelocity") {
+        setter.method = Method::SetMotorTargetVelocity;
+        setter.value =
+            static_cast<int16_t>(args.Get(1).As<Napi::Number>().Int32Value());
+    } else if (method == "setMotorTargetPosition") {
+        setter.method = Method::SetMotorTargetPosition;
+        setter.value = args.Get(1).As<Napi::Number>().Int32Value();
+        setter.tolerance = uintArg(2);
+    } else if (method == "setServoPulseWidth") {
+        setter.method = Method::SetServoPulseWidth;
+        setter.value = static_cast<uint16_t>(uintArg(1));
+    } else if (method == "setServoEnable") {
+        setter.method = Method::SetServoEnable;
+        setter.value = boolArg(1);
+    }
+    return setter;
+}
+
+/**
+ * @brief Record a setter in the open output frame of the hub.
+ *
+ * @return result of the setter, negative if it rejected its arguments
+ */
+static int applyOutputFrameSetter(RhspRevHub *hub,
+                                  const OutputFrameSetter &setter) {
+    using Method = OutputFrameSetter::Method;
+    switch (setter.method) {
+        case Method::SetDigitalSingleOutput:
+            return rhsp_setSingleOutput(hub, setter.channel, setter.value,
+                                        nullptr);
+        case Method::SetDigitalAllOutputs:
+            return rhsp_setAllOutputs(hub, setter.value, nullptr);
+        case Method::SetDigitalDirection:
+            return rhsp_setDirection(hub, setter.channel, setter.value,
+                                     nullptr);
+        case Method::SetMotorChannelMode:
+            return rhsp_setMotorChannelMode(
+                hub, setter.channel, static_cast<MotorMode>(setter.value),
+                setter.floatAtZero, nullptr);
+        case Method::SetMotorChannelEnable:
+            return rhsp_setMotorChannelEnable(hub, setter.channel,
+                                              setter.value, nullptr);
+        case Method::SetMotorConstantPower:
+            return rhsp_setMotorConstantPower(hub, setter.channel, setter.power,
+                                              nullptr);
+        case Method::SetMotorTargetVelocity:
+            return rhsp_setMotorTargetVelocity(hub, setter.channel,
+                                               setter.value, nullptr);
+        case Method::SetMotorTargetPosition:
+            return rhsp_setMotorTargetPosition(hub, setter.channel,
+                                               setter.value, setter.tolerance,
+                                               nullptr);
+        case Method::SetServoPulseWidth:
+            return rhsp_setServoPulseWidth(hub, setter.channel, setter.value,
+                                           nullptr);
+        case Method::SetServoEnable:
+            return rhsp_setServoEnable(hub, setter.channel, setter.value,
+                                       nullptr);
+        default:
+            return RHSP_ERROR_ARG_0_OUT_OF_RANGE;
+    }
+}
+
 // See https://github.com/nodejs/node-addon-api/blob/main/doc/object_wrap.md
 Napi::Object RevHub::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function func = DefineClass(
@@ -22,6 +232,21 @@ Napi::Object RevHub::Init(Napi::Env env, Napi::Object exports) {
                                  &RevHub::setResponseTimeoutMs),
           RevHub::InstanceMethod("getResponseTimeoutMs",
                                  &RevHub::getResponseTimeoutMs),
+          RevHub::InstanceMethod("setAdaptiveResponseTimeout",
+                                 &RevHub::setAdaptiveResponseTimeout),
+          RevHub::InstanceMethod("isAdaptiveResponseTimeoutEnabled",
+                                 &RevHub::isAdaptiveResponseTimeoutEnabled),
+          RevHub::InstanceMethod("setReadRetryLimit", &RevHub::setReadRetryLimit),
+          RevHub::InstanceMethod("getReadRetryLimit", &RevHub::getReadRetryLimit),
+          RevHub::InstanceMethod("getLinkStats", &RevHub::getLinkStats),
+          RevHub::InstanceMethod("publishTelemetry", &RevHub::publishTelemetry),
+          RevHub::InstanceMethod("stopPublishingTelemetry",
+                                 &RevHub::stopPublishingTelemetry),
+          RevHub::InstanceMethod("setQueryCacheTtlMs",
+                                 &RevHub::setQueryCacheTtlMs),
+          RevHub::InstanceMethod("getQueryCacheTtlMs",
+                                 &RevHub::getQueryCacheTtlMs),
+          RevHub::InstanceMethod("clearQueryCache", &RevHub::clearQueryCache),
           RevHub::InstanceMethod("sendWriteCommandInternal",
                                  &RevHub::sendWriteCommandInternal),
           RevHub::InstanceMethod("sendWriteCommand", &RevHub::sendWriteCommand),
@@ -30,6 +255,17 @@ Napi::Object RevHub::Init(Napi::Env env, Napi::Object exports) {
           RevHub::InstanceMethod("sendReadCommand", &RevHub::sendReadCommand),
           RevHub::InstanceMethod("getModuleStatus", &RevHub::getModuleStatus),
           RevHub::InstanceMethod("sendKeepAlive", &RevHub::sendKeepAlive),
+          RevHub::InstanceMethod("startKeepAlive", &RevHub::startKeepAlive),
+          RevHub::InstanceMethod("stopKeepAlive", &RevHub::stopKeepAlive),
+          RevHub::InstanceMethod("setRealtimeOptions",
+                                 &RevHub::setRealtimeOptions),
+          RevHub::InstanceMethod("getRealtimeStats", &RevHub::getRealtimeStats),
+          RevHub::InstanceMethod("startControlTick", &RevHub::startControlTick),
+          RevHub::InstanceMethod("stopControlTick", &RevHub::stopControlTick),
+          RevHub::InstanceMethod("setControlTickOutputs",
+                                 &RevHub::setControlTickOutputs),
+          RevHub::InstanceMethod("getControlTickStats",
+                                 &RevHub::getControlTickStats),
           RevHub::InstanceMethod("sendFailSafe", &RevHub::sendFailSafe),
           RevHub::InstanceMethod("setNewModuleAddress",
                                  &RevHub::setNewModuleAddress),
@@ -47,7 +283,12 @@ Napi::Object RevHub::Init(Napi::Env env, Napi::Object exports) {
           RevHub::InstanceMethod("getInterfacePacketID",
                                  &RevHub::getInterfacePacketID),
           RevHub::InstanceMethod("getBulkInputData", &RevHub::getBulkInputData),
+          RevHub::InstanceMethod("getBulkInputDataFromHubs",
+                                 &RevHub::getBulkInputDataFromHubs),
+          RevHub::InstanceMethod("commitOutputFrame",
+                                 &RevHub::commitOutputFrame),
           RevHub::InstanceMethod("getADC", &RevHub::getADC),
+          RevHub::InstanceMethod("getADCSweep", &RevHub::getADCSweep),
           RevHub::InstanceMethod("setPhoneChargeControl",
                                  &RevHub::setPhoneChargeControl),
           RevHub::InstanceMethod("getPhoneChargeControl",
@@ -90,6 +331,12 @@ Napi::Object RevHub::Init(Napi::Env env, Napi::Object exports) {
           RevHub::InstanceMethod("writeI2CReadMultipleBytes",
                                  &RevHub::writeI2CReadMultipleBytes),
           RevHub::InstanceMethod("getI2CReadStatus", &RevHub::getI2CReadStatus),
+          RevHub::InstanceMethod("i2cRead", &RevHub::i2cRead),
+          RevHub::InstanceMethod("runI2COperations",
+                                 &RevHub::runI2COperations),
+          RevHub::InstanceMethod("startI2CSampler", &RevHub::startI2CSampler),
+          RevHub::InstanceMethod("stopI2CSampler", &RevHub::stopI2CSampler),
+          RevHub::InstanceMethod("drainI2CSamples", &RevHub::drainI2CSamples),
           RevHub::InstanceMethod("setMotorChannelMode",
                                  &RevHub::setMotorChannelMode),
           RevHub::InstanceMethod("getMotorChannelMode",
@@ -119,6 +366,15 @@ Napi::Object RevHub::Init(Napi::Env env, Napi::Object exports) {
           RevHub::InstanceMethod("getMotorAtTarget", &RevHub::getMotorAtTarget),
           RevHub::InstanceMethod("getMotorEncoderPosition",
                                  &RevHub::getMotorEncoderPosition),
+          RevHub::InstanceMethod("getEncoderHistory",
+                                 &RevHub::getEncoderHistory),
+          RevHub::InstanceMethod("getLatestEncoderSample",
+                                 &RevHub::getLatestEncoderSample),
+          RevHub::InstanceMethod("setEncoderFilterGains",
+                                 &RevHub::setEncoderFilterGains),
+          RevHub::InstanceMethod("runMotionProfile", &RevHub::runMotionProfile),
+          RevHub::InstanceMethod("cancelMotionProfile",
+                                 &RevHub::cancelMotionProfile),
           RevHub::InstanceMethod("setMotorClosedLoopControlCoefficients",
                                  &RevHub::setMotorClosedLoopControlCoefficients),
           RevHub::InstanceMethod("getMotorClosedLoopControlCoefficients",
@@ -149,10 +405,18 @@ RevHub::RevHub(const Napi::CallbackInfo &info)
     : Napi::ObjectWrap<RevHub>(info) {
     Napi::Env env = info.Env();
 
+    this->commandMutex = std::make_shared<PriorityMutex>();
+
     // TODO(jan): Non-default constructor that calls RevHub::open()
 }
 
 RevHub::~RevHub() {
+    this->controlTickScheduler.reset();
+    this->motionProfileExecutor.reset();
+    this->stopAllI2CSamplers();
+    this->keepAliveThread.reset();
+    this->waitForBlockingI2CCalls();
+    this->unlockHubMemory();
     freeRevHub(this->obj);
 }
 
@@ -163,9 +427,25 @@ Napi::Value RevHub::open(const Napi::CallbackInfo &info) {
         Napi::ObjectWrap<Serial>::Unwrap(info[0].As<Napi::Object>());
     uint8_t destAddress = info[1].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    {
+        std::scoped_lock<std::mutex> lock{this->blockingI2CMutex};
+        this->closing = false;
+    }
+    // commands to the hubs on a port are serialized by the mutex of the port
+    this->commandMutex = serialPort->getCommandMutex();
+    PriorityMutex *portMutex = this->commandMutex.get();
+
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = 0;
         this->obj = rhsp_allocRevHub(serialPort->getSerialObj(), destAddress);
+        // blocking i2c calls let other commands run while the hub is busy
+        rhsp_setI2cWaitFunction(
+            this->obj,
+            [](void *mutex, uint32_t delayUs) {
+                static_cast<PriorityMutex *>(mutex)->yield(
+                    std::chrono::microseconds(delayUs));
+            },
+            portMutex);
     });
 
     QUEUE_WORKER(worker);
@@ -180,6 +460,12 @@ Napi::Value RevHub::isOpened(const Napi::CallbackInfo &info) {
 void RevHub::close(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
+    this->controlTickScheduler.reset();
+    this->motionProfileExecutor.reset();
+    this->stopAllI2CSamplers();
+    this->keepAliveThread.reset();
+    this->waitForBlockingI2CCalls();
+    this->unlockHubMemory();
     rhsp_close(this->obj);
 }
 
@@ -211,6 +497,115 @@ Napi::Value RevHub::getResponseTimeoutMs(const Napi::CallbackInfo &info) {
     return Napi::Number::New(env, rhsp_responseTimeoutMs(this->obj));
 }
 
+void RevHub::setAdaptiveResponseTimeout(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    bool enabled = info[0].As<Napi::Boolean>().Value();
+
+    rhsp_setAdaptiveResponseTimeout(this->obj, enabled);
+}
+
+Napi::Value RevHub::isAdaptiveResponseTimeoutEnabled(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    return Napi::Boolean::New(env, rhsp_isAdaptiveResponseTimeoutEnabled(this->obj));
+}
+
+void RevHub::setReadRetryLimit(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    uint8_t retries = info[0].As<Napi::Number>().Uint32Value();
+
+    rhsp_setReadRetryLimit(this->obj, retries);
+}
+
+Napi::Value RevHub::getReadRetryLimit(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    return Napi::Number::New(env, rhsp_readRetryLimit(this->obj));
+}
+
+Napi::Value RevHub::getLinkStats(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    // the counters are atomic, so no lock is needed while a worker sends commands
+    RhspLinkStats stats;
+    rhsp_getLinkStats(this->obj, &stats);
+    return linkStatsToObject(env, stats);
+}
+
+Napi::Value RevHub::publishTelemetry(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    std::string name = info[0].As<Napi::String>().Utf8Value();
+
+    // workers write the segment while holding the mutex, so it is created
+    // and removed by a worker too
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
+        _code = rhsp_publishTelemetry(this->obj, name.c_str());
+    });
+    worker->SetPriority(CommandPriority::Diagnostics);
+
+    QUEUE_WORKER(worker);
+}
+
+Napi::Value RevHub::stopPublishingTelemetry(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
+        rhsp_stopPublishingTelemetry(this->obj);
+        _code = RHSP_RESULT_OK;
+    });
+    worker->SetPriority(CommandPriority::Diagnostics);
+
+    QUEUE_WORKER(worker);
+}
+
+// The cache is used by every command, so it is only accessed by workers.
+
+Napi::Value RevHub::setQueryCacheTtlMs(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    RhspCachedQuery query =
+        static_cast<RhspCachedQuery>(info[0].As<Napi::Number>().Uint32Value());
+    uint32_t ttlMs = info[1].As<Napi::Number>().Uint32Value();
+
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
+        _code = rhsp_setQueryCacheTtlMs(this->obj, query, ttlMs);
+    });
+
+    QUEUE_WORKER(worker);
+}
+
+Napi::Value RevHub::getQueryCacheTtlMs(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    RhspCachedQuery query =
+        static_cast<RhspCachedQuery>(info[0].As<Napi::Number>().Uint32Value());
+
+    using retType = uint32_t;
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
+        _code = RHSP_RESULT_OK;
+        _data = rhsp_queryCacheTtlMs(this->obj, query);
+    });
+
+    SET_WORKER_CALLBACK(worker, retType,
+                        { return Napi::Number::New(_env, _data); });
+
+    QUEUE_WORKER(worker);
+}
+
+Napi::Value RevHub::clearQueryCache(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
+        rhsp_clearQueryCache(this->obj);
+        _code = RHSP_RESULT_OK;
+    });
+
+    QUEUE_WORKER(worker);
+}
+
 Napi::Value RevHub::sendWriteCommandInternal(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
@@ -223,7 +618,7 @@ Napi::Value RevHub::sendWriteCommandInternal(const Napi::CallbackInfo &info) {
         payloadData[i] = payload.Get(i).As<Napi::Number>().Uint32Value();
     }
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_sendWriteCommandInternal(
             this->obj, packetTypeID, payloadData, payloadSize, &_nackCode);
     });
@@ -244,7 +639,7 @@ Napi::Value RevHub::sendWriteCommand(const Napi::CallbackInfo &info) {
     }
 
     using retType = RhspPayloadData;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_sendWriteCommand(this->obj, packetTypeID, payloadData,
                                        payloadSize, &_data, &_nackCode);
     });
@@ -274,7 +669,7 @@ Napi::Value RevHub::sendReadCommandInternal(const Napi::CallbackInfo &info) {
         payloadData[i] = payload.Get(i).As<Napi::Number>().Uint32Value();
     }
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_sendReadCommandInternal(
             this->obj, packetTypeID, payloadData, payloadSize, &_nackCode);
     });
@@ -295,7 +690,7 @@ Napi::Value RevHub::sendReadCommand(const Napi::CallbackInfo &info) {
     }
 
     using retType = RhspPayloadData;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_sendReadCommand(this->obj, packetTypeID, payloadData,
                                        payloadSize, &_data, &_nackCode);
     });
@@ -319,10 +714,11 @@ Napi::Value RevHub::getModuleStatus(const Napi::CallbackInfo &info) {
     uint8_t clearStatusAfterResponse = info[0].As<Napi::Boolean>().Value();
 
     using retType = RhspModuleStatus;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getModuleStatus(this->obj, clearStatusAfterResponse,
                                       &_data, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     SET_WORKER_CALLBACK(worker, retType, {
         Napi::Object statusObj = Napi::Object::New(_env);
@@ -337,17 +733,284 @@ Napi::Value RevHub::getModuleStatus(const Napi::CallbackInfo &info) {
 Napi::Value RevHub::sendKeepAlive(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
-    CREATE_VOID_WORKER(
-        worker, env, { _code = rhsp_sendKeepAlive(this->obj, &_nackCode); });
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
+        _code = rhsp_sendKeepAlive(this->obj, &_nackCode);
+    });
+    worker->SetPriority(CommandPriority::Actuation);
 
     QUEUE_WORKER(worker);
 }
 
+void RevHub::startKeepAlive(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    uint32_t intervalMs = info[0].As<Napi::Number>().Uint32Value();
+    Napi::Function onError = info[1].As<Napi::Function>();
+
+    if (intervalMs < KeepAliveThread::minIntervalMs) {
+        Napi::Object errorObj = Napi::Object::New(env);
+        errorObj.Set("errorCode", RHSP_ERROR_ARG_1_OUT_OF_RANGE);
+        NAPI_THROW_VOID(Napi::Error(env, errorObj));
+    }
+
+    // Stop the previous thread before starting a new one
+    this->keepAliveThread.reset();
+
+    Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
+        env, onError, "RevHubKeepAlive", 0, 1);
+    // Keep alive alone should not keep the process running
+    tsfn.Unref(env);
+
+    this->keepAliveThread = std::make_unique<KeepAliveThread>(
+        this->obj, this->commandMutex, intervalMs, tsfn, this->realtimeOptions);
+}
+
+void RevHub::stopKeepAlive(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    this->keepAliveThread.reset();
+}
+
+bool RevHub::beginBlockingI2CCall() {
+    std::scoped_lock<std::mutex> lock{this->blockingI2CMutex};
+    if (this->closing) {
+        return false;
+    }
+    this->blockingI2CCalls++;
+    return true;
+}
+
+void RevHub::endBlockingI2CCall() {
+    std::scoped_lock<std::mutex> lock{this->blockingI2CMutex};
+    this->blockingI2CCalls--;
+    this->blockingI2CCallsDone.notify_all();
+}
+
+void RevHub::waitForBlockingI2CCalls() {
+    std::unique_lock<std::mutex> lock{this->blockingI2CMutex};
+    this->closing = true;
+    this->blockingI2CCallsDone.wait(
+        lock, [this] { return this->blockingI2CCalls == 0; });
+}
+
+void RevHub::setRealtimeOptions(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    Napi::Object optionsObj = info[0].As<Napi::Object>();
+    RealtimeOptions options;
+    if (optionsObj.Get("priority").IsNumber()) {
+        options.priority =
+            optionsObj.Get("priority").As<Napi::Number>().Int32Value();
+    }
+    if (optionsObj.Get("cpu").IsNumber()) {
+        options.cpu = optionsObj.Get("cpu").As<Napi::Number>().Int32Value();
+    }
+    if (optionsObj.Get("lockMemory").IsBoolean()) {
+        options.lockMemory =
+            optionsObj.Get("lockMemory").As<Napi::Boolean>().Value();
+    }
+
+    int result = validateRealtimeOptions(options);
+    // The transmit and receive buffers are in the hub, which is shared by all
+    // threads, so it is locked here rather than by each thread
+    if (result >= 0 && this->obj && options.lockMemory &&
+        !this->hubMemoryLocked) {
+        result = lockMemory(this->obj, rhsp_revHubSize(), true);
+        this->hubMemoryLocked = result >= 0;
+    }
+    if (result < 0) {
+        Napi::Object errorObj = Napi::Object::New(env);
+        errorObj.Set("errorCode", result);
+        NAPI_THROW_VOID(Napi::Error(env, errorObj));
+    }
+    if (!options.lockMemory) {
+        this->unlockHubMemory();
+    }
+
+    this->realtimeOptions = options;
+    if (this->keepAliveThread) {
+        this->keepAliveThread->setRealtimeOptions(options);
+    }
+    for (auto &sampler : this->i2cSamplers) {
+        if (sampler) {
+            sampler->setRealtimeOptions(options);
+        }
+    }
+    if (this->motionProfileExecutor) {
+        this->motionProfileExecutor->setRealtimeOptions(options);
+    }
+    if (this->controlTickScheduler) {
+        this->controlTickScheduler->setRealtimeOptions(options);
+    }
+}
+
+Napi::Value RevHub::getRealtimeStats(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    Napi::Array statsArray = Napi::Array::New(env);
+    auto append = [&](const char *thread, const RealtimeStats &stats) {
+        Napi::Object statsObj = Napi::Object::New(env);
+        statsObj.Set("thread", thread);
+        statsObj.Set("periods", static_cast<double>(stats.periods));
+        statsObj.Set("missedDeadlines",
+                     static_cast<double>(stats.missedDeadlines));
+        statsObj.Set("maxLatenessUs", stats.maxLatenessUs);
+        statsObj.Set("optionsApplied", stats.resultCode >= 0);
+        statsArray[statsArray.Length()] = statsObj;
+    };
+
+    if (this->keepAliveThread) {
+        append("keepAlive", this->keepAliveThread->realtimeStats());
+    }
+    static const char *samplerNames[numberOfI2CChannels] = {
+        "i2cSampler0", "i2cSampler1", "i2cSampler2", "i2cSampler3"};
+    for (int i = 0; i < numberOfI2CChannels; i++) {
+        if (this->i2cSamplers[i]) {
+            append(samplerNames[i], this->i2cSamplers[i]->realtimeStats());
+        }
+    }
+    if (this->motionProfileExecutor) {
+        append("motionProfile", this->motionProfileExecutor->realtimeStats());
+    }
+    if (this->controlTickScheduler) {
+        append("controlTick", this->controlTickScheduler->realtimeStats());
+    }
+    return statsArray;
+}
+
+void RevHub::startControlTick(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    uint32_t periodMs = info[0].As<Napi::Number>().Uint32Value();
+    Napi::Object planObj = info[1].As<Napi::Object>();
+    Napi::Function onTick = info[2].As<Napi::Function>();
+
+    ControlTickPlan plan;
+    plan.bulkInput = planObj.Get("bulkInput").IsBoolean() &&
+                     planObj.Get("bulkInput").As<Napi::Boolean>().Value();
+    if (planObj.Get("i2cReads").IsArray()) {
+        Napi::Array readsArray = planObj.Get("i2cReads").As<Napi::Array>();
+        for (uint32_t i = 0; i < readsArray.Length(); i++) {
+            Napi::Object readObj = readsArray.Get(i).As<Napi::Object>();
+            ControlTickPlan::I2CRead read;
+            read.i2cChannel =
+                readObj.Get("i2cChannel").As<Napi::Number>().Uint32Value();
+            read.operations = i2cOperationsFromArray(
+                readObj.Get("operations").As<Napi::Array>());
+            if (read.i2cChannel >= numberOfI2CChannels) {
+                Napi::Object errorObj = Napi::Object::New(env);
+                errorObj.Set("errorCode", RHSP_ERROR_ARG_1_OUT_OF_RANGE);
+                NAPI_THROW_VOID(Napi::Error(env, errorObj));
+            }
+            plan.i2cReads.push_back(std::move(read));
+        }
+    }
+
+    // Stop the previous scheduler before starting a new one
+    this->controlTickScheduler.reset();
+
+    // Not unreferenced: like setInterval, a running tick keeps the process
+    // alive
+    Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
+        env, onTick, "RevHubControlTick",
+        ControlTickScheduler::maxQueuedResults, 1);
+    this->controlTickScheduler = std::make_unique<ControlTickScheduler>(
+        this->obj, this->commandMutex, periodMs, std::move(plan), tsfn, this->realtimeOptions);
+}
+
+void RevHub::stopControlTick(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    this->controlTickScheduler.reset();
+}
+
+void RevHub::setControlTickOutputs(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    Napi::Array outputsArray = info[0].As<Napi::Array>();
+
+    int result = this->controlTickScheduler ? RHSP_RESULT_OK : RHSP_ERROR;
+    for (uint32_t i = 0; result >= 0 && i < outputsArray.Length(); i++) {
+        Napi::Object outputObj = outputsArray.Get(i).As<Napi::Object>();
+        std::string type = outputObj.Get("type").As<Napi::String>();
+        uint8_t channel =
+            outputObj.Get("channel").As<Napi::Number>().Uint32Value();
+        double value = outputObj.Get("value").As<Napi::Number>().DoubleValue();
+
+        ControlTickOutput output;
+        if (type == "motorConstantPower") {
+            output = ControlTickOutput::MotorConstantPower;
+        } else if (type == "motorTargetVelocity") {
+            output = ControlTickOutput::MotorTargetVelocity;
+        } else if (type == "servoPulseWidth") {
+            output = ControlTickOutput::ServoPulseWidth;
+        } else {
+            result = RHSP_ERROR_ARG_0_OUT_OF_RANGE;
+            break;
+        }
+        if (this->controlTickScheduler->setOutput(output, channel, value) < 0) {
+            result = RHSP_ERROR_ARG_0_OUT_OF_RANGE;
+        }
+    }
+
+    if (result < 0) {
+        Napi::Object errorObj = Napi::Object::New(env);
+        errorObj.Set("errorCode", result);
+        NAPI_THROW_VOID(Napi::Error(env, errorObj));
+    }
+}
+
+Napi::Value RevHub::getControlTickStats(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    if (!this->controlTickScheduler) {
+        return env.Undefined();
+    }
+    ControlTickScheduler::Stats stats = this->controlTickScheduler->stats();
+
+    auto histogramToArray = [&](const auto &histogram) {
+        Napi::Array histogramArray = Napi::Array::New(env, histogram.size());
+        for (uint32_t i = 0; i < histogram.size(); i++) {
+            histogramArray[i] = static_cast<double>(histogram[i]);
+        }
+        return histogramArray;
+    };
+    Napi::Array bucketsArray = Napi::Array::New(
+        env, ControlTickScheduler::histogramBucketsUs.size());
+    for (uint32_t i = 0; i < ControlTickScheduler::histogramBucketsUs.size();
+         i++) {
+        bucketsArray[i] = ControlTickScheduler::histogramBucketsUs[i];
+    }
+
+    Napi::Object statsObj = Napi::Object::New(env);
+    statsObj.Set("ticks", static_cast<double>(stats.ticks));
+    statsObj.Set("missedTicks", static_cast<double>(stats.missedTicks));
+    statsObj.Set("overruns", static_cast<double>(stats.overruns));
+    statsObj.Set("droppedResults", static_cast<double>(stats.droppedResults));
+    statsObj.Set("histogramBucketsUs", bucketsArray);
+    statsObj.Set("jitterHistogram", histogramToArray(stats.jitterHistogram));
+    statsObj.Set("durationHistogram",
+                 histogramToArray(stats.durationHistogram));
+    return statsObj;
+}
+
+void RevHub::unlockHubMemory() {
+    if (this->hubMemoryLocked) {
+        lockMemory(this->obj, rhsp_revHubSize(), false);
+        this->hubMemoryLocked = false;
+    }
+}
+
 Napi::Value RevHub::sendFailSafe(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
-    CREATE_VOID_WORKER(worker, env,
-                      { _code = rhsp_sendFailSafe(this->obj, &_nackCode); });
+    // output writes queued before the fail safe are cancelled, since it runs
+    // ahead of them
+    this->failSafes++;
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
+        _code = rhsp_sendFailSafe(this->obj, &_nackCode);
+    });
+    worker->SetPriority(CommandPriority::Safety);
 
     QUEUE_WORKER(worker);
 }
@@ -357,10 +1020,11 @@ Napi::Value RevHub::setNewModuleAddress(const Napi::CallbackInfo &info) {
 
     uint8_t newModuleAddress = info[0].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code =
             rhsp_setNewModuleAddress(this->obj, newModuleAddress, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     QUEUE_WORKER(worker);
 }
@@ -371,11 +1035,12 @@ Napi::Value RevHub::queryInterface(const Napi::CallbackInfo &info) {
     std::string interfaceNameStr = info[0].As<Napi::String>().Utf8Value();
 
     using retType = RhspModuleInterface;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         const char *interfaceName = interfaceNameStr.c_str();
         _code =
             rhsp_queryInterface(this->obj, interfaceName, &_data, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     SET_WORKER_CALLBACK(worker, retType, {
         Napi::Object interfaceObj = Napi::Object::New(_env);
@@ -395,9 +1060,10 @@ Napi::Value RevHub::setModuleLEDColor(const Napi::CallbackInfo &info) {
     uint8_t green = info[1].As<Napi::Number>().Uint32Value();
     uint8_t blue = info[2].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setModuleLedColor(this->obj, red, green, blue, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     QUEUE_WORKER(worker);
 }
@@ -405,20 +1071,22 @@ Napi::Value RevHub::setModuleLEDColor(const Napi::CallbackInfo &info) {
 Napi::Value RevHub::getModuleLEDColor(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
-    using retType = uint8_t *;
-    CREATE_WORKER(worker, env, retType, {
-        _data = new uint8_t[3];
-
-        _code = rhsp_getModuleLedColor(this->obj, &_data[0], &_data[1],
-                                          &_data[2], &_nackCode);
+    using retType = struct {
+        uint8_t red;
+        uint8_t green;
+        uint8_t blue;
+    };
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
+        _code = rhsp_getModuleLedColor(this->obj, &_data.red, &_data.green,
+                                          &_data.blue, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     SET_WORKER_CALLBACK(worker, retType, {
         Napi::Object RGB = Napi::Object::New(_env);
-        RGB.Set("red", _data[0]);
-        RGB.Set("green", _data[1]);
-        RGB.Set("blue", _data[2]);
-        delete[] _data;
+        RGB.Set("red", _data.red);
+        RGB.Set("green", _data.green);
+        RGB.Set("blue", _data.blue);
         return RGB;
     });
 
@@ -465,9 +1133,10 @@ Napi::Value RevHub::setModuleLEDPattern(const Napi::CallbackInfo &info) {
     ledPattern.rgbtPatternStep15 =
         ledPatternObj.Get("rgbtPatternStep15").As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setModuleLedPattern(this->obj, &ledPattern, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     QUEUE_WORKER(worker);
 }
@@ -476,9 +1145,10 @@ Napi::Value RevHub::getModuleLEDPattern(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
     using retType = RhspLedPattern;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getModuleLedPattern(this->obj, &_data, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     SET_WORKER_CALLBACK(worker, retType, {
         Napi::Object ledPatternObj = Napi::Object::New(_env);
@@ -514,10 +1184,11 @@ Napi::Value RevHub::setDebugLogLevel(const Napi::CallbackInfo &info) {
         static_cast<RhspVerbosityLevel>(
             info[1].As<Napi::Number>().Uint32Value());
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setDebugLogLevel(this->obj, debugGroupNumber,
                                          verbosityLevel, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     QUEUE_WORKER(worker);
 }
@@ -529,9 +1200,10 @@ Napi::Value RevHub::discoverRevHubs(const Napi::CallbackInfo &info) {
         Napi::ObjectWrap<Serial>::Unwrap(info[0].As<Napi::Object>());
 
     using retType = RhspDiscoveredAddresses;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, serialPort->getCommandMutex(), retType, {
         _code = rhsp_discoverRevHubs(serialPort->getSerialObj(), &_data);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     SET_WORKER_CALLBACK(worker, retType, {
         Napi::Object discoveredAddressesObj = Napi::Object::New(_env);
@@ -558,11 +1230,12 @@ Napi::Value RevHub::getInterfacePacketID(const Napi::CallbackInfo &info) {
     uint16_t functionNumber = info[1].As<Napi::Number>().Uint32Value();
 
     using retType = uint16_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         const char *interfaceName = interfaceNameStr.c_str();
         _code = rhsp_getInterfacePacketID(this->obj, interfaceName,
                                              functionNumber, &_data, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     SET_WORKER_CALLBACK(worker, retType,
                         { return Napi::Number::New(_env, _data); });
@@ -574,29 +1247,119 @@ Napi::Value RevHub::getBulkInputData(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
     using retType = RhspBulkInputData;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code =
             rhsp_getBulkInputData(this->obj, &_data, &_nackCode);
     });
 
+    SET_WORKER_CALLBACK(worker, retType,
+                        { return bulkInputDataToObject(_env, _data); });
+
+    QUEUE_WORKER(worker);
+}
+
+Napi::Value RevHub::getBulkInputDataFromHubs(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    // this hub first, so responses are received through it
+    std::vector<RhspRevHub *> hubs{this->obj};
+    Napi::Array otherHubs = info[0].As<Napi::Array>();
+    for (uint32_t i = 0; i < otherHubs.Length(); i++) {
+        Napi::Value otherHub = otherHubs[i];
+        hubs.push_back(
+            Napi::ObjectWrap<RevHub>::Unwrap(otherHub.As<Napi::Object>())->obj);
+    }
+
+    using retType = std::vector<RhspHubBulkInputData>;
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
+        _data.resize(hubs.size());
+        int result = rhsp_getBulkInputDataFromHubs(hubs.data(), hubs.size(),
+                                                   _data.data());
+        // a module that fails is reported in its own entry, so only fail
+        // the call when none has answered
+        _code = RHSP_RESULT_OK;
+        bool anyAnswered = false;
+        for (const RhspHubBulkInputData &hubData : _data) {
+            anyAnswered = anyAnswered || hubData.resultCode >= 0;
+        }
+        if (!anyAnswered) {
+            _code = result;
+            _nackCode = _data[0].nackReasonCode;
+        }
+    });
+
+    SET_WORKER_CALLBACK(worker, retType, {
+        Napi::Array samples = Napi::Array::New(_env, _data.size());
+        bool haveTimestamp = false;
+        uint32_t firstTimestampUs = 0;
+        uint32_t skewUs = 0;
+        for (size_t i = 0; i < _data.size(); i++) {
+            const RhspHubBulkInputData &hubData = _data[i];
+            Napi::Object sample = Napi::Object::New(_env);
+            if (hubData.resultCode >= 0) {
+                sample.Set("timestampUs", hubData.timestampUs);
+                sample.Set("bulkInputData",
+                           bulkInputDataToObject(_env, hubData.data));
+                // timestamps are received in order, so the first one is the
+                // earliest
+                if (!haveTimestamp) {
+                    firstTimestampUs = hubData.timestampUs;
+                    haveTimestamp = true;
+                }
+                uint32_t offsetUs = hubData.timestampUs - firstTimestampUs;
+                skewUs = offsetUs > skewUs ? offsetUs : skewUs;
+            } else {
+                Napi::Object errorObj = Napi::Object::New(_env);
+                errorObj.Set("errorCode", hubData.resultCode);
+                if (hubData.resultCode == RHSP_ERROR_NACK_RECEIVED) {
+                    errorObj.Set("nackCode", hubData.nackReasonCode);
+                }
+                sample.Set("error", errorObj);
+            }
+            samples[i] = sample;
+        }
+        Napi::Object result = Napi::Object::New(_env);
+        result.Set("samples", samples);
+        result.Set("skewUs", skewUs);
+        return result;
+    });
+
+    QUEUE_WORKER(worker);
+}
+
+Napi::Value RevHub::commitOutputFrame(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    Napi::Array settersArray = info[0].As<Napi::Array>();
+    std::vector<OutputFrameSetter> setters(settersArray.Length());
+    for (uint32_t i = 0; i < settersArray.Length(); i++) {
+        setters[i] = outputFrameSetterFromObject(
+            settersArray.Get(i).As<Napi::Object>());
+    }
+
+    // The frame is opened, filled and committed while holding the mutex, so
+    // no other command sees it open.
+    using retType = std::pair<RhspBulkInputData, std::vector<int>>;
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
+        rhsp_beginOutputFrame(this->obj);
+        for (const OutputFrameSetter &setter : setters) {
+            _data.second.push_back(applyOutputFrameSetter(this->obj, setter));
+        }
+        _code = rhsp_commitOutputFrame(this->obj, &_data.first, &_nackCode);
+    });
+    worker->SetPriority(CommandPriority::Actuation);
+    worker->CancelOnFailSafe(this->failSafes);
+
     SET_WORKER_CALLBACK(worker, retType, {
-        Napi::Object bulkInputDataObj = Napi::Object::New(_env);
-        bulkInputDataObj.Set("digitalInputs", _data.digitalInputs);
-        bulkInputDataObj.Set("motor0position_enc", _data.motor0position_enc);
-        bulkInputDataObj.Set("motor1position_enc", _data.motor1position_enc);
-        bulkInputDataObj.Set("motor2position_enc", _data.motor2position_enc);
-        bulkInputDataObj.Set("motor3position_enc", _data.motor3position_enc);
-        bulkInputDataObj.Set("motorStatus", _data.motorStatus);
-        bulkInputDataObj.Set("motor0velocity_cps", _data.motor0velocity_cps);
-        bulkInputDataObj.Set("motor1velocity_cps", _data.motor1velocity_cps);
-        bulkInputDataObj.Set("motor2velocity_cps", _data.motor2velocity_cps);
-        bulkInputDataObj.Set("motor3velocity_cps", _data.motor3velocity_cps);
-        bulkInputDataObj.Set("analog0_mV", _data.analog0_mV);
-        bulkInputDataObj.Set("analog1_mV", _data.analog1_mV);
-        bulkInputDataObj.Set("analog2_mV", _data.analog2_mV);
-        bulkInputDataObj.Set("analog3_mV", _data.analog3_mV);
-        bulkInputDataObj.Set("attentionRequired", _data.attentionRequired);
-        return bulkInputDataObj;
+        Napi::Array setterResults = Napi::Array::New(_env, _data.second.size());
+        for (uint32_t i = 0; i < _data.second.size(); i++) {
+            setterResults[i] = _data.second[i];
+        }
+
+        Napi::Object result = Napi::Object::New(_env);
+        result.Set("bulkInputData", bulkInputDataToObject(_env, _data.first));
+        result.Set("setterResults", setterResults);
+        return result;
     });
 
     QUEUE_WORKER(worker);
@@ -609,7 +1372,7 @@ Napi::Value RevHub::getADC(const Napi::CallbackInfo &info) {
     uint8_t rawMode = info[1].As<Napi::Number>().Uint32Value();
 
     using retType = int16_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getADC(this->obj, adcChannelToRead, rawMode,
                                              &_data, &_nackCode);
     });
@@ -620,15 +1383,55 @@ Napi::Value RevHub::getADC(const Napi::CallbackInfo &info) {
     QUEUE_WORKER(worker);
 }
 
+Napi::Value RevHub::getADCSweep(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    Napi::Array channelsArray = info[0].As<Napi::Array>();
+    uint8_t rawMode = info[1].As<Napi::Number>().Uint32Value();
+
+    // an oversized list is rejected by rhsp_getADCSweep
+    uint8_t channelCount = channelsArray.Length() <= RHSP_NUMBER_OF_ADC_CHANNELS
+                               ? channelsArray.Length()
+                               : 0;
+    std::vector<uint8_t> channels(channelCount);
+    for (int i = 0; i < channelCount; i++) {
+        channels[i] = channelsArray.Get(i).As<Napi::Number>().Uint32Value();
+    }
+
+    using retType = struct {
+        uint32_t timestampMs;
+        int16_t values[RHSP_NUMBER_OF_ADC_CHANNELS];
+    };
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
+        _code = rhsp_getADCSweep(this->obj, channels.data(), channelCount,
+                                 rawMode, _data.values, &_data.timestampMs,
+                                 &_nackCode);
+    });
+
+    SET_WORKER_CALLBACK(worker, retType, {
+        Napi::Object sweep = Napi::Object::New(_env);
+        sweep.Set("timestampMs", _data.timestampMs);
+        Napi::Array values = Napi::Array::New(_env, channelCount);
+        for (int i = 0; i < channelCount; i++) {
+            values[i] = _data.values[i];
+        }
+        sweep.Set("values", values);
+        return sweep;
+    });
+
+    QUEUE_WORKER(worker);
+}
+
 Napi::Value RevHub::setPhoneChargeControl(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
     uint8_t chargeEnable = info[0].As<Napi::Boolean>().Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_phoneChargeControl(this->obj, chargeEnable,
                                                          &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     QUEUE_WORKER(worker);
 }
@@ -637,10 +1440,11 @@ Napi::Value RevHub::getPhoneChargeControl(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
     using retType = uint8_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code =
             rhsp_phoneChargeQuery(this->obj, &_data, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     SET_WORKER_CALLBACK(worker, retType,
                         { return Napi::Boolean::New(_env, _data); });
@@ -652,11 +1456,12 @@ Napi::Value RevHub::injectDataLogHint(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
     std::string hintTextStr = info[0].As<Napi::String>().Utf8Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         const char *hintText = hintTextStr.c_str();
         _code = rhsp_injectDataLogHint(this->obj, hintText,
                                                         &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     QUEUE_WORKER(worker);
 }
@@ -668,10 +1473,11 @@ Napi::Value RevHub::readVersionString(const Napi::CallbackInfo &info) {
         uint8_t textLength;
         char text[40];
     };
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_readVersionString(
             this->obj, &_data.textLength, _data.text, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     SET_WORKER_CALLBACK(worker, retType, {
         return Napi::String::New(_env, _data.text, _data.textLength);
@@ -684,9 +1490,10 @@ Napi::Value RevHub::readVersion(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
     using retType = RhspVersion;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_readVersion(this->obj, &_data, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     SET_WORKER_CALLBACK(worker, retType, {
         Napi::Object version = Napi::Object::New(_env);
@@ -707,10 +1514,11 @@ Napi::Value RevHub::setFTDIResetControl(const Napi::CallbackInfo &info) {
 
     uint8_t ftdiResetControl = info[0].As<Napi::Boolean>().Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_ftdiResetControl(this->obj, ftdiResetControl,
                                                        &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     QUEUE_WORKER(worker);
 }
@@ -719,10 +1527,11 @@ Napi::Value RevHub::getFTDIResetControl(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
     using retType = uint8_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code =
             rhsp_ftdiResetQuery(this->obj, &_data, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Diagnostics);
 
     SET_WORKER_CALLBACK(worker, retType,
                         { return Napi::Boolean::New(_env, _data); });
@@ -736,9 +1545,11 @@ Napi::Value RevHub::setDigitalSingleOutput(const Napi::CallbackInfo &info) {
     uint8_t dioPin = info[0].As<Napi::Number>().Uint32Value();
     uint8_t value = info[1].As<Napi::Boolean>().Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setSingleOutput(this->obj, dioPin, value, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
+    worker->CancelOnFailSafe(this->failSafes);
 
     QUEUE_WORKER(worker);
 }
@@ -748,9 +1559,11 @@ Napi::Value RevHub::setDigitalAllOutputs(const Napi::CallbackInfo &info) {
 
     uint8_t bitPackedField = info[0].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setAllOutputs(this->obj, bitPackedField, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
+    worker->CancelOnFailSafe(this->failSafes);
 
     QUEUE_WORKER(worker);
 }
@@ -761,9 +1574,10 @@ Napi::Value RevHub::setDigitalDirection(const Napi::CallbackInfo &info) {
     uint8_t dioPin = info[0].As<Napi::Number>().Uint32Value();
     uint8_t direction = info[1].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setDirection(this->obj, dioPin, direction, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
 
     QUEUE_WORKER(worker);
 }
@@ -774,7 +1588,7 @@ Napi::Value RevHub::getDigitalDirection(const Napi::CallbackInfo &info) {
     uint8_t dioPin = info[0].As<Napi::Number>().Uint32Value();
 
     using retType = uint8_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getDirection(this->obj, dioPin, &_data, &_nackCode);
     });
 
@@ -790,7 +1604,7 @@ Napi::Value RevHub::getDigitalSingleInput(const Napi::CallbackInfo &info) {
     uint8_t dioPin = info[0].As<Napi::Number>().Uint32Value();
 
     using retType = uint8_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getSingleInput(this->obj, dioPin, &_data, &_nackCode);
     });
 
@@ -804,7 +1618,7 @@ Napi::Value RevHub::getDigitalAllInputs(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
     using retType = uint8_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getAllInputs(this->obj, &_data, &_nackCode);
     });
 
@@ -820,10 +1634,11 @@ Napi::Value RevHub::setI2CChannelConfiguration(const Napi::CallbackInfo &info) {
     uint8_t i2cChannel = info[0].As<Napi::Number>().Uint32Value();
     uint8_t speedCode = info[1].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_configureI2cChannel(this->obj, i2cChannel, speedCode,
                                              &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
 
     QUEUE_WORKER(worker);
 }
@@ -834,7 +1649,7 @@ Napi::Value RevHub::getI2CChannelConfiguration(const Napi::CallbackInfo &info) {
     uint8_t i2cChannel = info[0].As<Napi::Number>().Uint32Value();
 
     using retType = uint8_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code =
             rhsp_configureI2cQuery(this->obj, i2cChannel, &_data, &_nackCode);
     });
@@ -852,7 +1667,7 @@ Napi::Value RevHub::writeI2CSingleByte(const Napi::CallbackInfo &info) {
     uint8_t slaveAddress = info[1].As<Napi::Number>().Uint32Value();
     uint8_t byte = info[2].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_writeSingleByte(this->obj, i2cChannel, slaveAddress,
                                             byte, &_nackCode);
     });
@@ -873,7 +1688,7 @@ Napi::Value RevHub::writeI2CMultipleBytes(const Napi::CallbackInfo &info) {
         bytes[i] = bytesArray.Get(i).As<Napi::Number>().Uint32Value();
     }
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_writeMultipleBytes(this->obj, i2cChannel, slaveAddress,
                                                numBytes, bytes, &_nackCode);
         delete[] bytes;
@@ -891,7 +1706,7 @@ Napi::Value RevHub::getI2CWriteStatus(const Napi::CallbackInfo &info) {
         uint8_t i2cTransactionStatus;
         uint8_t numBytesWritten;
     };
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_writeStatusQuery(this->obj, i2cChannel,
                                              &_data.i2cTransactionStatus,
                                              &_data.numBytesWritten, &_nackCode);
@@ -913,7 +1728,7 @@ Napi::Value RevHub::readI2CSingleByte(const Napi::CallbackInfo &info) {
     uint8_t i2cChannel = info[0].As<Napi::Number>().Uint32Value();
     uint8_t slaveAddress = info[1].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_readSingleByte(this->obj, i2cChannel, slaveAddress,
                                            &_nackCode);
     });
@@ -928,7 +1743,7 @@ Napi::Value RevHub::readI2CMultipleBytes(const Napi::CallbackInfo &info) {
     uint8_t slaveAddress = info[1].As<Napi::Number>().Uint32Value();
     uint8_t numBytesToRead = info[2].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_readMultipleBytes(this->obj, i2cChannel, slaveAddress,
                                               numBytesToRead, &_nackCode);
     });
@@ -944,7 +1759,7 @@ Napi::Value RevHub::writeI2CReadMultipleBytes(const Napi::CallbackInfo &info) {
     uint8_t numBytesToRead = info[2].As<Napi::Number>().Uint32Value();
     uint8_t startAddress = info[3].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_writeReadMultipleBytes(this->obj, i2cChannel,
                                                    slaveAddress, numBytesToRead,
                                                    startAddress, &_nackCode);
@@ -963,7 +1778,7 @@ Napi::Value RevHub::getI2CReadStatus(const Napi::CallbackInfo &info) {
         uint8_t numBytesRead;
         uint8_t bytes[100];
     };
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_readStatusQuery(
             this->obj, i2cChannel, &_data.i2cTransactionStatus,
             &_data.numBytesRead, _data.bytes, &_nackCode);
@@ -984,6 +1799,180 @@ Napi::Value RevHub::getI2CReadStatus(const Napi::CallbackInfo &info) {
     QUEUE_WORKER(worker);
 }
 
+Napi::Value RevHub::i2cRead(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    uint8_t i2cChannel = info[0].As<Napi::Number>().Uint32Value();
+    uint8_t targetAddress = info[1].As<Napi::Number>().Uint32Value();
+    uint8_t numBytesToRead = info[2].As<Napi::Number>().Uint32Value();
+    bool hasRegister = info.Length() > 3 && info[3].IsNumber();
+    uint8_t startAddress =
+        hasRegister ? info[3].As<Napi::Number>().Uint32Value() : 0;
+
+    using retType = struct {
+        uint8_t i2cTransactionStatus;
+        uint8_t numBytesRead;
+        uint8_t bytes[100];
+    };
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
+        if (!this->beginBlockingI2CCall()) {
+            _code = RHSP_ERROR_NOT_OPENED;
+            return;
+        }
+        if (hasRegister) {
+            _code = rhsp_writeReadMultipleBytesBlocking(
+                this->obj, i2cChannel, targetAddress, numBytesToRead,
+                startAddress, &_data.i2cTransactionStatus,
+                &_data.numBytesRead, _data.bytes, &_nackCode);
+        } else {
+            _code = rhsp_readMultipleBytesBlocking(
+                this->obj, i2cChannel, targetAddress, numBytesToRead,
+                &_data.i2cTransactionStatus, &_data.numBytesRead,
+                _data.bytes, &_nackCode);
+        }
+        this->endBlockingI2CCall();
+    });
+
+    SET_WORKER_CALLBACK(worker, retType, {
+        Napi::Object i2cReadStatus = Napi::Object::New(_env);
+        i2cReadStatus.Set("i2cTransactionStatus", _data.i2cTransactionStatus);
+        i2cReadStatus.Set("numBytesRead", _data.numBytesRead);
+        Napi::Array bytes = Napi::Array::New(_env, _data.numBytesRead);
+        for (int i = 0; i < _data.numBytesRead; i++) {
+            bytes[i] = _data.bytes[i];
+        }
+        i2cReadStatus.Set("bytes", bytes);
+        return i2cReadStatus;
+    });
+
+    QUEUE_WORKER(worker);
+}
+
+Napi::Value RevHub::runI2COperations(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    uint8_t i2cChannel = info[0].As<Napi::Number>().Uint32Value();
+    std::vector<RhspI2cOperation> operations =
+        i2cOperationsFromArray(info[1].As<Napi::Array>());
+
+    using retType = std::vector<RhspI2cOperation>;
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
+        if (!this->beginBlockingI2CCall()) {
+            _code = RHSP_ERROR_NOT_OPENED;
+            return;
+        }
+        _data = operations;
+        _code = rhsp_runI2cOperations(this->obj, i2cChannel, _data.data(),
+                                      _data.size(), nullptr, &_nackCode);
+        this->endBlockingI2CCall();
+    });
+
+    SET_WORKER_CALLBACK(worker, retType, {
+        Napi::Array results = Napi::Array::New(_env, _data.size());
+        for (uint32_t i = 0; i < _data.size(); i++) {
+            const RhspI2cOperation &operation = _data[i];
+            uint8_t numBytes =
+                operation.type == RHSP_I2C_OPERATION_WRITE ? 0 : operation.length;
+            Napi::Array bytes = Napi::Array::New(_env, numBytes);
+            for (int j = 0; j < numBytes; j++) {
+                bytes[j] = operation.buffer[j];
+            }
+            results[i] = bytes;
+        }
+        return results;
+    });
+
+    QUEUE_WORKER(worker);
+}
+
+void RevHub::startI2CSampler(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    uint8_t i2cChannel = info[0].As<Napi::Number>().Uint32Value();
+    std::vector<RhspI2cOperation> operations =
+        i2cOperationsFromArray(info[1].As<Napi::Array>());
+    uint32_t periodMs = info[2].As<Napi::Number>().Uint32Value();
+    uint32_t capacity = info.Length() > 3 && info[3].IsNumber()
+                            ? info[3].As<Napi::Number>().Uint32Value()
+                            : 256;
+
+    if (i2cChannel >= numberOfI2CChannels) {
+        Napi::Object errorObj = Napi::Object::New(env);
+        errorObj.Set("errorCode", RHSP_ERROR_ARG_0_OUT_OF_RANGE);
+        NAPI_THROW_VOID(Napi::Error(env, errorObj));
+    }
+    if (periodMs == 0) {
+        Napi::Object errorObj = Napi::Object::New(env);
+        errorObj.Set("errorCode", RHSP_ERROR_ARG_2_OUT_OF_RANGE);
+        NAPI_THROW_VOID(Napi::Error(env, errorObj));
+    }
+    if (capacity == 0 || capacity > I2CSampler::maxCapacity) {
+        Napi::Object errorObj = Napi::Object::New(env);
+        errorObj.Set("errorCode", RHSP_ERROR_ARG_3_OUT_OF_RANGE);
+        NAPI_THROW_VOID(Napi::Error(env, errorObj));
+    }
+
+    // Stop the previous sampler before starting a new one
+    this->i2cSamplers[i2cChannel].reset();
+    this->i2cSamplers[i2cChannel] = std::make_unique<I2CSampler>(
+        this->obj, this->commandMutex, i2cChannel, std::move(operations), periodMs, capacity,
+        this->realtimeOptions);
+}
+
+void RevHub::stopI2CSampler(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    uint8_t i2cChannel = info[0].As<Napi::Number>().Uint32Value();
+
+    if (i2cChannel < numberOfI2CChannels) {
+        this->i2cSamplers[i2cChannel].reset();
+    }
+}
+
+Napi::Value RevHub::drainI2CSamples(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    uint8_t i2cChannel = info[0].As<Napi::Number>().Uint32Value();
+
+    std::vector<I2CSample> samples;
+    uint32_t droppedSamples = 0;
+    if (i2cChannel < numberOfI2CChannels && this->i2cSamplers[i2cChannel]) {
+        droppedSamples = this->i2cSamplers[i2cChannel]->drain(samples);
+    }
+
+    Napi::Array samplesArray = Napi::Array::New(env, samples.size());
+    for (uint32_t i = 0; i < samples.size(); i++) {
+        const I2CSample &sample = samples[i];
+        Napi::Object sampleObj = Napi::Object::New(env);
+        sampleObj.Set("timestampMs", sample.timestampMs);
+        if (sample.resultCode < 0) {
+            Napi::Object errorObj = Napi::Object::New(env);
+            errorObj.Set("errorCode", sample.resultCode);
+            if (sample.resultCode == RHSP_ERROR_NACK_RECEIVED) {
+                errorObj.Set("nackCode", sample.nackCode);
+            }
+            sampleObj.Set("error", errorObj);
+        }
+        Napi::Array bytes = Napi::Array::New(env, sample.numBytes);
+        for (int j = 0; j < sample.numBytes; j++) {
+            bytes[j] = sample.bytes[j];
+        }
+        sampleObj.Set("bytes", bytes);
+        samplesArray[i] = sampleObj;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("samples", samplesArray);
+    result.Set("droppedSamples", droppedSamples);
+    return result;
+}
+
+void RevHub::stopAllI2CSamplers() {
+    for (auto &sampler : this->i2cSamplers) {
+        sampler.reset();
+    }
+}
+
 Napi::Value RevHub::setMotorChannelMode(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
@@ -991,10 +1980,11 @@ Napi::Value RevHub::setMotorChannelMode(const Napi::CallbackInfo &info) {
     uint8_t motorMode = info[1].As<Napi::Number>().Uint32Value();
     uint8_t floatAtZero = info[2].As<Napi::Boolean>().Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setMotorChannelMode(this->obj, motorChannel, static_cast<MotorMode>(motorMode),
                                              floatAtZero, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
 
     QUEUE_WORKER(worker);
 }
@@ -1008,7 +1998,7 @@ Napi::Value RevHub::getMotorChannelMode(const Napi::CallbackInfo &info) {
         uint8_t motorMode;
         uint8_t floatAtZero;
     };
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code =
             rhsp_getMotorChannelMode(this->obj, motorChannel, &_data.motorMode,
                                          &_data.floatAtZero, &_nackCode);
@@ -1031,10 +2021,12 @@ Napi::Value RevHub::setMotorChannelEnable(const Napi::CallbackInfo &info) {
     uint8_t motorChannel = info[0].As<Napi::Number>().Uint32Value();
     uint8_t enabled = info[1].As<Napi::Boolean>().Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setMotorChannelEnable(this->obj, motorChannel, enabled,
                                                &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
+    worker->CancelOnFailSafe(this->failSafes);
 
     QUEUE_WORKER(worker);
 }
@@ -1045,7 +2037,7 @@ Napi::Value RevHub::getMotorChannelEnable(const Napi::CallbackInfo &info) {
     uint8_t motorChannel = info[0].As<Napi::Number>().Uint32Value();
 
     using retType = uint8_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getMotorChannelEnable(this->obj, motorChannel, &_data,
                                                &_nackCode);
     });
@@ -1063,10 +2055,11 @@ Napi::Value RevHub::setMotorChannelCurrentAlertLevel(
     uint8_t motorChannel = info[0].As<Napi::Number>().Uint32Value();
     uint16_t currentLimit_mA = info[1].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setMotorChannelCurrentAlertLevel(
             this->obj, motorChannel, currentLimit_mA, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
 
     QUEUE_WORKER(worker);
 }
@@ -1078,7 +2071,7 @@ Napi::Value RevHub::getMotorChannelCurrentAlertLevel(
     uint8_t motorChannel = info[0].As<Napi::Number>().Uint32Value();
 
     using retType = uint16_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getMotorChannelCurrentAlertLevel(this->obj, motorChannel,
                                                           &_data, &_nackCode);
     });
@@ -1094,9 +2087,10 @@ Napi::Value RevHub::resetMotorEncoder(const Napi::CallbackInfo &info) {
 
     uint8_t motorChannel = info[0].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_resetEncoder(this->obj, motorChannel, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
 
     QUEUE_WORKER(worker);
 }
@@ -1107,10 +2101,17 @@ Napi::Value RevHub::setMotorConstantPower(const Napi::CallbackInfo &info) {
     uint8_t motorChannel = info[0].As<Napi::Number>().Uint32Value();
     double powerLevel = info[1].As<Napi::Number>().DoubleValue();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setMotorConstantPower(this->obj, motorChannel, powerLevel,
                                                &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
+    worker->CancelOnFailSafe(this->failSafes);
+    // a write that is rejected for its arguments must not replace others
+    if (motorChannel < numberOfMotorChannels) {
+        worker->SetSupersessionKey(
+            {this->obj, RHSP_DEKA_SET_MOTOR_CONSTANT_POWER, motorChannel});
+    }
 
     QUEUE_WORKER(worker);
 }
@@ -1121,7 +2122,7 @@ Napi::Value RevHub::getMotorConstantPower(const Napi::CallbackInfo &info) {
     uint8_t motorChannel = info[0].As<Napi::Number>().Uint32Value();
 
     using retType = double;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getMotorConstantPower(this->obj, motorChannel, &_data,
                                                &_nackCode);
     });
@@ -1138,10 +2139,17 @@ Napi::Value RevHub::setMotorTargetVelocity(const Napi::CallbackInfo &info) {
     uint8_t motorChannel = info[0].As<Napi::Number>().Uint32Value();
     int16_t motorVelocity = info[1].As<Napi::Number>().Int32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setMotorTargetVelocity(this->obj, motorChannel,
                                                 motorVelocity, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
+    worker->CancelOnFailSafe(this->failSafes);
+    // a write that is rejected for its arguments must not replace others
+    if (motorChannel < numberOfMotorChannels) {
+        worker->SetSupersessionKey(
+            {this->obj, RHSP_DEKA_SET_MOTOR_TARGET_VELOCITY, motorChannel});
+    }
 
     QUEUE_WORKER(worker);
 }
@@ -1152,7 +2160,7 @@ Napi::Value RevHub::getMotorTargetVelocity(const Napi::CallbackInfo &info) {
     uint8_t motorChannel = info[0].As<Napi::Number>().Uint32Value();
 
     using retType = int16_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getMotorTargetVelocity(this->obj, motorChannel, &_data,
                                                 &_nackCode);
     });
@@ -1170,10 +2178,17 @@ Napi::Value RevHub::setMotorTargetPosition(const Napi::CallbackInfo &info) {
     int32_t targetPosition = info[1].As<Napi::Number>().Int32Value();
     uint16_t targetTolerance = info[2].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setMotorTargetPosition(
             this->obj, motorChannel, targetPosition, targetTolerance, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
+    worker->CancelOnFailSafe(this->failSafes);
+    // a write that is rejected for its arguments must not replace others
+    if (motorChannel < numberOfMotorChannels) {
+        worker->SetSupersessionKey(
+            {this->obj, RHSP_DEKA_SET_MOTOR_TARGET_POSITION, motorChannel});
+    }
 
     QUEUE_WORKER(worker);
 }
@@ -1187,7 +2202,7 @@ Napi::Value RevHub::getMotorTargetPosition(const Napi::CallbackInfo &info) {
         int32_t targetPosition;
         uint16_t targetTolerance;
     };
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getMotorTargetPosition(this->obj, motorChannel,
                                                 &_data.targetPosition,
                                                 &_data.targetTolerance, &_nackCode);
@@ -1209,7 +2224,7 @@ Napi::Value RevHub::getMotorAtTarget(const Napi::CallbackInfo &info) {
     uint8_t motorChannel = info[0].As<Napi::Number>().Uint32Value();
 
     using retType = uint8_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_isMotorAtTarget(this->obj, motorChannel, &_data,
                                                &_nackCode);
     });
@@ -1226,7 +2241,7 @@ Napi::Value RevHub::getMotorEncoderPosition(const Napi::CallbackInfo &info) {
     uint8_t motorChannel = info[0].As<Napi::Number>().Uint32Value();
 
     using retType = int32_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
       _code = rhsp_getEncoderPosition(this->obj, motorChannel, &_data,
                                                &_nackCode);
     });
@@ -1237,6 +2252,132 @@ Napi::Value RevHub::getMotorEncoderPosition(const Napi::CallbackInfo &info) {
     QUEUE_WORKER(worker);
 }
 
+Napi::Value RevHub::getEncoderHistory(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    uint32_t maxSamples = info.Length() > 0 && info[0].IsNumber()
+                              ? info[0].As<Napi::Number>().Uint32Value()
+                              : RHSP_ENCODER_HISTORY_SIZE;
+    if (maxSamples > RHSP_ENCODER_HISTORY_SIZE) {
+        maxSamples = RHSP_ENCODER_HISTORY_SIZE;
+    }
+
+    using retType = std::vector<RhspEncoderSample>;
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
+        _data.resize(maxSamples);
+        _data.resize(rhsp_getEncoderHistory(this->obj, _data.data(), maxSamples));
+        _code = RHSP_RESULT_OK;
+    });
+
+    SET_WORKER_CALLBACK(worker, retType, {
+        Napi::Array result = Napi::Array::New(_env, _data.size());
+        for (uint32_t i = 0; i < _data.size(); i++) {
+            result[i] = encoderSampleToObject(_env, _data[i]);
+        }
+        return result;
+    });
+
+    QUEUE_WORKER(worker);
+}
+
+Napi::Value RevHub::getLatestEncoderSample(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    using retType = std::optional<RhspEncoderSample>;
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
+        RhspEncoderSample sample;
+        if (rhsp_getLatestEncoderSample(this->obj, &sample) >= 0) {
+            _data = sample;
+        } else {
+            _data.reset();
+        }
+        _code = RHSP_RESULT_OK;
+    });
+
+    SET_WORKER_CALLBACK(worker, retType, {
+        if (!_data) {
+            return _env.Undefined();
+        }
+        return Napi::Value(encoderSampleToObject(_env, *_data));
+    });
+
+    QUEUE_WORKER(worker);
+}
+
+Napi::Value RevHub::setEncoderFilterGains(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    double alpha = info[0].As<Napi::Number>().DoubleValue();
+    double beta = info[1].As<Napi::Number>().DoubleValue();
+    double gamma = info[2].As<Napi::Number>().DoubleValue();
+
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
+        _code = rhsp_setEncoderFilterGains(this->obj, alpha, beta, gamma);
+    });
+    worker->SetPriority(CommandPriority::Actuation);
+
+    QUEUE_WORKER(worker);
+}
+
+void RevHub::runMotionProfile(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    uint8_t motorChannel = info[0].As<Napi::Number>().Uint32Value();
+    Napi::Object profileObj = info[1].As<Napi::Object>();
+    Napi::Function onComplete = info[2].As<Napi::Function>();
+
+    RhspMotionConstraints constraints;
+    constraints.distance =
+        profileObj.Get("distance").As<Napi::Number>().DoubleValue();
+    constraints.maxVelocity =
+        profileObj.Get("maxVelocity").As<Napi::Number>().DoubleValue();
+    constraints.maxAcceleration =
+        profileObj.Get("maxAcceleration").As<Napi::Number>().DoubleValue();
+    constraints.maxJerk =
+        profileObj.Has("maxJerk") && profileObj.Get("maxJerk").IsNumber()
+            ? profileObj.Get("maxJerk").As<Napi::Number>().DoubleValue()
+            : 0;
+    double positionGain =
+        profileObj.Has("positionGain") && profileObj.Get("positionGain").IsNumber()
+            ? profileObj.Get("positionGain").As<Napi::Number>().DoubleValue()
+            : 0;
+
+    if (motorChannel >= MotionProfileExecutor::numberOfMotorChannels) {
+        Napi::Object errorObj = Napi::Object::New(env);
+        errorObj.Set("errorCode", RHSP_ERROR_ARG_0_OUT_OF_RANGE);
+        NAPI_THROW_VOID(Napi::Error(env, errorObj));
+    }
+
+    RhspMotionProfile profile;
+    if (rhsp_planMotionProfile(&constraints, &profile) < 0 ||
+        !(positionGain >= 0)) {
+        Napi::Object errorObj = Napi::Object::New(env);
+        errorObj.Set("errorCode", RHSP_ERROR_ARG_1_OUT_OF_RANGE);
+        NAPI_THROW_VOID(Napi::Error(env, errorObj));
+    }
+
+    if (!this->motionProfileExecutor) {
+        this->motionProfileExecutor = std::make_unique<MotionProfileExecutor>(
+            this->obj, this->commandMutex, motionProfilePeriodMs, this->realtimeOptions);
+    }
+    // Not unreferenced: a running profile keeps the process alive
+    Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
+        env, onComplete, "RevHubMotionProfile", 0, 1);
+    this->motionProfileExecutor->start(motorChannel, profile, positionGain,
+                                       tsfn);
+}
+
+void RevHub::cancelMotionProfile(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    uint8_t motorChannel = info[0].As<Napi::Number>().Uint32Value();
+
+    if (this->motionProfileExecutor &&
+        motorChannel < MotionProfileExecutor::numberOfMotorChannels) {
+        this->motionProfileExecutor->cancel(motorChannel);
+    }
+}
+
 Napi::Value RevHub::setMotorClosedLoopControlCoefficients(const Napi::CallbackInfo &info) {
     Napi::Env env = info.Env();
 
@@ -1258,7 +2399,7 @@ Napi::Value RevHub::setMotorClosedLoopControlCoefficients(const Napi::CallbackIn
         feedForwardCoeff = fValue.As<Napi::Number>().DoubleValue();
     }
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         ClosedLoopControlParameters p;
         p.type = algorithm;
 
@@ -1276,6 +2417,7 @@ Napi::Value RevHub::setMotorClosedLoopControlCoefficients(const Napi::CallbackIn
         _code = rhsp_setClosedLoopControlCoefficients(
             this->obj, motorChannel, static_cast<MotorMode>(motorMode), &p, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
 
     QUEUE_WORKER(worker);
 }
@@ -1289,7 +2431,7 @@ Napi::Value RevHub::getMotorClosedLoopControlCoefficients(const Napi::CallbackIn
     using retType = struct {
         ClosedLoopControlParameters params;
     };
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getClosedLoopControlCoefficients(
             this->obj, motorChannel, static_cast<MotorMode>(motorMode), &_data.params, &_nackCode);
     });
@@ -1320,10 +2462,11 @@ Napi::Value RevHub::setServoConfiguration(const Napi::CallbackInfo &info) {
     uint8_t servoChannel = info[0].As<Napi::Number>().Uint32Value();
     uint16_t framePeriod = info[1].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setServoConfiguration(this->obj, servoChannel,
                                             framePeriod, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
 
     QUEUE_WORKER(worker);
 }
@@ -1334,7 +2477,7 @@ Napi::Value RevHub::getServoConfiguration(const Napi::CallbackInfo &info) {
     uint8_t servoChannel = info[0].As<Napi::Number>().Uint32Value();
 
     using retType = uint16_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getServoConfiguration(this->obj, servoChannel, &_data,
                                             &_nackCode);
     });
@@ -1351,10 +2494,17 @@ Napi::Value RevHub::setServoPulseWidth(const Napi::CallbackInfo &info) {
     uint8_t servoChannel = info[0].As<Napi::Number>().Uint32Value();
     uint16_t pulseWidth = info[1].As<Napi::Number>().Uint32Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_setServoPulseWidth(this->obj, servoChannel, pulseWidth,
                                         &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
+    worker->CancelOnFailSafe(this->failSafes);
+    // a write that is rejected for its arguments must not replace others
+    if (servoChannel < numberOfServoChannels && pulseWidth != 0) {
+        worker->SetSupersessionKey(
+            {this->obj, RHSP_DEKA_SET_SERVO_PULSE_WIDTH, servoChannel});
+    }
 
     QUEUE_WORKER(worker);
 }
@@ -1365,7 +2515,7 @@ Napi::Value RevHub::getServoPulseWidth(const Napi::CallbackInfo &info) {
     uint8_t servoChannel = info[0].As<Napi::Number>().Uint32Value();
 
     using retType = uint16_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code = rhsp_getServoPulseWidth(this->obj, servoChannel, &_data,
                                         &_nackCode);
     });
@@ -1382,10 +2532,12 @@ Napi::Value RevHub::setServoEnable(const Napi::CallbackInfo &info) {
     uint8_t servoChannel = info[0].As<Napi::Number>().Uint32Value();
     uint8_t enable = info[1].As<Napi::Boolean>().Value();
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code =
             rhsp_setServoEnable(this->obj, servoChannel, enable, &_nackCode);
     });
+    worker->SetPriority(CommandPriority::Actuation);
+    worker->CancelOnFailSafe(this->failSafes);
 
     QUEUE_WORKER(worker);
 }
@@ -1396,7 +2548,7 @@ Napi::Value RevHub::getServoEnable(const Napi::CallbackInfo &info) {
     uint8_t servoChannel = info[0].As<Napi::Number>().Uint32Value();
 
     using retType = uint8_t;
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _code =
             rhsp_getServoEnable(this->obj, servoChannel, &_data, &_nackCode);
     });
@@ -3,6 +3,22 @@
 
 #include <napi.h>
 #include "rhsp/rhsp.h"
+#include "ControlTickScheduler.h"
+#include "I2CSampler.h"
+#include "KeepAliveThread.h"
+#include "MotionProfileExecutor.h"
+#include "PriorityMutex.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+/**
+ * @brief Convert bulk input data to the object returned by getBulkInputData.
+ */
+Napi::Object bulkInputDataToObject(Napi::Env env,
+                                   const RhspBulkInputData &data);
 
 class RevHub : public Napi::ObjectWrap<RevHub> {
   public:
@@ -18,12 +34,30 @@ class RevHub : public Napi::ObjectWrap<RevHub> {
     Napi::Value getDestAddress(const Napi::CallbackInfo &info);
     void setResponseTimeoutMs(const Napi::CallbackInfo &info);
     Napi::Value getResponseTimeoutMs(const Napi::CallbackInfo &info);
+    void setAdaptiveResponseTimeout(const Napi::CallbackInfo &info);
+    Napi::Value isAdaptiveResponseTimeoutEnabled(const Napi::CallbackInfo &info);
+    void setReadRetryLimit(const Napi::CallbackInfo &info);
+    Napi::Value getReadRetryLimit(const Napi::CallbackInfo &info);
+    Napi::Value getLinkStats(const Napi::CallbackInfo &info);
+    Napi::Value publishTelemetry(const Napi::CallbackInfo &info);
+    Napi::Value stopPublishingTelemetry(const Napi::CallbackInfo &info);
+    Napi::Value setQueryCacheTtlMs(const Napi::CallbackInfo &info);
+    Napi::Value getQueryCacheTtlMs(const Napi::CallbackInfo &info);
+    Napi::Value clearQueryCache(const Napi::CallbackInfo &info);
     Napi::Value sendWriteCommandInternal(const Napi::CallbackInfo &info);
     Napi::Value sendWriteCommand(const Napi::CallbackInfo &info);
     Napi::Value sendReadCommandInternal(const Napi::CallbackInfo &info);
     Napi::Value sendReadCommand(const Napi::CallbackInfo &info);
     Napi::Value getModuleStatus(const Napi::CallbackInfo &info);
     Napi::Value sendKeepAlive(const Napi::CallbackInfo &info);
+    void startKeepAlive(const Napi::CallbackInfo &info);
+    void stopKeepAlive(const Napi::CallbackInfo &info);
+    void setRealtimeOptions(const Napi::CallbackInfo &info);
+    Napi::Value getRealtimeStats(const Napi::CallbackInfo &info);
+    void startControlTick(const Napi::CallbackInfo &info);
+    void stopControlTick(const Napi::CallbackInfo &info);
+    void setControlTickOutputs(const Napi::CallbackInfo &info);
+    Napi::Value getControlTickStats(const Napi::CallbackInfo &info);
     Napi::Value sendFailSafe(const Napi::CallbackInfo &info);
     Napi::Value setNewModuleAddress(const Napi::CallbackInfo &info);
     Napi::Value queryInterface(const Napi::CallbackInfo &info);
@@ -38,7 +72,10 @@ class RevHub : public Napi::ObjectWrap<RevHub> {
     /* Device Control */
 
     Napi::Value getBulkInputData(const Napi::CallbackInfo &info);
+    Napi::Value getBulkInputDataFromHubs(const Napi::CallbackInfo &info);
+    Napi::Value commitOutputFrame(const Napi::CallbackInfo &info);
     Napi::Value getADC(const Napi::CallbackInfo &info);
+    Napi::Value getADCSweep(const Napi::CallbackInfo &info);
     Napi::Value setPhoneChargeControl(const Napi::CallbackInfo &info);
     Napi::Value getPhoneChargeControl(const Napi::CallbackInfo &info);
     Napi::Value injectDataLogHint(const Napi::CallbackInfo &info);
@@ -65,6 +102,11 @@ class RevHub : public Napi::ObjectWrap<RevHub> {
     Napi::Value readI2CMultipleBytes(const Napi::CallbackInfo &info);
     Napi::Value writeI2CReadMultipleBytes(const Napi::CallbackInfo &info);
     Napi::Value getI2CReadStatus(const Napi::CallbackInfo &info);
+    Napi::Value i2cRead(const Napi::CallbackInfo &info);
+    Napi::Value runI2COperations(const Napi::CallbackInfo &info);
+    void startI2CSampler(const Napi::CallbackInfo &info);
+    void stopI2CSampler(const Napi::CallbackInfo &info);
+    Napi::Value drainI2CSamples(const Napi::CallbackInfo &info);
 
     /* Motor */
     Napi::Value setMotorChannelMode(const Napi::CallbackInfo &info);
@@ -82,6 +124,11 @@ class RevHub : public Napi::ObjectWrap<RevHub> {
     Napi::Value getMotorTargetPosition(const Napi::CallbackInfo &info);
     Napi::Value getMotorAtTarget(const Napi::CallbackInfo &info);
     Napi::Value getMotorEncoderPosition(const Napi::CallbackInfo &info);
+    Napi::Value getEncoderHistory(const Napi::CallbackInfo &info);
+    Napi::Value getLatestEncoderSample(const Napi::CallbackInfo &info);
+    Napi::Value setEncoderFilterGains(const Napi::CallbackInfo &info);
+    void runMotionProfile(const Napi::CallbackInfo &info);
+    void cancelMotionProfile(const Napi::CallbackInfo &info);
     Napi::Value setMotorClosedLoopControlCoefficients(const Napi::CallbackInfo &info);
     Napi::Value getMotorClosedLoopControlCoefficients(const Napi::CallbackInfo &info);
 
@@ -94,7 +141,45 @@ class RevHub : public Napi::ObjectWrap<RevHub> {
     Napi::Value getServoEnable(const Napi::CallbackInfo &info);
 
   private:
-    RhspRevHub* obj;
+    static constexpr int numberOfI2CChannels = 4;
+    static constexpr int numberOfMotorChannels = 4;
+    static constexpr int numberOfServoChannels = 6;
+    static constexpr uint32_t motionProfilePeriodMs = 10;
+
+    void stopAllI2CSamplers();
+    void unlockHubMemory();
+
+    /**
+     * @brief Register a blocking i2c call, which releases the mutex while it
+     * waits for the hub.
+     *
+     * @return false if the hub is being closed and the call must not run
+     */
+    bool beginBlockingI2CCall();
+    void endBlockingI2CCall();
+    /**
+     * @brief Stop new blocking i2c calls and wait for the running ones.
+     */
+    void waitForBlockingI2CCalls();
+
+    RhspRevHub* obj = nullptr;
+    // mutex of the serial port of the hub, shared with the native threads
+    std::shared_ptr<PriorityMutex> commandMutex;
+    // fail safes queued so far, see RHSPlibWorkerBase::CancelOnFailSafe
+    std::atomic<uint64_t> failSafes{0};
+    RealtimeOptions realtimeOptions;  // of native threads started from now on
+    bool hubMemoryLocked = false;
+    std::unique_ptr<KeepAliveThread> keepAliveThread;
+    std::unique_ptr<I2CSampler> i2cSamplers[numberOfI2CChannels];
+    std::unique_ptr<MotionProfileExecutor> motionProfileExecutor;
+    std::unique_ptr<ControlTickScheduler> controlTickScheduler;
+
+    // close() and the destructor wait for blocking i2c calls, since those can
+    // run while the mutex is held by someone else
+    std::mutex blockingI2CMutex;
+    std::condition_variable blockingI2CCallsDone;
+    int blockingI2CCalls = 0;
+    bool closing = false;
 };
 
 #endif
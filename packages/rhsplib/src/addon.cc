@@ -1,11 +1,14 @@
 #include <napi.h>
 
+#include "RHSPlibWorker.h"
 #include "RevHubWrapper.h"
 #include "serialWrapper.h"
 
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
   RevHub::Init(env, exports);
   Serial::Init(env, exports);
+  exports.Set("getWorkerStats",
+              Napi::Function::New(env, RHSPlibWorkerBase::GetStats));
   return exports;
 }
 
@@ -1,6 +1,32 @@
 #include "serialWrapper.h"
 
 #include "RHSPlibWorker.h"
+#include "rhsp/rhsp.h"
+
+Napi::Object linkStatsToObject(Napi::Env env, const RhspLinkStats &stats) {
+    Napi::Object statsObj = Napi::Object::New(env);
+    statsObj.Set("framesSent", stats.framesSent);
+    statsObj.Set("framesReceived", stats.framesReceived);
+    statsObj.Set("bytesSent", stats.bytesSent);
+    statsObj.Set("bytesReceived", stats.bytesReceived);
+    statsObj.Set("checksumErrors", stats.checksumErrors);
+    statsObj.Set("resyncs", stats.resyncs);
+    statsObj.Set("discardedBytes", stats.discardedBytes);
+    statsObj.Set("timeouts", stats.timeouts);
+    statsObj.Set("nacks", stats.nacks);
+    statsObj.Set("attentionRequired", stats.attentionRequired);
+    statsObj.Set("retries", stats.retries);
+
+    // only codes that have been received, so polling stays cheap
+    Napi::Object nacksByCode = Napi::Object::New(env);
+    for (uint32_t code = 0; code < RHSP_LINK_STATS_NUMBER_OF_NACK_CODES; code++) {
+        if (stats.nacksByCode[code] != 0) {
+            nacksByCode.Set(code, stats.nacksByCode[code]);
+        }
+    }
+    statsObj.Set("nacksByCode", nacksByCode);
+    return statsObj;
+}
 
 // See https://github.com/nodejs/node-addon-api/blob/main/doc/object_wrap.md
 Napi::Object Serial::Init(Napi::Env env, Napi::Object exports) {
@@ -11,6 +37,9 @@ Napi::Object Serial::Init(Napi::Env env, Napi::Object exports) {
                       Serial::InstanceMethod("close", &Serial::close),
                       Serial::InstanceMethod("read", &Serial::read),
                       Serial::InstanceMethod("write", &Serial::write),
+                      Serial::InstanceMethod("getLinkStats", &Serial::getLinkStats),
+                      Serial::InstanceMethod("getCommandQueueStats",
+                                             &Serial::getCommandQueueStats),
                   });
 
     Napi::FunctionReference *constructor = new Napi::FunctionReference();
@@ -45,7 +74,7 @@ Napi::Value Serial::open(const Napi::CallbackInfo &info) {
         static_cast<RhspSerialFlowControl>(
             info[5].As<Napi::Number>().Uint32Value());
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         const char *serialPortName = serialPortNameStr.c_str();
         _code = rhsp_serialOpen(&this->serialPort, serialPortName, baudrate,
                                     databits, parity, stopbits, flowControl);
@@ -67,7 +96,7 @@ Napi::Value Serial::read(const Napi::CallbackInfo &info) {
 
     using retType = uint8_t *;
 
-    CREATE_WORKER(worker, env, retType, {
+    CREATE_WORKER(worker, env, this->commandMutex, retType, {
         _data = new uint8_t[bytesToRead];
 
         _code = rhsp_serialRead(&this->serialPort, _data, bytesToRead);
@@ -96,10 +125,42 @@ Napi::Value Serial::write(const Napi::CallbackInfo &info) {
         buffer[i] = data.Get(i).As<Napi::Number>().Uint32Value();
     }
 
-    CREATE_VOID_WORKER(worker, env, {
+    CREATE_VOID_WORKER(worker, env, this->commandMutex, {
         _code = rhsp_serialWrite(&this->serialPort, buffer, bytesToWrite);
         delete[] buffer;
     });
 
     QUEUE_WORKER(worker);
 }
+
+Napi::Value Serial::getLinkStats(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    RhspLinkStats stats;
+    rhsp_getSerialLinkStats(&this->serialPort, &stats);
+    return linkStatsToObject(env, stats);
+}
+
+Napi::Value Serial::getCommandQueueStats(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+
+    const std::pair<const char *, CommandPriority> priorities[] = {
+        {"safety", CommandPriority::Safety},
+        {"actuation", CommandPriority::Actuation},
+        {"telemetry", CommandPriority::Telemetry},
+        {"diagnostics", CommandPriority::Diagnostics},
+    };
+    Napi::Object queues = Napi::Object::New(env);
+    for (const auto &[name, priority] : priorities) {
+        CommandQueueStats queueStats = this->commandMutex->stats(priority);
+        Napi::Object queue = Napi::Object::New(env);
+        queue.Set("waiting", queueStats.waiting);
+        queue.Set("maxWaiting", queueStats.maxWaiting);
+        queue.Set("acquired", static_cast<double>(queueStats.acquired));
+        queue.Set("promoted", static_cast<double>(queueStats.promoted));
+        queue.Set("totalWaitUs", static_cast<double>(queueStats.totalWaitUs));
+        queue.Set("maxWaitUs", queueStats.maxWaitUs);
+        queues.Set(name, queue);
+    }
+    return queues;
+}
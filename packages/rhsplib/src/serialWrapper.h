@@ -2,8 +2,11 @@
 #define SERIAL_WRAPPER_H_
 
 #include "rhsp/serial.h"
+#include "PriorityMutex.h"
 #include <napi.h>
 
+#include <memory>
+
 class Serial : public Napi::ObjectWrap<Serial> {
   public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
@@ -14,11 +17,25 @@ class Serial : public Napi::ObjectWrap<Serial> {
     void close(const Napi::CallbackInfo &info);
     Napi::Value read(const Napi::CallbackInfo &info);
     Napi::Value write(const Napi::CallbackInfo &info);
+    Napi::Value getLinkStats(const Napi::CallbackInfo &info);
+    Napi::Value getCommandQueueStats(const Napi::CallbackInfo &info);
 
     RhspSerial *getSerialObj() { return &serialPort; };
 
+    /**
+     * @brief Get the mutex that serializes the commands sent through the
+     * port. It is shared with the hubs opened on the port.
+     */
+    const std::shared_ptr<PriorityMutex> &getCommandMutex() {
+        return commandMutex;
+    }
+
   private:
     RhspSerial serialPort;
+    std::shared_ptr<PriorityMutex> commandMutex =
+        std::make_shared<PriorityMutex>();
 };
 
+Napi::Object linkStatsToObject(Napi::Env env, const RhspLinkStats &stats);
+
 #endif